@@ -403,6 +403,56 @@ extern DECLSPEC SDL_AudioStatus SDLCALL
 SDL_GetAudioDeviceStatus(SDL_AudioDeviceID dev);
 /* @} *//* Audio State */
 
+/**
+ *  \name Audio device statistics
+ *
+ *  Timing counters from a playback device's audio thread, to find out why
+ *  audio glitches. They are only collected on devices opened while
+ *  SDL_HINT_AUDIO_DEVICE_STATS is set, and only for devices SDL runs the
+ *  audio thread of. All times are in microseconds.
+ */
+/* @{ */
+#define SDL_AUDIO_STATS_BUCKETS 16
+
+typedef struct SDL_AudioDeviceStats
+{
+    Uint32 buffers;         /**< Device buffers played */
+    Uint32 buffer_time;     /**< How long one device buffer plays for */
+    Uint32 underruns;       /**< Buffers that took longer to produce than the previous one played for */
+    Uint32 callbacks;       /**< Times the callback ran (it doesn't while paused) */
+    Uint64 callback_time;   /**< Total time spent in the callback */
+    Uint32 callback_max;    /**< The longest callback */
+    Uint32 callback_histogram[SDL_AUDIO_STATS_BUCKETS];    /**< Callbacks by duration: bucket 0 took under 16us,
+                                                                 each bucket after is twice as wide as the one
+                                                                 before, and the last has all the longer ones */
+    Uint64 convert_time;    /**< Total time converting the callback's audio to the device's format */
+    Uint64 wait_time;       /**< Total time blocked waiting for the device to want more */
+    Uint32 queue_bytes;     /**< Bytes waiting in the SDL_QueueAudio() queue when the callback last ran */
+    Uint32 queue_bytes_min; /**< The fewest bytes there were waiting when the callback ran */
+    Uint32 queue_underruns; /**< Times the queue ran dry after it had a callback's worth */
+} SDL_AudioDeviceStats;
+
+/**
+ *  Get the statistics of an audio device opened while
+ *  SDL_HINT_AUDIO_DEVICE_STATS was set.
+ *
+ *  \param dev The device to query.
+ *  \param stats Filled in with the device's statistics so far.
+ *  \return 0 on success, or -1 if the device doesn't exist or isn't
+ *          collecting statistics.
+ *
+ *  \sa SDL_ResetAudioDeviceStats
+ */
+extern DECLSPEC int SDLCALL SDL_GetAudioDeviceStats(SDL_AudioDeviceID dev, SDL_AudioDeviceStats *stats);
+
+/**
+ *  Start an audio device's statistics over, to measure a part of a program.
+ *
+ *  \sa SDL_GetAudioDeviceStats
+ */
+extern DECLSPEC void SDLCALL SDL_ResetAudioDeviceStats(SDL_AudioDeviceID dev);
+/* @} *//* Audio device statistics */
+
 /**
  *  \name Pause audio functions
  *
@@ -435,7 +485,11 @@ extern DECLSPEC void SDLCALL SDL_PauseAudioDevice(SDL_AudioDeviceID dev,
  *
  *  This function returns NULL and sets the SDL error message if the
  *  wave file cannot be opened, uses an unknown data format, or is
- *  corrupt.  Currently raw and MS-ADPCM WAVE files are supported.
+ *  corrupt.  Currently raw, IEEE float, MS-ADPCM and IMA-ADPCM WAVE
+ *  files are supported.
+ *
+ *  To play a long file without decoding it all up front, use
+ *  SDL_NewWAVDecoder_RW() instead.
  */
 extern DECLSPEC SDL_AudioSpec *SDLCALL SDL_LoadWAV_RW(SDL_RWops * src,
                                                       int freesrc,
@@ -612,6 +666,112 @@ extern DECLSPEC void SDLCALL SDL_AudioStreamClear(SDL_AudioStream *stream);
  */
 extern DECLSPEC void SDLCALL SDL_FreeAudioStream(SDL_AudioStream *stream);
 
+
+/*
+ *  SDL_WAVDecoder is a way to play a WAVE file without loading and decoding
+ *  all of it first, like SDL_LoadWAV_RW() does: it reads and decodes the
+ *  data chunk a block at a time as you ask for audio, and can seek to any
+ *  sample frame. PCM, IEEE float, MS-ADPCM and IMA-ADPCM files are handled.
+ *
+ *  Each decoder keeps all of its state to itself, so different threads can
+ *  use different decoders at the same time. A single decoder isn't
+ *  thread-safe, though.
+ */
+/* this is opaque to the outside world. */
+struct _SDL_WAVDecoder;
+typedef struct _SDL_WAVDecoder SDL_WAVDecoder;
+
+/**
+ *  Open a WAVE file for streaming. This reads the headers up to the start of
+ *  the audio data, the audio data itself is read as it's needed.
+ *
+ *  \param src The data source; it has to stay seekable and open as long as
+ *             the decoder does.
+ *  \param freesrc Non-zero to close \c src when the decoder is freed (or
+ *                 if this function fails).
+ *  \param spec Filled in with the format of the decoded audio. This is the
+ *              same format SDL_LoadWAV_RW() would report for this file.
+ *  \return The new decoder, or NULL on error.
+ *
+ *  \sa SDL_WAVDecoderRead
+ *  \sa SDL_WAVDecoderPutAudioStream
+ *  \sa SDL_WAVDecoderSeek
+ *  \sa SDL_WAVDecoderTell
+ *  \sa SDL_WAVDecoderLength
+ *  \sa SDL_FreeWAVDecoder
+ */
+extern DECLSPEC SDL_WAVDecoder * SDLCALL SDL_NewWAVDecoder_RW(SDL_RWops *src,
+                                                             int freesrc,
+                                                             SDL_AudioSpec *spec);
+
+/**
+ *  Decode audio from the current position.
+ *
+ *  \param decoder The decoder to read from
+ *  \param buf A buffer to fill with audio data
+ *  \param len The maximum number of bytes to fill; only whole sample
+ *             frames are ever returned.
+ *  \return The number of bytes decoded, 0 at the end of the data, or -1
+ *          on error.
+ *
+ *  \sa SDL_NewWAVDecoder_RW
+ *  \sa SDL_WAVDecoderPutAudioStream
+ */
+extern DECLSPEC int SDLCALL SDL_WAVDecoderRead(SDL_WAVDecoder *decoder, void *buf, int len);
+
+/**
+ *  Decode audio from the current position straight into an audio stream.
+ *
+ *  \param decoder The decoder to read from
+ *  \param stream The stream to put the audio into. It has to have been
+ *                created with the format, channels and rate the decoder
+ *                reported as its source format.
+ *  \param len The maximum number of decoded bytes to put in the stream
+ *  \return The number of decoded bytes put in the stream, 0 at the end of
+ *          the data, or -1 on error.
+ *
+ *  \sa SDL_NewWAVDecoder_RW
+ *  \sa SDL_WAVDecoderRead
+ *  \sa SDL_NewAudioStream
+ */
+extern DECLSPEC int SDLCALL SDL_WAVDecoderPutAudioStream(SDL_WAVDecoder *decoder, SDL_AudioStream *stream, int len);
+
+/**
+ *  Move to a sample frame. For ADPCM files this only decodes the block the
+ *  frame is in, never the blocks before it.
+ *
+ *  \param decoder The decoder to seek
+ *  \param frame The sample frame to continue decoding from. Positions past
+ *               the end of the data seek to the end.
+ *  \return 0 on success, or -1 on error.
+ *
+ *  \sa SDL_WAVDecoderTell
+ *  \sa SDL_WAVDecoderLength
+ */
+extern DECLSPEC int SDLCALL SDL_WAVDecoderSeek(SDL_WAVDecoder *decoder, Uint32 frame);
+
+/**
+ *  Get the sample frame the next read will start at.
+ *
+ *  \sa SDL_WAVDecoderSeek
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVDecoderTell(SDL_WAVDecoder *decoder);
+
+/**
+ *  Get the number of sample frames in the file.
+ *
+ *  \sa SDL_WAVDecoderSeek
+ */
+extern DECLSPEC Uint32 SDLCALL SDL_WAVDecoderLength(SDL_WAVDecoder *decoder);
+
+/**
+ *  Free a WAVE decoder, closing its data source if it was opened with
+ *  \c freesrc set.
+ *
+ *  \sa SDL_NewWAVDecoder_RW
+ */
+extern DECLSPEC void SDLCALL SDL_FreeWAVDecoder(SDL_WAVDecoder *decoder);
+
 #define SDL_MIX_MAXVOLUME 128
 /**
  *  This takes two audio buffers of the playing audio format and mixes
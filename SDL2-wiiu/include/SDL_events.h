@@ -628,6 +628,23 @@ extern DECLSPEC void SDLCALL SDL_FlushEvents(Uint32 minType, Uint32 maxType);
  */
 extern DECLSPEC int SDLCALL SDL_PollEvent(SDL_Event * event);
 
+/**
+ *  \brief Polls for up to \c numevents currently pending events at once.
+ *
+ *  This pumps the event loop once and takes everything it can from the
+ *  queue under a single lock, which is cheaper than calling SDL_PollEvent()
+ *  for each event when a frame brings in many of them.
+ *
+ *  \return The number of events removed from the queue and stored in
+ *          \c events, 0 if there were none available, or -1 if \c events
+ *          is NULL, \c numevents isn't positive, or the event system isn't
+ *          running; call SDL_GetError() for more information.
+ *
+ *  \param events An array with room for at least \c numevents events.
+ *  \param numevents The most events to return.
+ */
+extern DECLSPEC int SDLCALL SDL_PollEvents(SDL_Event * events, int numevents);
+
 /**
  *  \brief Waits indefinitely for the next available event.
  *
@@ -917,6 +917,20 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_RESAMPLING_MODE   "SDL_AUDIO_RESAMPLING_MODE"
 
+/**
+ *  \brief  A variable controlling speed/quality tradeoff of SDL's internal resampler.
+ *
+ *  This is used by SDL_AudioCVT, and by SDL_AudioStream when libsamplerate
+ *  isn't in use, and is checked whenever a converter or stream is built.
+ *
+ *  This variable can be set to the following values:
+ *
+ *    "0" or "fast"    - Interpolate linearly between neighbouring frames
+ *    "1" or "medium"  - Use a short windowed sinc filter
+ *    "2" or "best"    - Use the full windowed sinc filter (default)
+ */
+#define SDL_HINT_AUDIO_RESAMPLING_QUALITY   "SDL_AUDIO_RESAMPLING_QUALITY"
+
 /**
  *  \brief  A variable controlling the audio category on iOS and Mac OS X
  *
@@ -930,6 +944,23 @@ extern "C" {
  */
 #define SDL_HINT_AUDIO_CATEGORY   "SDL_AUDIO_CATEGORY"
 
+/**
+ *  \brief  A variable controlling whether audio devices collect timing statistics
+ *
+ *  Playback devices opened while this is set time their audio thread: how
+ *  long the callback, format conversion and waiting for the device take,
+ *  how often a buffer came too late, and how full the SDL_QueueAudio()
+ *  queue was. Read them with SDL_GetAudioDeviceStats().
+ *
+ *  This variable can be set to the following values:
+ *    "0"       - Don't collect statistics (default)
+ *    "1"       - Collect statistics
+ *    ">1"      - Collect statistics and SDL_Log() them every this many milliseconds
+ *
+ *  This hint is checked when an audio device is opened.
+ */
+#define SDL_HINT_AUDIO_DEVICE_STATS   "SDL_AUDIO_DEVICE_STATS"
+
 /**
  *  \brief  An enumeration of hint priorities
  */
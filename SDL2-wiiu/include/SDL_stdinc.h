@@ -394,6 +394,44 @@ extern DECLSPEC int SDLCALL SDL_SetMemoryFunctions(SDL_malloc_func malloc_func,
  */
 extern DECLSPEC int SDLCALL SDL_GetNumAllocations(void);
 
+#define SDL_MEMORY_SIZE_CLASSES 16
+
+/**
+ *  \brief A snapshot of SDL's allocator, from SDL_GetMemoryStats()
+ *
+ *  Allocations of up to 512 bytes are rounded up to one of the block sizes
+ *  in \c classes and served from an arena SDL reserves on first use.
+ *  Everything else goes to the memory functions, and only shows up in
+ *  \c allocations.
+ */
+typedef struct SDL_MemoryStats
+{
+    int allocations;        /**< Outstanding allocations, as SDL_GetNumAllocations() */
+    int small_allocations;  /**< Outstanding allocations served from the arena */
+    size_t small_bytes;     /**< Bytes of arena blocks in use, rounded up to their class */
+    size_t peak_bytes;      /**< Most arena bytes ever handed out to threads at once, in use or cached */
+    size_t arena_size;      /**< Size of the arena, 0 if it isn't used */
+    size_t arena_used;      /**< Bytes of the arena given to size classes */
+    struct
+    {
+        int size;           /**< Block size */
+        int pages;          /**< Arena pages holding blocks of this size */
+        int in_use;         /**< Blocks allocated */
+        int cached;         /**< Free blocks kept by threads */
+        int free;           /**< Free blocks any thread can take */
+    } classes[SDL_MEMORY_SIZE_CLASSES];
+} SDL_MemoryStats;
+
+/**
+ *  \brief Get statistics about SDL_malloc()'s small block arena
+ *
+ *  The per-thread numbers are read without stopping the threads using
+ *  them, so they can be slightly off while other threads allocate.
+ *
+ *  \param stats Filled in with the current statistics.
+ */
+extern DECLSPEC void SDLCALL SDL_GetMemoryStats(SDL_MemoryStats *stats);
+
 extern DECLSPEC char *SDLCALL SDL_getenv(const char *name);
 extern DECLSPEC int SDLCALL SDL_setenv(const char *name, const char *value, int overwrite);
 
@@ -335,5 +335,302 @@ SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len)
     return packet->data;
 }
 
+
+/* Lock-free single-producer/single-consumer ring queue. */
+
+#define SDL_RINGQUEUE_CACHELINE 64
+#define SDL_RINGQUEUE_MINSIZE 1024
+
+typedef struct SDL_RingQueueSegment
+{
+    /* read position, owned by the consumer. */
+    SDL_atomic_t head;
+    char pad0[SDL_RINGQUEUE_CACHELINE - sizeof (SDL_atomic_t)];
+
+    /* write position, owned by the producer. */
+    SDL_atomic_t tail;
+    char pad1[SDL_RINGQUEUE_CACHELINE - sizeof (SDL_atomic_t)];
+
+    /* set by the producer once it has moved on to a newer segment. */
+    void *next;
+    /* links drained segments on the retired list. */
+    struct SDL_RingQueueSegment *retired_next;
+    Uint32 size;  /* power of two */
+    Uint8 *data;
+} SDL_RingQueueSegment;
+
+struct SDL_RingQueue
+{
+    /* consumer side. */
+    SDL_RingQueueSegment *readseg;
+    SDL_atomic_t bytes_read;
+    char pad0[SDL_RINGQUEUE_CACHELINE - sizeof (void *) - sizeof (SDL_atomic_t)];
+
+    /* producer side. */
+    SDL_RingQueueSegment *writeseg;
+    SDL_RingQueueSegment *spare;  /* a drained segment kept for reuse. */
+    SDL_atomic_t bytes_written;
+    char pad1[SDL_RINGQUEUE_CACHELINE - 2 * sizeof (void *) - sizeof (SDL_atomic_t)];
+
+    /* drained segments, pushed by the consumer, taken by the producer. */
+    void *retired;
+};
+
+static Uint32
+SDL_RingQueueRoundUp(size_t len)
+{
+    Uint32 size = SDL_RINGQUEUE_MINSIZE;
+    while ((size < len) && (size < 0x40000000)) {
+        size <<= 1;
+    }
+    return size;
+}
+
+static SDL_RingQueueSegment *
+SDL_NewRingQueueSegment(const Uint32 size)
+{
+    /* the segment header is followed by its cache-line aligned data. */
+    const size_t headerlen = (sizeof (SDL_RingQueueSegment) + (SDL_RINGQUEUE_CACHELINE - 1)) & ~((size_t) SDL_RINGQUEUE_CACHELINE - 1);
+    Uint8 *mem = (Uint8 *) SDL_malloc(headerlen + size + SDL_RINGQUEUE_CACHELINE);
+    SDL_RingQueueSegment *segment;
+
+    if (!mem) {
+        return NULL;
+    }
+
+    SDL_memset(mem, 0, sizeof (SDL_RingQueueSegment));
+    segment = (SDL_RingQueueSegment *) mem;
+    segment->size = size;
+    segment->data = mem + headerlen;
+    return segment;
+}
+
+static void
+SDL_ResetRingQueueSegment(SDL_RingQueueSegment *segment)
+{
+    SDL_AtomicSet(&segment->head, 0);
+    SDL_AtomicSet(&segment->tail, 0);
+    segment->next = NULL;
+    segment->retired_next = NULL;
+}
+
+/* consumer: hand a drained segment back to the producer. */
+static void
+SDL_RetireRingQueueSegment(SDL_RingQueue *queue, SDL_RingQueueSegment *segment)
+{
+    void *top;
+    do {
+        top = SDL_AtomicGetPtr(&queue->retired);
+        segment->retired_next = (SDL_RingQueueSegment *) top;
+    } while (!SDL_AtomicCASPtr(&queue->retired, top, segment));
+}
+
+/* producer: take back drained segments, keeping the largest as a spare. */
+static void
+SDL_ReclaimRingQueueSegments(SDL_RingQueue *queue)
+{
+    SDL_RingQueueSegment *segment;
+
+    if (SDL_AtomicGetPtr(&queue->retired) == NULL) {
+        return;
+    }
+
+    segment = (SDL_RingQueueSegment *) SDL_AtomicSetPtr(&queue->retired, NULL);
+    while (segment) {
+        SDL_RingQueueSegment *next = segment->retired_next;
+        if (!queue->spare || (queue->spare->size < segment->size)) {
+            SDL_free(queue->spare);
+            queue->spare = segment;
+        } else {
+            SDL_free(segment);
+        }
+        segment = next;
+    }
+}
+
+SDL_RingQueue *
+SDL_NewRingQueue(const size_t initialsize)
+{
+    SDL_RingQueue *queue = (SDL_RingQueue *) SDL_malloc(sizeof (SDL_RingQueue));
+
+    if (!queue) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    SDL_zerop(queue);
+    queue->writeseg = SDL_NewRingQueueSegment(SDL_RingQueueRoundUp(initialsize));
+    if (!queue->writeseg) {
+        SDL_free(queue);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    queue->readseg = queue->writeseg;
+    return queue;
+}
+
+void
+SDL_FreeRingQueue(SDL_RingQueue *queue)
+{
+    if (queue) {
+        SDL_RingQueueSegment *segment = queue->readseg;
+        while (segment) {
+            SDL_RingQueueSegment *next = (SDL_RingQueueSegment *) segment->next;
+            SDL_free(segment);
+            segment = next;
+        }
+        SDL_ReclaimRingQueueSegments(queue);
+        SDL_free(queue->spare);
+        SDL_free(queue);
+    }
+}
+
+void
+SDL_ClearRingQueue(SDL_RingQueue *queue)
+{
+    SDL_RingQueueSegment *segment;
+
+    if (!queue) {
+        return;
+    }
+
+    /* keep the newest (largest) segment, drop the older ones. */
+    segment = queue->readseg;
+    while (segment != queue->writeseg) {
+        SDL_RingQueueSegment *next = (SDL_RingQueueSegment *) segment->next;
+        SDL_free(segment);
+        segment = next;
+    }
+    SDL_ReclaimRingQueueSegments(queue);
+
+    SDL_ResetRingQueueSegment(queue->writeseg);
+    queue->readseg = queue->writeseg;
+    SDL_AtomicSet(&queue->bytes_read, 0);
+    SDL_AtomicSet(&queue->bytes_written, 0);
+}
+
+int
+SDL_WriteToRingQueue(SDL_RingQueue *queue, const void *_data, const size_t _len)
+{
+    size_t len = _len;
+    const Uint8 *data = (const Uint8 *) _data;
+
+    if (!queue) {
+        return SDL_InvalidParamError("queue");
+    }
+
+    SDL_ReclaimRingQueueSegments(queue);
+
+    while (len > 0) {
+        SDL_RingQueueSegment *segment = queue->writeseg;
+        const Uint32 tail = (Uint32) SDL_AtomicGet(&segment->tail);
+        const Uint32 head = (Uint32) SDL_AtomicGet(&segment->head);
+        const Uint32 space = segment->size - (tail - head);
+        Uint32 pos, cpy, first;
+
+        if (space == 0) {
+            /* ring is full; link in a larger one for the consumer to move to. */
+            const Uint32 wantsize = SDL_max(SDL_RingQueueRoundUp(len), (segment->size < 0x40000000) ? segment->size * 2 : segment->size);
+            SDL_RingQueueSegment *newseg;
+            if (queue->spare && (queue->spare->size >= wantsize)) {
+                newseg = queue->spare;
+                queue->spare = NULL;
+                SDL_ResetRingQueueSegment(newseg);
+            } else {
+                newseg = SDL_NewRingQueueSegment(wantsize);
+                if (!newseg) {
+                    return SDL_OutOfMemory();
+                }
+            }
+            SDL_MemoryBarrierRelease();
+            SDL_AtomicSetPtr(&segment->next, newseg);
+            queue->writeseg = newseg;
+            continue;
+        }
+
+        SDL_MemoryBarrierAcquire();  /* the consumer is done with the space we reuse. */
+
+        cpy = (Uint32) SDL_min(len, (size_t) space);
+        pos = tail & (segment->size - 1);
+        first = SDL_min(cpy, segment->size - pos);
+        SDL_memcpy(segment->data + pos, data, first);
+        SDL_memcpy(segment->data, data + first, cpy - first);
+
+        /* count before publishing, so a concurrent count never sees more read than written. */
+        SDL_AtomicAdd(&queue->bytes_written, (int) cpy);
+        SDL_MemoryBarrierRelease();  /* publish the data before the new tail. */
+        SDL_AtomicSet(&segment->tail, (int) (tail + cpy));
+
+        data += cpy;
+        len -= cpy;
+    }
+
+    return 0;
+}
+
+size_t
+SDL_ReadFromRingQueue(SDL_RingQueue *queue, void *_buf, const size_t _len)
+{
+    size_t len = _len;
+    Uint8 *buf = (Uint8 *) _buf;
+    Uint8 *ptr = buf;
+
+    if (!queue) {
+        return 0;
+    }
+
+    while (len > 0) {
+        SDL_RingQueueSegment *segment = queue->readseg;
+        const Uint32 head = (Uint32) SDL_AtomicGet(&segment->head);
+        Uint32 tail = (Uint32) SDL_AtomicGet(&segment->tail);
+        Uint32 pos, cpy, first;
+
+        if (tail == head) {
+            /* drained; move on if the producer has started a newer ring. */
+            SDL_RingQueueSegment *next = (SDL_RingQueueSegment *) SDL_AtomicGetPtr(&segment->next);
+            if (!next) {
+                break;
+            }
+            /* the producer stops writing here before linking the next ring. */
+            tail = (Uint32) SDL_AtomicGet(&segment->tail);
+            if (tail == head) {
+                queue->readseg = next;
+                SDL_RetireRingQueueSegment(queue, segment);
+                continue;
+            }
+        }
+
+        SDL_MemoryBarrierAcquire();  /* see the data published with the tail. */
+
+        cpy = (Uint32) SDL_min(len, (size_t) (tail - head));
+        pos = head & (segment->size - 1);
+        first = SDL_min(cpy, segment->size - pos);
+        SDL_memcpy(ptr, segment->data + pos, first);
+        SDL_memcpy(ptr + first, segment->data, cpy - first);
+
+        SDL_MemoryBarrierRelease();  /* finish reading before freeing the space. */
+        SDL_AtomicSet(&segment->head, (int) (head + cpy));
+        SDL_AtomicAdd(&queue->bytes_read, (int) cpy);
+
+        ptr += cpy;
+        len -= cpy;
+    }
+
+    return (size_t) (ptr - buf);
+}
+
+size_t
+SDL_CountRingQueue(SDL_RingQueue *queue)
+{
+    if (!queue) {
+        return 0;
+    } else {
+        /* read the consumer count first so the difference can't go negative. */
+        const Uint32 bytes_read = (Uint32) SDL_AtomicGet(&queue->bytes_read);
+        const Uint32 bytes_written = (Uint32) SDL_AtomicGet(&queue->bytes_written);
+        return (size_t) (bytes_written - bytes_read);
+    }
+}
+
 /* vi: set ts=4 sw=4 expandtab: */
 
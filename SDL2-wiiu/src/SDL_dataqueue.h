@@ -49,6 +49,32 @@ size_t SDL_CountDataQueue(SDL_DataQueue *queue);
 */
 void *SDL_ReserveSpaceInDataQueue(SDL_DataQueue *queue, const size_t len);
 
+
+/* A lock-free single-producer/single-consumer byte queue.
+
+   Data lives in power-of-two ring buffers with the read and write positions
+   on separate cache lines. One thread may write while another thread reads,
+   without any locks. Writes never fail for lack of space: when the current
+   ring is full, the producer links in a larger one and the consumer moves
+   over once it has drained the old ring. Drained rings are handed back to
+   the producer, which frees or reuses them, so the consumer never calls
+   into the allocator.
+
+   SDL_WriteToRingQueue() must only be called from one thread at a time (the
+   producer) and SDL_ReadFromRingQueue() from one thread at a time (the
+   consumer). SDL_CountRingQueue() is safe from either side. SDL_ClearRingQueue()
+   and SDL_FreeRingQueue() need both sides stopped (or locked out). */
+
+struct SDL_RingQueue;
+typedef struct SDL_RingQueue SDL_RingQueue;
+
+SDL_RingQueue *SDL_NewRingQueue(const size_t initialsize);
+void SDL_FreeRingQueue(SDL_RingQueue *queue);
+void SDL_ClearRingQueue(SDL_RingQueue *queue);
+int SDL_WriteToRingQueue(SDL_RingQueue *queue, const void *data, const size_t len);
+size_t SDL_ReadFromRingQueue(SDL_RingQueue *queue, void *buf, const size_t len);
+size_t SDL_CountRingQueue(SDL_RingQueue *queue);
+
 #endif /* SDL_dataqueue_h_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
@@ -522,7 +522,8 @@ SDL_RemoveAudioDevice(const int iscapture, void *handle)
 static void SDLCALL
 SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 {
-    /* this function always holds the mixer lock before being called. */
+    /* this function always holds the mixer lock before being called.
+       It is the only reader of the queue, so it never waits for the app. */
     SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
     size_t dequeued;
 
@@ -530,12 +531,11 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
     SDL_assert(!device->iscapture);  /* this shouldn't ever happen, right?! */
     SDL_assert(len >= 0);  /* this shouldn't ever happen, right?! */
 
-    dequeued = SDL_ReadFromDataQueue(device->buffer_queue, stream, len);
+    dequeued = SDL_ReadFromRingQueue(device->buffer_queue, stream, len);
     stream += dequeued;
     len -= (int) dequeued;
 
     if (len > 0) {  /* fill any remaining space in the stream with silence. */
-        SDL_assert(SDL_CountDataQueue(device->buffer_queue) == 0);
         SDL_memset(stream, device->spec.silence, len);
     }
 }
@@ -543,7 +543,8 @@ SDL_BufferQueueDrainCallback(void *userdata, Uint8 *stream, int len)
 static void SDLCALL
 SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
 {
-    /* this function always holds the mixer lock before being called. */
+    /* this function always holds the mixer lock before being called.
+       It is the only writer of the queue, so it never waits for the app. */
     SDL_AudioDevice *device = (SDL_AudioDevice *) userdata;
 
     SDL_assert(device != NULL);  /* this shouldn't ever happen, right?! */
@@ -553,7 +554,7 @@ SDL_BufferQueueFillCallback(void *userdata, Uint8 *stream, int len)
     /* note that if this needs to allocate more space and run out of memory,
        we have no choice but to quietly drop the data and hope it works out
        later, but you probably have bigger problems in this case anyhow. */
-    SDL_WriteToDataQueue(device->buffer_queue, stream, len);
+    SDL_WriteToRingQueue(device->buffer_queue, stream, len);
 }
 
 int
@@ -571,9 +572,10 @@ SDL_QueueAudio(SDL_AudioDeviceID devid, const void *data, Uint32 len)
     }
 
     if (len > 0) {
-        current_audio.impl.LockDevice(device);
-        rc = SDL_WriteToDataQueue(device->buffer_queue, data, len);
-        current_audio.impl.UnlockDevice(device);
+        /* only app threads contend here; the audio thread reads lock-free. */
+        SDL_LockMutex(device->buffer_queue_lock);
+        rc = SDL_WriteToRingQueue(device->buffer_queue, data, len);
+        SDL_UnlockMutex(device->buffer_queue_lock);
     }
 
     return rc;
@@ -592,9 +594,10 @@ SDL_DequeueAudio(SDL_AudioDeviceID devid, void *data, Uint32 len)
         return 0;  /* just report zero bytes dequeued. */
     }
 
-    current_audio.impl.LockDevice(device);
-    rc = (Uint32) SDL_ReadFromDataQueue(device->buffer_queue, data, len);
-    current_audio.impl.UnlockDevice(device);
+    /* only app threads contend here; the audio thread writes lock-free. */
+    SDL_LockMutex(device->buffer_queue_lock);
+    rc = (Uint32) SDL_ReadFromRingQueue(device->buffer_queue, data, len);
+    SDL_UnlockMutex(device->buffer_queue_lock);
     return rc;
 }
 
@@ -610,13 +613,12 @@ SDL_GetQueuedAudioSize(SDL_AudioDeviceID devid)
 
     /* Nothing to do unless we're set up for queueing. */
     if (device->callbackspec.callback == SDL_BufferQueueDrainCallback) {
+        retval = (Uint32) SDL_CountRingQueue(device->buffer_queue);
         current_audio.impl.LockDevice(device);
-        retval = ((Uint32) SDL_CountDataQueue(device->buffer_queue)) + current_audio.impl.GetPendingBytes(device);
+        retval += current_audio.impl.GetPendingBytes(device);
         current_audio.impl.UnlockDevice(device);
     } else if (device->callbackspec.callback == SDL_BufferQueueFillCallback) {
-        current_audio.impl.LockDevice(device);
-        retval = (Uint32) SDL_CountDataQueue(device->buffer_queue);
-        current_audio.impl.UnlockDevice(device);
+        retval = (Uint32) SDL_CountRingQueue(device->buffer_queue);
     }
 
     return retval;
@@ -631,16 +633,133 @@ SDL_ClearQueuedAudio(SDL_AudioDeviceID devid)
         return;  /* nothing to do. */
     }
 
-    /* Blank out the device and release the mutex. Free it afterwards. */
+    if (!device->buffer_queue) {
+        return;  /* not set up for queueing. */
+    }
+
+    /* Clearing needs both ends of the queue stopped: lock out the app
+       threads and the audio thread. Keeps the current ring allocated. */
+    SDL_LockMutex(device->buffer_queue_lock);
     current_audio.impl.LockDevice(device);
 
-    /* Keep up to two packets in the pool to reduce future malloc pressure. */
-    SDL_ClearDataQueue(device->buffer_queue, SDL_AUDIOBUFFERQUEUE_PACKETLEN * 2);
+    SDL_ClearRingQueue(device->buffer_queue);
 
     current_audio.impl.UnlockDevice(device);
+    SDL_UnlockMutex(device->buffer_queue_lock);
 }
 
 
+/* What one pass of the audio thread measured, for SDL_GetAudioDeviceStats().
+   Times are in performance counter ticks. */
+typedef struct
+{
+    SDL_bool called;
+    Uint64 callback;
+    Uint64 convert;
+    Uint64 wait;
+    Uint32 buffers;
+    Uint32 underruns;
+    SDL_bool queued;        /* the callback drained the SDL_QueueAudio() queue */
+    Uint32 queue_bytes;
+    SDL_bool queue_dry;
+} SDL_AudioThreadTimes;
+
+static Uint32
+ticks_to_us(Uint64 ticks)
+{
+    return (Uint32) ((ticks * 1000000) / SDL_GetPerformanceFrequency());
+}
+
+static void
+log_audio_stats(SDL_AudioDevice *device, const SDL_AudioDeviceStats *stats)
+{
+    const Uint32 average = stats->callbacks ? (Uint32) (stats->callback_time / stats->callbacks) : 0;
+
+    SDL_Log("Audio device %u: %u buffers of %u us, %u underruns; callback %u us avg, %u us max; convert %u us, wait %u us per buffer",
+            (unsigned int) device->id, (unsigned int) stats->buffers, (unsigned int) stats->buffer_time,
+            (unsigned int) stats->underruns, (unsigned int) average, (unsigned int) stats->callback_max,
+            (unsigned int) (stats->buffers ? stats->convert_time / stats->buffers : 0),
+            (unsigned int) (stats->buffers ? stats->wait_time / stats->buffers : 0));
+    if (device->callbackspec.callback == SDL_BufferQueueDrainCallback) {
+        SDL_Log("Audio device %u: %u bytes queued, %u at the lowest, ran dry %u times",
+                (unsigned int) device->id, (unsigned int) stats->queue_bytes,
+                (unsigned int) stats->queue_bytes_min, (unsigned int) stats->queue_underruns);
+    }
+}
+
+/* Add one pass of the audio thread to the device's statistics */
+static void
+update_audio_stats(SDL_AudioDevice *device, const SDL_AudioThreadTimes *times)
+{
+    SDL_AudioDeviceStats *stats = &device->stats;
+    SDL_AudioDeviceStats logged;
+    SDL_bool log = SDL_FALSE;
+
+    SDL_AtomicLock(&device->stats_lock);
+    stats->buffers += times->buffers;
+    stats->underruns += times->underruns;
+    if (times->called) {
+        const Uint32 us = ticks_to_us(times->callback);
+        int bucket = 0;
+        while (bucket < SDL_AUDIO_STATS_BUCKETS - 1 && (us >> (bucket + 4)) != 0) {
+            ++bucket;
+        }
+        stats->callback_histogram[bucket]++;
+        stats->callbacks++;
+        stats->callback_time += us;
+        if (us > stats->callback_max) {
+            stats->callback_max = us;
+        }
+        if (times->queued) {
+            if (stats->callbacks == 1 || times->queue_bytes < stats->queue_bytes_min) {
+                stats->queue_bytes_min = times->queue_bytes;
+            }
+            stats->queue_bytes = times->queue_bytes;
+            if (times->queue_dry) {
+                stats->queue_underruns++;
+            }
+        }
+    }
+    stats->convert_time += ticks_to_us(times->convert);
+    stats->wait_time += ticks_to_us(times->wait);
+    if (device->stats_log_interval && SDL_TICKS_PASSED(SDL_GetTicks(), device->stats_logged + device->stats_log_interval)) {
+        device->stats_logged = SDL_GetTicks();
+        logged = *stats;
+        log = SDL_TRUE;
+    }
+    SDL_AtomicUnlock(&device->stats_lock);
+
+    if (log) {
+        log_audio_stats(device, &logged);
+    }
+}
+
+/* Hand a buffer to the device and wait until it wants the next one. With
+   statistics on, the time since it last wanted one is how long this buffer
+   took to make; longer than a buffer plays for and the device ran dry. */
+static void
+play_and_wait_device(SDL_AudioDevice *device, SDL_AudioThreadTimes *times, Uint64 *ready)
+{
+    Uint64 now;
+
+    if (!device->stats_enabled) {
+        current_audio.impl.PlayDevice(device);
+        current_audio.impl.WaitDevice(device);
+        return;
+    }
+
+    now = SDL_GetPerformanceCounter();
+    if (ticks_to_us(now - *ready) > device->stats.buffer_time) {
+        times->underruns++;
+    }
+    times->buffers++;
+    current_audio.impl.PlayDevice(device);
+    now = SDL_GetPerformanceCounter();
+    current_audio.impl.WaitDevice(device);
+    *ready = SDL_GetPerformanceCounter();
+    times->wait += *ready - now;
+}
+
 /* The general mixing thread function */
 static int SDLCALL
 SDL_RunAudio(void *devicep)
@@ -648,6 +767,10 @@ SDL_RunAudio(void *devicep)
     SDL_AudioDevice *device = (SDL_AudioDevice *) devicep;
     void *udata = device->callbackspec.userdata;
     SDL_AudioCallback callback = device->callbackspec.callback;
+    const SDL_bool timed = device->stats_enabled;
+    SDL_AudioThreadTimes times;
+    SDL_bool queue_fed = SDL_FALSE;
+    Uint64 ready = 0, start = 0;
     int data_len = 0;
     Uint8 *data;
 
@@ -660,10 +783,15 @@ SDL_RunAudio(void *devicep)
     device->threadid = SDL_ThreadID();
     current_audio.impl.ThreadInit(device);
 
+    if (timed) {
+        ready = SDL_GetPerformanceCounter();
+    }
+
     /* Loop, filling the audio buffers */
     while (!SDL_AtomicGet(&device->shutdown)) {
         current_audio.impl.BeginLoopIteration(device);
         data_len = device->callbackspec.size;
+        SDL_zero(times);
 
         /* Fill the current buffer with sound */
         if (!device->stream && SDL_AtomicGet(&device->enabled)) {
@@ -687,14 +815,28 @@ SDL_RunAudio(void *devicep)
         SDL_LockMutex(device->mixer_lock);
         if (SDL_AtomicGet(&device->paused)) {
             SDL_memset(data, device->spec.silence, data_len);
+        } else if (!timed) {
+            callback(udata, data, data_len);
         } else {
+            if (callback == SDL_BufferQueueDrainCallback) {
+                times.queued = SDL_TRUE;
+                times.queue_bytes = (Uint32) SDL_CountRingQueue(device->buffer_queue);
+                times.queue_dry = (queue_fed && times.queue_bytes < (Uint32) data_len);
+                queue_fed = (times.queue_bytes >= (Uint32) data_len);
+            }
+            start = SDL_GetPerformanceCounter();
             callback(udata, data, data_len);
+            times.callback = SDL_GetPerformanceCounter() - start;
+            times.called = SDL_TRUE;
         }
         SDL_UnlockMutex(device->mixer_lock);
 
         if (device->stream) {
             /* Stream available audio to device, converting/resampling. */
             /* if this fails...oh well. We'll play silence here. */
+            if (timed) {
+                start = SDL_GetPerformanceCounter();
+            }
             SDL_AudioStreamPut(device->stream, data, data_len);
 
             while (SDL_AudioStreamAvailable(device->stream) >= ((int) device->spec.size)) {
@@ -702,6 +844,9 @@ SDL_RunAudio(void *devicep)
                 data = SDL_AtomicGet(&device->enabled) ? current_audio.impl.GetDeviceBuf(device) : NULL;
                 got = SDL_AudioStreamGet(device->stream, data ? data : device->work_buffer, device->spec.size);
                 SDL_assert((got < 0) || (got == device->spec.size));
+                if (timed) {
+                    times.convert += SDL_GetPerformanceCounter() - start;
+                }
 
                 if (data == NULL) {  /* device is having issues... */
                     const Uint32 delay = ((device->spec.samples * 1000) / device->spec.freq);
@@ -710,9 +855,14 @@ SDL_RunAudio(void *devicep)
                     if (got != device->spec.size) {
                         SDL_memset(data, device->spec.silence, device->spec.size);
                     }
-                    current_audio.impl.PlayDevice(device);
-                    current_audio.impl.WaitDevice(device);
+                    play_and_wait_device(device, &times, &ready);
                 }
+                if (timed) {
+                    start = SDL_GetPerformanceCounter();
+                }
+            }
+            if (timed) {
+                times.convert += SDL_GetPerformanceCounter() - start;
             }
         } else if (data == device->work_buffer) {
             /* nothing to do; pause like we queued a buffer to play. */
@@ -720,8 +870,11 @@ SDL_RunAudio(void *devicep)
             SDL_Delay(delay);
         } else {  /* writing directly to the device. */
             /* queue this buffer and wait for it to finish playing. */
-            current_audio.impl.PlayDevice(device);
-            current_audio.impl.WaitDevice(device);
+            play_and_wait_device(device, &times, &ready);
+        }
+
+        if (timed) {
+            update_audio_stats(device, &times);
         }
     }
 
@@ -1083,7 +1236,10 @@ close_audio_device(SDL_AudioDevice * device)
         current_audio.impl.CloseDevice(device);
     }
 
-    SDL_FreeDataQueue(device->buffer_queue);
+    SDL_FreeRingQueue(device->buffer_queue);
+    if (device->buffer_queue_lock != NULL) {
+        SDL_DestroyMutex(device->buffer_queue_lock);
+    }
 
     SDL_free(device);
 }
@@ -1125,6 +1281,7 @@ prepare_audiospec(const SDL_AudioSpec * orig, SDL_AudioSpec * prepared)
     case 2:                    /* Stereo */
     case 4:                    /* surround */
     case 6:                    /* surround with center and lfe */
+    case 8:                    /* 7.1 surround */
         break;
     default:
         SDL_SetError("Unsupported number of audio channels.");
@@ -1162,6 +1319,7 @@ open_audio_device(const char *devname, int iscapture,
     SDL_AudioDevice *device;
     SDL_bool build_stream;
     void *handle = NULL;
+    const char *hint;
     int i = 0;
 
     if (!SDL_WasInit(SDL_INIT_AUDIO)) {
@@ -1350,9 +1508,10 @@ open_audio_device(const char *devname, int iscapture,
     }
 
     if (device->spec.callback == NULL) {  /* use buffer queueing? */
-        /* pool a few packets to start. Enough for two callbacks. */
-        device->buffer_queue = SDL_NewDataQueue(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2);
-        if (!device->buffer_queue) {
+        /* start with a ring big enough for two callbacks. */
+        device->buffer_queue = SDL_NewRingQueue(SDL_max(SDL_AUDIOBUFFERQUEUE_PACKETLEN, obtained->size * 2));
+        device->buffer_queue_lock = SDL_CreateMutex();
+        if (!device->buffer_queue || !device->buffer_queue_lock) {
             close_audio_device(device);
             SDL_SetError("Couldn't create audio buffer queue");
             return 0;
@@ -1375,6 +1534,16 @@ open_audio_device(const char *devname, int iscapture,
         return 0;
     }
 
+    /* Statistics are only taken by SDL_RunAudio() */
+    hint = SDL_GetHint(SDL_HINT_AUDIO_DEVICE_STATS);
+    if (hint && *hint != '0' && !iscapture && !current_audio.impl.ProvidesOwnCallbackThread) {
+        const int interval = SDL_atoi(hint);
+        device->stats_enabled = SDL_TRUE;
+        device->stats_log_interval = (interval > 1) ? (Uint32) interval : 0;
+        device->stats_logged = SDL_GetTicks();
+        device->stats.buffer_time = (Uint32) (((Uint64) device->spec.samples * 1000000) / device->spec.freq);
+    }
+
     open_devices[id] = device;  /* add it to our list of open devices. */
 
     /* Start the audio thread if necessary */
@@ -1466,6 +1635,42 @@ SDL_GetAudioStatus(void)
     return SDL_GetAudioDeviceStatus(1);
 }
 
+int
+SDL_GetAudioDeviceStats(SDL_AudioDeviceID devid, SDL_AudioDeviceStats *stats)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+
+    if (!device) {
+        return -1;
+    }
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
+    }
+    if (!device->stats_enabled) {
+        return SDL_SetError("Audio device isn't collecting statistics");
+    }
+
+    SDL_AtomicLock(&device->stats_lock);
+    *stats = device->stats;
+    SDL_AtomicUnlock(&device->stats_lock);
+    return 0;
+}
+
+void
+SDL_ResetAudioDeviceStats(SDL_AudioDeviceID devid)
+{
+    SDL_AudioDevice *device = get_audio_device(devid);
+    Uint32 buffer_time;
+
+    if (device && device->stats_enabled) {
+        SDL_AtomicLock(&device->stats_lock);
+        buffer_time = device->stats.buffer_time;
+        SDL_zero(device->stats);
+        device->stats.buffer_time = buffer_time;
+        SDL_AtomicUnlock(&device->stats_lock);
+    }
+}
+
 void
 SDL_PauseAudioDevice(SDL_AudioDeviceID devid, int pause_on)
 {
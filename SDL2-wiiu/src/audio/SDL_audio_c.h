@@ -24,6 +24,31 @@
 
 #include "../SDL_internal.h"
 
+/* GCC and clang's generic vector extensions. These compile to whatever SIMD unit
+   the target has, and to plain scalar code on CPUs without one (like the Wii U's). */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 9))
+#define HAVE_VECTOR_EXTENSIONS 1
+typedef float SDL_AudioF32x4 __attribute__((vector_size(16)));
+typedef Sint32 SDL_AudioS32x4 __attribute__((vector_size(16)));
+typedef Uint32 SDL_AudioU32x4 __attribute__((vector_size(16)));
+typedef Sint16 SDL_AudioS16x8 __attribute__((vector_size(16)));
+typedef Uint16 SDL_AudioU16x8 __attribute__((vector_size(16)));
+/* for unaligned loads and stores. */
+typedef float SDL_AudioF32x4_u __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Sint32 SDL_AudioS32x4_u __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Sint16 SDL_AudioS16x8_u __attribute__((vector_size(16), aligned(1), may_alias));
+/* four samples of a narrower type, to widen to (or narrow from) four floats. */
+typedef Sint16 SDL_AudioS16x4_u __attribute__((vector_size(8), aligned(1), may_alias));
+typedef Uint16 SDL_AudioU16x4_u __attribute__((vector_size(8), aligned(1), may_alias));
+typedef Sint8 SDL_AudioS8x4_u __attribute__((vector_size(4), aligned(1), may_alias));
+typedef Uint8 SDL_AudioU8x4_u __attribute__((vector_size(4), aligned(1), may_alias));
+/* byteswap every lane of an unsigned 16 or 32-bit vector. */
+#define SDL_AUDIO_VSWAP16(v) (((v) << 8) | ((v) >> 8))
+#define SDL_AUDIO_VSWAP32(v) (((v) << 24) | (((v) << 8) & 0x00FF0000) | (((v) >> 8) & 0x0000FF00) | ((v) >> 24))
+#else
+#define HAVE_VECTOR_EXTENSIONS 0
+#endif
+
 #ifndef DEBUG_CONVERT
 #define DEBUG_CONVERT 0
 #endif
@@ -69,9 +94,16 @@ extern SDL_AudioFilter SDL_Convert_F32_to_S16;
 extern SDL_AudioFilter SDL_Convert_F32_to_U16;
 extern SDL_AudioFilter SDL_Convert_F32_to_S32;
 
-/* You need to call SDL_PrepareResampleFilter() before using the internal resampler.
-   SDL_AudioQuit() calls SDL_FreeResamplerFilter(), you should never call it yourself. */
-extern int SDL_PrepareResampleFilter(void);
+/* Byteswap and convert in one pass, for data in the other byte order. NULL if not available. */
+extern SDL_AudioFilter SDL_Convert_S16_Swapped_to_F32;
+extern SDL_AudioFilter SDL_Convert_U16_Swapped_to_F32;
+extern SDL_AudioFilter SDL_Convert_S32_Swapped_to_F32;
+extern SDL_AudioFilter SDL_Convert_F32_to_S16_Swapped;
+extern SDL_AudioFilter SDL_Convert_F32_to_U16_Swapped;
+extern SDL_AudioFilter SDL_Convert_F32_to_S32_Swapped;
+
+/* The internal resampler caches its filter banks; SDL_AudioQuit() calls
+   SDL_FreeResampleFilter() to drop the unused ones, you should never call it yourself. */
 extern void SDL_FreeResampleFilter(void);
 
 #endif /* SDL_audio_c_h_ */
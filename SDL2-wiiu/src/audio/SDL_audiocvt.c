@@ -375,12 +375,74 @@ SDL_Convert51To71(SDL_AudioCVT * cvt, SDL_AudioFormat format)
 }
 
 /* SDL's resampler uses a "bandlimited interpolation" algorithm:
-     https://ccrma.stanford.edu/~jos/resample/ */
+     https://ccrma.stanford.edu/~jos/resample/
+
+   Output frame i lands on input position (i * inrate / outrate), which we track
+   exactly with integers. The fractional part of that position selects a "phase":
+   a row of precomputed filter taps covering every input frame that contributes to
+   the output, so each output frame is one dot product between a row and a
+   contiguous run of input. If the reduced rate ratio has few enough distinct
+   phases (44100->48000 has 160), every phase gets its own row. Otherwise we build
+   rows for RESAMPLER_INTERPOLATED_PHASES evenly spaced positions and interpolate
+   between neighbours, like the old single-table approach did.
+
+   Banks of rows are cached and shared between every converter that uses the same
+   rates, channel count and quality. */
 
 #define RESAMPLER_ZERO_CROSSINGS 5
+#define RESAMPLER_SHORT_ZERO_CROSSINGS 4
 #define RESAMPLER_BITS_PER_SAMPLE 16
 #define RESAMPLER_SAMPLES_PER_ZERO_CROSSING  (1 << ((RESAMPLER_BITS_PER_SAMPLE / 2) + 1))
-#define RESAMPLER_FILTER_SIZE ((RESAMPLER_SAMPLES_PER_ZERO_CROSSING * RESAMPLER_ZERO_CROSSINGS) + 1)
+#define RESAMPLER_MAX_EXACT_PHASES 1024
+#define RESAMPLER_INTERPOLATED_PHASES 256
+#define RESAMPLER_MAX_BANK_SAMPLES (256 * 1024)
+#define RESAMPLER_MAX_IDLE_BANKS 8
+#define RESAMPLER_MAX_ACCUMULATORS 8
+
+typedef enum
+{
+    SDL_RESAMPLER_LINEAR,
+    SDL_RESAMPLER_SINC_SHORT,
+    SDL_RESAMPLER_SINC
+} SDL_ResamplerQuality;
+
+typedef struct SDL_ResamplerBank
+{
+    int chans;
+    int inrate;
+    int outrate;
+    SDL_ResamplerQuality quality;
+    int denom;  /* outrate / gcd(inrate, outrate): phase positions per input frame. */
+    int step;  /* whole input frames to advance per output frame... */
+    int step_rem;  /* ...plus this many 1/denom fractions. */
+    int wing;  /* the window for an output starts (wing - 1) frames before its source frame. */
+    int taps;  /* frames per row, always a multiple of 4. */
+    int rowlen;  /* taps * chans: rows are expanded so each channel has its own copy of a tap. */
+    int phases;  /* number of rows. */
+    int accumulators;  /* vector accumulators needed to cover a multiple of chans, 0 if too many. */
+    float *rows;
+    float *diffs;  /* difference to the next row, only for interpolated banks. */
+    int refcount;
+    struct SDL_ResamplerBank *next;
+} SDL_ResamplerBank;
+
+static SDL_SpinLock ResampleFilterSpinlock = 0;
+static SDL_ResamplerBank *ResamplerBanks = NULL;
+
+static SDL_ResamplerQuality
+SDL_GetResamplerQuality(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_AUDIO_RESAMPLING_QUALITY);
+
+    if (hint) {
+        if (*hint == '0' || SDL_strcasecmp(hint, "fast") == 0) {
+            return SDL_RESAMPLER_LINEAR;
+        } else if (*hint == '1' || SDL_strcasecmp(hint, "medium") == 0) {
+            return SDL_RESAMPLER_SINC_SHORT;
+        }
+    }
+    return SDL_RESAMPLER_SINC;
+}
 
 /* This is a "modified" bessel function, so you can't use POSIX j0() */
 static double
@@ -404,133 +466,453 @@ bessel(const double x)
     return i0;
 }
 
-/* build kaiser table with cardinal sine applied to it, and array of differences between elements. */
+static int
+ResamplerGCD(int a, int b)
+{
+    while (b != 0) {
+        const int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int
+ResamplerPadding(const int inrate, const int outrate)
+{
+    if (inrate == outrate) {
+        return 0;
+    } else if (inrate > outrate) {
+        return (int) SDL_ceil(((float) (RESAMPLER_SAMPLES_PER_ZERO_CROSSING * inrate) / ((float) outrate)));
+    }
+    return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+}
+
+/* Fill one row of taps for an output (frac) of an input frame past the row's source frame. */
 static void
-kaiser_and_sinc(float *table, float *diffs, const int tablelen, const double beta)
+ResamplerBuildRow(const SDL_ResamplerBank *bank, float *row, const double frac)
 {
-    const int lenm1 = tablelen - 1;
-    const int lenm1div2 = lenm1 / 2;
-    int i;
+    const int zerocrossings = (bank->quality == SDL_RESAMPLER_SINC_SHORT) ? RESAMPLER_SHORT_ZERO_CROSSINGS : RESAMPLER_ZERO_CROSSINGS;
+    /* when downsampling, lower the cutoff to the output's Nyquist frequency so we don't alias. */
+    const double cutoff = (bank->inrate > bank->outrate) ? (((double) bank->outrate) / ((double) bank->inrate)) : 1.0;
+    /* if dB > 50, beta=(0.1102 * (dB - 8.7)), according to Matlab. The short filter
+       trades stopband rejection for a narrower main lobe, or it would eat the treble. */
+    const double dB = (bank->quality == SDL_RESAMPLER_SINC_SHORT) ? 60.0 : 80.0;
+    const double beta = 0.1102 * (dB - 8.7);
+    const double besselbeta = bessel(beta);
+    const int chans = bank->chans;
+    double sum = 0.0;
+    int i, chan;
+
+    for (i = 0; i < bank->taps; i++) {
+        const double x = ((double) (i - (bank->wing - 1))) - frac;
+        double tap = 0.0;
+
+        if (bank->quality == SDL_RESAMPLER_LINEAR) {
+            if (SDL_fabs(x) < 1.0) {
+                tap = 1.0 - SDL_fabs(x);
+            }
+        } else {
+            const double xc = x * cutoff;
+            if (SDL_fabs(xc) < zerocrossings) {
+                const double pos = xc / zerocrossings;
+                const double kaiser = bessel(beta * SDL_sqrt(1.0 - (pos * pos))) / besselbeta;
+                const double sinc = (xc == 0.0) ? 1.0 : (SDL_sin(M_PI * xc) / (M_PI * xc));
+                tap = cutoff * sinc * kaiser;
+            }
+        }
 
-    table[0] = 1.0f;
-    for (i = 1; i < tablelen; i++) {
-        const double kaiser = bessel(beta * SDL_sqrt(1.0 - SDL_pow(((i - lenm1) / 2.0) / lenm1div2, 2.0))) / bessel(beta);
-        table[tablelen - i] = (float) kaiser;
+        row[i * chans] = (float) tap;
+        sum += tap;
     }
 
-    for (i = 1; i < tablelen; i++) {
-        const float x = (((float) i) / ((float) RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) * ((float) M_PI);
-        table[i] *= SDL_sinf(x) / x;
-        diffs[i - 1] = table[i] - table[i - 1];
+    /* normalize so every phase has exactly unity gain at DC. */
+    for (i = 0; i < bank->taps; i++) {
+        const float tap = (sum != 0.0) ? (float) (row[i * chans] / sum) : 0.0f;
+        for (chan = 0; chan < chans; chan++) {
+            row[(i * chans) + chan] = tap;
+        }
     }
-    diffs[lenm1] = 0.0f;
 }
 
+static SDL_ResamplerBank *
+SDL_CreateResamplerBank(const int chans, const int inrate, const int outrate, const SDL_ResamplerQuality quality)
+{
+    const int gcd = ResamplerGCD(inrate, outrate);
+    const int zerocrossings = (quality == SDL_RESAMPLER_SINC_SHORT) ? RESAMPLER_SHORT_ZERO_CROSSINGS : RESAMPLER_ZERO_CROSSINGS;
+    SDL_ResamplerBank *bank;
+    SDL_bool interpolated;
+    int i, j;
+
+    bank = (SDL_ResamplerBank *) SDL_calloc(1, sizeof (SDL_ResamplerBank));
+    if (!bank) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
 
-static SDL_SpinLock ResampleFilterSpinlock = 0;
-static float *ResamplerFilter = NULL;
-static float *ResamplerFilterDifference = NULL;
+    bank->chans = chans;
+    bank->inrate = inrate;
+    bank->outrate = outrate;
+    bank->quality = quality;
+    bank->denom = outrate / gcd;
+    bank->step = (inrate / gcd) / bank->denom;
+    bank->step_rem = (inrate / gcd) % bank->denom;
 
-int
-SDL_PrepareResampleFilter(void)
+    if (quality == SDL_RESAMPLER_LINEAR) {
+        bank->wing = 1;
+    } else if (inrate > outrate) {
+        bank->wing = (int) SDL_ceil((((double) zerocrossings) * inrate) / outrate);
+    } else {
+        bank->wing = zerocrossings;
+    }
+    SDL_assert(bank->wing <= ResamplerPadding(inrate, outrate));
+
+    bank->taps = ((bank->wing * 2) + 3) & ~3;
+    bank->rowlen = bank->taps * chans;
+
+    interpolated = ((bank->denom > RESAMPLER_MAX_EXACT_PHASES) || ((bank->denom * bank->rowlen) > RESAMPLER_MAX_BANK_SAMPLES));
+    if (!interpolated) {
+        bank->phases = bank->denom;
+    } else {
+        bank->phases = RESAMPLER_INTERPOLATED_PHASES;
+        while ((bank->phases > 16) && (((bank->phases + 1) * bank->rowlen) > RESAMPLER_MAX_BANK_SAMPLES)) {
+            bank->phases /= 2;
+        }
+    }
+
+    if (chans <= RESAMPLER_MAX_ACCUMULATORS) {
+        /* enough 4-float vectors to cover a whole number of frames: lcm(chans, 4) / 4. */
+        bank->accumulators = chans / ResamplerGCD(chans, 4);
+    }
+
+    /* one extra row for interpolated banks: the position a whole frame along. */
+    bank->rows = (float *) SDL_malloc((bank->phases + (interpolated ? 1 : 0)) * bank->rowlen * sizeof (float));
+    if (!bank->rows) {
+        SDL_free(bank);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    if (!interpolated) {
+        for (i = 0; i < bank->phases; i++) {
+            ResamplerBuildRow(bank, bank->rows + (i * bank->rowlen), ((double) i) / ((double) bank->denom));
+        }
+    } else {
+        bank->diffs = (float *) SDL_malloc(bank->phases * bank->rowlen * sizeof (float));
+        if (!bank->diffs) {
+            SDL_free(bank->rows);
+            SDL_free(bank);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+
+        for (i = 0; i <= bank->phases; i++) {
+            ResamplerBuildRow(bank, bank->rows + (i * bank->rowlen), ((double) i) / ((double) bank->phases));
+        }
+        for (i = 0; i < bank->phases; i++) {
+            const float *row = bank->rows + (i * bank->rowlen);
+            float *diff = bank->diffs + (i * bank->rowlen);
+            for (j = 0; j < bank->rowlen; j++) {
+                diff[j] = row[j + bank->rowlen] - row[j];
+            }
+        }
+    }
+
+    return bank;
+}
+
+static void
+SDL_DestroyResamplerBank(SDL_ResamplerBank *bank)
 {
-    SDL_AtomicLock(&ResampleFilterSpinlock);
-    if (!ResamplerFilter) {
-        /* if dB > 50, beta=(0.1102 * (dB - 8.7)), according to Matlab. */
-        const double dB = 80.0;
-        const double beta = 0.1102 * (dB - 8.7);
-        const size_t alloclen = RESAMPLER_FILTER_SIZE * sizeof (float);
-
-        ResamplerFilter = (float *) SDL_malloc(alloclen);
-        if (!ResamplerFilter) {
-            SDL_AtomicUnlock(&ResampleFilterSpinlock);
-            return SDL_OutOfMemory();
+    SDL_free(bank->rows);
+    SDL_free(bank->diffs);
+    SDL_free(bank);
+}
+
+/* Finds a cached bank and moves it to the front, so the list stays in most-recently-used order. */
+static SDL_ResamplerBank *
+FindResamplerBank(const int chans, const int inrate, const int outrate, const SDL_ResamplerQuality quality)
+{
+    SDL_ResamplerBank **prev;
+    for (prev = &ResamplerBanks; *prev; prev = &(*prev)->next) {
+        SDL_ResamplerBank *bank = *prev;
+        if ((bank->chans == chans) && (bank->inrate == inrate) && (bank->outrate == outrate) && (bank->quality == quality)) {
+            *prev = bank->next;
+            bank->next = ResamplerBanks;
+            ResamplerBanks = bank;
+            return bank;
         }
+    }
+    return NULL;
+}
+
+/* Returns a filter bank for this conversion, building it if nobody else is using one. */
+static SDL_ResamplerBank *
+SDL_AcquireResamplerBank(const int chans, const int inrate, const int outrate, const SDL_ResamplerQuality quality)
+{
+    SDL_ResamplerBank *bank;
+    SDL_ResamplerBank *existing;
 
-        ResamplerFilterDifference = (float *) SDL_malloc(alloclen);
-        if (!ResamplerFilterDifference) {
-            SDL_free(ResamplerFilter);
-            ResamplerFilter = NULL;
-            SDL_AtomicUnlock(&ResampleFilterSpinlock);
-            return SDL_OutOfMemory();
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    bank = FindResamplerBank(chans, inrate, outrate, quality);
+    if (bank) {
+        bank->refcount++;
+    }
+    SDL_AtomicUnlock(&ResampleFilterSpinlock);
+
+    if (bank) {
+        return bank;
+    }
+
+    /* build it without holding the lock, this can take a moment. */
+    bank = SDL_CreateResamplerBank(chans, inrate, outrate, quality);
+    if (!bank) {
+        return NULL;
+    }
+
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    existing = FindResamplerBank(chans, inrate, outrate, quality);  /* another thread might have beaten us to it. */
+    if (existing) {
+        existing->refcount++;
+    } else {
+        bank->refcount = 1;
+        bank->next = ResamplerBanks;
+        ResamplerBanks = bank;
+    }
+    SDL_AtomicUnlock(&ResampleFilterSpinlock);
+
+    if (existing) {
+        SDL_DestroyResamplerBank(bank);
+        return existing;
+    }
+    return bank;
+}
+
+/* Idle banks stick around for the next converter to use, up to a point. */
+static void
+SDL_ReleaseResamplerBank(SDL_ResamplerBank *bank)
+{
+    SDL_ResamplerBank *destroy = NULL;
+
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    SDL_assert(bank->refcount > 0);
+    if (--bank->refcount == 0) {
+        SDL_ResamplerBank **prev;
+        SDL_ResamplerBank **oldest = NULL;
+        int idle = 0;
+        for (prev = &ResamplerBanks; *prev; prev = &(*prev)->next) {
+            if ((*prev)->refcount == 0) {
+                oldest = prev;
+                idle++;
+            }
+        }
+        if (idle > RESAMPLER_MAX_IDLE_BANKS) {
+            destroy = *oldest;
+            *oldest = destroy->next;
         }
-        kaiser_and_sinc(ResamplerFilter, ResamplerFilterDifference, RESAMPLER_FILTER_SIZE, beta);
     }
     SDL_AtomicUnlock(&ResampleFilterSpinlock);
-    return 0;
+
+    if (destroy) {
+        SDL_DestroyResamplerBank(destroy);
+    }
 }
 
 void
 SDL_FreeResampleFilter(void)
 {
-    SDL_free(ResamplerFilter);
-    SDL_free(ResamplerFilterDifference);
-    ResamplerFilter = NULL;
-    ResamplerFilterDifference = NULL;
+    SDL_ResamplerBank **prev = &ResamplerBanks;
+    SDL_ResamplerBank *destroy = NULL;
+
+    /* banks still held by a live SDL_AudioStream are freed when it is. */
+    SDL_AtomicLock(&ResampleFilterSpinlock);
+    while (*prev) {
+        SDL_ResamplerBank *bank = *prev;
+        if (bank->refcount == 0) {
+            *prev = bank->next;
+            bank->next = destroy;
+            destroy = bank;
+        } else {
+            prev = &bank->next;
+        }
+    }
+    SDL_AtomicUnlock(&ResampleFilterSpinlock);
+
+    while (destroy) {
+        SDL_ResamplerBank *next = destroy->next;
+        SDL_DestroyResamplerBank(destroy);
+        destroy = next;
+    }
 }
 
-static int
-ResamplerPadding(const int inrate, const int outrate)
+#if HAVE_VECTOR_EXTENSIONS
+static void
+ResamplerDot_Vector(const SDL_ResamplerBank *bank, const float *row, const float *diff,
+                    const float interpolation, const float *in, float *out)
 {
-    if (inrate == outrate) {
-        return 0;
-    } else if (inrate > outrate) {
-        return (int) SDL_ceil(((float) (RESAMPLER_SAMPLES_PER_ZERO_CROSSING * inrate) / ((float) outrate)));
+    const int accumulators = bank->accumulators;
+    const int block = accumulators * 4;
+    const int rowlen = bank->rowlen;
+    const int chans = bank->chans;
+    SDL_AudioF32x4 acc[RESAMPLER_MAX_ACCUMULATORS];
+    int i, j, chan;
+
+    for (j = 0; j < accumulators; j++) {
+        acc[j] = (SDL_AudioF32x4) { 0.0f, 0.0f, 0.0f, 0.0f };
     }
-    return RESAMPLER_SAMPLES_PER_ZERO_CROSSING;
+
+    if (diff) {
+        for (i = 0; i < rowlen; i += block) {
+            for (j = 0; j < accumulators; j++) {
+                const int k = i + (j * 4);
+                const SDL_AudioF32x4 taps = *(const SDL_AudioF32x4_u *) (row + k) + (*(const SDL_AudioF32x4_u *) (diff + k) * interpolation);
+                acc[j] += taps * *(const SDL_AudioF32x4_u *) (in + k);
+            }
+        }
+    } else {
+        for (i = 0; i < rowlen; i += block) {
+            for (j = 0; j < accumulators; j++) {
+                const int k = i + (j * 4);
+                acc[j] += *(const SDL_AudioF32x4_u *) (row + k) * *(const SDL_AudioF32x4_u *) (in + k);
+            }
+        }
+    }
+
+    /* lanes repeat the channel layout, fold them back down into one frame. */
+    for (chan = 0; chan < chans; chan++) {
+        out[chan] = 0.0f;
+    }
+    chan = 0;
+    for (j = 0; j < accumulators; j++) {
+        for (i = 0; i < 4; i++) {
+            out[chan] += acc[j][i];
+            if (++chan == chans) {
+                chan = 0;
+            }
+        }
+    }
+}
+#endif
+
+static void
+ResamplerDot_Scalar(const SDL_ResamplerBank *bank, const float *row, const float *diff,
+                    const float interpolation, const float *in, float *out)
+{
+    const int rowlen = bank->rowlen;
+    const int chans = bank->chans;
+    int i, chan;
+
+    for (chan = 0; chan < chans; chan++) {
+        float outsample = 0.0f;
+        if (diff) {
+            for (i = chan; i < rowlen; i += chans) {
+                outsample += (row[i] + (interpolation * diff[i])) * in[i];
+            }
+        } else {
+            for (i = chan; i < rowlen; i += chans) {
+                outsample += row[i] * in[i];
+            }
+        }
+        out[chan] = outsample;
+    }
+}
+
+/* Picks the taps for an output (phase) 1/denom fractions of a frame past its source frame. */
+static SDL_INLINE const float *
+ResamplerRow(const SDL_ResamplerBank *bank, const int phase, const float **diff, float *interpolation)
+{
+    if (bank->diffs) {
+        const float pos = (((float) phase) * bank->phases) / ((float) bank->denom);
+        const int rowindex = SDL_min((int) pos, bank->phases - 1);
+        *interpolation = pos - rowindex;
+        *diff = bank->diffs + (rowindex * bank->rowlen);
+        return bank->rows + (rowindex * bank->rowlen);
+    }
+
+    *interpolation = 0.0f;
+    *diff = NULL;
+    return bank->rows + (phase * bank->rowlen);
+}
+
+/* Calculates one output frame; (in) must hold (bank->taps) frames, starting (bank->wing - 1) before the source frame. */
+static SDL_INLINE void
+ResamplerFrame(const SDL_ResamplerBank *bank, const int phase, const float *in, float *out)
+{
+    const float *diff;
+    float interpolation;
+    const float *row = ResamplerRow(bank, phase, &diff, &interpolation);
+
+    #if HAVE_VECTOR_EXTENSIONS
+    if (bank->accumulators) {
+        ResamplerDot_Vector(bank, row, diff, interpolation, in, out);
+        return;
+    }
+    #endif
+    ResamplerDot_Scalar(bank, row, diff, interpolation, in, out);
 }
 
 /* lpadding and rpadding are expected to be buffers of (ResamplePadding(inrate, outrate) * chans * sizeof (float)) bytes. */
 static int
-SDL_ResampleAudio(const int chans, const int inrate, const int outrate,
+SDL_ResampleAudio(const SDL_ResamplerBank *bank,
                         const float *lpadding, const float *rpadding,
                         const float *inbuf, const int inbuflen,
                         float *outbuf, const int outbuflen)
 {
-    const double finrate = (double) inrate;
-    const double outtimeincr = 1.0 / ((float) outrate);
-    const double  ratio = ((float) outrate) / ((float) inrate);
-    const int paddinglen = ResamplerPadding(inrate, outrate);
+    const int chans = bank->chans;
+    const double ratio = ((float) bank->outrate) / ((float) bank->inrate);
+    const int paddinglen = ResamplerPadding(bank->inrate, bank->outrate);
     const int framelen = chans * (int)sizeof (float);
     const int inframes = inbuflen / framelen;
     const int wantedoutframes = (int) ((inbuflen / framelen) * ratio);  /* outbuflen isn't total to write, it's total available. */
     const int maxoutframes = outbuflen / framelen;
     const int outframes = SDL_min(wantedoutframes, maxoutframes);
+    const int taps = bank->taps;
     float *dst = outbuf;
-    double outtime = 0.0;
+    int srcindex = 0;
+    int phase = 0;  /* in 1/denom fractions of an input frame. */
     int i, j, chan;
 
     for (i = 0; i < outframes; i++) {
-        const int srcindex = (int) (outtime * inrate);
-        const double intime = ((double) srcindex) / finrate;
-        const double innexttime = ((double) (srcindex + 1)) / finrate;
-        const double interpolation1 = 1.0 - ((innexttime - outtime) / (innexttime - intime));
-        const int filterindex1 = (int) (interpolation1 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
-        const double interpolation2 = 1.0 - interpolation1;
-        const int filterindex2 = (int) (interpolation2 * RESAMPLER_SAMPLES_PER_ZERO_CROSSING);
-
-        for (chan = 0; chan < chans; chan++) {
-            float outsample = 0.0f;
-
-            /* do this twice to calculate the sample, once for the "left wing" and then same for the right. */
-            /* !!! FIXME: do both wings in one loop */
-            for (j = 0; (filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex - j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a pre loop. */
-                const float insample = (srcframe < 0) ? lpadding[((paddinglen + srcframe) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation1 * ResamplerFilterDifference[filterindex1 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
-            }
+        const int firstframe = srcindex - (bank->wing - 1);
 
-            for (j = 0; (filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)) < RESAMPLER_FILTER_SIZE; j++) {
-                const int srcframe = srcindex + 1 + j;
-                /* !!! FIXME: we can bubble this conditional out of here by doing a post loop. */
-                const float insample = (srcframe >= inframes) ? rpadding[((srcframe - inframes) * chans) + chan] : inbuf[(srcframe * chans) + chan];
-                outsample += (float)(insample * (ResamplerFilter[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)] + (interpolation2 * ResamplerFilterDifference[filterindex2 + (j * RESAMPLER_SAMPLES_PER_ZERO_CROSSING)])));
+        if ((firstframe >= 0) && ((firstframe + taps) <= inframes)) {
+            ResamplerFrame(bank, phase, inbuf + (firstframe * chans), dst);
+        } else {
+            /* near the ends of the buffer, the window runs into the padding. */
+            const float *diff;
+            float interpolation;
+            const float *row = ResamplerRow(bank, phase, &diff, &interpolation);
+            for (chan = 0; chan < chans; chan++) {
+                float outsample = 0.0f;
+                for (j = 0; j < taps; j++) {
+                    const int srcframe = firstframe + j;
+                    const int k = (j * chans) + chan;
+                    const float tap = row[k] + (diff ? (interpolation * diff[k]) : 0.0f);
+                    float insample = 0.0f;
+                    if (srcframe < 0) {
+                        if (srcframe >= -paddinglen) {
+                            insample = lpadding[((paddinglen + srcframe) * chans) + chan];
+                        }
+                    } else if (srcframe >= inframes) {
+                        if (srcframe < (inframes + paddinglen)) {
+                            insample = rpadding[((srcframe - inframes) * chans) + chan];
+                        }
+                    } else {
+                        insample = inbuf[(srcframe * chans) + chan];
+                    }
+                    outsample += tap * insample;
+                }
+                dst[chan] = outsample;
             }
-            *(dst++) = outsample;
         }
 
-        outtime += outtimeincr;
+        dst += chans;
+        srcindex += bank->step;
+        phase += bank->step_rem;
+        if (phase >= bank->denom) {
+            phase -= bank->denom;
+            srcindex++;
+        }
     }
 
     return outframes * chans * sizeof (float);
@@ -611,30 +993,50 @@ SDL_AddAudioCVTFilter(SDL_AudioCVT *cvt, const SDL_AudioFilter filter)
     return 0;
 }
 
+/* 8-bit formats have no byte order, whatever their endian bit says. */
+static SDL_bool
+SDL_AudioFormatNeedsByteswap(const SDL_AudioFormat fmt)
+{
+    return (SDL_AUDIO_BITSIZE(fmt) > 8) && ((SDL_AUDIO_ISBIGENDIAN(fmt) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN));
+}
+
 static int
 SDL_BuildAudioTypeCVTToFloat(SDL_AudioCVT *cvt, const SDL_AudioFormat src_fmt)
 {
     int retval = 0;  /* 0 == no conversion necessary. */
+    SDL_AudioFilter swapped_filter = NULL;
 
-    if ((SDL_AUDIO_ISBIGENDIAN(src_fmt) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN)) {
-        if (SDL_AddAudioCVTFilter(cvt, SDL_Convert_Byteswap) < 0) {
-            return -1;
+    if (SDL_AudioFormatNeedsByteswap(src_fmt)) {
+        /* byteswap and convert in one pass if there's a converter for that. */
+        switch (src_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
+            case AUDIO_S16: swapped_filter = SDL_Convert_S16_Swapped_to_F32; break;
+            case AUDIO_U16: swapped_filter = SDL_Convert_U16_Swapped_to_F32; break;
+            case AUDIO_S32: swapped_filter = SDL_Convert_S32_Swapped_to_F32; break;
+            default: break;
+        }
+
+        if (!swapped_filter) {
+            if (SDL_AddAudioCVTFilter(cvt, SDL_Convert_Byteswap) < 0) {
+                return -1;
+            }
+            retval = 1;  /* added a converter. */
         }
-        retval = 1;  /* added a converter. */
     }
 
     if (!SDL_AUDIO_ISFLOAT(src_fmt)) {
         const Uint16 src_bitsize = SDL_AUDIO_BITSIZE(src_fmt);
         const Uint16 dst_bitsize = 32;
-        SDL_AudioFilter filter = NULL;
+        SDL_AudioFilter filter = swapped_filter;
 
-        switch (src_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
-            case AUDIO_S8: filter = SDL_Convert_S8_to_F32; break;
-            case AUDIO_U8: filter = SDL_Convert_U8_to_F32; break;
-            case AUDIO_S16: filter = SDL_Convert_S16_to_F32; break;
-            case AUDIO_U16: filter = SDL_Convert_U16_to_F32; break;
-            case AUDIO_S32: filter = SDL_Convert_S32_to_F32; break;
-            default: SDL_assert(!"Unexpected audio format!"); break;
+        if (!filter) {
+            switch (src_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
+                case AUDIO_S8: filter = SDL_Convert_S8_to_F32; break;
+                case AUDIO_U8: filter = SDL_Convert_U8_to_F32; break;
+                case AUDIO_S16: filter = SDL_Convert_S16_to_F32; break;
+                case AUDIO_U16: filter = SDL_Convert_U16_to_F32; break;
+                case AUDIO_S32: filter = SDL_Convert_S32_to_F32; break;
+                default: SDL_assert(!"Unexpected audio format!"); break;
+            }
         }
 
         if (!filter) {
@@ -662,18 +1064,35 @@ static int
 SDL_BuildAudioTypeCVTFromFloat(SDL_AudioCVT *cvt, const SDL_AudioFormat dst_fmt)
 {
     int retval = 0;  /* 0 == no conversion necessary. */
+    SDL_bool needs_byteswap = SDL_AudioFormatNeedsByteswap(dst_fmt);
 
     if (!SDL_AUDIO_ISFLOAT(dst_fmt)) {
         const Uint16 dst_bitsize = SDL_AUDIO_BITSIZE(dst_fmt);
         const Uint16 src_bitsize = 32;
         SDL_AudioFilter filter = NULL;
-        switch (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
-            case AUDIO_S8: filter = SDL_Convert_F32_to_S8; break;
-            case AUDIO_U8: filter = SDL_Convert_F32_to_U8; break;
-            case AUDIO_S16: filter = SDL_Convert_F32_to_S16; break;
-            case AUDIO_U16: filter = SDL_Convert_F32_to_U16; break;
-            case AUDIO_S32: filter = SDL_Convert_F32_to_S32; break;
-            default: SDL_assert(!"Unexpected audio format!"); break;
+
+        if (needs_byteswap) {
+            /* convert and byteswap in one pass if there's a converter for that. */
+            switch (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
+                case AUDIO_S16: filter = SDL_Convert_F32_to_S16_Swapped; break;
+                case AUDIO_U16: filter = SDL_Convert_F32_to_U16_Swapped; break;
+                case AUDIO_S32: filter = SDL_Convert_F32_to_S32_Swapped; break;
+                default: break;
+            }
+            if (filter) {
+                needs_byteswap = SDL_FALSE;
+            }
+        }
+
+        if (!filter) {
+            switch (dst_fmt & ~SDL_AUDIO_MASK_ENDIAN) {
+                case AUDIO_S8: filter = SDL_Convert_F32_to_S8; break;
+                case AUDIO_U8: filter = SDL_Convert_F32_to_U8; break;
+                case AUDIO_S16: filter = SDL_Convert_F32_to_S16; break;
+                case AUDIO_U16: filter = SDL_Convert_F32_to_U16; break;
+                case AUDIO_S32: filter = SDL_Convert_F32_to_S32; break;
+                default: SDL_assert(!"Unexpected audio format!"); break;
+            }
         }
 
         if (!filter) {
@@ -693,7 +1112,7 @@ SDL_BuildAudioTypeCVTFromFloat(SDL_AudioCVT *cvt, const SDL_AudioFormat dst_fmt)
         retval = 1;  /* added a converter. */
     }
 
-    if ((SDL_AUDIO_ISBIGENDIAN(dst_fmt) != 0) == (SDL_BYTEORDER == SDL_LIL_ENDIAN)) {
+    if (needs_byteswap) {
         if (SDL_AddAudioCVTFilter(cvt, SDL_Convert_Byteswap) < 0) {
             return -1;
         }
@@ -719,20 +1138,29 @@ SDL_ResampleCVT(SDL_AudioCVT *cvt, const int chans, const SDL_AudioFormat format
     float *dst = (float *) (cvt->buf + srclen);
     const int dstlen = (cvt->len * cvt->len_mult) - srclen;
     const int paddingsamples = (ResamplerPadding(inrate, outrate) * chans);
+    SDL_ResamplerBank *bank;
     float *padding;
 
     SDL_assert(format == AUDIO_F32SYS);
 
+    /* SDL_BuildAudioResampleCVT() built this already, unless the hint changed since. */
+    bank = SDL_AcquireResamplerBank(chans, inrate, outrate, SDL_GetResamplerQuality());
+    if (!bank) {
+        return;
+    }
+
     /* we keep no streaming state here, so pad with silence on both ends. */
     padding = (float *) SDL_calloc(paddingsamples ? paddingsamples : 1, sizeof (float));
     if (!padding) {
+        SDL_ReleaseResamplerBank(bank);
         SDL_OutOfMemory();
         return;
     }
 
-    cvt->len_cvt = SDL_ResampleAudio(chans, inrate, outrate, padding, padding, src, srclen, dst, dstlen);
+    cvt->len_cvt = SDL_ResampleAudio(bank, padding, padding, src, srclen, dst, dstlen);
 
     SDL_free(padding);
+    SDL_ReleaseResamplerBank(bank);
 
     SDL_memmove(cvt->buf, dst, cvt->len_cvt);  /* !!! FIXME: remove this if we can get the resampler to work in-place again. */
 
@@ -777,6 +1205,7 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, const int dst_channels,
                           const int src_rate, const int dst_rate)
 {
     SDL_AudioFilter filter;
+    SDL_ResamplerBank *bank;
 
     if (src_rate == dst_rate) {
         return 0;  /* no conversion necessary. */
@@ -787,9 +1216,12 @@ SDL_BuildAudioResampleCVT(SDL_AudioCVT * cvt, const int dst_channels,
         return SDL_SetError("No conversion available for these rates");
     }
 
-    if (SDL_PrepareResampleFilter() < 0) {
+    /* build the filter bank now, it stays cached for SDL_ConvertAudio() to use. */
+    bank = SDL_AcquireResamplerBank(dst_channels, src_rate, dst_rate, SDL_GetResamplerQuality());
+    if (!bank) {
         return -1;
     }
+    SDL_ReleaseResamplerBank(bank);
 
     /* Update (cvt) with filter details... */
     if (SDL_AddAudioCVTFilter(cvt, filter) < 0) {
@@ -920,6 +1352,10 @@ SDL_BuildAudioCVT(SDL_AudioCVT * cvt,
         - convert back to native format.
         - byteswap back to foreign format if necessary.
 
+       Where there's a converter that byteswaps as it goes (see
+       SDL_Convert_S16_Swapped_to_F32 and friends), the byteswap and the
+       conversion next to it are done in a single pass.
+
        The expectation is we can process data faster in float32
        (possibly with SIMD), and making several passes over the same
        buffer is likely to be CPU cache-friendly, avoiding the
@@ -1080,17 +1516,21 @@ typedef int (*SDL_ResampleAudioStreamFunc)(SDL_AudioStream *stream, const void *
 typedef void (*SDL_ResetAudioStreamResamplerFunc)(SDL_AudioStream *stream);
 typedef void (*SDL_CleanupAudioStreamResamplerFunc)(SDL_AudioStream *stream);
 
+/* Streams convert in blocks of this many input frames, running every stage on
+   one block before moving to the next, so the data stays in cache the whole way.
+   It's a multiple of 16, so the converters that grow data in place (and walk it
+   backwards) keep the 16-byte alignment the SIMD paths want. */
+#define AUDIOSTREAM_BLOCK_FRAMES 256
+
 struct _SDL_AudioStream
 {
     SDL_AudioCVT cvt_before_resampling;
     SDL_AudioCVT cvt_after_resampling;
     SDL_DataQueue *queue;
-    SDL_bool first_run;
-    Uint8 *staging_buffer;
-    int staging_buffer_size;
-    int staging_buffer_filled;
-    Uint8 *work_buffer_base;  /* maybe unaligned pointer from SDL_realloc(). */
-    int work_buffer_len;
+    Uint8 *work_buffer_base;  /* maybe unaligned pointer from SDL_malloc(). */
+    Uint8 *work_buffer;  /* one block, through cvt_before_resampling (or the whole conversion if not resampling). */
+    Uint8 *resample_buffer;  /* one block's resampler output, through cvt_after_resampling. */
+    int resample_buffer_len;  /* bytes the resampler may write, before cvt_after_resampling grows it. */
     int src_sample_frame_size;
     SDL_AudioFormat src_format;
     Uint8 src_channels;
@@ -1102,37 +1542,19 @@ struct _SDL_AudioStream
     double rate_incr;
     Uint8 pre_resample_channels;
     int packetlen;
-    int resampler_padding_samples;
-    float *resampler_padding;
+    int resampler_lookahead;  /* input frames the resampler holds back before it can produce output. */
+    Sint64 resampler_frames_in;  /* since the last flush or clear. */
+    Sint64 resampler_frames_out;
     void *resampler_state;
+    SDL_ResamplerBank *resampler_bank;
+    int resampler_history_frames;
+    int resampler_srcindex;
+    int resampler_phase;
     SDL_ResampleAudioStreamFunc resampler_func;
     SDL_ResetAudioStreamResamplerFunc reset_resampler_func;
     SDL_CleanupAudioStreamResamplerFunc cleanup_resampler_func;
 };
 
-static Uint8 *
-EnsureStreamBufferSize(SDL_AudioStream *stream, const int newlen)
-{
-    Uint8 *ptr;
-    size_t offset;
-
-    if (stream->work_buffer_len >= newlen) {
-        ptr = stream->work_buffer_base;
-    } else {
-        ptr = (Uint8 *) SDL_realloc(stream->work_buffer_base, newlen + 32);
-        if (!ptr) {
-            SDL_OutOfMemory();
-            return NULL;
-        }
-        /* Make sure we're aligned to 16 bytes for SIMD code. */
-        stream->work_buffer_base = ptr;
-        stream->work_buffer_len = newlen;
-    }
-
-    offset = ((size_t) ptr) & 15;
-    return offset ? ptr + (16 - offset) : ptr;
-}
-
 #ifdef HAVE_LIBSAMPLERATE_H
 static int
 SDL_ResampleAudioStream_SRC(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
@@ -1207,6 +1629,7 @@ SetupLibSampleRateResampling(SDL_AudioStream *stream)
     }
 
     stream->resampler_state = state;
+    stream->resampler_lookahead = ResamplerPadding(stream->src_rate, stream->dst_rate);  /* libsamplerate won't tell us its delay; this is plenty. */
     stream->resampler_func = SDL_ResampleAudioStream_SRC;
     stream->reset_resampler_func = SDL_ResetAudioStreamResampler_SRC;
     stream->cleanup_resampler_func = SDL_CleanupAudioStreamResampler_SRC;
@@ -1215,44 +1638,131 @@ SetupLibSampleRateResampling(SDL_AudioStream *stream)
 }
 #endif /* HAVE_LIBSAMPLERATE_H */
 
-
+/* The internal resampler keeps a little history of input frames: enough before
+   the next output's source frame for the left side of the filter, plus whatever
+   has arrived after it. Output is produced as soon as the right side of the
+   filter is covered, and the stream's position carries over between blocks. */
 static int
 SDL_ResampleAudioStream(SDL_AudioStream *stream, const void *_inbuf, const int inbuflen, void *_outbuf, const int outbuflen)
 {
-    const Uint8 *inbufend = ((const Uint8 *) _inbuf) + inbuflen;
-    const float *inbuf = (const float *) _inbuf;
-    float *outbuf = (float *) _outbuf;
-    const int chans = (int) stream->pre_resample_channels;
-    const int inrate = stream->src_rate;
-    const int outrate = stream->dst_rate;
-    const int paddingsamples = stream->resampler_padding_samples;
-    const int paddingbytes = paddingsamples * sizeof (float);
-    float *lpadding = (float *) stream->resampler_state;
-    const float *rpadding = (const float *) inbufend; /* we set this up so there are valid padding samples at the end of the input buffer. */
-    const int cpy = SDL_min(inbuflen, paddingbytes);
-    int retval;
+    const SDL_ResamplerBank *bank = stream->resampler_bank;
+    const int chans = bank->chans;
+    const int framelen = chans * (int) sizeof (float);
+    const int maxoutframes = outbuflen / framelen;
+    const int taps = bank->taps;
+    float *history = (float *) stream->resampler_state;
+    float *dst = (float *) _outbuf;
+    int frames = stream->resampler_history_frames;
+    int srcindex = stream->resampler_srcindex;
+    int phase = stream->resampler_phase;
+    int outframes = 0;
+    int firstframe;
+    int discard;
+
+    SDL_assert((frames + (inbuflen / framelen)) <= (taps + AUDIOSTREAM_BLOCK_FRAMES));
+
+    SDL_memcpy(history + (frames * chans), _inbuf, inbuflen);
+    frames += inbuflen / framelen;
+
+    while (outframes < maxoutframes) {
+        firstframe = srcindex - (bank->wing - 1);
+        if ((firstframe + taps) > frames) {
+            break;  /* need more input for this one. */
+        }
 
-    SDL_assert(inbuf != ((const float *) outbuf));  /* SDL_AudioStreamPut() shouldn't allow in-place resamples. */
+        ResamplerFrame(bank, phase, history + (firstframe * chans), dst);
+        dst += chans;
+        outframes++;
+
+        srcindex += bank->step;
+        phase += bank->step_rem;
+        if (phase >= bank->denom) {
+            phase -= bank->denom;
+            srcindex++;
+        }
+    }
 
-    retval = SDL_ResampleAudio(chans, inrate, outrate, lpadding, rpadding, inbuf, inbuflen, outbuf, outbuflen);
+    /* drop the frames no future output needs. When downsampling, the next
+       window can start past everything we have, so skip into the next block. */
+    firstframe = srcindex - (bank->wing - 1);
+    discard = SDL_min(firstframe, frames);
+    if (discard > 0) {
+        SDL_memmove(history, history + (discard * chans), (frames - discard) * framelen);
+        frames -= discard;
+        srcindex -= discard;
+    }
 
-    /* update our left padding with end of current input, for next run. */
-    SDL_memcpy((lpadding + paddingsamples) - (cpy / sizeof (float)), inbufend - cpy, cpy);
-    return retval;
+    stream->resampler_history_frames = frames;
+    stream->resampler_srcindex = srcindex;
+    stream->resampler_phase = phase;
+
+    return outframes * framelen;
 }
 
 static void
 SDL_ResetAudioStreamResampler(SDL_AudioStream *stream)
 {
-    /* set all the padding to silence. */
-    const int len = stream->resampler_padding_samples;
-    SDL_memset(stream->resampler_state, '\0', len * sizeof (float));
+    /* start with silence for the left side of the first output's filter. */
+    const SDL_ResamplerBank *bank = stream->resampler_bank;
+    const int frames = bank->wing - 1;
+    SDL_memset(stream->resampler_state, '\0', frames * bank->chans * sizeof (float));
+    stream->resampler_history_frames = frames;
+    stream->resampler_srcindex = frames;
+    stream->resampler_phase = 0;
 }
 
 static void
 SDL_CleanupAudioStreamResampler(SDL_AudioStream *stream)
 {
     SDL_free(stream->resampler_state);
+    if (stream->resampler_bank) {
+        SDL_ReleaseResamplerBank(stream->resampler_bank);
+    }
+}
+
+/* Sets up the aligned scratch space for one block, once, so putting data never allocates. */
+static int
+SetupAudioStreamBuffers(SDL_AudioStream *stream)
+{
+    const int blockframes = AUDIOSTREAM_BLOCK_FRAMES;
+    const int floatframelen = stream->pre_resample_channels * (int) sizeof (float);
+    int worklen = blockframes * stream->src_sample_frame_size;
+    int resamplelen = 0;
+    Uint8 *ptr;
+
+    if (stream->cvt_before_resampling.needed) {
+        worklen *= stream->cvt_before_resampling.len_mult;
+    }
+
+    if (stream->src_rate == stream->dst_rate) {
+        if (stream->cvt_after_resampling.needed) {
+            worklen *= stream->cvt_after_resampling.len_mult;
+        }
+    } else {
+        /* flushing runs blocks of silence straight into the resampler. */
+        worklen = SDL_max(worklen, blockframes * floatframelen);
+
+        /* a block can finish off outputs that were waiting on the lookahead, too. */
+        stream->resample_buffer_len = ((int) SDL_ceil((blockframes + stream->resampler_lookahead) * stream->rate_incr) + 2) * floatframelen;
+        resamplelen = stream->resample_buffer_len;
+        if (stream->cvt_after_resampling.needed) {
+            resamplelen *= stream->cvt_after_resampling.len_mult;
+        }
+    }
+
+    /* give each buffer its own cache lines. */
+    worklen = (worklen + 63) & ~63;
+    resamplelen = (resamplelen + 63) & ~63;
+
+    ptr = (Uint8 *) SDL_malloc(worklen + resamplelen + 64);
+    if (!ptr) {
+        return SDL_OutOfMemory();
+    }
+
+    stream->work_buffer_base = ptr;
+    stream->work_buffer = ptr + ((64 - (((size_t) ptr) & 63)) & 63);
+    stream->resample_buffer = resamplelen ? (stream->work_buffer + worklen) : NULL;
+    return 0;
 }
 
 SDL_AudioStream *
@@ -1278,7 +1788,6 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
        the resampled data (!!! FIXME: decide if that works in practice, though!). */
     pre_resample_channels = SDL_min(src_channels, dst_channels);
 
-    retval->first_run = SDL_TRUE;
     retval->src_sample_frame_size = (SDL_AUDIO_BITSIZE(src_format) / 8) * src_channels;
     retval->src_format = src_format;
     retval->src_channels = src_channels;
@@ -1290,24 +1799,6 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
     retval->pre_resample_channels = pre_resample_channels;
     retval->packetlen = packetlen;
     retval->rate_incr = ((double) dst_rate) / ((double) src_rate);
-    retval->resampler_padding_samples = ResamplerPadding(retval->src_rate, retval->dst_rate) * pre_resample_channels;
-    retval->resampler_padding = (float *) SDL_calloc(retval->resampler_padding_samples ? retval->resampler_padding_samples : 1, sizeof (float));
-
-    if (retval->resampler_padding == NULL) {
-        SDL_FreeAudioStream(retval);
-        SDL_OutOfMemory();
-        return NULL;
-    }
-
-    retval->staging_buffer_size = ((retval->resampler_padding_samples / retval->pre_resample_channels) * retval->src_sample_frame_size);
-    if (retval->staging_buffer_size > 0) {
-        retval->staging_buffer = (Uint8 *) SDL_malloc(retval->staging_buffer_size);
-        if (retval->staging_buffer == NULL) {
-            SDL_FreeAudioStream(retval);
-            SDL_OutOfMemory();
-            return NULL;
-        }
-    }
 
     /* Not resampling? It's an easy conversion (and maybe not even that!) */
     if (src_rate == dst_rate) {
@@ -1329,23 +1820,26 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
 #endif
 
         if (!retval->resampler_func) {
-            retval->resampler_state = SDL_calloc(retval->resampler_padding_samples, sizeof (float));
-            if (!retval->resampler_state) {
+            retval->resampler_bank = SDL_AcquireResamplerBank(pre_resample_channels, src_rate, dst_rate, SDL_GetResamplerQuality());
+            if (!retval->resampler_bank) {
                 SDL_FreeAudioStream(retval);
-                SDL_OutOfMemory();
                 return NULL;
             }
 
-            if (SDL_PrepareResampleFilter() < 0) {
-                SDL_free(retval->resampler_state);
-                retval->resampler_state = NULL;
+            retval->resampler_state = SDL_malloc((retval->resampler_bank->taps + AUDIOSTREAM_BLOCK_FRAMES) * pre_resample_channels * sizeof (float));
+            if (!retval->resampler_state) {
+                SDL_ReleaseResamplerBank(retval->resampler_bank);
+                retval->resampler_bank = NULL;
                 SDL_FreeAudioStream(retval);
+                SDL_OutOfMemory();
                 return NULL;
             }
 
+            retval->resampler_lookahead = retval->resampler_bank->taps;
             retval->resampler_func = SDL_ResampleAudioStream;
             retval->reset_resampler_func = SDL_ResetAudioStreamResampler;
             retval->cleanup_resampler_func = SDL_CleanupAudioStreamResampler;
+            SDL_ResetAudioStreamResampler(retval);
         }
 
         /* Convert us to the final format after resampling. */
@@ -1355,6 +1849,11 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
         }
     }
 
+    if (SetupAudioStreamBuffers(retval) < 0) {
+        SDL_FreeAudioStream(retval);
+        return NULL;
+    }
+
     retval->queue = SDL_NewDataQueue(packetlen, packetlen * 2);
     if (!retval->queue) {
         SDL_FreeAudioStream(retval);
@@ -1364,74 +1863,70 @@ SDL_NewAudioStream(const SDL_AudioFormat src_format,
     return retval;
 }
 
+/* Last stage for a block: (buf) is one of our aligned scratch buffers, convert it in place and queue it. */
 static int
-SDL_AudioStreamPutInternal(SDL_AudioStream *stream, const void *buf, int len, int *maxputbytes)
+SDL_AudioStreamFinishBlock(SDL_AudioStream *stream, Uint8 *buf, int buflen, int *maxputbytes)
 {
-    int buflen = len;
-    int workbuflen;
-    Uint8 *workbuf;
-    Uint8 *resamplebuf = NULL;
-    int resamplebuflen = 0;
-    int neededpaddingbytes;
-    int paddingbytes;
-
-    /* !!! FIXME: several converters can take advantage of SIMD, but only
-       !!! FIXME:  if the data is aligned to 16 bytes. EnsureStreamBufferSize()
-       !!! FIXME:  guarantees the buffer will align, but the
-       !!! FIXME:  converters will iterate over the data backwards if
-       !!! FIXME:  the output grows, and this means we won't align if buflen
-       !!! FIXME:  isn't a multiple of 16. In these cases, we should chop off
-       !!! FIXME:  a few samples at the end and convert them separately. */
-
-    /* no padding prepended on first run. */
-    neededpaddingbytes = stream->resampler_padding_samples * sizeof (float);
-    paddingbytes = stream->first_run ? 0 : neededpaddingbytes;
-    stream->first_run = SDL_FALSE;
-
-    /* Make sure the work buffer can hold all the data we need at once... */
-    workbuflen = buflen;
-    if (stream->cvt_before_resampling.needed) {
-        workbuflen *= stream->cvt_before_resampling.len_mult;
-    }
+    if (stream->cvt_after_resampling.needed && (buflen > 0)) {
+        stream->cvt_after_resampling.buf = buf;
+        stream->cvt_after_resampling.len = buflen;
+        if (SDL_ConvertAudio(&stream->cvt_after_resampling) == -1) {
+            return -1;   /* uhoh! */
+        }
+        buflen = stream->cvt_after_resampling.len_cvt;
 
-    if (stream->dst_rate != stream->src_rate) {
-        /* resamples can't happen in place, so make space for second buf. */
-        const int framesize = stream->pre_resample_channels * sizeof (float);
-        const int frames = workbuflen / framesize;
-        resamplebuflen = ((int) SDL_ceil(frames * stream->rate_incr)) * framesize;
         #if DEBUG_AUDIOSTREAM
-        printf("AUDIOSTREAM: will resample %d bytes to %d (ratio=%.6f)\n", workbuflen, resamplebuflen, stream->rate_incr);
+        printf("AUDIOSTREAM: After final conversion we have %d bytes\n", buflen);
         #endif
-        workbuflen += resamplebuflen;
     }
 
-    if (stream->cvt_after_resampling.needed) {
-        /* !!! FIXME: buffer might be big enough already? */
-        workbuflen *= stream->cvt_after_resampling.len_mult;
+    if (maxputbytes) {
+        const int maxbytes = *maxputbytes;
+        if (buflen > maxbytes)
+            buflen = maxbytes;
+        *maxputbytes -= buflen;
     }
 
-    workbuflen += neededpaddingbytes;
+    return buflen ? SDL_WriteToDataQueue(stream->queue, buf, buflen) : 0;
+}
+
+/* Resample one block of float data and finish it off. */
+static int
+SDL_AudioStreamResampleBlock(SDL_AudioStream *stream, const void *buf, const int buflen, int *maxputbytes)
+{
+    const int framelen = stream->pre_resample_channels * (int) sizeof (float);
+    const int outlen = stream->resampler_func(stream, buf, buflen, stream->resample_buffer, stream->resample_buffer_len);
 
     #if DEBUG_AUDIOSTREAM
-    printf("AUDIOSTREAM: Putting %d bytes of preconverted audio, need %d byte work buffer\n", buflen, workbuflen);
+    printf("AUDIOSTREAM: After resampling we have %d bytes\n", outlen);
     #endif
 
-    workbuf = EnsureStreamBufferSize(stream, workbuflen);
-    if (!workbuf) {
-        return -1;  /* probably out of memory. */
-    }
+    stream->resampler_frames_out += outlen / framelen;
+    return SDL_AudioStreamFinishBlock(stream, stream->resample_buffer, outlen, maxputbytes);
+}
+
+/* Run one block (at most AUDIOSTREAM_BLOCK_FRAMES frames) through the whole pipeline. */
+static int
+SDL_AudioStreamPutInternal(SDL_AudioStream *stream, const void *buf, int len)
+{
+    Uint8 *workbuf = stream->work_buffer;
+    int buflen = len;
 
-    resamplebuf = workbuf;  /* default if not resampling. */
+    SDL_assert(len <= (AUDIOSTREAM_BLOCK_FRAMES * stream->src_sample_frame_size));
 
-    SDL_memcpy(workbuf + paddingbytes, buf, buflen);
+    #if DEBUG_AUDIOSTREAM
+    printf("AUDIOSTREAM: Putting a block of %d bytes of preconverted audio\n", len);
+    #endif
 
     if (stream->cvt_before_resampling.needed) {
-        stream->cvt_before_resampling.buf = workbuf + paddingbytes;
-        stream->cvt_before_resampling.len = buflen;
+        SDL_memcpy(workbuf, buf, len);
+        stream->cvt_before_resampling.buf = workbuf;
+        stream->cvt_before_resampling.len = len;
         if (SDL_ConvertAudio(&stream->cvt_before_resampling) == -1) {
             return -1;   /* uhoh! */
         }
         buflen = stream->cvt_before_resampling.len_cvt;
+        buf = workbuf;
 
         #if DEBUG_AUDIOSTREAM
         printf("AUDIOSTREAM: After initial conversion we have %d bytes\n", buflen);
@@ -1439,73 +1934,24 @@ SDL_AudioStreamPutInternal(SDL_AudioStream *stream, const void *buf, int len, in
     }
 
     if (stream->dst_rate != stream->src_rate) {
-        /* save off some samples at the end; they are used for padding now so
-           the resampler is coherent and then used at the start of the next
-           put operation. Prepend last put operation's padding, too. */
-
-        /* prepend prior put's padding. :P */
-        if (paddingbytes) {
-            SDL_memcpy(workbuf, stream->resampler_padding, paddingbytes);
-            buflen += paddingbytes;
-        }
-
-        /* save off the data at the end for the next run. */
-        SDL_memcpy(stream->resampler_padding, workbuf + (buflen - neededpaddingbytes), neededpaddingbytes);
-
-        resamplebuf = workbuf + buflen;  /* skip to second piece of workbuf. */
-        SDL_assert(buflen >= neededpaddingbytes);
-        if (buflen > neededpaddingbytes) {
-            buflen = stream->resampler_func(stream, workbuf, buflen - neededpaddingbytes, resamplebuf, resamplebuflen);
-        } else {
-            buflen = 0;
-        }
-
-        #if DEBUG_AUDIOSTREAM
-        printf("AUDIOSTREAM: After resampling we have %d bytes\n", buflen);
-        #endif
-    }
-
-    if (stream->cvt_after_resampling.needed && (buflen > 0)) {
-        stream->cvt_after_resampling.buf = resamplebuf;
-        stream->cvt_after_resampling.len = buflen;
-        if (SDL_ConvertAudio(&stream->cvt_after_resampling) == -1) {
-            return -1;   /* uhoh! */
-        }
-        buflen = stream->cvt_after_resampling.len_cvt;
-
-        #if DEBUG_AUDIOSTREAM
-        printf("AUDIOSTREAM: After final conversion we have %d bytes\n", buflen);
-        #endif
+        /* the resampler copies or consumes its input, so it can read the app's buffer directly. */
+        stream->resampler_frames_in += len / stream->src_sample_frame_size;
+        return SDL_AudioStreamResampleBlock(stream, buf, buflen, NULL);
     }
 
-    #if DEBUG_AUDIOSTREAM
-    printf("AUDIOSTREAM: Final output is %d bytes\n", buflen);
-    #endif
-
-    if (maxputbytes) {
-        const int maxbytes = *maxputbytes;
-        if (buflen > maxbytes)
-            buflen = maxbytes;
-        *maxputbytes -= buflen;
+    if (buf != workbuf) {
+        SDL_memcpy(workbuf, buf, len);
     }
-
-    /* resamplebuf holds the final output, even if we didn't resample. */
-    return buflen ? SDL_WriteToDataQueue(stream->queue, resamplebuf, buflen) : 0;
+    return SDL_AudioStreamFinishBlock(stream, workbuf, buflen, NULL);
 }
 
 int
 SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, int len)
 {
-    /* !!! FIXME: several converters can take advantage of SIMD, but only
-       !!! FIXME:  if the data is aligned to 16 bytes. EnsureStreamBufferSize()
-       !!! FIXME:  guarantees the buffer will align, but the
-       !!! FIXME:  converters will iterate over the data backwards if
-       !!! FIXME:  the output grows, and this means we won't align if buflen
-       !!! FIXME:  isn't a multiple of 16. In these cases, we should chop off
-       !!! FIXME:  a few samples at the end and convert them separately. */
+    const int blocklen = AUDIOSTREAM_BLOCK_FRAMES * (stream ? stream->src_sample_frame_size : 0);
 
     #if DEBUG_AUDIOSTREAM
-    printf("AUDIOSTREAM: wants to put %d preconverted bytes\n", buflen);
+    printf("AUDIOSTREAM: wants to put %d preconverted bytes\n", len);
     #endif
 
     if (!stream) {
@@ -1528,31 +1974,22 @@ SDL_AudioStreamPut(SDL_AudioStream *stream, const void *buf, int len)
     }
 
     while (len > 0) {
-        int amount;
-
-        /* If we don't have a staging buffer or we're given enough data that
-           we don't need to store it for later, skip the staging process.
-         */
-        if (!stream->staging_buffer_filled && len >= stream->staging_buffer_size) {
-            return SDL_AudioStreamPutInternal(stream, buf, len, NULL);
+        int amount = SDL_min(len, blocklen);
+
+        /* A short final block would leave converters that grow the data
+           unaligned, so convert all but the last few frames first and
+           do those separately. */
+        if (amount < blocklen) {
+            const int chunk = 16 * stream->src_sample_frame_size;
+            if (amount > chunk) {
+                amount -= amount % chunk;
+            }
         }
 
-        /* If there's not enough data to fill the staging buffer, just save it */
-        if ((stream->staging_buffer_filled + len) < stream->staging_buffer_size) {
-            SDL_memcpy(stream->staging_buffer + stream->staging_buffer_filled, buf, len);
-            stream->staging_buffer_filled += len;
-            return 0;
-        }
- 
-        /* Fill the staging buffer, process it, and continue */
-        amount = (stream->staging_buffer_size - stream->staging_buffer_filled);
-        SDL_assert(amount > 0);
-        SDL_memcpy(stream->staging_buffer + stream->staging_buffer_filled, buf, amount);
-        stream->staging_buffer_filled = 0;
-        if (SDL_AudioStreamPutInternal(stream, stream->staging_buffer, stream->staging_buffer_size, NULL) < 0) {
+        if (SDL_AudioStreamPutInternal(stream, buf, amount) < 0) {
             return -1;
         }
-        buf = (void *)((Uint8 *)buf + amount);
+        buf = (const void *) (((const Uint8 *) buf) + amount);
         len -= amount;
     }
     return 0;
@@ -1565,47 +2002,33 @@ int SDL_AudioStreamFlush(SDL_AudioStream *stream)
     }
 
     #if DEBUG_AUDIOSTREAM
-    printf("AUDIOSTREAM: flushing! staging_buffer_filled=%d bytes\n", stream->staging_buffer_filled);
+    printf("AUDIOSTREAM: flushing! %d frames in, %d frames out\n", (int) stream->resampler_frames_in, (int) stream->resampler_frames_out);
     #endif
 
-    /* shouldn't use a staging buffer if we're not resampling. */
-    SDL_assert((stream->dst_rate != stream->src_rate) || (stream->staging_buffer_filled == 0));
-
-    if (stream->staging_buffer_filled > 0) {
-        /* push the staging buffer + silence. We need to flush out not just
-           the staging buffer, but the piece that the stream was saving off
-           for right-side resampler padding. */
-        const SDL_bool first_run = stream->first_run;
-        const int filled = stream->staging_buffer_filled;
-        int actual_input_frames = filled / stream->src_sample_frame_size;
-        if (!first_run)
-            actual_input_frames += stream->resampler_padding_samples / stream->pre_resample_channels;
-
-        if (actual_input_frames > 0) {  /* don't bother if nothing to flush. */
-            /* This is how many bytes we're expecting without silence appended. */
-            int flush_remaining = ((int) SDL_ceil(actual_input_frames * stream->rate_incr)) * stream->dst_sample_frame_size;
-
-            #if DEBUG_AUDIOSTREAM
-            printf("AUDIOSTREAM: flushing with padding to get max %d bytes!\n", flush_remaining);
-            #endif
-
-            SDL_memset(stream->staging_buffer + filled, '\0', stream->staging_buffer_size - filled);
-            if (SDL_AudioStreamPutInternal(stream, stream->staging_buffer, stream->staging_buffer_size, &flush_remaining) < 0) {
-                return -1;
-            }
-
-            /* we have flushed out (or initially filled) the pending right-side
-               resampler padding, but we need to push more silence to guarantee
-               the staging buffer is fully flushed out, too. */
-            SDL_memset(stream->staging_buffer, '\0', filled);
-            if (SDL_AudioStreamPutInternal(stream, stream->staging_buffer, stream->staging_buffer_size, &flush_remaining) < 0) {
+    if ((stream->dst_rate != stream->src_rate) && (stream->resampler_frames_in > 0)) {
+        /* push silence through the resampler until everything that was put
+           has come out the other side, but nothing more: floor(in * dst / src)
+           frames, the same as SDL_ConvertAudio() gives for the whole buffer. */
+        const int framelen = stream->pre_resample_channels * (int) sizeof (float);
+        const Sint64 wanted = (stream->resampler_frames_in * stream->dst_rate) / stream->src_rate;
+        int flush_remaining = (int) (wanted - stream->resampler_frames_out) * stream->dst_sample_frame_size;
+        int silence = 0;
+
+        SDL_memset(stream->work_buffer, '\0', AUDIOSTREAM_BLOCK_FRAMES * framelen);
+        while ((flush_remaining > 0) && (silence <= stream->resampler_lookahead)) {
+            if (SDL_AudioStreamResampleBlock(stream, stream->work_buffer, AUDIOSTREAM_BLOCK_FRAMES * framelen, &flush_remaining) < 0) {
                 return -1;
             }
+            silence += AUDIOSTREAM_BLOCK_FRAMES;
         }
     }
 
-    stream->staging_buffer_filled = 0;
-    stream->first_run = SDL_TRUE;
+    /* whatever comes next starts fresh. */
+    if (stream->reset_resampler_func) {
+        stream->reset_resampler_func(stream);
+    }
+    stream->resampler_frames_in = 0;
+    stream->resampler_frames_out = 0;
 
     return 0;
 }
@@ -1648,8 +2071,8 @@ SDL_AudioStreamClear(SDL_AudioStream *stream)
         if (stream->reset_resampler_func) {
             stream->reset_resampler_func(stream);
         }
-        stream->first_run = SDL_TRUE;
-        stream->staging_buffer_filled = 0;
+        stream->resampler_frames_in = 0;
+        stream->resampler_frames_out = 0;
     }
 }
 
@@ -1662,12 +2085,9 @@ SDL_FreeAudioStream(SDL_AudioStream *stream)
             stream->cleanup_resampler_func(stream);
         }
         SDL_FreeDataQueue(stream->queue);
-        SDL_free(stream->staging_buffer);
         SDL_free(stream->work_buffer_base);
-        SDL_free(stream->resampler_padding);
         SDL_free(stream);
     }
 }
 
 /* vi: set ts=4 sw=4 expandtab: */
-
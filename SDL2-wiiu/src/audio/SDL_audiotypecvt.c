@@ -41,6 +41,8 @@
 #define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* ARMv8+ promise NEON. */
 #elif defined(__APPLE__) && defined(__ARM_ARCH) && (__ARM_ARCH >= 7) && HAVE_NEON_INTRINSICS
 #define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* All Apple ARMv7 chips promise NEON support. */
+#elif HAVE_VECTOR_EXTENSIONS
+#define NEED_SCALAR_CONVERTER_FALLBACKS 0  /* the vector extension converters build everywhere. */
 #endif
 
 /* Set to zero if platform is guaranteed to use a SIMD codepath here. */
@@ -59,6 +61,12 @@ SDL_AudioFilter SDL_Convert_F32_to_U8 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_S16 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_U16 = NULL;
 SDL_AudioFilter SDL_Convert_F32_to_S32 = NULL;
+SDL_AudioFilter SDL_Convert_S16_Swapped_to_F32 = NULL;
+SDL_AudioFilter SDL_Convert_U16_Swapped_to_F32 = NULL;
+SDL_AudioFilter SDL_Convert_S32_Swapped_to_F32 = NULL;
+SDL_AudioFilter SDL_Convert_F32_to_S16_Swapped = NULL;
+SDL_AudioFilter SDL_Convert_F32_to_U16_Swapped = NULL;
+SDL_AudioFilter SDL_Convert_F32_to_S32_Swapped = NULL;
 
 
 #define DIVBY128 0.0078125f
@@ -293,6 +301,10 @@ SDL_Convert_F32_to_S32_Scalar(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 
 
 #if HAVE_SSE2_INTRINSICS
+/* Float to int conversions truncate (_mm_cvttps_epi32) and put +/-1.0f and
+   beyond at the ends of the range, like the scalar, NEON and vector extension
+   converters, so every path, and the leftovers each one finishes with scalar
+   code, agree on every sample. */
 static void SDLCALL
 SDL_Convert_S8_to_F32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 {
@@ -581,10 +593,10 @@ SDL_Convert_F32_to_S8_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby127 = _mm_set1_ps(127.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+8)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints4 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+12)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
+            const __m128i ints1 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby127)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const __m128i ints2 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), mulby127)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src+4), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const __m128i ints3 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+8)), one), mulby127)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src+8), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const __m128i ints4 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+12)), one), mulby127)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src+12), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
             _mm_store_si128(mmdst, _mm_packs_epi16(_mm_packs_epi32(ints1, ints2), _mm_packs_epi32(ints3, ints4)));  /* pack down, store out. */
             i -= 16; src += 16; mmdst++;
         }
@@ -641,10 +653,10 @@ SDL_Convert_F32_to_U8_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby127 = _mm_set1_ps(127.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+8)), one), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints4 = _mm_cvtps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+12)), one), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
+            const __m128i ints1 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), one), mulby127)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
+            const __m128i ints2 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), one), mulby127)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src+4), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
+            const __m128i ints3 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+8)), one), one), mulby127)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src+8), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
+            const __m128i ints4 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+12)), one), one), mulby127)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src+12), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
             _mm_store_si128(mmdst, _mm_packus_epi16(_mm_packs_epi32(ints1, ints2), _mm_packs_epi32(ints3, ints4)));  /* pack down, store out. */
             i -= 16; src += 16; mmdst++;
         }
@@ -701,8 +713,8 @@ SDL_Convert_F32_to_S16_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 mulby32767 = _mm_set1_ps(32767.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
+            const __m128i ints1 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby32767)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const __m128i ints2 = _mm_add_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), mulby32767)), _mm_castps_si128(_mm_cmple_ps(_mm_load_ps(src+4), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
             _mm_store_si128(mmdst, _mm_packs_epi32(ints1, ints2));  /* pack to sint16, store out. */
             i -= 8; src += 8; mmdst++;
         }
@@ -754,22 +766,22 @@ SDL_Convert_F32_to_U16_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
     /* Make sure src is aligned too. */
     if ((((size_t) src) & 15) == 0) {
         /* Aligned! Do SSE blocks as long as we have 16 bytes available. */
-        /* This calculates differently than the scalar path because SSE2 can't
-           pack int32 data down to unsigned int16. _mm_packs_epi32 does signed
-           saturation, so that would corrupt our data. _mm_packus_epi32 exists,
-           but not before SSE 4.1. So we convert from float to sint16, packing
-           that down with legit signed saturation, and then xor the top bit
-           against 1. This results in the correct unsigned 16-bit value, even
-           though it looks like dark magic. */
+        /* SSE2 can't pack int32 data down to unsigned int16. _mm_packs_epi32
+           does signed saturation, so that would corrupt our data.
+           _mm_packus_epi32 exists, but not before SSE 4.1. So we work out
+           the same unsigned value as the scalar path, take 32768 off to make
+           it fit a sint16, pack that down with legit signed saturation, and
+           then xor the top bit against 1 to put the 32768 back. */
         const __m128 mulby32767 = _mm_set1_ps(32767.0f);
         const __m128i topbit = _mm_set1_epi16(-32768);
+        const __m128i half = _mm_set1_epi32(32768);
         const __m128 one = _mm_set1_ps(1.0f);
         const __m128 negone = _mm_set1_ps(-1.0f);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const __m128i ints1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
-            const __m128i ints2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
-            _mm_store_si128(mmdst, _mm_xor_si128(_mm_packs_epi32(ints1, ints2), topbit));  /* pack to sint16, xor top bit, store out. */
+            const __m128i ints1 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), one), mulby32767)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
+            const __m128i ints2 = _mm_sub_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src+4)), one), one), mulby32767)), _mm_castps_si128(_mm_cmpge_ps(_mm_load_ps(src+4), one)));  /* load 4 floats, clamp, convert to sint32, 1.0f up is the maximum */
+            _mm_store_si128(mmdst, _mm_xor_si128(_mm_packs_epi32(_mm_sub_epi32(ints1, half), _mm_sub_epi32(ints2, half)), topbit));  /* pack to sint16, xor top bit, store out. */
             i -= 8; src += 8; mmdst++;
         }
         dst = (Uint16 *) mmdst;
@@ -823,9 +835,17 @@ SDL_Convert_F32_to_S32_SSE2(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const __m128 one = _mm_set1_ps(1.0f);
         const __m128 negone = _mm_set1_ps(-1.0f);
         const __m128 mulby8388607 = _mm_set1_ps(8388607.0f);
+        const __m128i maxint = _mm_set1_epi32(2147483647);
+        const __m128i minint = _mm_set1_epi32((int) 0x80000000);
         __m128i *mmdst = (__m128i *) dst;
         while (i >= 4) {   /* 4 * float32 */
-            _mm_store_si128(mmdst, _mm_slli_epi32(_mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, _mm_load_ps(src)), one), mulby8388607)), 8));  /* load 4 floats, clamp, convert to sint32 */
+            const __m128 floats = _mm_load_ps(src);
+            const __m128i toobig = _mm_castps_si128(_mm_cmpge_ps(floats, one));
+            const __m128i toosmall = _mm_castps_si128(_mm_cmple_ps(floats, negone));
+            const __m128i ints = _mm_slli_epi32(_mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(negone, floats), one), mulby8388607)), 8);  /* clamp, convert to sint32 */
+            /* +/-1.0f and beyond go to the ends of the range, like the scalar path. */
+            _mm_store_si128(mmdst, _mm_or_si128(_mm_andnot_si128(_mm_or_si128(toobig, toosmall), ints),
+                                                _mm_or_si128(_mm_and_si128(toobig, maxint), _mm_and_si128(toosmall, minint))));
             i -= 4; src += 4; mmdst++;
         }
         dst = (Sint32 *) mmdst;
@@ -1115,10 +1135,10 @@ SDL_Convert_F32_to_S8_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const float32x4_t mulby127 = vdupq_n_f32(127.0f);
         int8_t *mmdst = (int8_t *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const int32x4_t ints1 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const int32x4_t ints2 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const int32x4_t ints3 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+8)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
-            const int32x4_t ints4 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+12)), one), mulby127));  /* load 4 floats, clamp, convert to sint32 */
+            const int32x4_t ints1 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), mulby127)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const int32x4_t ints2 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), mulby127)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src+4), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const int32x4_t ints3 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+8)), one), mulby127)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src+8), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const int32x4_t ints4 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+12)), one), mulby127)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src+12), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
             const int8x8_t i8lo = vmovn_s16(vcombine_s16(vmovn_s32(ints1), vmovn_s32(ints2))); /* narrow to sint16, combine, narrow to sint8 */
             const int8x8_t i8hi = vmovn_s16(vcombine_s16(vmovn_s32(ints3), vmovn_s32(ints4))); /* narrow to sint16, combine, narrow to sint8 */
             vst1q_s8(mmdst, vcombine_s8(i8lo, i8hi));  /* combine to int8x16_t, store out */
@@ -1177,10 +1197,10 @@ SDL_Convert_F32_to_U8_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const float32x4_t mulby127 = vdupq_n_f32(127.0f);
         uint8_t *mmdst = (uint8_t *) dst;
         while (i >= 16) {   /* 16 * float32 */
-            const uint32x4_t uints1 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), one), mulby127));  /* load 4 floats, clamp, convert to uint32 */
-            const uint32x4_t uints2 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), one), mulby127));  /* load 4 floats, clamp, convert to uint32 */
-            const uint32x4_t uints3 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+8)), one), one), mulby127));  /* load 4 floats, clamp, convert to uint32 */
-            const uint32x4_t uints4 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+12)), one), one), mulby127));  /* load 4 floats, clamp, convert to uint32 */
+            const uint32x4_t uints1 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), one), mulby127)), vcgeq_f32(vld1q_f32(src), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
+            const uint32x4_t uints2 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), one), mulby127)), vcgeq_f32(vld1q_f32(src+4), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
+            const uint32x4_t uints3 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+8)), one), one), mulby127)), vcgeq_f32(vld1q_f32(src+8), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
+            const uint32x4_t uints4 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+12)), one), one), mulby127)), vcgeq_f32(vld1q_f32(src+12), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
             const uint8x8_t ui8lo = vmovn_u16(vcombine_u16(vmovn_u32(uints1), vmovn_u32(uints2))); /* narrow to uint16, combine, narrow to uint8 */
             const uint8x8_t ui8hi = vmovn_u16(vcombine_u16(vmovn_u32(uints3), vmovn_u32(uints4))); /* narrow to uint16, combine, narrow to uint8 */
             vst1q_u8(mmdst, vcombine_u8(ui8lo, ui8hi));  /* combine to uint8x16_t, store out */
@@ -1240,8 +1260,8 @@ SDL_Convert_F32_to_S16_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const float32x4_t mulby32767 = vdupq_n_f32(32767.0f);
         int16_t *mmdst = (int16_t *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const int32x4_t ints1 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
-            const int32x4_t ints2 = vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), mulby32767));  /* load 4 floats, clamp, convert to sint32 */
+            const int32x4_t ints1 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), mulby32767)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
+            const int32x4_t ints2 = vaddq_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), mulby32767)), vreinterpretq_s32_u32(vcleq_f32(vld1q_f32(src+4), negone)));  /* load 4 floats, clamp, convert to sint32, -1.0f down is the minimum */
             vst1q_s16(mmdst, vcombine_s16(vmovn_s32(ints1), vmovn_s32(ints2)));  /* narrow to sint16, combine, store out. */
             i -= 8; src += 8; mmdst += 8;
         }
@@ -1298,8 +1318,8 @@ SDL_Convert_F32_to_U16_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const float32x4_t mulby32767 = vdupq_n_f32(32767.0f);
         uint16_t *mmdst = (uint16_t *) dst;
         while (i >= 8) {   /* 8 * float32 */
-            const uint32x4_t uints1 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), one), mulby32767));  /* load 4 floats, clamp, convert to uint32 */
-            const uint32x4_t uints2 = vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), one), mulby32767));  /* load 4 floats, clamp, convert to uint32 */
+            const uint32x4_t uints1 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), one), mulby32767)), vcgeq_f32(vld1q_f32(src), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
+            const uint32x4_t uints2 = vsubq_u32(vcvtq_u32_f32(vmulq_f32(vaddq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src+4)), one), one), mulby32767)), vcgeq_f32(vld1q_f32(src+4), one));  /* load 4 floats, clamp, convert to uint32, 1.0f up is the maximum */
             vst1q_u16(mmdst, vcombine_u16(vmovn_u32(uints1), vmovn_u32(uints2)));  /* narrow to uint16, combine, store out. */
             i -= 8; src += 8; mmdst += 8;
         }
@@ -1354,9 +1374,14 @@ SDL_Convert_F32_to_S32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
         const float32x4_t one = vdupq_n_f32(1.0f);
         const float32x4_t negone = vdupq_n_f32(-1.0f);
         const float32x4_t mulby8388607 = vdupq_n_f32(8388607.0f);
+        const int32x4_t maxint = vdupq_n_s32(2147483647);
+        const int32x4_t minint = vdupq_n_s32((int32_t) 0x80000000);
         int32_t *mmdst = (int32_t *) dst;
         while (i >= 4) {   /* 4 * float32 */
-            vst1q_s32(mmdst, vshlq_n_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, vld1q_f32(src)), one), mulby8388607)), 8));
+            const float32x4_t floats = vld1q_f32(src);
+            const int32x4_t ints = vshlq_n_s32(vcvtq_s32_f32(vmulq_f32(vminq_f32(vmaxq_f32(negone, floats), one), mulby8388607)), 8);  /* clamp, convert to sint32 */
+            /* +/-1.0f and beyond go to the ends of the range, like the scalar path. */
+            vst1q_s32(mmdst, vbslq_s32(vcgeq_f32(floats, one), maxint, vbslq_s32(vcleq_f32(floats, negone), minint, ints)));
             i -= 4; src += 4; mmdst += 4;
         }
         dst = (Sint32 *) mmdst;
@@ -1382,6 +1407,449 @@ SDL_Convert_F32_to_S32_NEON(SDL_AudioCVT *cvt, SDL_AudioFormat format)
 #endif
 
 
+#if HAVE_VECTOR_EXTENSIONS
+/* Converters written with the compiler's vector extensions. They do the same
+   math as the scalar versions, four samples at a time, and optionally byteswap
+   on the way in or out, so foreign-endian data doesn't need a separate
+   SDL_Convert_Byteswap pass over the buffer. */
+
+#define VSWAP16_IF(swap, type, v) ((swap) ? (type) SDL_AUDIO_VSWAP16((SDL_AudioU16x4_u) (v)) : (type) (v))
+#define VSWAP32_IF(swap, type, v) ((swap) ? (type) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) (v)) : (type) (v))
+
+/* These grow the buffer in place, so they walk it from the end. */
+static SDL_INLINE void
+SDL_ConvertS8ToF32_Vector(float *dst, const Sint8 *src, const int num)
+{
+    int i = num;
+
+    while (i & 3) {
+        i--;
+        dst[i] = ((float) src[i]) * DIVBY128;
+    }
+
+    while (i) {
+        i -= 4;
+        *(SDL_AudioF32x4_u *) (dst + i) = __builtin_convertvector(*(const SDL_AudioS8x4_u *) (src + i), SDL_AudioF32x4) * DIVBY128;
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertU8ToF32_Vector(float *dst, const Uint8 *src, const int num)
+{
+    int i = num;
+
+    while (i & 3) {
+        i--;
+        dst[i] = (((float) src[i]) * DIVBY128) - 1.0f;
+    }
+
+    while (i) {
+        i -= 4;
+        *(SDL_AudioF32x4_u *) (dst + i) = (__builtin_convertvector(*(const SDL_AudioU8x4_u *) (src + i), SDL_AudioF32x4) * DIVBY128) - 1.0f;
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertS16ToF32_Vector(float *dst, const Sint16 *src, const int num, const SDL_bool swap)
+{
+    int i = num;
+
+    while (i & 3) {
+        i--;
+        dst[i] = ((float) (swap ? (Sint16) SDL_Swap16((Uint16) src[i]) : src[i])) * DIVBY32768;
+    }
+
+    while (i) {
+        SDL_AudioS16x4_u ints;
+        i -= 4;
+        ints = VSWAP16_IF(swap, SDL_AudioS16x4_u, *(const SDL_AudioS16x4_u *) (src + i));
+        *(SDL_AudioF32x4_u *) (dst + i) = __builtin_convertvector(ints, SDL_AudioF32x4) * DIVBY32768;
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertU16ToF32_Vector(float *dst, const Uint16 *src, const int num, const SDL_bool swap)
+{
+    int i = num;
+
+    while (i & 3) {
+        i--;
+        dst[i] = (((float) (swap ? SDL_Swap16(src[i]) : src[i])) * DIVBY32768) - 1.0f;
+    }
+
+    while (i) {
+        SDL_AudioU16x4_u ints;
+        i -= 4;
+        ints = VSWAP16_IF(swap, SDL_AudioU16x4_u, *(const SDL_AudioU16x4_u *) (src + i));
+        *(SDL_AudioF32x4_u *) (dst + i) = (__builtin_convertvector(ints, SDL_AudioF32x4) * DIVBY32768) - 1.0f;
+    }
+}
+
+/* The rest keep or shrink the sample size, so they walk forward. */
+static SDL_INLINE void
+SDL_ConvertS32ToF32_Vector(float *dst, const Sint32 *src, const int num, const SDL_bool swap)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioS32x4 ints = VSWAP32_IF(swap, SDL_AudioS32x4, *(const SDL_AudioS32x4_u *) (src + i));
+        *(SDL_AudioF32x4_u *) (dst + i) = __builtin_convertvector(ints >> 8, SDL_AudioF32x4) * DIVBY8388607;
+    }
+
+    for (; i < num; i++) {
+        dst[i] = ((float) ((swap ? (Sint32) SDL_Swap32((Uint32) src[i]) : src[i]) >> 8)) * DIVBY8388607;
+    }
+}
+
+/* Converts (samples * scale) + bias to ints, where samples >= 1.0f become maxval
+   and samples <= -1.0f become minval, just like the scalar converters. Anything
+   out of range is zeroed before the conversion so it can't overflow. */
+static SDL_INLINE SDL_AudioS32x4
+SDL_ClampedFloatsToInts_Vector(const SDL_AudioF32x4 samples, const float scale, const float bias, const Sint32 minval, const Sint32 maxval)
+{
+    const SDL_AudioS32x4 toobig = (samples >= 1.0f);
+    const SDL_AudioS32x4 toosmall = (samples <= -1.0f);
+    const SDL_AudioS32x4 inrange = ~(toobig | toosmall);
+    const SDL_AudioF32x4 clamped = (SDL_AudioF32x4) ((SDL_AudioS32x4) samples & inrange);
+    const SDL_AudioS32x4 ints = __builtin_convertvector((clamped + bias) * scale, SDL_AudioS32x4);
+    return (ints & inrange) | (toobig & maxval) | (toosmall & minval);
+}
+
+static SDL_INLINE void
+SDL_ConvertF32ToS8_Vector(Sint8 *dst, const float *src, const int num)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioS32x4 ints = SDL_ClampedFloatsToInts_Vector(*(const SDL_AudioF32x4_u *) (src + i), 127.0f, 0.0f, -128, 127);
+        *(SDL_AudioS8x4_u *) (dst + i) = __builtin_convertvector(ints, SDL_AudioS8x4_u);
+    }
+
+    for (; i < num; i++) {
+        const float sample = src[i];
+        if (sample >= 1.0f) {
+            dst[i] = 127;
+        } else if (sample <= -1.0f) {
+            dst[i] = -128;
+        } else {
+            dst[i] = (Sint8)(sample * 127.0f);
+        }
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertF32ToU8_Vector(Uint8 *dst, const float *src, const int num)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioS32x4 ints = SDL_ClampedFloatsToInts_Vector(*(const SDL_AudioF32x4_u *) (src + i), 127.0f, 1.0f, 0, 255);
+        *(SDL_AudioU8x4_u *) (dst + i) = __builtin_convertvector(ints, SDL_AudioU8x4_u);
+    }
+
+    for (; i < num; i++) {
+        const float sample = src[i];
+        if (sample >= 1.0f) {
+            dst[i] = 255;
+        } else if (sample <= -1.0f) {
+            dst[i] = 0;
+        } else {
+            dst[i] = (Uint8)((sample + 1.0f) * 127.0f);
+        }
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertF32ToS16_Vector(Sint16 *dst, const float *src, const int num, const SDL_bool swap)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioS32x4 ints = SDL_ClampedFloatsToInts_Vector(*(const SDL_AudioF32x4_u *) (src + i), 32767.0f, 0.0f, -32768, 32767);
+        const SDL_AudioS16x4_u shorts = __builtin_convertvector(ints, SDL_AudioS16x4_u);
+        *(SDL_AudioS16x4_u *) (dst + i) = VSWAP16_IF(swap, SDL_AudioS16x4_u, shorts);
+    }
+
+    for (; i < num; i++) {
+        const float sample = src[i];
+        Sint16 val;
+        if (sample >= 1.0f) {
+            val = 32767;
+        } else if (sample <= -1.0f) {
+            val = -32768;
+        } else {
+            val = (Sint16)(sample * 32767.0f);
+        }
+        dst[i] = swap ? (Sint16) SDL_Swap16((Uint16) val) : val;
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertF32ToU16_Vector(Uint16 *dst, const float *src, const int num, const SDL_bool swap)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioS32x4 ints = SDL_ClampedFloatsToInts_Vector(*(const SDL_AudioF32x4_u *) (src + i), 32767.0f, 1.0f, 0, 65535);
+        const SDL_AudioU16x4_u shorts = __builtin_convertvector(ints, SDL_AudioU16x4_u);
+        *(SDL_AudioU16x4_u *) (dst + i) = VSWAP16_IF(swap, SDL_AudioU16x4_u, shorts);
+    }
+
+    for (; i < num; i++) {
+        const float sample = src[i];
+        Uint16 val;
+        if (sample >= 1.0f) {
+            val = 65535;
+        } else if (sample <= -1.0f) {
+            val = 0;
+        } else {
+            val = (Uint16)((sample + 1.0f) * 32767.0f);
+        }
+        dst[i] = swap ? SDL_Swap16(val) : val;
+    }
+}
+
+static SDL_INLINE void
+SDL_ConvertF32ToS32_Vector(Sint32 *dst, const float *src, const int num, const SDL_bool swap)
+{
+    int i;
+
+    for (i = 0; (i + 4) <= num; i += 4) {
+        const SDL_AudioF32x4 samples = *(const SDL_AudioF32x4_u *) (src + i);
+        const SDL_AudioS32x4 toobig = (samples >= 1.0f);
+        const SDL_AudioS32x4 toosmall = (samples <= -1.0f);
+        const SDL_AudioS32x4 inrange = ~(toobig | toosmall);
+        const SDL_AudioF32x4 clamped = (SDL_AudioF32x4) ((SDL_AudioS32x4) samples & inrange);
+        SDL_AudioS32x4 ints = __builtin_convertvector(clamped * 8388607.0f, SDL_AudioS32x4);
+        ints = (SDL_AudioS32x4) ((SDL_AudioU32x4) ints << 8);
+        ints = (ints & inrange) | (toobig & 2147483647) | (toosmall & (Sint32) 0x80000000);
+        *(SDL_AudioS32x4_u *) (dst + i) = VSWAP32_IF(swap, SDL_AudioS32x4, ints);
+    }
+
+    for (; i < num; i++) {
+        const float sample = src[i];
+        Sint32 val;
+        if (sample >= 1.0f) {
+            val = 2147483647;
+        } else if (sample <= -1.0f) {
+            val = (Sint32) -2147483648LL;
+        } else {
+            val = (Sint32) (((Uint32) (Sint32) (sample * 8388607.0f)) << 8);
+        }
+        dst[i] = swap ? (Sint32) SDL_Swap32((Uint32) val) : val;
+    }
+}
+
+#undef VSWAP16_IF
+#undef VSWAP32_IF
+
+static void SDLCALL
+SDL_Convert_S8_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_S8", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertS8ToF32_Vector((float *) cvt->buf, (const Sint8 *) cvt->buf, cvt->len_cvt);
+
+    cvt->len_cvt *= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_U8_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_U8", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertU8ToF32_Vector((float *) cvt->buf, (const Uint8 *) cvt->buf, cvt->len_cvt);
+
+    cvt->len_cvt *= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_S16_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_S16", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertS16ToF32_Vector((float *) cvt->buf, (const Sint16 *) cvt->buf, cvt->len_cvt / sizeof (Sint16), SDL_FALSE);
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_U16_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_U16", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertU16ToF32_Vector((float *) cvt->buf, (const Uint16 *) cvt->buf, cvt->len_cvt / sizeof (Uint16), SDL_FALSE);
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_S32_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_S32", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertS32ToF32_Vector((float *) cvt->buf, (const Sint32 *) cvt->buf, cvt->len_cvt / sizeof (Sint32), SDL_FALSE);
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S8_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S8 (using vector extensions)");
+
+    SDL_ConvertF32ToS8_Vector((Sint8 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float));
+
+    cvt->len_cvt /= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S8);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_U8_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_U8 (using vector extensions)");
+
+    SDL_ConvertF32ToU8_Vector((Uint8 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float));
+
+    cvt->len_cvt /= 4;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_U8);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S16_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S16 (using vector extensions)");
+
+    SDL_ConvertF32ToS16_Vector((Sint16 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_FALSE);
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S16SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_U16_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_U16 (using vector extensions)");
+
+    SDL_ConvertF32ToU16_Vector((Uint16 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_FALSE);
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_U16SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "AUDIO_S32 (using vector extensions)");
+
+    SDL_ConvertF32ToS32_Vector((Sint32 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_FALSE);
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S32SYS);
+    }
+}
+
+/* Foreign byte order in or out. These are used no matter which SIMD set got
+   picked for the native converters, since they'd otherwise need a second pass. */
+static void SDLCALL
+SDL_Convert_S16_Swapped_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("byteswapped AUDIO_S16", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertS16ToF32_Vector((float *) cvt->buf, (const Sint16 *) cvt->buf, cvt->len_cvt / sizeof (Sint16), SDL_TRUE);
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_U16_Swapped_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("byteswapped AUDIO_U16", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertU16ToF32_Vector((float *) cvt->buf, (const Uint16 *) cvt->buf, cvt->len_cvt / sizeof (Uint16), SDL_TRUE);
+
+    cvt->len_cvt *= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_S32_Swapped_to_F32_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("byteswapped AUDIO_S32", "AUDIO_F32 (using vector extensions)");
+
+    SDL_ConvertS32ToF32_Vector((float *) cvt->buf, (const Sint32 *) cvt->buf, cvt->len_cvt / sizeof (Sint32), SDL_TRUE);
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_F32SYS);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S16_Swapped_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "byteswapped AUDIO_S16 (using vector extensions)");
+
+    SDL_ConvertF32ToS16_Vector((Sint16 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_TRUE);
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_U16_Swapped_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "byteswapped AUDIO_U16 (using vector extensions)");
+
+    SDL_ConvertF32ToU16_Vector((Uint16 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_TRUE);
+
+    cvt->len_cvt /= 2;
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_U16SYS ^ SDL_AUDIO_MASK_ENDIAN);
+    }
+}
+
+static void SDLCALL
+SDL_Convert_F32_to_S32_Swapped_Vector(SDL_AudioCVT *cvt, SDL_AudioFormat format)
+{
+    LOG_DEBUG_CONVERT("AUDIO_F32", "byteswapped AUDIO_S32 (using vector extensions)");
+
+    SDL_ConvertF32ToS32_Vector((Sint32 *) cvt->buf, (const float *) cvt->buf, cvt->len_cvt / sizeof (float), SDL_TRUE);
+
+    if (cvt->filters[++cvt->filter_index]) {
+        cvt->filters[cvt->filter_index](cvt, AUDIO_S32SYS ^ SDL_AUDIO_MASK_ENDIAN);
+    }
+}
+#endif
+
 
 void SDL_ChooseAudioConverters(void)
 {
@@ -1404,6 +1872,15 @@ void SDL_ChooseAudioConverters(void)
         SDL_Convert_F32_to_S32 = SDL_Convert_F32_to_S32_##fntype; \
         converters_chosen = SDL_TRUE
 
+#if HAVE_VECTOR_EXTENSIONS
+    SDL_Convert_S16_Swapped_to_F32 = SDL_Convert_S16_Swapped_to_F32_Vector;
+    SDL_Convert_U16_Swapped_to_F32 = SDL_Convert_U16_Swapped_to_F32_Vector;
+    SDL_Convert_S32_Swapped_to_F32 = SDL_Convert_S32_Swapped_to_F32_Vector;
+    SDL_Convert_F32_to_S16_Swapped = SDL_Convert_F32_to_S16_Swapped_Vector;
+    SDL_Convert_F32_to_U16_Swapped = SDL_Convert_F32_to_U16_Swapped_Vector;
+    SDL_Convert_F32_to_S32_Swapped = SDL_Convert_F32_to_S32_Swapped_Vector;
+#endif
+
 #if HAVE_SSE2_INTRINSICS
     if (SDL_HasSSE2()) {
         SET_CONVERTER_FUNCS(SSE2);
@@ -1418,6 +1895,11 @@ void SDL_ChooseAudioConverters(void)
     }
 #endif
 
+#if HAVE_VECTOR_EXTENSIONS
+    SET_CONVERTER_FUNCS(Vector);
+    return;
+#endif
+
 #if NEED_SCALAR_CONVERTER_FALLBACKS
     SET_CONVERTER_FUNCS(Scalar);
 #endif
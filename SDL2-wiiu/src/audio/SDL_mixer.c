@@ -26,6 +26,7 @@
 #include "SDL_timer.h"
 #include "SDL_audio.h"
 #include "SDL_sysaudio.h"
+#include "SDL_audio_c.h"
 
 /* This table is used to add two sound values together and pin
  * the value to avoid overflow.  (used with permission from ARDI)
@@ -85,6 +86,147 @@ static const Uint8 mix8[] = {
 #define ADJUST_VOLUME(s, v) (s = (s*v)/SDL_MIX_MAXVOLUME)
 #define ADJUST_VOLUME_U8(s, v)  (s = (((s-128)*v)/SDL_MIX_MAXVOLUME)+128)
 
+#if HAVE_VECTOR_EXTENSIONS
+/* Vector versions of the S16, S32 and F32 mixers, in native or swapped byte
+   order. They give exactly the same results as the scalar code below: the
+   volume is applied without widening by splitting off the low 7 bits (so
+   nothing overflows and it still rounds toward zero), and the sum saturates
+   by checking the sign bits instead of going through a wider type. */
+
+static Uint32
+SDL_MixS16_Vector(Sint16 *dst, const Sint16 *src, const Uint32 samples, const int volume, const SDL_bool swap)
+{
+    const Sint16 vol = (Sint16) volume;
+    Uint32 i;
+
+    for (i = 0; (i + 8) <= samples; i += 8) {
+        SDL_AudioS16x8 s = *(const SDL_AudioS16x8_u *) (src + i);
+        SDL_AudioS16x8 d = *(const SDL_AudioS16x8_u *) (dst + i);
+        SDL_AudioS16x8 sum, overflow;
+
+        if (swap) {
+            s = (SDL_AudioS16x8) SDL_AUDIO_VSWAP16((SDL_AudioU16x8) s);
+            d = (SDL_AudioS16x8) SDL_AUDIO_VSWAP16((SDL_AudioU16x8) d);
+        }
+
+        if (vol != SDL_MIX_MAXVOLUME) {
+            const SDL_AudioS16x8 low = (s & 127) * vol;
+            s = ((s >> 7) * vol) + (low >> 7) - ((s < 0) & ((low & 127) != 0));
+        }
+
+        sum = (SDL_AudioS16x8) ((SDL_AudioU16x8) s + (SDL_AudioU16x8) d);
+        overflow = (~(s ^ d) & (s ^ sum)) >> 15;
+        sum = (sum & ~overflow) | (((s >> 15) ^ 0x7FFF) & overflow);
+
+        if (swap) {
+            sum = (SDL_AudioS16x8) SDL_AUDIO_VSWAP16((SDL_AudioU16x8) sum);
+        }
+        *(SDL_AudioS16x8_u *) (dst + i) = sum;
+    }
+
+    return i;
+}
+
+static Uint32
+SDL_MixS32_Vector(Sint32 *dst, const Sint32 *src, const Uint32 samples, const int volume, const SDL_bool swap)
+{
+    Uint32 i;
+
+    for (i = 0; (i + 4) <= samples; i += 4) {
+        SDL_AudioS32x4 s = *(const SDL_AudioS32x4_u *) (src + i);
+        SDL_AudioS32x4 d = *(const SDL_AudioS32x4_u *) (dst + i);
+        SDL_AudioS32x4 sum, overflow;
+
+        if (swap) {
+            s = (SDL_AudioS32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) s);
+            d = (SDL_AudioS32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) d);
+        }
+
+        if (volume != SDL_MIX_MAXVOLUME) {
+            const SDL_AudioS32x4 low = (s & 127) * volume;
+            s = ((s >> 7) * volume) + (low >> 7) - ((s < 0) & ((low & 127) != 0));
+        }
+
+        sum = (SDL_AudioS32x4) ((SDL_AudioU32x4) s + (SDL_AudioU32x4) d);
+        overflow = (~(s ^ d) & (s ^ sum)) >> 31;
+        sum = (sum & ~overflow) | (((s >> 31) ^ 0x7FFFFFFF) & overflow);
+
+        if (swap) {
+            sum = (SDL_AudioS32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) sum);
+        }
+        *(SDL_AudioS32x4_u *) (dst + i) = sum;
+    }
+
+    return i;
+}
+
+static Uint32
+SDL_MixF32_Vector(float *dst, const float *src, const Uint32 samples, const int volume, const SDL_bool swap)
+{
+    const float fmaxvolume = 1.0f / ((float) SDL_MIX_MAXVOLUME);
+    const float fvolume = (float) volume;
+    const float max_audioval = 3.402823466e+38F;
+    Uint32 i;
+
+    for (i = 0; (i + 4) <= samples; i += 4) {
+        SDL_AudioF32x4 s = *(const SDL_AudioF32x4_u *) (src + i);
+        SDL_AudioF32x4 d = *(const SDL_AudioF32x4_u *) (dst + i);
+        SDL_AudioF32x4 sum;
+        SDL_AudioS32x4 over, under;
+
+        if (swap) {
+            s = (SDL_AudioF32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) s);
+            d = (SDL_AudioF32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) d);
+        }
+
+        if (volume != SDL_MIX_MAXVOLUME) {
+            s = (s * fvolume) * fmaxvolume;
+        }
+
+        /* adding in float rounds the same as adding in double and narrowing. */
+        sum = s + d;
+        over = (sum > max_audioval);
+        under = (sum < -max_audioval);
+        sum = (SDL_AudioF32x4) (((SDL_AudioS32x4) sum & ~(over | under)) |
+                                ((SDL_AudioS32x4) ((SDL_AudioF32x4) { max_audioval, max_audioval, max_audioval, max_audioval }) & over) |
+                                ((SDL_AudioS32x4) ((SDL_AudioF32x4) { -max_audioval, -max_audioval, -max_audioval, -max_audioval }) & under));
+
+        if (swap) {
+            sum = (SDL_AudioF32x4) SDL_AUDIO_VSWAP32((SDL_AudioU32x4) sum);
+        }
+        *(SDL_AudioF32x4_u *) (dst + i) = sum;
+    }
+
+    return i;
+}
+
+/* Mixes as much of the buffer as the vector code can, returns the number of bytes done. */
+static Uint32
+SDL_MixAudioFormat_Vector(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format, Uint32 len, int volume)
+{
+    const SDL_bool swap = (SDL_AUDIO_ISBIGENDIAN(format) != 0) != (SDL_BYTEORDER == SDL_BIG_ENDIAN);
+
+    switch (format) {
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+        return SDL_MixS16_Vector((Sint16 *) dst, (const Sint16 *) src, len / 2, volume, swap) * 2;
+
+    case AUDIO_S32LSB:
+    case AUDIO_S32MSB:
+        return SDL_MixS32_Vector((Sint32 *) dst, (const Sint32 *) src, len / 4, volume, swap) * 4;
+
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        return SDL_MixF32_Vector((float *) dst, (const float *) src, len / 4, volume, swap) * 4;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+#endif /* HAVE_VECTOR_EXTENSIONS */
+
 
 void
 SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
@@ -94,6 +236,16 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
         return;
     }
 
+#if HAVE_VECTOR_EXTENSIONS
+    /* the scalar code below finishes off whatever is left. */
+    if (volume <= SDL_MIX_MAXVOLUME) {
+        const Uint32 done = SDL_MixAudioFormat_Vector(dst, src, format, len, volume);
+        dst += done;
+        src += done;
+        len -= done;
+    }
+#endif
+
     switch (format) {
 
     case AUDIO_U8:
@@ -316,7 +468,10 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
 
             len /= 4;
             while (len--) {
-                src1 = ((SDL_SwapFloatLE(*src32) * fvolume) * fmaxvolume);
+                src1 = SDL_SwapFloatLE(*src32);
+                if (volume != SDL_MIX_MAXVOLUME) {
+                    src1 = ((src1 * fvolume) * fmaxvolume);
+                }
                 src2 = SDL_SwapFloatLE(*dst32);
                 src32++;
 
@@ -345,7 +500,10 @@ SDL_MixAudioFormat(Uint8 * dst, const Uint8 * src, SDL_AudioFormat format,
 
             len /= 4;
             while (len--) {
-                src1 = ((SDL_SwapFloatBE(*src32) * fvolume) * fmaxvolume);
+                src1 = SDL_SwapFloatBE(*src32);
+                if (volume != SDL_MIX_MAXVOLUME) {
+                    src1 = ((src1 * fvolume) * fmaxvolume);
+                }
                 src2 = SDL_SwapFloatBE(*dst32);
                 src32++;
 
@@ -161,8 +161,18 @@ struct SDL_AudioDevice
     SDL_Thread *thread;
     SDL_threadID threadid;
 
-    /* Queued buffers (if app not using callback). */
-    SDL_DataQueue *buffer_queue;
+    /* Queued buffers (if app not using callback). Lock-free between the
+       app and the audio thread; buffer_queue_lock only serializes app threads. */
+    SDL_RingQueue *buffer_queue;
+    SDL_mutex *buffer_queue_lock;
+
+    /* Audio thread statistics, if SDL_HINT_AUDIO_DEVICE_STATS was set when
+       the device was opened. The thread updates them under stats_lock. */
+    SDL_bool stats_enabled;
+    Uint32 stats_log_interval;  /* ms between SDL_Log() lines, 0 for none. */
+    Uint32 stats_logged;        /* SDL_GetTicks() at the last line. */
+    SDL_SpinLock stats_lock;
+    SDL_AudioDeviceStats stats;
 
     /* * * */
     /* Data private to this driver */
@@ -26,7 +26,11 @@
 #include "SDL_wave.h"
 
 
-static int ReadChunk(SDL_RWops * src, Chunk * chunk);
+/* PCM files are read this many sample frames at a time when they need
+   converting or are going into an audio stream. */
+#define WAV_SCRATCH_FRAMES 1024
+
+#define WAV_NO_POSITION 0xFFFFFFFF
 
 struct MS_ADPCM_decodestate
 {
@@ -35,49 +39,71 @@ struct MS_ADPCM_decodestate
     Sint16 iSamp1;
     Sint16 iSamp2;
 };
-static struct MS_ADPCM_decoder
+
+struct IMA_ADPCM_decodestate
+{
+    Sint32 sample;
+    Sint8 index;
+};
+
+struct _SDL_WAVDecoder
 {
-    WaveFMT wavefmt;
-    Uint16 wSamplesPerBlock;
-    Uint16 wNumCoef;
-    Sint16 aCoeff[7][2];
-    /* * * */
-    struct MS_ADPCM_decodestate state[2];
-} MS_ADPCM_state;
+    SDL_RWops *src;
+    int freesrc;
+
+    /* what's in the file. */
+    Uint16 encoding;            /* PCM_CODE, IEEE_FLOAT_CODE, MS_ADPCM_CODE or IMA_ADPCM_CODE */
+    Uint16 channels;
+    Uint16 blockalign;
+    Uint16 bitspersample;
+    Uint16 wSamplesPerBlock;    /* ADPCM only. */
+    Sint16 aCoeff[7][2];        /* MS ADPCM only. */
+    Sint64 riff_end;            /* where SDL_LoadWAV_RW() leaves the file. */
+    Sint64 data_start;
+    Uint32 data_length;
+
+    /* what we decode it to. */
+    int frame_size;             /* bytes per decoded sample frame. */
+    int file_frame_size;        /* bytes per sample frame in the file, PCM only. */
+    Uint32 total_frames;
+    Uint32 position;            /* the next frame we hand out. */
+
+    /* where src is: a frame for PCM, a block for ADPCM. WAV_NO_POSITION if unknown. */
+    Uint32 file_position;
+
+    Uint8 *encoded;             /* one ADPCM block as it is in the file. */
+    Uint8 *decoded;             /* that block decoded, or PCM scratch space. */
+    Uint32 decoded_block;       /* WAV_NO_POSITION if nothing's been decoded. */
+};
 
 static int
-InitMS_ADPCM(WaveFMT * format)
+InitMS_ADPCM(SDL_WAVDecoder * decoder, const Uint8 * rogue_feel, const Uint32 extra_len)
 {
-    Uint8 *rogue_feel;
     int i;
 
-    /* Set the rogue pointer to the MS_ADPCM specific data */
-    MS_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    MS_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    MS_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    MS_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    MS_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    MS_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
-    rogue_feel = (Uint8 *) format + sizeof(*format);
-    if (sizeof(*format) == 16) {
-        /* const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]); */
-        rogue_feel += sizeof(Uint16);
+    /* the extra fmt bytes: cbSize, wSamplesPerBlock, wNumCoef, then the coefficients. */
+    if (extra_len < (3 + 7 * 2) * sizeof (Uint16)) {
+        return SDL_SetError("Invalid MS ADPCM format chunk length");
     }
-    MS_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    MS_ADPCM_state.wNumCoef = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     rogue_feel += sizeof(Uint16);
-    if (MS_ADPCM_state.wNumCoef != 7) {
-        SDL_SetError("Unknown set of MS_ADPCM coefficients");
-        return (-1);
+    if (((rogue_feel[1] << 8) | rogue_feel[0]) != 7) {
+        return SDL_SetError("Unknown set of MS_ADPCM coefficients");
     }
-    for (i = 0; i < MS_ADPCM_state.wNumCoef; ++i) {
-        MS_ADPCM_state.aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+    rogue_feel += sizeof(Uint16);
+    for (i = 0; i < 7; ++i) {
+        decoder->aCoeff[i][0] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
-        MS_ADPCM_state.aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
+        decoder->aCoeff[i][1] = ((rogue_feel[1] << 8) | rogue_feel[0]);
         rogue_feel += sizeof(Uint16);
     }
+    if (decoder->channels > 2) {
+        return SDL_SetError("MS ADPCM decoder can only handle 2 channels");
+    }
+    if (decoder->wSamplesPerBlock < 2) {
+        return SDL_SetError("Invalid MS ADPCM block size");
+    }
     return (0);
 }
 
@@ -115,138 +141,124 @@ MS_ADPCM_nibble(struct MS_ADPCM_decodestate *state,
     return (new_sample);
 }
 
+/* Bytes of one MS ADPCM block we actually look at, and samples we write for it. */
+static Uint32
+MS_ADPCM_encoded_size(const SDL_WAVDecoder * decoder)
+{
+    return (7 * decoder->channels) + ((((decoder->wSamplesPerBlock - 2) * decoder->channels) + 1) / 2);
+}
+
+static Uint32
+MS_ADPCM_decoded_samples(const SDL_WAVDecoder * decoder)
+{
+    return (decoder->wSamplesPerBlock * decoder->channels) + 1;
+}
+
 static int
-MS_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+MS_ADPCM_decode(SDL_WAVDecoder * decoder)
 {
+    struct MS_ADPCM_decodestate states[2];
     struct MS_ADPCM_decodestate *state[2];
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    const Uint8 *encoded = decoder->encoded;
+    Uint8 *decoded = decoder->decoded;
+    Sint32 samplesleft;
     Sint8 nybble;
     Uint8 stereo;
     Sint16 *coeff[2];
     Sint32 new_sample;
 
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / MS_ADPCM_state.wavefmt.blockalign) *
-        MS_ADPCM_state.wSamplesPerBlock *
-        MS_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        return SDL_OutOfMemory();
-    }
-    decoded = *audio_buf;
-
     /* Get ready... Go! */
-    stereo = (MS_ADPCM_state.wavefmt.channels == 2);
-    state[0] = &MS_ADPCM_state.state[0];
-    state[1] = &MS_ADPCM_state.state[stereo];
-    while (encoded_len >= MS_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        state[0]->hPredictor = *encoded++;
-        if (stereo) {
-            state[1]->hPredictor = *encoded++;
-        }
-        state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    stereo = (decoder->channels == 2);
+    state[0] = &states[0];
+    state[1] = &states[stereo];
+
+    /* Grab the initial information for this block */
+    state[0]->hPredictor = *encoded++;
+    if (stereo) {
+        state[1]->hPredictor = *encoded++;
+    }
+    state[0]->iDelta = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iDelta = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp1 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    }
+    state[0]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
+    encoded += sizeof(Sint16);
+    if (stereo) {
+        state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
         encoded += sizeof(Sint16);
-        if (stereo) {
-            state[1]->iSamp2 = ((encoded[1] << 8) | encoded[0]);
-            encoded += sizeof(Sint16);
-        }
-        coeff[0] = MS_ADPCM_state.aCoeff[state[0]->hPredictor];
-        coeff[1] = MS_ADPCM_state.aCoeff[state[1]->hPredictor];
+    }
+    if ((state[0]->hPredictor >= 7) || (state[1]->hPredictor >= 7)) {
+        return SDL_SetError("Invalid MS ADPCM predictor");
+    }
+    coeff[0] = decoder->aCoeff[state[0]->hPredictor];
+    coeff[1] = decoder->aCoeff[state[1]->hPredictor];
+
+    /* Store the two initial samples we start with */
+    decoded[0] = state[0]->iSamp2 & 0xFF;
+    decoded[1] = state[0]->iSamp2 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp2 & 0xFF;
+        decoded[1] = state[1]->iSamp2 >> 8;
+        decoded += 2;
+    }
+    decoded[0] = state[0]->iSamp1 & 0xFF;
+    decoded[1] = state[0]->iSamp1 >> 8;
+    decoded += 2;
+    if (stereo) {
+        decoded[0] = state[1]->iSamp1 & 0xFF;
+        decoded[1] = state[1]->iSamp1 >> 8;
+        decoded += 2;
+    }
 
-        /* Store the two initial samples we start with */
-        decoded[0] = state[0]->iSamp2 & 0xFF;
-        decoded[1] = state[0]->iSamp2 >> 8;
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 2) * decoder->channels;
+    while (samplesleft > 0) {
+        nybble = (*encoded) >> 4;
+        new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp2 & 0xFF;
-            decoded[1] = state[1]->iSamp2 >> 8;
-            decoded += 2;
-        }
-        decoded[0] = state[0]->iSamp1 & 0xFF;
-        decoded[1] = state[0]->iSamp1 >> 8;
+
+        nybble = (*encoded) & 0x0F;
+        new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
+        decoded[0] = new_sample & 0xFF;
+        new_sample >>= 8;
+        decoded[1] = new_sample & 0xFF;
         decoded += 2;
-        if (stereo) {
-            decoded[0] = state[1]->iSamp1 & 0xFF;
-            decoded[1] = state[1]->iSamp1 >> 8;
-            decoded += 2;
-        }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (MS_ADPCM_state.wSamplesPerBlock - 2) *
-            MS_ADPCM_state.wavefmt.channels;
-        while (samplesleft > 0) {
-            nybble = (*encoded) >> 4;
-            new_sample = MS_ADPCM_nibble(state[0], nybble, coeff[0]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
-
-            nybble = (*encoded) & 0x0F;
-            new_sample = MS_ADPCM_nibble(state[1], nybble, coeff[1]);
-            decoded[0] = new_sample & 0xFF;
-            new_sample >>= 8;
-            decoded[1] = new_sample & 0xFF;
-            decoded += 2;
-
-            ++encoded;
-            samplesleft -= 2;
-        }
-        encoded_len -= MS_ADPCM_state.wavefmt.blockalign;
+        ++encoded;
+        samplesleft -= 2;
     }
-    SDL_free(freeable);
     return (0);
 }
 
-struct IMA_ADPCM_decodestate
-{
-    Sint32 sample;
-    Sint8 index;
-};
-static struct IMA_ADPCM_decoder
-{
-    WaveFMT wavefmt;
-    Uint16 wSamplesPerBlock;
-    /* * * */
-    struct IMA_ADPCM_decodestate state[2];
-} IMA_ADPCM_state;
-
 static int
-InitIMA_ADPCM(WaveFMT * format)
+InitIMA_ADPCM(SDL_WAVDecoder * decoder, const Uint8 * rogue_feel, const Uint32 extra_len)
 {
-    Uint8 *rogue_feel;
-
-    /* Set the rogue pointer to the IMA_ADPCM specific data */
-    IMA_ADPCM_state.wavefmt.encoding = SDL_SwapLE16(format->encoding);
-    IMA_ADPCM_state.wavefmt.channels = SDL_SwapLE16(format->channels);
-    IMA_ADPCM_state.wavefmt.frequency = SDL_SwapLE32(format->frequency);
-    IMA_ADPCM_state.wavefmt.byterate = SDL_SwapLE32(format->byterate);
-    IMA_ADPCM_state.wavefmt.blockalign = SDL_SwapLE16(format->blockalign);
-    IMA_ADPCM_state.wavefmt.bitspersample =
-        SDL_SwapLE16(format->bitspersample);
-    rogue_feel = (Uint8 *) format + sizeof(*format);
-    if (sizeof(*format) == 16) {
-        /* const Uint16 extra_info = ((rogue_feel[1] << 8) | rogue_feel[0]); */
-        rogue_feel += sizeof(Uint16);
+    /* the extra fmt bytes: cbSize, then wSamplesPerBlock. */
+    if (extra_len < 2 * sizeof (Uint16)) {
+        return SDL_SetError("Invalid IMA ADPCM format chunk length");
+    }
+    rogue_feel += sizeof(Uint16);
+    decoder->wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
+
+    /* Check to make sure we have enough variables in the state array */
+    if (decoder->channels > 2) {
+        return SDL_SetError("IMA ADPCM decoder can only handle %u channels", 2);
+    }
+    if (decoder->wSamplesPerBlock < 1) {
+        return SDL_SetError("Invalid IMA ADPCM block size");
     }
-    IMA_ADPCM_state.wSamplesPerBlock = ((rogue_feel[1] << 8) | rogue_feel[0]);
     return (0);
 }
 
@@ -306,7 +318,7 @@ IMA_ADPCM_nibble(struct IMA_ADPCM_decodestate *state, Uint8 nybble)
 
 /* Fill the decode buffer with a channel block of data (8 samples) */
 static void
-Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
+Fill_IMA_ADPCM_block(Uint8 * decoded, const Uint8 * encoded,
                      int channel, int numchannels,
                      struct IMA_ADPCM_decodestate *state)
 {
@@ -334,98 +346,76 @@ Fill_IMA_ADPCM_block(Uint8 * decoded, Uint8 * encoded,
     }
 }
 
+/* IMA ADPCM decodes in runs of 8 samples per channel, so a block that isn't
+   1 + (a multiple of 8) samples long reads and writes a little past its end. */
+static Uint32
+IMA_ADPCM_encoded_size(const SDL_WAVDecoder * decoder)
+{
+    return 4 * decoder->channels * (1 + ((decoder->wSamplesPerBlock + 6) / 8));
+}
+
+static Uint32
+IMA_ADPCM_decoded_samples(const SDL_WAVDecoder * decoder)
+{
+    return decoder->channels * (1 + (((decoder->wSamplesPerBlock + 6) / 8) * 8));
+}
+
 static int
-IMA_ADPCM_decode(Uint8 ** audio_buf, Uint32 * audio_len)
+IMA_ADPCM_decode(SDL_WAVDecoder * decoder)
 {
-    struct IMA_ADPCM_decodestate *state;
-    Uint8 *freeable, *encoded, *decoded;
-    Sint32 encoded_len, samplesleft;
+    struct IMA_ADPCM_decodestate state[2];
+    const Uint8 *encoded = decoder->encoded;
+    Uint8 *decoded = decoder->decoded;
+    Sint32 samplesleft;
     unsigned int c, channels;
 
-    /* Check to make sure we have enough variables in the state array */
-    channels = IMA_ADPCM_state.wavefmt.channels;
-    if (channels > SDL_arraysize(IMA_ADPCM_state.state)) {
-        SDL_SetError("IMA ADPCM decoder can only handle %u channels",
-                     (unsigned int)SDL_arraysize(IMA_ADPCM_state.state));
-        return (-1);
-    }
-    state = IMA_ADPCM_state.state;
-
-    /* Allocate the proper sized output buffer */
-    encoded_len = *audio_len;
-    encoded = *audio_buf;
-    freeable = *audio_buf;
-    *audio_len = (encoded_len / IMA_ADPCM_state.wavefmt.blockalign) *
-        IMA_ADPCM_state.wSamplesPerBlock *
-        IMA_ADPCM_state.wavefmt.channels * sizeof(Sint16);
-    *audio_buf = (Uint8 *) SDL_malloc(*audio_len);
-    if (*audio_buf == NULL) {
-        return SDL_OutOfMemory();
-    }
-    decoded = *audio_buf;
-
-    /* Get ready... Go! */
-    while (encoded_len >= IMA_ADPCM_state.wavefmt.blockalign) {
-        /* Grab the initial information for this block */
-        for (c = 0; c < channels; ++c) {
-            /* Fill the state information for this block */
-            state[c].sample = ((encoded[1] << 8) | encoded[0]);
-            encoded += 2;
-            if (state[c].sample & 0x8000) {
-                state[c].sample -= 0x10000;
-            }
-            state[c].index = *encoded++;
-            /* Reserved byte in buffer header, should be 0 */
-            if (*encoded++ != 0) {
-                /* Uh oh, corrupt data?  Buggy code? */ ;
-            }
+    channels = decoder->channels;
 
-            /* Store the initial sample we start with */
-            decoded[0] = (Uint8) (state[c].sample & 0xFF);
-            decoded[1] = (Uint8) (state[c].sample >> 8);
-            decoded += 2;
+    /* Grab the initial information for this block */
+    for (c = 0; c < channels; ++c) {
+        /* Fill the state information for this block */
+        state[c].sample = ((encoded[1] << 8) | encoded[0]);
+        encoded += 2;
+        if (state[c].sample & 0x8000) {
+            state[c].sample -= 0x10000;
+        }
+        state[c].index = *encoded++;
+        /* Reserved byte in buffer header, should be 0 */
+        if (*encoded++ != 0) {
+            /* Uh oh, corrupt data?  Buggy code? */ ;
         }
 
-        /* Decode and store the other samples in this block */
-        samplesleft = (IMA_ADPCM_state.wSamplesPerBlock - 1) * channels;
-        while (samplesleft > 0) {
-            for (c = 0; c < channels; ++c) {
-                Fill_IMA_ADPCM_block(decoded, encoded,
-                                     c, channels, &state[c]);
-                encoded += 4;
-                samplesleft -= 8;
-            }
-            decoded += (channels * 8 * 2);
+        /* Store the initial sample we start with */
+        decoded[0] = (Uint8) (state[c].sample & 0xFF);
+        decoded[1] = (Uint8) (state[c].sample >> 8);
+        decoded += 2;
+    }
+
+    /* Decode and store the other samples in this block */
+    samplesleft = (decoder->wSamplesPerBlock - 1) * channels;
+    while (samplesleft > 0) {
+        for (c = 0; c < channels; ++c) {
+            Fill_IMA_ADPCM_block(decoded, encoded,
+                                 c, channels, &state[c]);
+            encoded += 4;
+            samplesleft -= 8;
         }
-        encoded_len -= IMA_ADPCM_state.wavefmt.blockalign;
+        decoded += (channels * 8 * 2);
     }
-    SDL_free(freeable);
     return (0);
 }
 
 
-static int
-ConvertSint24ToSint32(Uint8 ** audio_buf, Uint32 * audio_len)
+/* Expands packed 24-bit samples to 32 bits. Works from end to start, so it
+   can be done in place. */
+static void
+ConvertSint24ToSint32(Uint8 * buf, const Uint32 samples)
 {
     const double DIVBY8388608 = 0.00000011920928955078125;
-    const Uint32 original_len = *audio_len;
-    const Uint32 samples = original_len / 3;
-    const Uint32 expanded_len = samples * sizeof (Uint32);
-    Uint8 *ptr = (Uint8 *) SDL_realloc(*audio_buf, expanded_len);
-    const Uint8 *src;
-    Uint32 *dst;
+    const Uint8 *src = (buf + (samples * 3)) - 3;
+    Uint32 *dst = ((Uint32 *) (buf + (samples * sizeof (Uint32)))) - 1;
     Uint32 i;
 
-    if (!ptr) {
-        return SDL_OutOfMemory();
-    }
-
-    *audio_buf = ptr;
-    *audio_len = expanded_len;
-
-    /* work from end to start, since we're expanding in-place. */
-    src = (ptr + original_len) - 3;
-    dst = ((Uint32 *) (ptr + expanded_len)) - 1;
     for (i = 0; i < samples; i++) {
         /* There's probably a faster way to do all this. */
         const Sint32 converted = ((Sint32) ( (((Uint32) src[2]) << 24) |
@@ -435,148 +425,87 @@ ConvertSint24ToSint32(Uint8 ** audio_buf, Uint32 * audio_len)
         src -= 3;
         *(dst--) = (Sint32) (scaled * 2147483647.0);
     }
-
-    return 0;
 }
 
 
-/* GUIDs that are used by WAVE_FORMAT_EXTENSIBLE */
-static const Uint8 extensible_pcm_guid[16] = { 1, 0, 0, 0, 0, 0, 16, 0, 128, 0, 0, 170, 0, 56, 155, 113 };
+/* The WAVE_FORMAT_EXTENSIBLE subformat GUID for float data, anything else is read as PCM */
 static const Uint8 extensible_ieee_guid[16] = { 3, 0, 0, 0, 0, 0, 16, 0, 128, 0, 0, 170, 0, 56, 155, 113 };
 
-SDL_AudioSpec *
-SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
-               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+static int
+SkipChunk(SDL_RWops * src, const Uint32 length)
 {
-    int was_error;
-    Chunk chunk;
-    int lenread;
-    int IEEE_float_encoded, MS_ADPCM_encoded, IMA_ADPCM_encoded;
-    int samplesize;
-
-    /* WAV magic header */
-    Uint32 RIFFchunk;
-    Uint32 wavelen = 0;
-    Uint32 WAVEmagic;
-    Uint32 headerDiff = 0;
-
-    /* FMT chunk */
-    WaveFMT *format = NULL;
-    WaveExtensibleFMT *ext = NULL;
-
-    SDL_zero(chunk);
-
-    /* Make sure we are passed a valid data source */
-    was_error = 0;
-    if (src == NULL) {
-        was_error = 1;
-        goto done;
+    if (SDL_RWseek(src, length, RW_SEEK_CUR) < 0) {
+        return SDL_Error(SDL_EFSEEK);
     }
+    return 0;
+}
 
-    /* Check the magic header */
-    RIFFchunk = SDL_ReadLE32(src);
-    wavelen = SDL_ReadLE32(src);
-    if (wavelen == WAVE) {      /* The RIFFchunk has already been read */
-        WAVEmagic = wavelen;
-        wavelen = RIFFchunk;
-        RIFFchunk = RIFF;
-    } else {
-        WAVEmagic = SDL_ReadLE32(src);
-    }
-    if ((RIFFchunk != RIFF) || (WAVEmagic != WAVE)) {
-        SDL_SetError("Unrecognized file type (not WAVE)");
-        was_error = 1;
-        goto done;
-    }
-    headerDiff += sizeof(Uint32);       /* for WAVE */
-
-    /* Read the audio data format chunk */
-    chunk.data = NULL;
-    do {
-        SDL_free(chunk.data);
-        chunk.data = NULL;
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
-        }
-        /* 2 Uint32's for chunk header+len, plus the lenread */
-        headerDiff += lenread + 2 * sizeof(Uint32);
-    } while ((chunk.magic == FACT) || (chunk.magic == LIST) || (chunk.magic == BEXT) || (chunk.magic == JUNK));
-
-    /* Decode the audio data format */
-    format = (WaveFMT *) chunk.data;
-    if (chunk.magic != FMT) {
-        SDL_SetError("Complex WAVE files not supported");
-        was_error = 1;
-        goto done;
-    }
-    IEEE_float_encoded = MS_ADPCM_encoded = IMA_ADPCM_encoded = 0;
-    switch (SDL_SwapLE16(format->encoding)) {
+/* Reads the fmt chunk and fills in the decoder's format and the spec. */
+static int
+ParseFormat(SDL_WAVDecoder * decoder, const Uint8 * data, const Uint32 length, SDL_AudioSpec * spec)
+{
+    const WaveFMT *format = (const WaveFMT *) data;
+    const Uint8 *rogue_feel = data + sizeof(*format);
+    const Uint32 extra_len = length - sizeof(*format);
+    const WaveExtensibleFMT *ext;
+    int was_error = 0;
+
+    decoder->encoding = SDL_SwapLE16(format->encoding);
+    decoder->channels = SDL_SwapLE16(format->channels);
+    decoder->blockalign = SDL_SwapLE16(format->blockalign);
+    decoder->bitspersample = SDL_SwapLE16(format->bitspersample);
+
+    switch (decoder->encoding) {
     case PCM_CODE:
         /* We can understand this */
         break;
     case IEEE_FLOAT_CODE:
-        IEEE_float_encoded = 1;
         /* We can understand this */
         break;
     case MS_ADPCM_CODE:
         /* Try to understand this */
-        if (InitMS_ADPCM(format) < 0) {
-            was_error = 1;
-            goto done;
+        if (InitMS_ADPCM(decoder, rogue_feel, extra_len) < 0) {
+            return -1;
         }
-        MS_ADPCM_encoded = 1;
         break;
     case IMA_ADPCM_CODE:
         /* Try to understand this */
-        if (InitIMA_ADPCM(format) < 0) {
-            was_error = 1;
-            goto done;
+        if (InitIMA_ADPCM(decoder, rogue_feel, extra_len) < 0) {
+            return -1;
         }
-        IMA_ADPCM_encoded = 1;
         break;
     case EXTENSIBLE_CODE:
         /* note that this ignores channel masks, smaller valid bit counts
            inside a larger container, and most subtypes. This is just enough
            to get things that didn't really _need_ WAVE_FORMAT_EXTENSIBLE
            to be useful working when they use this format flag. */
-        ext = (WaveExtensibleFMT *) format;
-        if (SDL_SwapLE16(ext->size) < 22) {
-            SDL_SetError("bogus extended .wav header");
-            was_error = 1;
-            goto done;
+        ext = (const WaveExtensibleFMT *) data;
+        if ((length < sizeof (*ext)) || (SDL_SwapLE16(ext->size) < 22)) {
+            return SDL_SetError("bogus extended .wav header");
         }
-        if (SDL_memcmp(ext->subformat, extensible_pcm_guid, 16) == 0) {
-            break;  /* cool. */
-        } else if (SDL_memcmp(ext->subformat, extensible_ieee_guid, 16) == 0) {
-            IEEE_float_encoded = 1;
-            break;
+        decoder->encoding = PCM_CODE;
+        if (SDL_memcmp(ext->subformat, extensible_ieee_guid, 16) == 0) {
+            decoder->encoding = IEEE_FLOAT_CODE;
         }
         break;
     case MP3_CODE:
-        SDL_SetError("MPEG Layer 3 data not supported");
-        was_error = 1;
-        goto done;
+        return SDL_SetError("MPEG Layer 3 data not supported");
     default:
-        SDL_SetError("Unknown WAVE data format: 0x%.4x",
-                     SDL_SwapLE16(format->encoding));
-        was_error = 1;
-        goto done;
+        return SDL_SetError("Unknown WAVE data format: 0x%.4x", decoder->encoding);
     }
     SDL_zerop(spec);
     spec->freq = SDL_SwapLE32(format->frequency);
 
-    if (IEEE_float_encoded) {
-        if ((SDL_SwapLE16(format->bitspersample)) != 32) {
+    if (decoder->encoding == IEEE_FLOAT_CODE) {
+        if (decoder->bitspersample != 32) {
             was_error = 1;
         } else {
             spec->format = AUDIO_F32;
         }
     } else {
-        switch (SDL_SwapLE16(format->bitspersample)) {
+        switch (decoder->bitspersample) {
         case 4:
-            if (MS_ADPCM_encoded || IMA_ADPCM_encoded) {
+            if ((decoder->encoding == MS_ADPCM_CODE) || (decoder->encoding == IMA_ADPCM_CODE)) {
                 spec->format = AUDIO_S16;
             } else {
                 was_error = 1;
@@ -601,68 +530,462 @@ SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
     }
 
     if (was_error) {
-        SDL_SetError("Unknown %d-bit PCM data format",
-                     SDL_SwapLE16(format->bitspersample));
-        goto done;
+        return SDL_SetError("Unknown %d-bit PCM data format", decoder->bitspersample);
     }
-    spec->channels = (Uint8) SDL_SwapLE16(format->channels);
+    if (decoder->channels == 0) {
+        return SDL_SetError("Invalid number of channels");
+    }
+    spec->channels = (Uint8) decoder->channels;
     spec->samples = 4096;       /* Good default buffer size */
 
-    /* Read the audio data chunk */
-    *audio_buf = NULL;
-    do {
-        SDL_free(*audio_buf);
-        *audio_buf = NULL;
-        lenread = ReadChunk(src, &chunk);
-        if (lenread < 0) {
-            was_error = 1;
-            goto done;
+    decoder->frame_size = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) * spec->channels;
+    if ((decoder->encoding == MS_ADPCM_CODE) || (decoder->encoding == IMA_ADPCM_CODE)) {
+        if (decoder->blockalign == 0) {
+            return SDL_SetError("Invalid ADPCM block size");
         }
-        *audio_len = lenread;
-        *audio_buf = chunk.data;
-        if (chunk.magic != DATA)
-            headerDiff += lenread + 2 * sizeof(Uint32);
-    } while (chunk.magic != DATA);
-    headerDiff += 2 * sizeof(Uint32);   /* for the data chunk and len */
-
-    if (MS_ADPCM_encoded) {
-        if (MS_ADPCM_decode(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+    } else {
+        decoder->file_frame_size = (decoder->bitspersample / 8) * decoder->channels;
+    }
+    return 0;
+}
+
+/* Set up the buffers once we know how big the data is. */
+static int
+SetupDecoderBuffers(SDL_WAVDecoder * decoder)
+{
+    Uint32 encoded_len, decoded_len;
+
+    switch (decoder->encoding) {
+    case MS_ADPCM_CODE:
+    case IMA_ADPCM_CODE:
+        decoder->total_frames = (decoder->data_length / decoder->blockalign) * decoder->wSamplesPerBlock;
+        if (decoder->encoding == MS_ADPCM_CODE) {
+            encoded_len = MS_ADPCM_encoded_size(decoder);
+            decoded_len = MS_ADPCM_decoded_samples(decoder) * sizeof (Sint16);
+        } else {
+            encoded_len = IMA_ADPCM_encoded_size(decoder);
+            decoded_len = IMA_ADPCM_decoded_samples(decoder) * sizeof (Sint16);
         }
+        /* Only whole blocks are decoded; a short one at the end of the data
+           is left out of total_frames. If blockalign is less than the
+           decoder looks at, the rest of the buffer is the calloc'd zeros,
+           since reading a block only ever fills its first blockalign bytes. */
+        if (encoded_len < decoder->blockalign) {
+            encoded_len = decoder->blockalign;
+        }
+        decoder->encoded = (Uint8 *) SDL_calloc(1, encoded_len);
+        break;
+
+    default:
+        decoder->total_frames = decoder->data_length / decoder->file_frame_size;
+        decoded_len = WAV_SCRATCH_FRAMES * decoder->frame_size;
+        break;
     }
-    if (IMA_ADPCM_encoded) {
-        if (IMA_ADPCM_decode(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+
+    decoder->decoded = (Uint8 *) SDL_malloc(decoded_len);
+    if (!decoder->decoded || (!decoder->encoded && (decoder->encoding == MS_ADPCM_CODE || decoder->encoding == IMA_ADPCM_CODE))) {
+        return SDL_OutOfMemory();
+    }
+    return 0;
+}
+
+SDL_WAVDecoder *
+SDL_NewWAVDecoder_RW(SDL_RWops * src, int freesrc, SDL_AudioSpec * spec)
+{
+    SDL_WAVDecoder *decoder;
+    Uint32 magic, length;
+    Uint8 *format = NULL;
+    Uint32 format_len = 0;
+    Sint64 riff_start;
+    Sint64 file_size;
+
+    /* WAV magic header */
+    Uint32 RIFFchunk;
+    Uint32 wavelen = 0;
+    Uint32 WAVEmagic;
+
+    if (src == NULL) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+    if (spec == NULL) {
+        SDL_InvalidParamError("spec");
+        if (freesrc) {
+            SDL_RWclose(src);
         }
+        return NULL;
     }
 
-    if (SDL_SwapLE16(format->bitspersample) == 24) {
-        if (ConvertSint24ToSint32(audio_buf, audio_len) < 0) {
-            was_error = 1;
-            goto done;
+    decoder = (SDL_WAVDecoder *) SDL_calloc(1, sizeof (*decoder));
+    if (decoder == NULL) {
+        SDL_OutOfMemory();
+        if (freesrc) {
+            SDL_RWclose(src);
         }
+        return NULL;
     }
+    decoder->src = src;
+    decoder->freesrc = freesrc;
+    decoder->file_position = WAV_NO_POSITION;
+    decoder->decoded_block = WAV_NO_POSITION;
 
-    /* Don't return a buffer that isn't a multiple of samplesize */
-    samplesize = ((SDL_AUDIO_BITSIZE(spec->format)) / 8) * spec->channels;
-    *audio_len &= ~(samplesize - 1);
+    /* Check the magic header */
+    riff_start = SDL_RWtell(src);
+    RIFFchunk = SDL_ReadLE32(src);
+    wavelen = SDL_ReadLE32(src);
+    if (wavelen == WAVE) {      /* The RIFFchunk has already been read */
+        WAVEmagic = wavelen;
+        wavelen = RIFFchunk;
+        RIFFchunk = RIFF;
+        riff_start -= sizeof (Uint32);
+    } else {
+        WAVEmagic = SDL_ReadLE32(src);
+    }
+    if ((RIFFchunk != RIFF) || (WAVEmagic != WAVE)) {
+        SDL_SetError("Unrecognized file type (not WAVE)");
+        goto failed;
+    }
+    decoder->riff_end = riff_start + (2 * sizeof (Uint32)) + wavelen;
 
-  done:
+    /* Read the audio data format chunk */
+    for (;;) {
+        magic = SDL_ReadLE32(src);
+        length = SDL_ReadLE32(src);
+        if (magic == FMT) {
+            break;
+        } else if ((magic == FACT) || (magic == LIST) || (magic == BEXT) || (magic == JUNK)) {
+            if (SkipChunk(src, length) < 0) {
+                goto failed;
+            }
+        } else {
+            SDL_SetError("Complex WAVE files not supported");
+            goto failed;
+        }
+    }
+
+    if (length < sizeof (WaveFMT)) {
+        SDL_SetError("Invalid WAVE format chunk length");
+        goto failed;
+    }
+    format = (Uint8 *) SDL_malloc(length);
+    if (format == NULL) {
+        SDL_OutOfMemory();
+        goto failed;
+    }
+    if (SDL_RWread(src, format, length, 1) != 1) {
+        SDL_Error(SDL_EFREAD);
+        goto failed;
+    }
+    format_len = length;
+    if (ParseFormat(decoder, format, format_len, spec) < 0) {
+        goto failed;
+    }
     SDL_free(format);
-    if (src) {
+    format = NULL;
+
+    /* Find the audio data chunk */
+    for (;;) {
+        magic = SDL_ReadLE32(src);
+        length = SDL_ReadLE32(src);
+        if (magic == DATA) {
+            break;
+        }
+        if ((magic == 0) && (length == 0)) {
+            SDL_SetError("No WAVE data chunk found");  /* ran off the end of the file. */
+            goto failed;
+        }
+        if (SkipChunk(src, length) < 0) {
+            goto failed;
+        }
+    }
+    decoder->data_start = SDL_RWtell(src);
+    decoder->data_length = length;
+
+    /* don't trust a data length that runs past the end of the file. */
+    file_size = SDL_RWsize(src);
+    if ((file_size >= 0) && (decoder->data_start >= 0) &&
+        ((decoder->data_start + decoder->data_length) > file_size)) {
+        decoder->data_length = (Uint32) (file_size - decoder->data_start);
+    }
+
+    if (SetupDecoderBuffers(decoder) < 0) {
+        goto failed;
+    }
+
+    decoder->file_position = 0;  /* src is at the start of the data now. */
+    return decoder;
+
+failed:
+    SDL_free(format);
+    SDL_FreeWAVDecoder(decoder);
+    return NULL;
+}
+
+/* Reads and decodes one ADPCM block. */
+static int
+WAV_DecodeBlock(SDL_WAVDecoder * decoder, const Uint32 block)
+{
+    int retval;
+
+    if (decoder->file_position != block) {
+        const Sint64 offset = decoder->data_start + (((Sint64) block) * decoder->blockalign);
+        if (SDL_RWseek(decoder->src, offset, RW_SEEK_SET) < 0) {
+            decoder->file_position = WAV_NO_POSITION;
+            return SDL_Error(SDL_EFSEEK);
+        }
+    }
+    if (SDL_RWread(decoder->src, decoder->encoded, decoder->blockalign, 1) != 1) {
+        decoder->file_position = WAV_NO_POSITION;
+        return SDL_Error(SDL_EFREAD);
+    }
+    decoder->file_position = block + 1;
+
+    if (decoder->encoding == MS_ADPCM_CODE) {
+        retval = MS_ADPCM_decode(decoder);
+    } else {
+        retval = IMA_ADPCM_decode(decoder);
+    }
+    decoder->decoded_block = (retval < 0) ? WAV_NO_POSITION : block;
+    return retval;
+}
+
+/* Decodes up to maxframes from the current position into either buf or
+   stream, stopping early at the end of an ADPCM block or the PCM scratch
+   buffer. Returns the number of frames, 0 at the end, or -1 on error. */
+static int
+WAV_DecodeSome(SDL_WAVDecoder * decoder, Uint8 * buf, SDL_AudioStream * stream, Uint32 maxframes)
+{
+    const Uint32 available = decoder->total_frames - decoder->position;
+    Uint32 frames = SDL_min(available, maxframes);
+    const Uint8 *decoded;
+
+    if (frames == 0) {
+        return 0;
+    }
+
+    if ((decoder->encoding == MS_ADPCM_CODE) || (decoder->encoding == IMA_ADPCM_CODE)) {
+        const Uint32 block = decoder->position / decoder->wSamplesPerBlock;
+        const Uint32 offset = decoder->position % decoder->wSamplesPerBlock;
+        if (decoder->decoded_block != block) {
+            if (WAV_DecodeBlock(decoder, block) < 0) {
+                return -1;
+            }
+        }
+        frames = SDL_min(frames, decoder->wSamplesPerBlock - offset);
+        decoded = decoder->decoded + (offset * decoder->frame_size);
+    } else {
+        const SDL_bool use_scratch = (stream != NULL) || (decoder->bitspersample == 24);
+        Uint8 *dst = use_scratch ? decoder->decoded : buf;
+        size_t got;
+
+        if (use_scratch) {
+            frames = SDL_min(frames, WAV_SCRATCH_FRAMES);
+        }
+        if (decoder->file_position != decoder->position) {
+            const Sint64 offset = decoder->data_start + (((Sint64) decoder->position) * decoder->file_frame_size);
+            if (SDL_RWseek(decoder->src, offset, RW_SEEK_SET) < 0) {
+                decoder->file_position = WAV_NO_POSITION;
+                return SDL_Error(SDL_EFSEEK);
+            }
+        }
+        got = SDL_RWread(decoder->src, dst, decoder->file_frame_size, frames);
+        if (got < frames) {
+            /* we might have read part of a frame, don't trust the position. */
+            decoder->file_position = WAV_NO_POSITION;
+            if (got == 0) {
+                return SDL_Error(SDL_EFREAD);
+            }
+            frames = (Uint32) got;
+        } else {
+            decoder->file_position = decoder->position + frames;
+        }
+        if (decoder->bitspersample == 24) {
+            ConvertSint24ToSint32(dst, frames * decoder->channels);
+        }
+        if (!use_scratch) {
+            decoder->position += frames;
+            return (int) frames;
+        }
+        decoded = dst;
+    }
+
+    if (stream) {
+        if (SDL_AudioStreamPut(stream, decoded, frames * decoder->frame_size) < 0) {
+            return -1;
+        }
+    } else {
+        SDL_memcpy(buf, decoded, frames * decoder->frame_size);
+    }
+    decoder->position += frames;
+    return (int) frames;
+}
+
+int
+SDL_WAVDecoderRead(SDL_WAVDecoder * decoder, void *buf, int len)
+{
+    Uint8 *dst = (Uint8 *) buf;
+    Uint32 frames, done = 0;
+
+    if (!decoder) {
+        return SDL_InvalidParamError("decoder");
+    } else if (!buf) {
+        return SDL_InvalidParamError("buf");
+    } else if (len < 0) {
+        return SDL_InvalidParamError("len");
+    }
+
+    frames = (Uint32) len / decoder->frame_size;
+    while (done < frames) {
+        const int rc = WAV_DecodeSome(decoder, dst + (done * decoder->frame_size), NULL, frames - done);
+        if (rc < 0) {
+            if (done == 0) {
+                return -1;
+            }
+            break;  /* hand out what we have, the error will come up again next time. */
+        } else if (rc == 0) {
+            break;  /* end of the data. */
+        }
+        done += (Uint32) rc;
+    }
+    return (int) (done * decoder->frame_size);
+}
+
+int
+SDL_WAVDecoderPutAudioStream(SDL_WAVDecoder * decoder, SDL_AudioStream * stream, int len)
+{
+    Uint32 frames, done = 0;
+
+    if (!decoder) {
+        return SDL_InvalidParamError("decoder");
+    } else if (!stream) {
+        return SDL_InvalidParamError("stream");
+    } else if (len < 0) {
+        return SDL_InvalidParamError("len");
+    }
+
+    frames = (Uint32) len / decoder->frame_size;
+    while (done < frames) {
+        const int rc = WAV_DecodeSome(decoder, NULL, stream, frames - done);
+        if (rc < 0) {
+            if (done == 0) {
+                return -1;
+            }
+            break;
+        } else if (rc == 0) {
+            break;
+        }
+        done += (Uint32) rc;
+    }
+    return (int) (done * decoder->frame_size);
+}
+
+int
+SDL_WAVDecoderSeek(SDL_WAVDecoder * decoder, Uint32 frame)
+{
+    if (!decoder) {
+        return SDL_InvalidParamError("decoder");
+    }
+    /* the actual seeking happens on the next read. */
+    decoder->position = SDL_min(frame, decoder->total_frames);
+    return 0;
+}
+
+Uint32
+SDL_WAVDecoderTell(SDL_WAVDecoder * decoder)
+{
+    if (!decoder) {
+        SDL_InvalidParamError("decoder");
+        return 0;
+    }
+    return decoder->position;
+}
+
+Uint32
+SDL_WAVDecoderLength(SDL_WAVDecoder * decoder)
+{
+    if (!decoder) {
+        SDL_InvalidParamError("decoder");
+        return 0;
+    }
+    return decoder->total_frames;
+}
+
+void
+SDL_FreeWAVDecoder(SDL_WAVDecoder * decoder)
+{
+    if (decoder) {
+        if (decoder->freesrc) {
+            SDL_RWclose(decoder->src);
+        }
+        SDL_free(decoder->encoded);
+        SDL_free(decoder->decoded);
+        SDL_free(decoder);
+    }
+}
+
+SDL_AudioSpec *
+SDL_LoadWAV_RW(SDL_RWops * src, int freesrc,
+               SDL_AudioSpec * spec, Uint8 ** audio_buf, Uint32 * audio_len)
+{
+    /* SDL_WAVDecoderRead takes an int, so read in pieces no bigger than this. */
+    const Uint32 max_read = 0x40000000;
+    SDL_WAVDecoder *decoder;
+    Uint32 len, done = 0;
+    Uint8 *buf = NULL;
+
+    if (src == NULL) {
+        return NULL;
+    }
+
+    /* this is just a decoder that reads everything at once. */
+    decoder = SDL_NewWAVDecoder_RW(src, 0, spec);
+    if (decoder == NULL) {
         if (freesrc) {
             SDL_RWclose(src);
-        } else {
-            /* seek to the end of the file (given by the RIFF chunk) */
-            SDL_RWseek(src, wavelen - chunk.length - headerDiff, RW_SEEK_CUR);
         }
+        return NULL;
     }
-    if (was_error) {
-        spec = NULL;
+
+    if (decoder->total_frames > (SDL_MAX_UINT32 / decoder->frame_size)) {
+        SDL_SetError("WAVE data too large");
+        goto failed;
+    }
+    len = decoder->total_frames * decoder->frame_size;
+    buf = (Uint8 *) SDL_malloc(len ? len : 1);
+    if (buf == NULL) {
+        SDL_OutOfMemory();
+        goto failed;
+    }
+
+    while (done < len) {
+        const int rc = SDL_WAVDecoderRead(decoder, buf + done, (int) SDL_min(len - done, max_read));
+        if (rc < 0) {
+            goto failed;
+        } else if (rc == 0) {
+            SDL_Error(SDL_EFREAD);
+            goto failed;
+        }
+        done += (Uint32) rc;
+    }
+
+    if (freesrc) {
+        SDL_RWclose(src);
+    } else {
+        /* seek to the end of the file (given by the RIFF chunk) */
+        SDL_RWseek(src, decoder->riff_end, RW_SEEK_SET);
     }
-    return (spec);
+    SDL_FreeWAVDecoder(decoder);
+    *audio_buf = buf;
+    *audio_len = len;
+    return spec;
+
+failed:
+    SDL_free(buf);
+    SDL_FreeWAVDecoder(decoder);
+    if (freesrc) {
+        SDL_RWclose(src);
+    }
+    return NULL;
 }
 
 /* Since the WAV memory is allocated in the shared library, it must also
@@ -674,21 +997,4 @@ SDL_FreeWAV(Uint8 * audio_buf)
     SDL_free(audio_buf);
 }
 
-static int
-ReadChunk(SDL_RWops * src, Chunk * chunk)
-{
-    chunk->magic = SDL_ReadLE32(src);
-    chunk->length = SDL_ReadLE32(src);
-    chunk->data = (Uint8 *) SDL_malloc(chunk->length);
-    if (chunk->data == NULL) {
-        return SDL_OutOfMemory();
-    }
-    if (SDL_RWread(src, chunk->data, chunk->length, 1) != 1) {
-        SDL_free(chunk->data);
-        chunk->data = NULL;
-        return SDL_Error(SDL_EFREAD);
-    }
-    return (chunk->length);
-}
-
 /* vi: set ts=4 sw=4 expandtab: */
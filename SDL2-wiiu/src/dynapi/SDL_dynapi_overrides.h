@@ -674,3 +674,14 @@
 #define SDL_HasAVX512F SDL_HasAVX512F_REAL
 #define SDL_IsChromebook SDL_IsChromebook_REAL
 #define SDL_IsDeXMode SDL_IsDeXMode_REAL
+#define SDL_NewWAVDecoder_RW SDL_NewWAVDecoder_RW_REAL
+#define SDL_WAVDecoderRead SDL_WAVDecoderRead_REAL
+#define SDL_WAVDecoderPutAudioStream SDL_WAVDecoderPutAudioStream_REAL
+#define SDL_WAVDecoderSeek SDL_WAVDecoderSeek_REAL
+#define SDL_WAVDecoderTell SDL_WAVDecoderTell_REAL
+#define SDL_WAVDecoderLength SDL_WAVDecoderLength_REAL
+#define SDL_FreeWAVDecoder SDL_FreeWAVDecoder_REAL
+#define SDL_GetAudioDeviceStats SDL_GetAudioDeviceStats_REAL
+#define SDL_ResetAudioDeviceStats SDL_ResetAudioDeviceStats_REAL
+#define SDL_GetMemoryStats SDL_GetMemoryStats_REAL
+#define SDL_PollEvents SDL_PollEvents_REAL
@@ -716,3 +716,14 @@ SDL_DYNAPI_PROC(SDL_bool,SDL_HasAVX512F,(void),(),return)
 SDL_DYNAPI_PROC(SDL_bool,SDL_IsChromebook,(void),(),return)
 SDL_DYNAPI_PROC(SDL_bool,SDL_IsDeXMode,(void),(),return)
 #endif
+SDL_DYNAPI_PROC(SDL_WAVDecoder*,SDL_NewWAVDecoder_RW,(SDL_RWops *a, int b, SDL_AudioSpec *c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_WAVDecoderRead,(SDL_WAVDecoder *a, void *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_WAVDecoderPutAudioStream,(SDL_WAVDecoder *a, SDL_AudioStream *b, int c),(a,b,c),return)
+SDL_DYNAPI_PROC(int,SDL_WAVDecoderSeek,(SDL_WAVDecoder *a, Uint32 b),(a,b),return)
+SDL_DYNAPI_PROC(Uint32,SDL_WAVDecoderTell,(SDL_WAVDecoder *a),(a),return)
+SDL_DYNAPI_PROC(Uint32,SDL_WAVDecoderLength,(SDL_WAVDecoder *a),(a),return)
+SDL_DYNAPI_PROC(void,SDL_FreeWAVDecoder,(SDL_WAVDecoder *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_GetAudioDeviceStats,(SDL_AudioDeviceID a, SDL_AudioDeviceStats *b),(a,b),return)
+SDL_DYNAPI_PROC(void,SDL_ResetAudioDeviceStats,(SDL_AudioDeviceID a),(a),)
+SDL_DYNAPI_PROC(void,SDL_GetMemoryStats,(SDL_MemoryStats *a),(a),)
+SDL_DYNAPI_PROC(int,SDL_PollEvents,(SDL_Event *a, int b),(a,b),return)
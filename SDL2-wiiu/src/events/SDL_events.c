@@ -35,8 +35,10 @@
 
 /*#define SDL_DEBUG_EVENTS 1*/
 
-/* An arbitrary limit so we don't have unbounded growth */
-#define SDL_MAX_QUEUED_EVENTS   65535
+/* How many events the queue holds, all preallocated. Must be a power of two. */
+#ifndef SDL_MAX_QUEUED_EVENTS
+#define SDL_MAX_QUEUED_EVENTS   4096
+#endif
 
 typedef struct SDL_EventWatcher {
     SDL_EventFilter callback;
@@ -58,18 +60,27 @@ typedef struct {
 static SDL_DisabledEventBlock *SDL_disabled_events[256];
 static Uint32 SDL_userevents = SDL_USEREVENT;
 
-/* Private data -- event queue */
-typedef struct _SDL_EventEntry
+/* Private data -- event queue
+
+   The queue is a ring of slots that any thread can add events to without
+   taking a lock: the producer claims the slot at 'tail' with a compare and
+   swap, copies its event in, and then publishes it by advancing the slot's
+   sequence number. Looking at and removing events is done with 'lock' held,
+   so there is only ever one consumer, which owns 'head'. Events removed from
+   the middle of the queue are marked and skipped while it's being looked at,
+   and then the events left are moved up over them, so the slots can go back
+   to the producers and the queue's size limits the events in it.
+ */
+typedef struct _SDL_EventSlot
 {
+    SDL_atomic_t sequence;  /* relative to the slot's index, see SDL_EventSequence() */
+    SDL_bool removed;
     SDL_Event event;
-    SDL_SysWMmsg msg;
-    struct _SDL_EventEntry *prev;
-    struct _SDL_EventEntry *next;
-} SDL_EventEntry;
+} SDL_EventSlot;
 
 typedef struct _SDL_SysWMEntry
 {
-    SDL_SysWMmsg msg;
+    SDL_SysWMmsg msg;       /* first, so queued events can point at their entry */
     struct _SDL_SysWMEntry *next;
 } SDL_SysWMEntry;
 
@@ -78,13 +89,39 @@ static struct
     SDL_mutex *lock;
     SDL_atomic_t active;
     SDL_atomic_t count;
-    int max_events_seen;
-    SDL_EventEntry *head;
-    SDL_EventEntry *tail;
-    SDL_EventEntry *free;
+    SDL_atomic_t max_events_seen;
+    SDL_atomic_t tail;
+    SDL_atomic_t producers;     /* threads adding an event right now */
+    Uint32 head;
+    int removed;                /* slots marked removed, owned by the consumer */
     SDL_SysWMEntry *wmmsg_used;
-    SDL_SysWMEntry *wmmsg_free;
-} SDL_EventQ = { NULL, { 1 }, { 0 }, 0, NULL, NULL, NULL, NULL, NULL };
+    SDL_EventSlot slots[SDL_MAX_QUEUED_EVENTS];
+} SDL_EventQ = { NULL, { 1 } };
+
+SDL_COMPILE_TIME_ASSERT(event_queue_size, (SDL_MAX_QUEUED_EVENTS & (SDL_MAX_QUEUED_EVENTS - 1)) == 0);
+
+/* The slot at queue position 'pos' is free for a producer when its sequence
+   is 'pos', and holds an event when it's 'pos + 1'. The sequences are stored
+   minus the slot's index, so the zeroed queue starts out empty. */
+static SDL_INLINE SDL_EventSlot *
+SDL_EventSlotAt(Uint32 pos)
+{
+    return &SDL_EventQ.slots[pos & (SDL_MAX_QUEUED_EVENTS - 1)];
+}
+
+static SDL_INLINE Uint32
+SDL_EventSequence(Uint32 pos)
+{
+    return (Uint32)SDL_AtomicGet(&SDL_EventSlotAt(pos)->sequence) + (pos & (SDL_MAX_QUEUED_EVENTS - 1));
+}
+
+static SDL_INLINE void
+SDL_SetEventSequence(Uint32 pos, Uint32 sequence)
+{
+    /* Everything done with the slot so far has to be visible before it changes hands */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&SDL_EventSlotAt(pos)->sequence, (int)(sequence - (pos & (SDL_MAX_QUEUED_EVENTS - 1))));
+}
 
 
 #ifdef SDL_DEBUG_EVENTS
@@ -318,7 +355,7 @@ SDL_StopEventLoop(void)
 {
     const char *report = SDL_GetHint("SDL_EVENT_QUEUE_STATISTICS");
     int i;
-    SDL_EventEntry *entry;
+    Uint32 pos;
     SDL_SysWMEntry *wmmsg;
 
     if (SDL_EventQ.lock) {
@@ -327,40 +364,38 @@ SDL_StopEventLoop(void)
 
     SDL_AtomicSet(&SDL_EventQ.active, 0);
 
+    /* Let any thread that's in the middle of adding an event finish */
+    while (SDL_AtomicGet(&SDL_EventQ.producers) > 0) {
+        SDL_Delay(0);
+    }
+
     if (report && SDL_atoi(report)) {
         SDL_Log("SDL EVENT QUEUE: Maximum events in-flight: %d\n",
-                SDL_EventQ.max_events_seen);
+                SDL_AtomicGet(&SDL_EventQ.max_events_seen));
     }
 
     /* Clean out EventQ */
-    for (entry = SDL_EventQ.head; entry; ) {
-        SDL_EventEntry *next = entry->next;
-        SDL_free(entry);
-        entry = next;
-    }
-    for (entry = SDL_EventQ.free; entry; ) {
-        SDL_EventEntry *next = entry->next;
-        SDL_free(entry);
-        entry = next;
+    for (pos = SDL_EventQ.head; SDL_EventSequence(pos) == pos + 1; ++pos) {
+        SDL_EventSlot *slot = SDL_EventSlotAt(pos);
+        if (!slot->removed && slot->event.type == SDL_SYSWMEVENT) {
+            SDL_free(slot->event.syswm.msg);
+        }
     }
     for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; ) {
         SDL_SysWMEntry *next = wmmsg->next;
         SDL_free(wmmsg);
         wmmsg = next;
     }
-    for (wmmsg = SDL_EventQ.wmmsg_free; wmmsg; ) {
-        SDL_SysWMEntry *next = wmmsg->next;
-        SDL_free(wmmsg);
-        wmmsg = next;
-    }
 
     SDL_AtomicSet(&SDL_EventQ.count, 0);
-    SDL_EventQ.max_events_seen = 0;
-    SDL_EventQ.head = NULL;
-    SDL_EventQ.tail = NULL;
-    SDL_EventQ.free = NULL;
+    SDL_AtomicSet(&SDL_EventQ.max_events_seen, 0);
+    SDL_AtomicSet(&SDL_EventQ.tail, 0);
+    SDL_EventQ.head = 0;
+    SDL_EventQ.removed = 0;
+    for (i = 0; i < SDL_arraysize(SDL_EventQ.slots); ++i) {
+        SDL_AtomicSet(&SDL_EventQ.slots[i].sequence, 0);
+    }
     SDL_EventQ.wmmsg_used = NULL;
-    SDL_EventQ.wmmsg_free = NULL;
 
     /* Clear disabled event state */
     for (i = 0; i < SDL_arraysize(SDL_disabled_events); ++i) {
@@ -424,55 +459,69 @@ SDL_StartEventLoop(void)
 }
 
 
-/* Add an event to the event queue -- called with the queue locked */
+/* Add an event to the event queue -- called from any thread, without the lock */
 static int
 SDL_AddEvent(SDL_Event * event)
 {
-    SDL_EventEntry *entry;
-    const int initial_count = SDL_AtomicGet(&SDL_EventQ.count);
-    int final_count;
+    SDL_SysWMEntry *wmmsg = NULL;
+    SDL_EventSlot *slot;
+    Uint32 pos;
+    int final_count, max_events_seen;
+
+    if (event->type == SDL_SYSWMEVENT) {
+        wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
+        if (!wmmsg) {
+            SDL_OutOfMemory();
+            return 0;
+        }
+        wmmsg->msg = *event->syswm.msg;
+    }
 
-    if (initial_count >= SDL_MAX_QUEUED_EVENTS) {
-        SDL_SetError("Event queue is full (%d events)", initial_count);
+    /* SDL_StopEventLoop() waits for us once it's seen this, or we see it stopped */
+    SDL_AtomicAdd(&SDL_EventQ.producers, 1);
+    if (!SDL_AtomicGet(&SDL_EventQ.active)) {
+        SDL_AtomicAdd(&SDL_EventQ.producers, -1);
+        SDL_free(wmmsg);
         return 0;
     }
 
-    if (SDL_EventQ.free == NULL) {
-        entry = (SDL_EventEntry *)SDL_malloc(sizeof(*entry));
-        if (!entry) {
+    for (;;) {
+        int diff;
+
+        pos = (Uint32)SDL_AtomicGet(&SDL_EventQ.tail);
+        diff = (int)(SDL_EventSequence(pos) - pos);
+        if (diff == 0) {
+            if (SDL_AtomicCAS(&SDL_EventQ.tail, (int)pos, (int)(pos + 1))) {
+                break;
+            }
+        } else if (diff < 0) {
+            /* The consumer hasn't handed this slot back yet */
+            SDL_AtomicAdd(&SDL_EventQ.producers, -1);
+            SDL_free(wmmsg);
+            SDL_SetError("Event queue is full (%d events)", SDL_AtomicGet(&SDL_EventQ.count));
             return 0;
         }
-    } else {
-        entry = SDL_EventQ.free;
-        SDL_EventQ.free = entry->next;
+        /* Otherwise another thread took the slot first, try the next one */
     }
 
     #ifdef SDL_DEBUG_EVENTS
     SDL_DebugPrintEvent(event);
     #endif
 
-    entry->event = *event;
-    if (event->type == SDL_SYSWMEVENT) {
-        entry->msg = *event->syswm.msg;
-        entry->event.syswm.msg = &entry->msg;
-    }
-
-    if (SDL_EventQ.tail) {
-        SDL_EventQ.tail->next = entry;
-        entry->prev = SDL_EventQ.tail;
-        SDL_EventQ.tail = entry;
-        entry->next = NULL;
-    } else {
-        SDL_assert(!SDL_EventQ.head);
-        SDL_EventQ.head = entry;
-        SDL_EventQ.tail = entry;
-        entry->prev = NULL;
-        entry->next = NULL;
+    slot = SDL_EventSlotAt(pos);
+    slot->event = *event;
+    slot->removed = SDL_FALSE;
+    if (wmmsg) {
+        slot->event.syswm.msg = &wmmsg->msg;
     }
+    SDL_SetEventSequence(pos, pos + 1);
+    SDL_AtomicAdd(&SDL_EventQ.producers, -1);
 
     final_count = SDL_AtomicAdd(&SDL_EventQ.count, 1) + 1;
-    if (final_count > SDL_EventQ.max_events_seen) {
-        SDL_EventQ.max_events_seen = final_count;
+    max_events_seen = SDL_AtomicGet(&SDL_EventQ.max_events_seen);
+    while (final_count > max_events_seen &&
+           !SDL_AtomicCAS(&SDL_EventQ.max_events_seen, max_events_seen, final_count)) {
+        max_events_seen = SDL_AtomicGet(&SDL_EventQ.max_events_seen);
     }
 
     return 1;
@@ -480,28 +529,99 @@ SDL_AddEvent(SDL_Event * event)
 
 /* Remove an event from the queue -- called with the queue locked */
 static void
-SDL_CutEvent(SDL_EventEntry *entry)
+SDL_CutEvent(Uint32 pos)
 {
-    if (entry->prev) {
-        entry->prev->next = entry->next;
+    SDL_EventSlot *slot = SDL_EventSlotAt(pos);
+
+    if (slot->event.type == SDL_SYSWMEVENT) {
+        /* The message stays valid at least until the next SDL_PeepEvents() */
+        SDL_SysWMEntry *wmmsg = (SDL_SysWMEntry *)slot->event.syswm.msg;
+        wmmsg->next = SDL_EventQ.wmmsg_used;
+        SDL_EventQ.wmmsg_used = wmmsg;
     }
-    if (entry->next) {
-        entry->next->prev = entry->prev;
+    slot->removed = SDL_TRUE;
+    ++SDL_EventQ.removed;
+    SDL_assert(SDL_AtomicGet(&SDL_EventQ.count) > 0);
+    SDL_AtomicAdd(&SDL_EventQ.count, -1);
+}
+
+/* Hand the empty slots back to the producers -- called with the queue locked */
+static void
+SDL_ReleaseEventSlots(void)
+{
+    Uint32 pos, end, keep;
+
+    /* Removing from the front of the queue, the slots go straight back */
+    while (SDL_EventQ.removed > 0 && SDL_EventSlotAt(SDL_EventQ.head)->removed) {
+        SDL_SetEventSequence(SDL_EventQ.head, SDL_EventQ.head + SDL_MAX_QUEUED_EVENTS);
+        ++SDL_EventQ.head;
+        --SDL_EventQ.removed;
+    }
+    if (SDL_EventQ.removed == 0) {
+        return;
     }
 
-    if (entry == SDL_EventQ.head) {
-        SDL_assert(entry->prev == NULL);
-        SDL_EventQ.head = entry->next;
+    /* Otherwise move the events that are left back over the removed ones,
+       in order, so the empty slots all end up at the front. Everything up
+       to the first slot that hasn't been published is ours to move. */
+    for (end = SDL_EventQ.head; SDL_EventSequence(end) == end + 1; ++end) {
     }
-    if (entry == SDL_EventQ.tail) {
-        SDL_assert(entry->next == NULL);
-        SDL_EventQ.tail = entry->prev;
+    keep = end;
+    for (pos = end; pos != SDL_EventQ.head; ) {
+        SDL_EventSlot *slot = SDL_EventSlotAt(--pos);
+        if (!slot->removed && pos != --keep) {
+            SDL_EventSlot *to = SDL_EventSlotAt(keep);
+            to->event = slot->event;
+            to->removed = SDL_FALSE;
+            slot->removed = SDL_TRUE;
+        }
+    }
+    while (SDL_EventQ.head != keep) {
+        SDL_SetEventSequence(SDL_EventQ.head, SDL_EventQ.head + SDL_MAX_QUEUED_EVENTS);
+        ++SDL_EventQ.head;
     }
+    SDL_EventQ.removed = 0;
+}
 
-    entry->next = SDL_EventQ.free;
-    SDL_EventQ.free = entry;
-    SDL_assert(SDL_AtomicGet(&SDL_EventQ.count) > 0);
-    SDL_AtomicAdd(&SDL_EventQ.count, -1);
+/* Take a peep at the event queue -- called with the queue locked */
+static int
+SDL_PeepQueuedEvents(SDL_Event * events, int numevents, SDL_eventaction action,
+                     Uint32 minType, Uint32 maxType)
+{
+    SDL_SysWMEntry *wmmsg, *wmmsg_next;
+    Uint32 pos, type;
+    int used = 0;
+
+    if (action == SDL_GETEVENT) {
+        /* Clean out any used wmmsg data
+           FIXME: Do we want to retain the data for some period of time?
+         */
+        for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
+            wmmsg_next = wmmsg->next;
+            SDL_free(wmmsg);
+        }
+        SDL_EventQ.wmmsg_used = NULL;
+    }
+
+    /* Events being added while we look are past the first unpublished slot */
+    for (pos = SDL_EventQ.head; SDL_EventSequence(pos) == pos + 1 && (!events || used < numevents); ++pos) {
+        SDL_EventSlot *slot = SDL_EventSlotAt(pos);
+        if (slot->removed) {
+            continue;
+        }
+        type = slot->event.type;
+        if (minType <= type && type <= maxType) {
+            if (events) {
+                events[used] = slot->event;
+                if (action == SDL_GETEVENT) {
+                    SDL_CutEvent(pos);
+                }
+            }
+            ++used;
+        }
+    }
+    SDL_ReleaseEventSlots();
+    return used;
 }
 
 /* Lock the event queue, take a peep at it, and unlock it */
@@ -519,61 +639,19 @@ SDL_PeepEvents(SDL_Event * events, int numevents, SDL_eventaction action,
         }
         return (-1);
     }
-    /* Lock the event queue */
-    used = 0;
-    if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        if (action == SDL_ADDEVENT) {
-            for (i = 0; i < numevents; ++i) {
-                used += SDL_AddEvent(&events[i]);
-            }
-        } else {
-            SDL_EventEntry *entry, *next;
-            SDL_SysWMEntry *wmmsg, *wmmsg_next;
-            Uint32 type;
-
-            if (action == SDL_GETEVENT) {
-                /* Clean out any used wmmsg data
-                   FIXME: Do we want to retain the data for some period of time?
-                 */
-                for (wmmsg = SDL_EventQ.wmmsg_used; wmmsg; wmmsg = wmmsg_next) {
-                    wmmsg_next = wmmsg->next;
-                    wmmsg->next = SDL_EventQ.wmmsg_free;
-                    SDL_EventQ.wmmsg_free = wmmsg;
-                }
-                SDL_EventQ.wmmsg_used = NULL;
-            }
-
-            for (entry = SDL_EventQ.head; entry && (!events || used < numevents); entry = next) {
-                next = entry->next;
-                type = entry->event.type;
-                if (minType <= type && type <= maxType) {
-                    if (events) {
-                        events[used] = entry->event;
-                        if (entry->event.type == SDL_SYSWMEVENT) {
-                            /* We need to copy the wmmsg somewhere safe.
-                               For now we'll guarantee it's valid at least until
-                               the next call to SDL_PeepEvents()
-                             */
-                            if (SDL_EventQ.wmmsg_free) {
-                                wmmsg = SDL_EventQ.wmmsg_free;
-                                SDL_EventQ.wmmsg_free = wmmsg->next;
-                            } else {
-                                wmmsg = (SDL_SysWMEntry *)SDL_malloc(sizeof(*wmmsg));
-                            }
-                            wmmsg->msg = *entry->event.syswm.msg;
-                            wmmsg->next = SDL_EventQ.wmmsg_used;
-                            SDL_EventQ.wmmsg_used = wmmsg;
-                            events[used].syswm.msg = &wmmsg->msg;
-                        }
 
-                        if (action == SDL_GETEVENT) {
-                            SDL_CutEvent(entry);
-                        }
-                    }
-                    ++used;
-                }
-            }
+    /* Adding events doesn't need the lock */
+    used = 0;
+    if (action == SDL_ADDEVENT) {
+        for (i = 0; i < numevents; ++i) {
+            used += SDL_AddEvent(&events[i]);
         }
+        return (used);
+    }
+
+    /* Lock the event queue */
+    if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
+        used = SDL_PeepQueuedEvents(events, numevents, action, minType, maxType);
         if (SDL_EventQ.lock) {
             SDL_UnlockMutex(SDL_EventQ.lock);
         }
@@ -619,15 +697,15 @@ SDL_FlushEvents(Uint32 minType, Uint32 maxType)
 
     /* Lock the event queue */
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        SDL_EventEntry *entry, *next;
-        Uint32 type;
-        for (entry = SDL_EventQ.head; entry; entry = next) {
-            next = entry->next;
-            type = entry->event.type;
-            if (minType <= type && type <= maxType) {
-                SDL_CutEvent(entry);
+        Uint32 pos, type;
+        for (pos = SDL_EventQ.head; SDL_EventSequence(pos) == pos + 1; ++pos) {
+            SDL_EventSlot *slot = SDL_EventSlotAt(pos);
+            type = slot->event.type;
+            if (!slot->removed && minType <= type && type <= maxType) {
+                SDL_CutEvent(pos);
             }
         }
+        SDL_ReleaseEventSlots();
         if (SDL_EventQ.lock) {
             SDL_UnlockMutex(SDL_EventQ.lock);
         }
@@ -662,6 +740,17 @@ SDL_PollEvent(SDL_Event * event)
     return SDL_WaitEventTimeout(event, 0);
 }
 
+int
+SDL_PollEvents(SDL_Event * events, int numevents)
+{
+    if (!events || numevents <= 0) {
+        return SDL_InvalidParamError("events");
+    }
+
+    SDL_PumpEvents();
+    return SDL_PeepEvents(events, numevents, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT);
+}
+
 int
 SDL_WaitEvent(SDL_Event * event)
 {
@@ -847,13 +936,14 @@ void
 SDL_FilterEvents(SDL_EventFilter filter, void *userdata)
 {
     if (!SDL_EventQ.lock || SDL_LockMutex(SDL_EventQ.lock) == 0) {
-        SDL_EventEntry *entry, *next;
-        for (entry = SDL_EventQ.head; entry; entry = next) {
-            next = entry->next;
-            if (!filter(userdata, &entry->event)) {
-                SDL_CutEvent(entry);
+        Uint32 pos;
+        for (pos = SDL_EventQ.head; SDL_EventSequence(pos) == pos + 1; ++pos) {
+            SDL_EventSlot *slot = SDL_EventSlotAt(pos);
+            if (!slot->removed && !filter(userdata, &slot->event)) {
+                SDL_CutEvent(pos);
             }
         }
+        SDL_ReleaseEventSlots();
         if (SDL_EventQ.lock) {
             SDL_UnlockMutex(SDL_EventQ.lock);
         }
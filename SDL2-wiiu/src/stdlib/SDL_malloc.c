@@ -29,6 +29,7 @@
 #include "SDL_stdinc.h"
 #include "SDL_atomic.h"
 #include "SDL_error.h"
+#include "SDL_thread.h"
 
 #ifndef HAVE_MALLOC
 #define LACKS_SYS_TYPES_H
@@ -5318,6 +5319,385 @@ int SDL_SetMemoryFunctions(SDL_malloc_func malloc_func,
     return 0;
 }
 
+/* Small allocations are served from one block of memory, cut into
+   SDL_SLAB_PAGE_SIZE pages that each hold blocks of one size class. Free
+   blocks sit in a per-thread cache first, so allocating and freeing them
+   mostly doesn't touch any lock or shared cache line; the caches trade
+   batches of blocks with a spinlocked free list per class.
+
+   The arena is taken from the default allocator on the first small
+   allocation and never given back. Pages are never returned to the arena
+   either, a class keeps the pages it's been given. When the arena is used
+   up, or an application has set its own memory functions, allocations go
+   to the memory functions as before. SDL_free() can tell arena blocks
+   apart by their address, so memory from any source can still be freed. */
+#ifndef SDL_MALLOC_ARENA_SIZE
+#if defined(SDL_ATOMIC_DISABLED) || defined(__SANITIZE_ADDRESS__)
+#define SDL_MALLOC_ARENA_SIZE   0   /* spinlocks would allocate; sanitizers need to see every block */
+#else
+#define SDL_MALLOC_ARENA_SIZE   (4 * 1024 * 1024)
+#endif
+#endif
+
+#define SDL_SLAB_PAGE_SIZE      (16 * 1024)
+#define SDL_SLAB_MAX_SIZE       512
+#define SDL_SLAB_CACHES         32      /* threads that can have a cache at once */
+#define SDL_SLAB_PROBES         4
+
+#if SDL_MALLOC_ARENA_SIZE > 0
+
+#define SDL_SLAB_PAGES          (SDL_MALLOC_ARENA_SIZE / SDL_SLAB_PAGE_SIZE)
+
+typedef struct SDL_slab_block
+{
+    struct SDL_slab_block *next;
+} SDL_slab_block;
+
+/* The arena's free blocks of one size class, and the page being cut up */
+typedef struct
+{
+    SDL_SpinLock lock;
+    SDL_slab_block *head;
+    Uint32 count;
+    Uint8 *carve;
+    Uint8 *carve_end;
+    Uint32 pages;
+    Uint32 allocs;          /* blocks allocated and freed without a cache, */
+    Uint32 frees;           /* and by the threads that gave theirs back. */
+} SDL_slab_class;
+
+/* One thread's free blocks, only ever touched by that thread */
+typedef struct
+{
+    void *owner;            /* SDL_ThreadID() + 1 of the thread, NULL if unused. */
+    struct
+    {
+        SDL_slab_block *head;
+        Uint32 count;
+        Uint32 allocs;
+        Uint32 frees;
+    } bins[SDL_MEMORY_SIZE_CLASSES];
+} SDL_slab_cache;
+
+static struct
+{
+    Uint8 *base;            /* NULL until the first small allocation. */
+    Uint8 *end;
+    void *block;            /* what the allocator returned, base is aligned. */
+    SDL_bool failed;
+    SDL_SpinLock lock;
+    int next_page;
+    Uint8 page_class[SDL_SLAB_PAGES];
+    SDL_atomic_t outstanding;   /* bytes of blocks outside the arena's free lists. */
+    SDL_atomic_t peak;
+    SDL_slab_class classes[SDL_MEMORY_SIZE_CLASSES];
+    SDL_slab_cache caches[SDL_SLAB_CACHES];
+} s_slab;
+
+/* 16 byte steps up to 128, 32 up to 256, 64 up to 512 */
+static const Uint16 s_slab_sizes[SDL_MEMORY_SIZE_CLASSES] = {
+    16, 32, 48, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384, 448, 512
+};
+
+static SDL_INLINE int slab_class(size_t size)
+{
+    if (size <= 128) {
+        return (size <= 16) ? 0 : (int)((size - 1) >> 4);
+    } else if (size <= 256) {
+        return 8 + (int)((size - 129) >> 5);
+    }
+    return 12 + (int)((size - 257) >> 6);
+}
+
+/* How many blocks a cache trades with the arena at once */
+static SDL_INLINE Uint32 slab_batch(int c)
+{
+    return SDL_max(4, 1024 / s_slab_sizes[c]);
+}
+
+static SDL_INLINE SDL_bool slab_owns(const void *ptr)
+{
+    return ((const Uint8 *)ptr >= s_slab.base && (const Uint8 *)ptr < s_slab.end);
+}
+
+static SDL_bool slab_init(void)
+{
+    SDL_AtomicLock(&s_slab.lock);
+    if (!s_slab.base && !s_slab.failed) {
+        s_slab.block = real_malloc(SDL_MALLOC_ARENA_SIZE + 15);
+        if (s_slab.block) {
+            Uint8 *base = (Uint8 *)(((uintptr_t)s_slab.block + 15) & ~(uintptr_t)15);
+            s_slab.end = base + SDL_MALLOC_ARENA_SIZE;
+            SDL_MemoryBarrierRelease();
+            s_slab.base = base;
+        } else {
+            s_slab.failed = SDL_TRUE;
+        }
+    }
+    SDL_AtomicUnlock(&s_slab.lock);
+    return (s_slab.base != NULL);
+}
+
+static void slab_count_outstanding(int bytes)
+{
+    const int outstanding = SDL_AtomicAdd(&s_slab.outstanding, bytes) + bytes;
+    int peak = SDL_AtomicGet(&s_slab.peak);
+    while (outstanding > peak && !SDL_AtomicCAS(&s_slab.peak, peak, outstanding)) {
+        peak = SDL_AtomicGet(&s_slab.peak);
+    }
+}
+
+/* Take up to 'wanted' blocks of a class from the arena, with its lock held */
+static Uint32 slab_take(int c, SDL_slab_block **list, Uint32 wanted)
+{
+    SDL_slab_class *cls = &s_slab.classes[c];
+    const size_t size = s_slab_sizes[c];
+    Uint32 taken = 0;
+
+    while (taken < wanted) {
+        SDL_slab_block *block;
+        if (cls->head) {
+            block = cls->head;
+            cls->head = block->next;
+            cls->count--;
+        } else if (cls->carve < cls->carve_end) {
+            block = (SDL_slab_block *)cls->carve;
+            cls->carve += size;
+        } else {
+            int page;
+            SDL_AtomicLock(&s_slab.lock);
+            page = (s_slab.next_page < SDL_SLAB_PAGES) ? s_slab.next_page++ : -1;
+            SDL_AtomicUnlock(&s_slab.lock);
+            if (page < 0) {
+                break;
+            }
+            s_slab.page_class[page] = (Uint8)c;
+            cls->carve = s_slab.base + (size_t)page * SDL_SLAB_PAGE_SIZE;
+            cls->carve_end = cls->carve + (SDL_SLAB_PAGE_SIZE / size) * size;
+            cls->pages++;
+            continue;
+        }
+        block->next = *list;
+        *list = block;
+        ++taken;
+    }
+    return taken;
+}
+
+/* The calling thread's cache, or NULL if it has none and can't claim one */
+static SDL_slab_cache *slab_cache(SDL_bool claim)
+{
+    const SDL_threadID id = SDL_ThreadID();
+    void *key = (void *)(uintptr_t)(id + 1);
+    const unsigned int first = (unsigned int)((id >> 4) ^ (id >> 12));
+    int i;
+
+    for (i = 0; i < SDL_SLAB_PROBES; ++i) {
+        SDL_slab_cache *cache = &s_slab.caches[(first + i) % SDL_SLAB_CACHES];
+        if (cache->owner == key) {
+            return cache;
+        }
+    }
+    for (i = 0; claim && i < SDL_SLAB_PROBES; ++i) {
+        SDL_slab_cache *cache = &s_slab.caches[(first + i) % SDL_SLAB_CACHES];
+        if (!cache->owner && SDL_AtomicCASPtr(&cache->owner, NULL, key)) {
+            return cache;
+        }
+    }
+    return NULL;
+}
+
+static void *slab_alloc(size_t size)
+{
+    const int c = slab_class(size);
+    SDL_slab_cache *cache;
+    SDL_slab_block *block = NULL;
+
+    if (!s_slab.base && !slab_init()) {
+        return NULL;
+    }
+
+    cache = slab_cache(SDL_TRUE);
+    if (cache) {
+        if (!cache->bins[c].head) {
+            Uint32 taken;
+            SDL_AtomicLock(&s_slab.classes[c].lock);
+            taken = slab_take(c, &cache->bins[c].head, slab_batch(c));
+            SDL_AtomicUnlock(&s_slab.classes[c].lock);
+            if (!taken) {
+                return NULL;
+            }
+            cache->bins[c].count += taken;
+            slab_count_outstanding((int)(taken * s_slab_sizes[c]));
+        }
+        block = cache->bins[c].head;
+        cache->bins[c].head = block->next;
+        cache->bins[c].count--;
+        cache->bins[c].allocs++;
+        return block;
+    }
+
+    SDL_AtomicLock(&s_slab.classes[c].lock);
+    if (slab_take(c, &block, 1)) {
+        s_slab.classes[c].allocs++;
+    }
+    SDL_AtomicUnlock(&s_slab.classes[c].lock);
+    if (block) {
+        slab_count_outstanding(s_slab_sizes[c]);
+    }
+    return block;
+}
+
+/* Give up to 'count' blocks from the front of a list back to the arena */
+static void slab_give(int c, SDL_slab_block **list, Uint32 count)
+{
+    SDL_slab_class *cls = &s_slab.classes[c];
+    SDL_slab_block *first = *list, *last = *list;
+    Uint32 given = 1;
+
+    if (!first || !count) {
+        return;
+    }
+    while (given < count && last->next) {
+        last = last->next;
+        ++given;
+    }
+    *list = last->next;
+
+    SDL_AtomicLock(&cls->lock);
+    last->next = cls->head;
+    cls->head = first;
+    cls->count += given;
+    SDL_AtomicUnlock(&cls->lock);
+    slab_count_outstanding(-(int)(given * s_slab_sizes[c]));
+}
+
+static void slab_free(void *ptr)
+{
+    const int c = s_slab.page_class[((Uint8 *)ptr - s_slab.base) / SDL_SLAB_PAGE_SIZE];
+    SDL_slab_block *block = (SDL_slab_block *)ptr;
+    SDL_slab_cache *cache = slab_cache(SDL_TRUE);
+
+    if (cache) {
+        block->next = cache->bins[c].head;
+        cache->bins[c].head = block;
+        cache->bins[c].frees++;
+        if (++cache->bins[c].count > 2 * slab_batch(c)) {
+            cache->bins[c].count -= slab_batch(c);
+            slab_give(c, &cache->bins[c].head, slab_batch(c));
+        }
+        return;
+    }
+
+    block->next = NULL;
+    SDL_AtomicLock(&s_slab.classes[c].lock);
+    s_slab.classes[c].frees++;
+    SDL_AtomicUnlock(&s_slab.classes[c].lock);
+    slab_give(c, &block, 1);
+}
+
+/* Small blocks outlive a realloc() that still fits them */
+static void *slab_realloc(void *ptr, size_t size)
+{
+    const int c = s_slab.page_class[((Uint8 *)ptr - s_slab.base) / SDL_SLAB_PAGE_SIZE];
+    void *mem;
+
+    if (size <= s_slab_sizes[c]) {
+        return ptr;
+    }
+    mem = NULL;
+    if (size <= SDL_SLAB_MAX_SIZE && s_mem.malloc_func == real_malloc) {
+        mem = slab_alloc(size);
+    }
+    if (!mem) {
+        mem = s_mem.malloc_func(size);
+    }
+    if (mem) {
+        SDL_memcpy(mem, ptr, s_slab_sizes[c]);
+        slab_free(ptr);
+    }
+    return mem;
+}
+
+void SDL_ReleaseThreadMemoryCache(void)
+{
+    SDL_slab_cache *cache;
+    int c;
+
+    if (!s_slab.base || (cache = slab_cache(SDL_FALSE)) == NULL) {
+        return;
+    }
+    for (c = 0; c < SDL_MEMORY_SIZE_CLASSES; ++c) {
+        SDL_AtomicLock(&s_slab.classes[c].lock);
+        s_slab.classes[c].allocs += cache->bins[c].allocs;
+        s_slab.classes[c].frees += cache->bins[c].frees;
+        SDL_AtomicUnlock(&s_slab.classes[c].lock);
+        slab_give(c, &cache->bins[c].head, cache->bins[c].count);
+        SDL_zero(cache->bins[c]);
+    }
+    /* The next thread to take the slot has to see it emptied */
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSetPtr(&cache->owner, NULL);
+}
+
+#else
+
+#define slab_owns(ptr)              SDL_FALSE
+#define slab_alloc(size)            NULL
+#define slab_free(ptr)
+#define slab_realloc(ptr, size)     NULL
+
+void SDL_ReleaseThreadMemoryCache(void)
+{
+}
+
+#endif /* SDL_MALLOC_ARENA_SIZE > 0 */
+
+void SDL_GetMemoryStats(SDL_MemoryStats *stats)
+{
+#if SDL_MALLOC_ARENA_SIZE > 0
+    int c, i;
+#endif
+
+    if (!stats) {
+        return;
+    }
+    SDL_zerop(stats);
+    stats->allocations = SDL_AtomicGet(&s_mem.num_allocations);
+
+#if SDL_MALLOC_ARENA_SIZE > 0
+    if (!s_slab.base) {
+        return;
+    }
+    stats->arena_size = SDL_MALLOC_ARENA_SIZE;
+    stats->peak_bytes = (size_t)SDL_AtomicGet(&s_slab.peak);
+    for (c = 0; c < SDL_MEMORY_SIZE_CLASSES; ++c) {
+        SDL_slab_class *cls = &s_slab.classes[c];
+        Uint32 allocs, frees, cached = 0;
+
+        SDL_AtomicLock(&cls->lock);
+        allocs = cls->allocs;
+        frees = cls->frees;
+        stats->classes[c].pages = (int)cls->pages;
+        stats->classes[c].free = (int)cls->count;
+        SDL_AtomicUnlock(&cls->lock);
+
+        /* the caches are their threads' to change, this is a snapshot */
+        for (i = 0; i < SDL_SLAB_CACHES; ++i) {
+            allocs += s_slab.caches[i].bins[c].allocs;
+            frees += s_slab.caches[i].bins[c].frees;
+            cached += s_slab.caches[i].bins[c].count;
+        }
+        stats->classes[c].size = s_slab_sizes[c];
+        stats->classes[c].in_use = (int)(allocs - frees);
+        stats->classes[c].cached = (int)cached;
+        stats->small_allocations += stats->classes[c].in_use;
+        stats->small_bytes += (size_t)stats->classes[c].in_use * s_slab_sizes[c];
+        stats->arena_used += (size_t)stats->classes[c].pages * SDL_SLAB_PAGE_SIZE;
+    }
+#endif
+}
+
 int SDL_GetNumAllocations(void)
 {
     return SDL_AtomicGet(&s_mem.num_allocations);
@@ -5325,13 +5705,18 @@ int SDL_GetNumAllocations(void)
 
 void *SDL_malloc(size_t size)
 {
-    void *mem;
+    void *mem = NULL;
 
     if (!size) {
         size = 1;
     }
 
-    mem = s_mem.malloc_func(size);
+    if (size <= SDL_SLAB_MAX_SIZE && s_mem.malloc_func == real_malloc) {
+        mem = slab_alloc(size);
+    }
+    if (!mem) {
+        mem = s_mem.malloc_func(size);
+    }
     if (mem) {
         SDL_AtomicIncRef(&s_mem.num_allocations);
     }
@@ -5340,14 +5725,22 @@ void *SDL_malloc(size_t size)
 
 void *SDL_calloc(size_t nmemb, size_t size)
 {
-    void *mem;
+    void *mem = NULL;
 
     if (!nmemb || !size) {
         nmemb = 1;
         size = 1;
     }
 
-    mem = s_mem.calloc_func(nmemb, size);
+    if (size <= SDL_SLAB_MAX_SIZE && nmemb <= SDL_SLAB_MAX_SIZE / size && s_mem.malloc_func == real_malloc) {
+        mem = slab_alloc(nmemb * size);
+        if (mem) {
+            SDL_memset(mem, 0, nmemb * size);
+        }
+    }
+    if (!mem) {
+        mem = s_mem.calloc_func(nmemb, size);
+    }
     if (mem) {
         SDL_AtomicIncRef(&s_mem.num_allocations);
     }
@@ -5362,6 +5755,9 @@ void *SDL_realloc(void *ptr, size_t size)
         size = 1;
     }
 
+    if (ptr && slab_owns(ptr)) {
+        return slab_realloc(ptr, size);
+    }
     mem = s_mem.realloc_func(ptr, size);
     if (mem && !ptr) {
         SDL_AtomicIncRef(&s_mem.num_allocations);
@@ -5375,7 +5771,11 @@ void SDL_free(void *ptr)
         return;
     }
 
-    s_mem.free_func(ptr);
+    if (slab_owns(ptr)) {
+        slab_free(ptr);
+    } else {
+        s_mem.free_func(ptr);
+    }
     (void)SDL_AtomicDecRef(&s_mem.num_allocations);
 }
 
@@ -295,6 +295,9 @@ SDL_RunThread(void *data)
             SDL_free(thread);
         }
     }
+
+    /* Give this thread's cached small blocks back to SDL_malloc */
+    SDL_ReleaseThreadMemoryCache();
 }
 
 #ifdef SDL_CreateThread
@@ -68,6 +68,9 @@ struct SDL_Thread
 /* This is the function called to run a thread */
 extern void SDL_RunThread(void *data);
 
+/* Return the calling thread's small block cache to SDL_malloc, in SDL_malloc.c */
+extern void SDL_ReleaseThreadMemoryCache(void);
+
 /* This is the system-independent thread local storage structure */
 typedef struct {
     unsigned int limit;
@@ -0,0 +1,158 @@
+/*
+  Copyright (C) 1997-2018 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely.
+*/
+
+/* Measures how fast SDL_AudioStream and SDL_ConvertAudio() convert a wave file. */
+
+#include "SDL.h"
+
+#define ITERATIONS 10
+
+static double
+seconds_since(const Uint64 start)
+{
+    return ((double) (SDL_GetPerformanceCounter() - start)) / ((double) SDL_GetPerformanceFrequency());
+}
+
+int
+main(int argc, char **argv)
+{
+    SDL_AudioSpec spec;
+    SDL_AudioCVT cvt;
+    SDL_AudioStream *stream = NULL;
+    Uint32 len = 0;
+    Uint8 *data = NULL;
+    Uint8 *out = NULL;
+    int outlen = 0;
+    int cvtfreq = 0;
+    int cvtchans = 0;
+    int putsize = 4096;
+    int framesize = 0;
+    double audioseconds = 0.0;
+    double best = 0.0;
+    Uint64 start;
+    int i;
+
+    /* Enable standard application logging */
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_INFO);
+
+    if ((argc != 4) && (argc != 5)) {
+        SDL_Log("USAGE: %s in.wav newfreq newchans [putbytes]\n", argv[0]);
+        return 1;
+    }
+
+    cvtfreq = SDL_atoi(argv[2]);
+    cvtchans = SDL_atoi(argv[3]);
+    if (argc == 5) {
+        putsize = SDL_atoi(argv[4]);
+    }
+
+    if (SDL_Init(SDL_INIT_AUDIO) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "SDL_Init() failed: %s\n", SDL_GetError());
+        return 2;
+    }
+
+    if (SDL_LoadWAV(argv[1], &spec, &data, &len) == NULL) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "failed to load %s: %s\n", argv[1], SDL_GetError());
+        SDL_Quit();
+        return 3;
+    }
+
+    framesize = (SDL_AUDIO_BITSIZE(spec.format) / 8) * spec.channels;
+    audioseconds = ((double) (len / framesize)) / ((double) spec.freq);
+    putsize -= putsize % framesize;
+    if (putsize <= 0) {
+        putsize = framesize;
+    }
+
+    if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                          spec.format, cvtchans, cvtfreq) == -1) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "failed to build CVT: %s\n", SDL_GetError());
+        SDL_FreeWAV(data);
+        SDL_Quit();
+        return 4;
+    }
+
+    cvt.buf = (Uint8 *) SDL_malloc(len * cvt.len_mult);
+    stream = SDL_NewAudioStream(spec.format, spec.channels, spec.freq, spec.format, cvtchans, cvtfreq);
+    outlen = (int) (len * cvt.len_ratio) + 4096;
+    outlen -= outlen % ((SDL_AUDIO_BITSIZE(spec.format) / 8) * cvtchans);  /* whole frames only. */
+    out = (Uint8 *) SDL_malloc(outlen);
+    if (!cvt.buf || !stream || !out) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Setup failed: %s\n", SDL_GetError());
+        SDL_free(cvt.buf);
+        SDL_free(out);
+        SDL_FreeAudioStream(stream);
+        SDL_FreeWAV(data);
+        SDL_Quit();
+        return 5;
+    }
+
+    SDL_Log("Converting %.2f seconds of audio: %d Hz, %d channels -> %d Hz, %d channels\n",
+            audioseconds, spec.freq, (int) spec.channels, cvtfreq, cvtchans);
+
+    /* SDL_ConvertAudio() on the whole buffer at once. */
+    for (i = 0; i < ITERATIONS; i++) {
+        double elapsed;
+        SDL_memcpy(cvt.buf, data, len);
+        cvt.len = len;
+        start = SDL_GetPerformanceCounter();
+        if (SDL_ConvertAudio(&cvt) == -1) {
+            SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Conversion failed: %s\n", SDL_GetError());
+            break;
+        }
+        elapsed = seconds_since(start);
+        if ((i == 0) || (elapsed < best)) {
+            best = elapsed;
+        }
+    }
+    SDL_Log("SDL_ConvertAudio: %.3f ms, %.1fx realtime\n", best * 1000.0, audioseconds / best);
+
+    /* SDL_AudioStream, putting (putsize) bytes at a time and draining as we go. */
+    for (i = 0; i < ITERATIONS; i++) {
+        const Uint8 *ptr = data;
+        Uint32 remaining = len;
+        double elapsed;
+        int got = 0;
+
+        SDL_AudioStreamClear(stream);
+        start = SDL_GetPerformanceCounter();
+        while (remaining > 0) {
+            const int amount = (remaining < (Uint32) putsize) ? (int) remaining : putsize;
+            if (SDL_AudioStreamPut(stream, ptr, amount) == -1) {
+                SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Stream put failed: %s\n", SDL_GetError());
+                break;
+            }
+            ptr += amount;
+            remaining -= amount;
+            got += SDL_AudioStreamGet(stream, out, outlen);
+        }
+        SDL_AudioStreamFlush(stream);
+        got += SDL_AudioStreamGet(stream, out, outlen);
+        elapsed = seconds_since(start);
+        if ((i == 0) || (elapsed < best)) {
+            best = elapsed;
+        }
+        if (i == 0) {
+            SDL_Log("SDL_AudioStream produced %d bytes (SDL_ConvertAudio: %d)\n", got, cvt.len_cvt);
+        }
+    }
+    SDL_Log("SDL_AudioStream (%d byte puts): %.3f ms, %.1fx realtime\n", putsize, best * 1000.0, audioseconds / best);
+
+    SDL_FreeAudioStream(stream);
+    SDL_free(out);
+    SDL_free(cvt.buf);
+    SDL_FreeWAV(data);
+    SDL_Quit();
+    return 0;
+}                               /* main */
+
+/* end of testaudiostreamperf.c ... */
@@ -51,11 +51,76 @@ Uint32 _getTicks()
 	}
 }
 
+/*!
+\brief Default counter of the framerate manager.
+*/
+static Uint64 _defaultCounter(void *userdata)
+{
+	return SDL_GetPerformanceCounter();
+}
+
+/*!
+\brief Default delay of the framerate manager.
+*/
+static void _defaultDelay(void *userdata, Uint32 ms)
+{
+	SDL_Delay(ms);
+}
+
+/*!
+\brief Internal: reads the counter of the framerate manager.
+*/
+static Uint64 _getCount(FPSmanager * manager)
+{
+	return manager->counter(manager->userdata);
+}
+
+/*!
+\brief Internal: returns the counter value of the deadline of the current frame.
+*/
+static Uint64 _targetCount(FPSmanager * manager)
+{
+	return manager->basecount + ((Uint64) manager->framecount * manager->frequency) / manager->rate;
+}
+
+/*!
+\brief Internal: adds a frame time to the rolling history and histogram.
+
+The oldest frame is dropped once FPS_HISTORY_SIZE frames are recorded.
+
+\param manager Pointer to the framerate manager.
+\param us The frame time in microseconds.
+*/
+void _recordFrametime(FPSmanager * manager, Uint32 us)
+{
+	Uint32 bucket;
+
+	if (manager->historycount == FPS_HISTORY_SIZE) {
+		bucket = manager->history[manager->historypos] / FPS_HISTOGRAM_RESOLUTION;
+		if (bucket >= FPS_HISTOGRAM_BUCKETS) {
+			bucket = FPS_HISTOGRAM_BUCKETS - 1;
+		}
+		manager->histogram[bucket]--;
+	} else {
+		manager->historycount++;
+	}
+
+	manager->history[manager->historypos] = us;
+	manager->historypos = (manager->historypos + 1) % FPS_HISTORY_SIZE;
+
+	bucket = us / FPS_HISTOGRAM_RESOLUTION;
+	if (bucket >= FPS_HISTOGRAM_BUCKETS) {
+		bucket = FPS_HISTOGRAM_BUCKETS - 1;
+	}
+	manager->histogram[bucket]++;
+}
+
 /*!
 \brief Initialize the framerate manager.
 
 Initialize the framerate manager, set default framerate of 30Hz and
-reset delay interpolation.
+reset delay interpolation and frame statistics. Timing uses
+SDL_GetPerformanceCounter and SDL_Delay; see SDL_setFramerateClock.
 
 \param manager Pointer to the framerate manager.
 */
@@ -70,6 +135,51 @@ void SDL_initFramerate(FPSmanager * manager)
 	manager->baseticks = _getTicks();
 	manager->lastticks = manager->baseticks;
 
+	manager->counter = _defaultCounter;
+	manager->delay = _defaultDelay;
+	manager->userdata = NULL;
+	manager->frequency = SDL_GetPerformanceFrequency();
+	manager->basecount = _getCount(manager);
+	manager->lastcount = manager->basecount;
+	SDL_resetFramerateStats(manager);
+}
+
+/*!
+\brief Set the clock used by the framerate manager.
+
+Replaces the high resolution counter and delay functions of the manager, for example
+with a simulated clock to test pacing and statistics. The delay function is called
+with 0 to yield while waiting out the last FPS_SPIN_MS of a frame, so a simulated
+clock must advance on either call. Resets delay interpolation and frame statistics.
+
+\param manager Pointer to the framerate manager.
+\param counter The counter function or NULL for SDL_GetPerformanceCounter.
+\param delay The delay function or NULL for SDL_Delay.
+\param frequency The counter frequency in Hz (ignored for the default counter).
+\param userdata Pointer passed to the counter and delay functions.
+
+\return 0 for sucess and -1 for error.
+*/
+int SDL_setFramerateClock(FPSmanager * manager, FPScounter counter, FPSdelay delay, Uint64 frequency, void *userdata)
+{
+	if ((manager == NULL) || ((counter != NULL) && (frequency == 0))) {
+		return (-1);
+	}
+
+	if (manager->baseticks == 0) {
+		SDL_initFramerate(manager);
+	}
+
+	manager->counter = (counter != NULL) ? counter : _defaultCounter;
+	manager->delay = (delay != NULL) ? delay : _defaultDelay;
+	manager->userdata = userdata;
+	manager->frequency = (counter != NULL) ? frequency : SDL_GetPerformanceFrequency();
+	manager->framecount = 0;
+	manager->basecount = _getCount(manager);
+	manager->lastcount = manager->basecount;
+	SDL_resetFramerateStats(manager);
+
+	return (0);
 }
 
 /*!
@@ -89,6 +199,9 @@ int SDL_setFramerate(FPSmanager * manager, Uint32 rate)
 		manager->framecount = 0;
 		manager->rate = rate;
 		manager->rateticks = (1000.0f / (float) rate);
+		if (manager->baseticks != 0) {
+			manager->basecount = manager->lastcount;
+		}
 		return (0);
 	} else {
 		return (-1);
@@ -136,8 +249,11 @@ int SDL_getFramecount(FPSmanager * manager)
 \brief Delay execution to maintain a constant framerate and calculate fps.
 
 Generate a delay to accomodate currently set framerate. Call once in the
-graphics/rendering loop. If the computer cannot keep up with the rate (i.e.
-drawing too slow), the delay is zero and the delay interpolation is reset.
+graphics/rendering loop. The manager sleeps until FPS_SPIN_MS before the
+frame deadline and yields for the remainder, timed with the high resolution
+counter. If the computer cannot keep up with the rate (i.e. drawing too slow),
+the delay is zero, the frame counts as a missed deadline and the delay
+interpolation is reset. Each frame time is added to the frame statistics.
 
 \param manager Pointer to the framerate manager.
 
@@ -145,9 +261,10 @@ drawing too slow), the delay is zero and the delay interpolation is reset.
 */
 Uint32 SDL_framerateDelay(FPSmanager * manager)
 {
-	Uint32 current_ticks;
-	Uint32 target_ticks;
-	Uint32 the_delay;
+	Uint64 current_count;
+	Uint64 target_count;
+	Uint64 frame_count;
+	Uint64 remaining_ms;
 	Uint32 time_passed = 0;
 
 	/*
@@ -170,20 +287,148 @@ Uint32 SDL_framerateDelay(FPSmanager * manager)
 	manager->framecount++;
 
 	/*
-	* Get/calc ticks 
+	* Get/calc counts 
 	*/
-	current_ticks = _getTicks();
-	time_passed = current_ticks - manager->lastticks;
-	manager->lastticks = current_ticks;
-	target_ticks = manager->baseticks + (Uint32) ((float) manager->framecount * manager->rateticks);
-
-	if (current_ticks <= target_ticks) {
-		the_delay = target_ticks - current_ticks;
-		SDL_Delay(the_delay);
+	current_count = _getCount(manager);
+	target_count = _targetCount(manager);
+
+	if (current_count <= target_count) {
+		/*
+		* Sleep coarsely, then yield until the deadline
+		*/
+		remaining_ms = ((target_count - current_count) * 1000) / manager->frequency;
+		if (remaining_ms > FPS_SPIN_MS) {
+			manager->delay(manager->userdata, (Uint32) (remaining_ms - FPS_SPIN_MS));
+		}
+		while (_getCount(manager) < target_count) {
+			manager->delay(manager->userdata, 0);
+		}
 	} else {
+		manager->missed++;
 		manager->framecount = 0;
-		manager->baseticks = _getTicks();
+		manager->basecount = current_count;
 	}
 
+	/*
+	* Frame time since the end of the last call
+	*/
+	current_count = _getCount(manager);
+	frame_count = current_count - manager->lastcount;
+	manager->lastcount = current_count;
+	manager->lastticks = _getTicks();
+	_recordFrametime(manager, (Uint32) SDL_min((frame_count * 1000000) / manager->frequency, 0xffffffffu));
+	time_passed = (Uint32) ((frame_count * 1000) / manager->frequency);
+
 	return time_passed;
 }
+
+/*!
+\brief Return a percentile of the recent frame times.
+
+Looks up the frame time below which the given percentage of the last
+FPS_HISTORY_SIZE frames fall. Results have FPS_HISTOGRAM_RESOLUTION
+accuracy up to the last histogram bucket and are exact above.
+
+\param manager Pointer to the framerate manager.
+\param percentile The percentile (0 to 100), e.g. 50, 95 or 99.
+
+\return The frame time in ms or -1 for error (or no recorded frames).
+*/
+float SDL_getFramePercentile(FPSmanager * manager, float percentile)
+{
+	Uint32 rank, count, bucket, i, j, below, value;
+
+	if ((manager == NULL) || (manager->historycount == 0) || (percentile < 0.0f) || (percentile > 100.0f)) {
+		return (-1.0f);
+	}
+
+	/*
+	* Find the bucket holding the frame of the given rank (1 based)
+	*/
+	rank = (Uint32) SDL_ceil(percentile * (float) manager->historycount / 100.0f);
+	if (rank < 1) {
+		rank = 1;
+	}
+	count = 0;
+	for (bucket = 0; bucket < FPS_HISTOGRAM_BUCKETS - 1; bucket++) {
+		count += manager->histogram[bucket];
+		if (count >= rank) {
+			return (float) ((bucket + 1) * FPS_HISTOGRAM_RESOLUTION) / 1000.0f;
+		}
+	}
+
+	/*
+	* Long frames: select the exact value from the history
+	*/
+	rank -= count;
+	for (i = 0; i < manager->historycount; i++) {
+		value = manager->history[i];
+		if (value < (FPS_HISTOGRAM_BUCKETS - 1) * FPS_HISTOGRAM_RESOLUTION) {
+			continue;
+		}
+		below = 0;
+		for (j = 0; j < manager->historycount; j++) {
+			if ((manager->history[j] >= (FPS_HISTOGRAM_BUCKETS - 1) * FPS_HISTOGRAM_RESOLUTION) &&
+				((manager->history[j] < value) || ((manager->history[j] == value) && (j < i)))) {
+					below++;
+			}
+		}
+		if (below == rank - 1) {
+			return (float) value / 1000.0f;
+		}
+	}
+
+	return (-1.0f);
+}
+
+/*!
+\brief Return the frame statistics of the framerate manager.
+
+Fills in the 50th, 95th and 99th percentile and the maximum of the recent
+frame times (see SDL_getFramePercentile) and the number of missed frame
+deadlines since the statistics were reset.
+
+\param manager Pointer to the framerate manager.
+\param stats Pointer to the statistics to fill in.
+
+\return 0 for sucess and -1 for error.
+*/
+int SDL_getFramerateStats(FPSmanager * manager, FPSstats * stats)
+{
+	if ((manager == NULL) || (stats == NULL)) {
+		return (-1);
+	}
+
+	stats->frames = manager->historycount;
+	stats->missed = manager->missed;
+	if (manager->historycount == 0) {
+		stats->p50 = stats->p95 = stats->p99 = stats->max = 0.0f;
+	} else {
+		stats->p50 = SDL_getFramePercentile(manager, 50.0f);
+		stats->p95 = SDL_getFramePercentile(manager, 95.0f);
+		stats->p99 = SDL_getFramePercentile(manager, 99.0f);
+		stats->max = SDL_getFramePercentile(manager, 100.0f);
+	}
+
+	return (0);
+}
+
+/*!
+\brief Reset the frame statistics of the framerate manager.
+
+Clears the frame time history and the missed deadline count.
+
+\param manager Pointer to the framerate manager.
+*/
+void SDL_resetFramerateStats(FPSmanager * manager)
+{
+	if (manager == NULL) {
+		return;
+	}
+
+	manager->missed = 0;
+	manager->historypos = 0;
+	manager->historycount = 0;
+	SDL_memset(manager->history, 0, sizeof(manager->history));
+	SDL_memset(manager->histogram, 0, sizeof(manager->histogram));
+}
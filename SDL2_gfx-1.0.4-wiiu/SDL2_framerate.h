@@ -56,6 +56,36 @@ extern "C" {
 	*/
 #define FPS_DEFAULT		30
 
+	/*!
+	\brief Number of frames in the rolling frame time history.
+	*/
+#define FPS_HISTORY_SIZE	256
+
+	/*!
+	\brief Number of frame time histogram buckets (the last one collects longer frames).
+	*/
+#define FPS_HISTOGRAM_BUCKETS	256
+
+	/*!
+	\brief Width of a frame time histogram bucket in microseconds.
+	*/
+#define FPS_HISTOGRAM_RESOLUTION	250
+
+	/*!
+	\brief Time in ms before a frame deadline which is waited out by yielding instead of sleeping.
+	*/
+#define FPS_SPIN_MS		2
+
+	/*!
+	\brief Clock function returning a monotonic counter (defaults to SDL_GetPerformanceCounter).
+	*/
+	typedef Uint64 (*FPScounter)(void *userdata);
+
+	/*!
+	\brief Delay function sleeping for ms milliseconds, or yielding for 0 (defaults to SDL_Delay).
+	*/
+	typedef void (*FPSdelay)(void *userdata, Uint32 ms);
+
 	/*! 
 	\brief Structure holding the state and timing information of the framerate controller. 
 	*/
@@ -65,8 +95,31 @@ extern "C" {
 		Uint32 baseticks;
 		Uint32 lastticks;
 		Uint32 rate;
+		FPScounter counter;
+		FPSdelay delay;
+		void *userdata;
+		Uint64 frequency;
+		Uint64 basecount;
+		Uint64 lastcount;
+		Uint32 missed;
+		Uint32 history[FPS_HISTORY_SIZE];
+		Uint32 historypos;
+		Uint32 historycount;
+		Uint16 histogram[FPS_HISTOGRAM_BUCKETS];
 	} FPSmanager;
 
+	/*!
+	\brief Frame time statistics of the framerate controller.
+	*/
+	typedef struct {
+		Uint32 frames;
+		float p50;
+		float p95;
+		float p99;
+		float max;
+		Uint32 missed;
+	} FPSstats;
+
 	/* ---- Function Prototypes */
 
 #ifdef _MSC_VER
@@ -89,6 +142,10 @@ extern "C" {
 	SDL2_FRAMERATE_SCOPE int SDL_getFramerate(FPSmanager * manager);
 	SDL2_FRAMERATE_SCOPE int SDL_getFramecount(FPSmanager * manager);
 	SDL2_FRAMERATE_SCOPE Uint32 SDL_framerateDelay(FPSmanager * manager);
+	SDL2_FRAMERATE_SCOPE int SDL_setFramerateClock(FPSmanager * manager, FPScounter counter, FPSdelay delay, Uint64 frequency, void *userdata);
+	SDL2_FRAMERATE_SCOPE float SDL_getFramePercentile(FPSmanager * manager, float percentile);
+	SDL2_FRAMERATE_SCOPE int SDL_getFramerateStats(FPSmanager * manager, FPSstats * stats);
+	SDL2_FRAMERATE_SCOPE void SDL_resetFramerateStats(FPSmanager * manager);
 
 	/* --- */
 
@@ -32,6 +32,9 @@ Andreas Schiffler -- aschiffler at ferzkopp dot net
 
 Note: Uses inline x86 MMX or ASM optimizations if available and enabled.
 
+Note: Uses portable GCC/clang vector extension routines (16 bytes per step)
+before MMX if available and enabled; they also run on non-x86 targets.
+
 Note: Most of the MMX code is based on published routines 
 by Vladimir Kravtchenko at vk@cs.ubc.ca - credits go to 
 him for his work.
@@ -103,6 +106,95 @@ void SDL_imageFilterMMXon()
 	SDL_imageFilterUseMMX = 1;
 }
 
+/* Detect GCC/clang vector extensions: portable SIMD which also builds on non-x86 targets */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 9))
+#define USE_VECTOR_EXT
+#endif
+
+/* The MMX convolution routines only exist as i386 inline assembly */
+#if defined(USE_MMX) && defined(i386)
+#define SDL_IMAGEFILTER_MMX_CONVOLVE 1
+#else
+#define SDL_IMAGEFILTER_MMX_CONVOLVE 0
+#endif
+
+#ifdef USE_VECTOR_EXT
+typedef unsigned char VecU8x4 __attribute__((vector_size(4)));
+typedef unsigned char VecU8x8 __attribute__((vector_size(8)));
+typedef unsigned char VecU8x16 __attribute__((vector_size(16)));
+typedef unsigned short VecU16x8 __attribute__((vector_size(16)));
+typedef unsigned int VecU32x4 __attribute__((vector_size(16)));
+typedef int VecS32x4 __attribute__((vector_size(16)));
+
+/*!
+\brief Unaligned vector load and store. Compiles to a single vector move where the target has one.
+*/
+#define VEC_LOAD(v, p) memcpy(&(v), (p), sizeof(v))
+#define VEC_STORE(p, v) memcpy((p), &(v), sizeof(v))
+
+/*!
+\brief Clamps 8 words to 255 and narrows them into 8 bytes.
+*/
+#define VEC_PACK_U16_SAT(d, w) do { \
+	(w) |= (VecU16x8)((w) > 255); \
+	(d) = __builtin_convertvector((w), VecU8x8); \
+	} while (0)
+
+/*!
+\brief Clamps 4 ints to the range 0 to 255 and narrows them into 4 bytes.
+*/
+#define VEC_PACK_S32_SAT(d, w) do { \
+	VecS32x4 m_; \
+	(w) &= ~((w) < 0); \
+	m_ = ((w) > 255); \
+	(w) = ((w) & ~m_) | (m_ & 255); \
+	(d) = __builtin_convertvector((w), VecU8x4); \
+	} while (0)
+#endif
+
+/*!
+\brief Static state which enables the use of the vector routines. Enabled by default
+*/
+static int SDL_imageFilterUseSIMD = 1;
+
+/*!
+\brief Vector routine detection (with override flag).
+
+The vector routines are built with the compiler's generic vector extensions and are
+used on any target (e.g. SSE2 on x86, scalarized on CPUs without vector units).
+
+\returns 1 if the vector routines are available, 0 otherwise.
+*/
+int SDL_imageFilterSIMDdetect(void)
+{
+	/* Check override flag */
+	if (SDL_imageFilterUseSIMD == 0) {
+		return (0);
+	}
+
+#ifdef USE_VECTOR_EXT
+	return (1);
+#else
+	return (0);
+#endif
+}
+
+/*!
+\brief Disable the vector routines for filter functions and fall back to MMX or C code.
+*/
+void SDL_imageFilterSIMDoff()
+{
+	SDL_imageFilterUseSIMD = 0;
+}
+
+/*!
+\brief Enable the vector routines for filter functions if available.
+*/
+void SDL_imageFilterSIMDon()
+{
+	SDL_imageFilterUseSIMD = 1;
+}
+
 /* ------------------------------------------------------------------------------------ */
 
 /*!
@@ -160,6 +252,38 @@ L1010:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using Add: D = saturation255(S1 + S2)
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterAddSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = a + b;
+		d |= (VecU8x16)(d < a);	/* saturate lanes which wrapped around */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using Add: D = saturation255(S1 + S2) 
 
@@ -182,7 +306,23 @@ int SDL_imageFilterAdd(unsigned char *Src1, unsigned char *Src2, unsigned char *
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterAddSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* Use MMX assembly routine */
 		SDL_imageFilterAddMMX(Src1, Src2, Dest, length);
@@ -295,6 +435,37 @@ L21011:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using Mean: D = S1/2 + S2/2
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMeanSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = (a >> 1) + (b >> 1);
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using Mean: D = S1/2 + S2/2
 
@@ -318,7 +489,23 @@ int SDL_imageFilterMean(unsigned char *Src1, unsigned char *Src2, unsigned char
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMeanSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterMeanMMX(Src1, Src2, Dest, length, Mask);
 
@@ -409,6 +596,37 @@ L1012:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using Sub: D = saturation0(S1 - S2)
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterSubSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = (a - b) & (VecU8x16)(a >= b);	/* zero lanes which would underflow */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using Sub: D = saturation0(S1 - S2)
 
@@ -431,7 +649,23 @@ int SDL_imageFilterSub(unsigned char *Src1, unsigned char *Src2, unsigned char *
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterSubSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterSubMMX(Src1, Src2, Dest, length);
 
@@ -529,6 +763,38 @@ L1013:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using AbsDiff: D = | S1 - S2 |
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterAbsDiffSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, m, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		m = (VecU8x16)(a > b);
+		d = ((a & m) | (b & ~m)) - ((b & m) | (a & ~m));	/* max - min */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using AbsDiff: D = | S1 - S2 |
 
@@ -551,7 +817,23 @@ int SDL_imageFilterAbsDiff(unsigned char *Src1, unsigned char *Src2, unsigned ch
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterAbsDiffSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterAbsDiffMMX(Src1, Src2, Dest, length);
 
@@ -716,6 +998,41 @@ L1014:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using Mult: D = saturation255(S1 * S2)
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMultSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, b8, d8;
+	VecU16x8 a, b, w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		VEC_LOAD(b8, Src2);
+		a = __builtin_convertvector(a8, VecU16x8);
+		b = __builtin_convertvector(b8, VecU16x8);
+		w = a * b;
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Src2 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using Mult: D = saturation255(S1 * S2)
 
@@ -738,7 +1055,23 @@ int SDL_imageFilterMult(unsigned char *Src1, unsigned char *Src2, unsigned char
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMultSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterMultMMX(Src1, Src2, Dest, length);
 
@@ -849,6 +1182,37 @@ L10141:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using MultNor: D = S1 * S2
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMultNorSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = a * b;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using MultNor: D = S1 * S2
 
@@ -870,7 +1234,23 @@ int SDL_imageFilterMultNor(unsigned char *Src1, unsigned char *Src2, unsigned ch
 	if (length == 0)
 		return(0);
 
-	if (SDL_imageFilterMMXdetect()) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMultNorSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if (SDL_imageFilterMMXdetect()) {
 		if (length > 0) {
 			/* ASM routine */
 			SDL_imageFilterMultNorASM(Src1, Src2, Dest, length);
@@ -987,6 +1367,41 @@ L1015:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using MultDivby2: D = saturation255(S1/2 * S2)
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMultDivby2SIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, b8, d8;
+	VecU16x8 a, b, w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		VEC_LOAD(b8, Src2);
+		a = __builtin_convertvector(a8, VecU16x8);
+		b = __builtin_convertvector(b8, VecU16x8);
+		w = (a >> 1) * b;
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Src2 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using MultDivby2: D = saturation255(S1/2 * S2)
 
@@ -1009,7 +1424,23 @@ int SDL_imageFilterMultDivby2(unsigned char *Src1, unsigned char *Src2, unsigned
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMultDivby2SIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterMultDivby2MMX(Src1, Src2, Dest, length);
 
@@ -1128,6 +1559,41 @@ L1016:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using MultDivby4: D = saturation255(S1/2 * S2/2)
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMultDivby4SIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, b8, d8;
+	VecU16x8 a, b, w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		VEC_LOAD(b8, Src2);
+		a = __builtin_convertvector(a8, VecU16x8);
+		b = __builtin_convertvector(b8, VecU16x8);
+		w = (a >> 1) * (b >> 1);
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Src2 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using MultDivby4: D = saturation255(S1/2 * S2/2)
 
@@ -1150,7 +1616,23 @@ int SDL_imageFilterMultDivby4(unsigned char *Src1, unsigned char *Src2, unsigned
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMultDivby4SIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterMultDivby4MMX(Src1, Src2, Dest, length);
 
@@ -1265,6 +1747,37 @@ L1017:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using BitAnd: D = S1 & S2
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterBitAndSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = a & b;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using BitAnd: D = S1 & S2
 
@@ -1286,7 +1799,23 @@ int SDL_imageFilterBitAnd(unsigned char *Src1, unsigned char *Src2, unsigned cha
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()>0) && (length>7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterBitAndSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()>0) && (length>7)) {
 		/*  if (length > 7) { */
 		/* Call MMX routine */
 
@@ -1379,6 +1908,37 @@ L91017:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using BitOr: D = S1 | S2
+
+\param Src1 Pointer to the start of the first source byte array (S1).
+\param Src2 Pointer to the start of the second source byte array (S2).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source arrays.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterBitOrSIMD(unsigned char *Src1, unsigned char *Src2, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, b, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		VEC_LOAD(b, Src2);
+		d = a | b;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Src2 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using BitOr: D = S1 | S2
 
@@ -1400,7 +1960,23 @@ int SDL_imageFilterBitOr(unsigned char *Src1, unsigned char *Src2, unsigned char
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterBitOrSIMD(Src1, Src2, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			cursrc2 = &Src2[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		SDL_imageFilterBitOrMMX(Src1, Src2, Dest, length);
@@ -1659,6 +2235,34 @@ L91117:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using BitNegation: D = !S
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterBitNegationSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = ~a;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using BitNegation: D = !S
 
@@ -1679,7 +2283,22 @@ int SDL_imageFilterBitNegation(unsigned char *Src1, unsigned char *Dest, unsigne
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterBitNegationSIMD(Src1, Dest, length);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdst = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 		/* MMX routine */
 		SDL_imageFilterBitNegationMMX(Src1, Dest, length);
 
@@ -1777,6 +2396,36 @@ L1021:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using AddByte: D = saturation255(S + C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant value to add (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterAddByteSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = a + C;
+		d |= (VecU8x16)(d < a);	/* saturate lanes which wrapped around */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using AddByte: D = saturation255(S + C) 
 
@@ -1807,7 +2456,22 @@ int SDL_imageFilterAddByte(unsigned char *Src1, unsigned char *Dest, unsigned in
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterAddByteSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		SDL_imageFilterAddByteMMX(Src1, Dest, length, C);
@@ -1906,6 +2570,41 @@ L11023:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using AddUint: D = saturation255((S[i] + Cs[i % 4]), Cs=Swap32((uint)C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant to add (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterAddUintSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned int C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, c, d;
+	unsigned int i;
+
+	/* Repeat the 4 constant bytes across the vector, in the order the C routine uses them */
+	for (i = 0; i < 16; i++) {
+		c[i] = (unsigned char) ((C >> (8 * (i & 3))) & 0xff);
+	}
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = a + c;
+		d |= (VecU8x16)(d < a);	/* saturate lanes which wrapped around */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using AddUint: D = saturation255((S[i] + Cs[i % 4]), Cs=Swap32((uint)C)
 
@@ -1936,7 +2635,22 @@ int SDL_imageFilterAddUint(unsigned char *Src1, unsigned char *Dest, unsigned in
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterAddUintSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		D=SWAP_32(C);
@@ -2055,6 +2769,37 @@ L1022:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using AddByteToHalf: D = saturation255(S/2 + C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant to add (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterAddByteToHalfSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, h, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		h = a >> 1;
+		d = h + C;
+		d |= (VecU8x16)(d < h);	/* saturate lanes which wrapped around */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using AddByteToHalf: D = saturation255(S/2 + C)
 
@@ -2080,7 +2825,22 @@ int SDL_imageFilterAddByteToHalf(unsigned char *Src1, unsigned char *Dest, unsig
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterAddByteToHalfSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		SDL_imageFilterAddByteToHalfMMX(Src1, Dest, length, C, Mask);
@@ -2183,6 +2943,35 @@ L1023:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using SubByte: D = saturation0(S - C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant to subtract (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterSubByteSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = (a - C) & (VecU8x16)(a >= C);	/* zero lanes which would underflow */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using SubByte: D = saturation0(S - C)
 
@@ -2213,7 +3002,22 @@ int SDL_imageFilterSubByte(unsigned char *Src1, unsigned char *Dest, unsigned in
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterSubByteSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		SDL_imageFilterSubByteMMX(Src1, Dest, length, C);
@@ -2312,6 +3116,40 @@ L11024:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using SubUint: D = saturation0(S[i] - Cs[i % 4]), Cs=Swap32((uint)C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant to subtract (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterSubUintSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned int C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, c, d;
+	unsigned int i;
+
+	/* Repeat the 4 constant bytes across the vector, in the order the C routine uses them */
+	for (i = 0; i < 16; i++) {
+		c[i] = (unsigned char) ((C >> (8 * (i & 3))) & 0xff);
+	}
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = (a - c) & (VecU8x16)(a >= c);	/* zero lanes which would underflow */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using SubUint: D = saturation0(S[i] - Cs[i % 4]), Cs=Swap32((uint)C)
 
@@ -2342,7 +3180,22 @@ int SDL_imageFilterSubUint(unsigned char *Src1, unsigned char *Dest, unsigned in
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterSubUintSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		D=SWAP_32(C);
@@ -2463,6 +3316,37 @@ L10241:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftRight: D = saturation0(S >> N)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 8.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftRightSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned char n = (N > 7) ? 7 : N;
+	unsigned char m = (N > 7) ? 0 : 0xff;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = (a >> n) & m;	/* shifting out all 8 bits yields 0 */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ShiftRight: D = saturation0(S >> N)
 
@@ -2497,7 +3381,22 @@ int SDL_imageFilterShiftRight(unsigned char *Src1, unsigned char *Dest, unsigned
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftRightSIMD(Src1, Dest, length, N);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		/* MMX routine */
 		SDL_imageFilterShiftRightMMX(Src1, Dest, length, N, Mask);
@@ -2581,6 +3480,35 @@ L13023:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftRightUint: D = saturation0((uint)S[i] >> N)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 32.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftRightUintSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N)
+{
+#ifdef USE_VECTOR_EXT
+	VecU32x4 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = a >> N;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ShiftRightUint: D = saturation0((uint)S[i] >> N)
 
@@ -2614,7 +3542,22 @@ int SDL_imageFilterShiftRightUint(unsigned char *Src1, unsigned char *Dest, unsi
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftRightUintSIMD(Src1, Dest, length, N);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterShiftRightUintMMX(Src1, Dest, length, N);
 
@@ -2777,6 +3720,38 @@ L10252:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using MultByByte: D = saturation255(S * C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param C Constant to multiply with (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterMultByByteSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, d8;
+	VecU16x8 w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		w = __builtin_convertvector(a8, VecU16x8);
+		w = w * C;
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using MultByByte: D = saturation255(S * C)
 
@@ -2807,7 +3782,22 @@ int SDL_imageFilterMultByByte(unsigned char *Src1, unsigned char *Dest, unsigned
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterMultByByteSIMD(Src1, Dest, length, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterMultByByteMMX(Src1, Dest, length, C);
 
@@ -2929,6 +3919,40 @@ L1026:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftRightAndMultByByte: D = saturation255((S >> N) * C)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 8.
+\param C Constant to multiply with (C).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftRightAndMultByByteSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N,
+											  unsigned char C)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, d8;
+	VecU16x8 w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		w = __builtin_convertvector(a8, VecU16x8);
+		w = (w >> N) * C;
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ShiftRightAndMultByByte: D = saturation255((S >> N) * C) 
 
@@ -2966,7 +3990,22 @@ int SDL_imageFilterShiftRightAndMultByByte(unsigned char *Src1, unsigned char *D
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftRightAndMultByByteSIMD(Src1, Dest, length, N, C);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterShiftRightAndMultByByteMMX(Src1, Dest, length, N, C);
 
@@ -3080,6 +4119,37 @@ L10271:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftLeftByte: D = (S << N)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 8.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftLeftByteSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned char n = (N > 7) ? 7 : N;
+	unsigned char m = (N > 7) ? 0 : 0xff;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = (a << n) & m;	/* shifting out all 8 bits yields 0 */
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ShiftLeftByte: D = (S << N)
 
@@ -3113,7 +4183,22 @@ int SDL_imageFilterShiftLeftByte(unsigned char *Src1, unsigned char *Dest, unsig
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftLeftByteSIMD(Src1, Dest, length, N);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterShiftLeftByteMMX(Src1, Dest, length, N, Mask);
 
@@ -3197,6 +4282,35 @@ L12023:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftLeftUint: D = ((uint)S << N)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 32.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftLeftUintSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N)
+{
+#ifdef USE_VECTOR_EXT
+	VecU32x4 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = a << N;
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ShiftLeftUint: D = ((uint)S << N)
 
@@ -3230,7 +4344,22 @@ int SDL_imageFilterShiftLeftUint(unsigned char *Src1, unsigned char *Dest, unsig
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftLeftUintSIMD(Src1, Dest, length, N);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterShiftLeftUintMMX(Src1, Dest, length, N);
 
@@ -3380,6 +4509,38 @@ L10282:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ShiftLeft: D = saturation255(S << N)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param N Number of bit-positions to shift (N). Valid range is 0 to 8.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterShiftLeftSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char N)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x8 a8, d8;
+	VecU16x8 w;
+	unsigned int i;
+
+	for (i = 0; i < (SrcLength/16)*2; i++) {
+		VEC_LOAD(a8, Src1);
+		w = __builtin_convertvector(a8, VecU16x8);
+		w = w << N;
+		VEC_PACK_U16_SAT(d8, w);
+		VEC_STORE(Dest, d8);
+		Src1 += 8;
+		Dest += 8;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter ShiftLeft: D = saturation255(S << N)
 
@@ -3412,7 +4573,22 @@ int SDL_imageFilterShiftLeft(unsigned char *Src1, unsigned char *Dest, unsigned
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterShiftLeftSIMD(Src1, Dest, length, N);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterShiftLeftMMX(Src1, Dest, length, N);
 
@@ -3521,6 +4697,35 @@ L1029:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using BinarizeUsingThreshold: D = (S >= T) ? 255:0
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param T The threshold boundary (inclusive).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterBinarizeUsingThresholdSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char T)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		d = (VecU8x16)(a >= T);
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using BinarizeUsingThreshold: D = (S >= T) ? 255:0
 
@@ -3549,7 +4754,22 @@ int SDL_imageFilterBinarizeUsingThreshold(unsigned char *Src1, unsigned char *De
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterBinarizeUsingThresholdSIMD(Src1, Dest, length, T);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterBinarizeUsingThresholdMMX(Src1, Dest, length, T);
 
@@ -3677,6 +4897,40 @@ L1030:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using ClipToRange: D = (S >= Tmin) & (S <= Tmax) S:Tmin | Tmax
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param Tmin Lower (inclusive) boundary of the clipping range.
+\param Tmax Upper (inclusive) boundary of the clipping range.
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterClipToRangeSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, unsigned char Tmin,
+									  unsigned char Tmax)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x16 a, m, d;
+	unsigned int i;
+
+	for (i = 0; i < SrcLength/16; i++) {
+		VEC_LOAD(a, Src1);
+		m = (VecU8x16)(a > Tmax);
+		d = (a & ~m) | (m & Tmax);
+		m = (VecU8x16)(a < Tmin);
+		d = (d & ~m) | (m & Tmin);
+		VEC_STORE(Dest, d);
+		Src1 += 16;
+		Dest += 16;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using ClipToRange: D = (S >= Tmin) & (S <= Tmax) S:Tmin | Tmax
 
@@ -3707,7 +4961,22 @@ int SDL_imageFilterClipToRange(unsigned char *Src1, unsigned char *Dest, unsigne
 		return (0); 
 	}
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterClipToRangeSIMD(Src1, Dest, length, Tmin, Tmax);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc1 = &Src1[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterClipToRangeMMX(Src1, Dest, length, Tmin, Tmax);
 
@@ -3893,6 +5162,50 @@ L1031:
 #endif
 }
 
+/*!
+\brief Internal vector Filter using NormalizeLinear: D = saturation255((Nmax - Nmin)/(Cmax - Cmin)*(S - Cmin) + Nmin)
+
+\param Src1 Pointer to the start of the source byte array (S).
+\param Dest Pointer to the start of the destination byte array (D).
+\param SrcLength The number of bytes in the source array.
+\param Cmin Normalization constant (Cmin).
+\param Cmax Normalization constant (Cmax).
+\param Nmin Normalization constant (Nmin).
+\param Nmax Normalization constant (Nmax).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterNormalizeLinearSIMD(unsigned char *Src1, unsigned char *Dest, unsigned int SrcLength, int Cmin, int Cmax,
+										  int Nmin, int Nmax)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x4 a, d;
+	VecS32x4 w, m;
+	int dC, factor;
+	unsigned int i;
+
+	dC = Cmax - Cmin;
+	if (dC == 0)
+		return (0);
+	factor = (Nmax - Nmin) / dC;
+
+	for (i = 0; i < (SrcLength/16)*4; i++) {
+		VEC_LOAD(a, Src1);
+		w = __builtin_convertvector(a, VecS32x4);
+		w = factor * (w - Cmin) + Nmin;
+		m = (w > 255);
+		w = (w & ~m) | (m & 255);
+		d = __builtin_convertvector(w, VecU8x4);	/* truncate like the C routine */
+		VEC_STORE(Dest, d);
+		Src1 += 4;
+		Dest += 4;
+	}
+	return (0);
+#else
+	return (-1);
+#endif
+}
+
 /*!
 \brief Filter using NormalizeLinear: D = saturation255((Nmax - Nmin)/(Cmax - Cmin)*(S - Cmin) + Nmin)
 
@@ -3921,7 +5234,22 @@ int SDL_imageFilterNormalizeLinear(unsigned char *Src, unsigned char *Dest, unsi
 	if (length == 0)
 		return(0);
 
-	if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
+	if ((SDL_imageFilterSIMDdetect()) && (length > 15)) {
+
+		/* Vector routine */
+		SDL_imageFilterNormalizeLinearSIMD(Src, Dest, length, Cmin, Cmax, Nmin, Nmax);
+
+		/* Check for unaligned bytes */
+		if ((length & 15) > 0) {
+			/* Setup to process unaligned bytes */
+			istart = length & 0xfffffff0;
+			cursrc = &Src[istart];
+			curdest = &Dest[istart];
+		} else {
+			/* No unaligned bytes - we are done */
+			return (0);
+		}
+	} else if ((SDL_imageFilterMMXdetect()) && (length > 7)) {
 
 		SDL_imageFilterNormalizeLinearMMX(Src, Dest, length, Cmin, Cmax, Nmin, Nmax);
 
@@ -3963,6 +5291,241 @@ int SDL_imageFilterNormalizeLinear(unsigned char *Src, unsigned char *Dest, unsi
 
 /* ------------------------------------------------------------------------------------ */
 
+/*!
+\brief Internal helper which splits a convolution kernel into a vertical and a horizontal 1D kernel.
+
+A kernel K is separable if K[r][c] * K[p][q] == K[r][q] * K[p][c] for a pivot element K[p][q] != 0.
+Then K[r][c] * K[p][q] == Vertical[r] * Horizontal[c] with Vertical[r] = K[r][q] and
+Horizontal[c] = K[p][c], so the 2D sum can be computed with two 1D passes and one exact
+division by K[p][q].
+
+\param Kernel The 2D convolution kernel, stored row by row.
+\param KernelStride The number of shorts between two kernel rows.
+\param KernelSize The width and height of the kernel.
+\param Vertical The vertical 1D kernel (output).
+\param Horizontal The horizontal 1D kernel (output).
+\param Scale The pivot element to divide the separable sum by (output).
+
+\return Returns 1 if the kernel is separable without overflowing 32bit sums, 0 otherwise.
+*/
+static int SDL_imageFilterSeparateKernel(signed short *Kernel, int KernelStride, int KernelSize,
+										 int *Vertical, int *Horizontal, int *Scale)
+{
+	int r, c, p, q, pivot;
+	Sint64 vsum, hsum;
+
+	/* Find the first non-zero element as pivot */
+	pivot = 0;
+	p = q = 0;
+	for (r = 0; (r < KernelSize) && (pivot == 0); r++) {
+		for (c = 0; c < KernelSize; c++) {
+			if (Kernel[r * KernelStride + c] != 0) {
+				p = r;
+				q = c;
+				pivot = Kernel[r * KernelStride + c];
+				break;
+			}
+		}
+	}
+	if (pivot == 0)
+		return (0);
+
+	/* Check for rank 1 */
+	for (r = 0; r < KernelSize; r++) {
+		for (c = 0; c < KernelSize; c++) {
+			if ((int) Kernel[r * KernelStride + c] * pivot !=
+				(int) Kernel[r * KernelStride + q] * (int) Kernel[p * KernelStride + c]) {
+				return (0);
+			}
+		}
+	}
+
+	vsum = hsum = 0;
+	for (r = 0; r < KernelSize; r++) {
+		Vertical[r] = Kernel[r * KernelStride + q];
+		Horizontal[r] = Kernel[p * KernelStride + r];
+		vsum += SDL_abs(Vertical[r]);
+		hsum += SDL_abs(Horizontal[r]);
+	}
+	*Scale = pivot;
+
+	/* The separable sum is Scale times larger than the direct sum, check it fits */
+	return ((vsum * hsum * 255) < 0x7fffffff);
+}
+
+/*!
+\brief Internal helper which turns a convolution sum into an output byte.
+
+\param sum The convolution sum.
+\param Divisor The divisor of the convolution sum.
+\param Absolute Use the absolute value of the sum instead of dividing it.
+
+\return Returns the sum saturated to the range 0 to 255.
+*/
+static unsigned char SDL_imageFilterConvolveResult(int sum, int Divisor, int Absolute)
+{
+	if (Absolute) {
+		sum = SDL_abs(sum);
+	} else {
+		sum = sum / Divisor;
+	}
+	if (sum < 0)
+		return (0);
+	if (sum > 255)
+		return (255);
+	return ((unsigned char) sum);
+}
+
+/*!
+\brief Internal convolution routine used when the MMX routines are not selected.
+
+Convolves the inner region of the image; the border of KernelSize/2 pixels in Dest is not
+modified. Separable kernels (box, binomial/Gaussian, Sobel, ...) run as a vertical pass over
+each source row block into a row buffer followed by a horizontal pass over that buffer,
+which needs 2*KernelSize instead of KernelSize*KernelSize multiplications per pixel. Other
+kernels are applied directly. Both forms use the vector routines (4 pixels per step) if
+enabled, and sums are accumulated in 32bit.
+
+\param Src The source 2D byte array to convolve. Should be different from destination.
+\param Dest The destination 2D byte array to store the result in. Should be different from source.
+\param rows Number of rows in source/destination array.
+\param columns Number of columns in source/destination array.
+\param Kernel The 2D convolution kernel, stored row by row.
+\param KernelStride The number of shorts between two kernel rows.
+\param KernelSize The width and height of the kernel (3, 5, 7 or 9).
+\param Divisor The divisor of the convolution sum. Must be >0.
+\param NRightShift The number of right bit shifts to apply to each source pixel.
+\param Absolute Store the absolute value of the sum instead of dividing it (used by Sobel).
+
+\return Returns 0 for success or -1 for error.
+*/
+static int SDL_imageFilterConvolve(unsigned char *Src, unsigned char *Dest, int rows, int columns,
+								   signed short *Kernel, int KernelStride, int KernelSize,
+								   unsigned char Divisor, unsigned char NRightShift, int Absolute)
+{
+	int half = KernelSize / 2;
+	int vertical[9], horizontal[9];
+	int scale = 1;
+	int separable;
+	int useSIMD = SDL_imageFilterSIMDdetect();
+	int x, y, r, c, sum;
+	int *rowsum = NULL;
+	unsigned char *srow, *drow;
+
+	separable = SDL_imageFilterSeparateKernel(Kernel, KernelStride, KernelSize, vertical, horizontal, &scale);
+	if (separable) {
+		rowsum = (int *) malloc(columns * sizeof(int));
+		if (rowsum == NULL)
+			return (-1);
+	}
+
+	for (y = half; y < rows - half; y++) {
+		srow = Src + (y - half) * columns;
+		drow = Dest + y * columns;
+		x = 0;
+
+		if (separable) {
+			/* Vertical pass: rowsum[x] = sum over the rows of the block */
+#ifdef USE_VECTOR_EXT
+			if (useSIMD) {
+				VecU8x4 p;
+				VecS32x4 acc, v;
+				for (; x + 4 <= columns; x += 4) {
+					acc = (VecS32x4) { 0, 0, 0, 0 };
+					for (r = 0; r < KernelSize; r++) {
+						VEC_LOAD(p, srow + r * columns + x);
+						v = __builtin_convertvector(p, VecS32x4) >> NRightShift;
+						acc += v * vertical[r];
+					}
+					VEC_STORE(rowsum + x, acc);
+				}
+			}
+#endif
+			for (; x < columns; x++) {
+				sum = 0;
+				for (r = 0; r < KernelSize; r++) {
+					sum += (srow[r * columns + x] >> NRightShift) * vertical[r];
+				}
+				rowsum[x] = sum;
+			}
+
+			/* Horizontal pass over the row buffer */
+			x = half;
+#ifdef USE_VECTOR_EXT
+			if (useSIMD) {
+				VecU8x4 d;
+				VecS32x4 acc, v;
+				for (; x + 4 <= columns - half; x += 4) {
+					acc = (VecS32x4) { 0, 0, 0, 0 };
+					for (c = 0; c < KernelSize; c++) {
+						VEC_LOAD(v, rowsum + x - half + c);
+						acc += v * horizontal[c];
+					}
+					if (scale != 1)
+						acc /= scale;
+					if (Absolute) {
+						v = (acc < 0);
+						acc = (acc ^ v) - v;
+					} else if (Divisor != 1) {
+						acc /= (int) Divisor;
+					}
+					VEC_PACK_S32_SAT(d, acc);
+					VEC_STORE(drow + x, d);
+				}
+			}
+#endif
+			for (; x < columns - half; x++) {
+				sum = 0;
+				for (c = 0; c < KernelSize; c++) {
+					sum += rowsum[x - half + c] * horizontal[c];
+				}
+				drow[x] = SDL_imageFilterConvolveResult(sum / scale, Divisor, Absolute);
+			}
+		} else {
+			/* Direct form */
+			x = half;
+#ifdef USE_VECTOR_EXT
+			if (useSIMD) {
+				VecU8x4 p, d;
+				VecS32x4 acc, v;
+				for (; x + 4 <= columns - half; x += 4) {
+					acc = (VecS32x4) { 0, 0, 0, 0 };
+					for (r = 0; r < KernelSize; r++) {
+						for (c = 0; c < KernelSize; c++) {
+							VEC_LOAD(p, srow + r * columns + x - half + c);
+							v = __builtin_convertvector(p, VecS32x4) >> NRightShift;
+							acc += v * (int) Kernel[r * KernelStride + c];
+						}
+					}
+					if (Absolute) {
+						v = (acc < 0);
+						acc = (acc ^ v) - v;
+					} else if (Divisor != 1) {
+						acc /= (int) Divisor;
+					}
+					VEC_PACK_S32_SAT(d, acc);
+					VEC_STORE(drow + x, d);
+				}
+			}
+#endif
+			for (; x < columns - half; x++) {
+				sum = 0;
+				for (r = 0; r < KernelSize; r++) {
+					for (c = 0; c < KernelSize; c++) {
+						sum += (srow[r * columns + x - half + c] >> NRightShift) * Kernel[r * KernelStride + c];
+					}
+				}
+				drow[x] = SDL_imageFilterConvolveResult(sum, Divisor, Absolute);
+			}
+		}
+	}
+
+	if (rowsum != NULL)
+		free(rowsum);
+
+	return (0);
+}
+
 /*!
 \brief Filter using ConvolveKernel3x3Divide: Dij = saturation0and255( ... ) 
 
@@ -3970,10 +5533,10 @@ int SDL_imageFilterNormalizeLinear(unsigned char *Src, unsigned char *Dest, unsi
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >2.
 \param columns Number of columns in source/destination array. Must be >2.
-\param Kernel The 2D convolution kernel of size 3x3.
+\param Kernel The 2D convolution kernel of size 3x3, each row padded to 4 shorts.
 \param Divisor The divisor of the convolution sum. Must be >0.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -3987,6 +5550,11 @@ int SDL_imageFilterConvolveKernel3x3Divide(unsigned char *Src, unsigned char *De
 	if ((columns < 3) || (rows < 3) || (Divisor == 0))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 4, 3, Divisor, 0, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -4148,7 +5716,7 @@ L10322:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -4160,10 +5728,10 @@ L10322:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >4.
 \param columns Number of columns in source/destination array. Must be >4.
-\param Kernel The 2D convolution kernel of size 5x5.
+\param Kernel The 2D convolution kernel of size 5x5, each row padded to 8 shorts.
 \param Divisor The divisor of the convolution sum. Must be >0.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -4177,6 +5745,11 @@ int SDL_imageFilterConvolveKernel5x5Divide(unsigned char *Src, unsigned char *De
 	if ((columns < 5) || (rows < 5) || (Divisor == 0))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 8, 5, Divisor, 0, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -4451,7 +6024,7 @@ L10332:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -4463,10 +6036,10 @@ L10332:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >6.
 \param columns Number of columns in source/destination array. Must be >6.
-\param Kernel The 2D convolution kernel of size 7x7.
+\param Kernel The 2D convolution kernel of size 7x7, each row padded to 8 shorts.
 \param Divisor The divisor of the convolution sum. Must be >0.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -4480,6 +6053,11 @@ int SDL_imageFilterConvolveKernel7x7Divide(unsigned char *Src, unsigned char *De
 	if ((columns < 7) || (rows < 7) || (Divisor == 0))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 8, 7, Divisor, 0, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -4808,7 +6386,7 @@ L10342:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -4820,10 +6398,10 @@ L10342:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >8.
 \param columns Number of columns in source/destination array. Must be >8.
-\param Kernel The 2D convolution kernel of size 9x9.
+\param Kernel The 2D convolution kernel of size 9x9, each row padded to 12 shorts.
 \param Divisor The divisor of the convolution sum. Must be >0.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -4837,6 +6415,11 @@ int SDL_imageFilterConvolveKernel9x9Divide(unsigned char *Src, unsigned char *De
 	if ((columns < 9) || (rows < 9) || (Divisor == 0))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 12, 9, Divisor, 0, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -5356,7 +6939,7 @@ L10352:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -5368,10 +6951,10 @@ L10352:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >2.
 \param columns Number of columns in source/destination array. Must be >2.
-\param Kernel The 2D convolution kernel of size 3x3.
+\param Kernel The 2D convolution kernel of size 3x3, each row padded to 4 shorts.
 \param NRightShift The number of right bit shifts to apply to the convolution sum. Must be <7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -5385,6 +6968,11 @@ int SDL_imageFilterConvolveKernel3x3ShiftRight(unsigned char *Src, unsigned char
 	if ((columns < 3) || (rows < 3) || (NRightShift > 7))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 4, 3, 1, NRightShift, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -5533,7 +7121,7 @@ L10362:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -5545,10 +7133,10 @@ L10362:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >4.
 \param columns Number of columns in source/destination array. Must be >4.
-\param Kernel The 2D convolution kernel of size 5x5.
+\param Kernel The 2D convolution kernel of size 5x5, each row padded to 8 shorts.
 \param NRightShift The number of right bit shifts to apply to the convolution sum. Must be <7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -5562,6 +7150,11 @@ int SDL_imageFilterConvolveKernel5x5ShiftRight(unsigned char *Src, unsigned char
 	if ((columns < 5) || (rows < 5) || (NRightShift > 7))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 8, 5, 1, NRightShift, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -5834,7 +7427,7 @@ L10372:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -5846,10 +7439,10 @@ L10372:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >6.
 \param columns Number of columns in source/destination array. Must be >6.
-\param Kernel The 2D convolution kernel of size 7x7.
+\param Kernel The 2D convolution kernel of size 7x7, each row padded to 8 shorts.
 \param NRightShift The number of right bit shifts to apply to the convolution sum. Must be <7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -5863,6 +7456,11 @@ int SDL_imageFilterConvolveKernel7x7ShiftRight(unsigned char *Src, unsigned char
 	if ((columns < 7) || (rows < 7) || (NRightShift > 7))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 8, 7, 1, NRightShift, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -6197,7 +7795,7 @@ L10382:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -6209,10 +7807,10 @@ L10382:
 \param Dest The destination 2D byte array to store the result in. Should be different from source.
 \param rows Number of rows in source/destination array. Must be >8.
 \param columns Number of columns in source/destination array. Must be >8.
-\param Kernel The 2D convolution kernel of size 9x9.
+\param Kernel The 2D convolution kernel of size 9x9, each row padded to 12 shorts.
 \param NRightShift The number of right bit shifts to apply to the convolution sum. Must be <7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
@@ -6226,6 +7824,11 @@ int SDL_imageFilterConvolveKernel9x9ShiftRight(unsigned char *Src, unsigned char
 	if ((columns < 9) || (rows < 9) || (NRightShift > 7))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, Kernel, 12, 9, 1, NRightShift, 0));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -6777,7 +8380,7 @@ L10392:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -6792,12 +8395,14 @@ L10392:
 \param rows Number of rows in source/destination array. Must be >2.
 \param columns Number of columns in source/destination array. Must be >7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
 int SDL_imageFilterSobelX(unsigned char *Src, unsigned char *Dest, int rows, int columns)
 {
+	static signed short SobelKernel[12] = { -1, 0, 1, 0, -2, 0, 2, 0, -1, 0, 1, 0 };
+
 	/* Validate input parameters */
 	if ((Src == NULL) || (Dest == NULL))
 		return(-1);
@@ -6805,6 +8410,11 @@ int SDL_imageFilterSobelX(unsigned char *Src, unsigned char *Dest, int rows, int
 	if ((columns < 8) || (rows < 3))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, SobelKernel, 4, 3, 1, 0, 1));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -7031,7 +8641,7 @@ L10402:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -7045,19 +8655,26 @@ L10402:
 \param columns Number of columns in source/destination array. Must be >8.
 \param NRightShift The number of right bit shifts to apply to the filter sum. Must be <7.
 
-Note: Non-MMX implementation not available for this function.
+Note: Uses the portable vector or C routine unless MMX is selected and vector routines are off.
 
 \return Returns 1 if filter was applied, 0 otherwise.
 */
 int SDL_imageFilterSobelXShiftRight(unsigned char *Src, unsigned char *Dest, int rows, int columns,
 									unsigned char NRightShift)
 {
+	static signed short SobelKernel[12] = { -1, 0, 1, 0, -2, 0, 2, 0, -1, 0, 1, 0 };
+
 	/* Validate input parameters */
 	if ((Src == NULL) || (Dest == NULL))
 		return(-1);
 	if ((columns < 8) || (rows < 3) || (NRightShift > 7))
 		return (-1);
 
+	/* Use the portable vector/C routine unless the MMX routine is selected */
+	if ((SDL_imageFilterSIMDdetect()) || (!SDL_IMAGEFILTER_MMX_CONVOLVE) || (!SDL_imageFilterMMXdetect())) {
+		return (SDL_imageFilterConvolve(Src, Dest, rows, columns, SobelKernel, 4, 3, 1, NRightShift, 1));
+	}
+
 	if ((SDL_imageFilterMMXdetect())) {
 //#ifdef USE_MMX
 #if defined(USE_MMX) && defined(i386)
@@ -7315,7 +8932,7 @@ L10412:
 #endif
 		return (0);
 	} else {
-		/* No non-MMX implementation yet */
+		/* Not reached, the portable routine handles this case */
 		return (-1);
 	}
 }
@@ -53,7 +53,9 @@ extern "C" {
 	/* Comments:                                                                           */
 	/*  1.) MMX functions work best if all data blocks are aligned on a 32 bytes boundary. */
 	/*  2.) Data that is not within an 8 byte boundary is processed using the C routine.   */
-	/*  3.) Convolution routines do not have C routines at this time.                      */
+	/*  3.) Vector (SIMD) functions process 16 byte blocks and are used before MMX.        */
+	/*  4.) Convolution kernels are stored row by row, each row padded to 4 (3x3),         */
+	/*      8 (5x5, 7x7) or 12 (9x9) shorts.                                               */
 
 	// Detect MMX capability in CPU
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterMMXdetect(void);
@@ -62,6 +64,13 @@ extern "C" {
 	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterMMXoff(void);
 	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterMMXon(void);
 
+	// Detect availability of the portable vector routines
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterSIMDdetect(void);
+
+	// Force use of the vector routines off (or turn possible use back on)
+	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterSIMDoff(void);
+	SDL2_IMAGEFILTER_SCOPE void SDL_imageFilterSIMDon(void);
+
 	//
 	// All routines return:
 	//   0   OK
@@ -158,6 +167,45 @@ extern "C" {
 	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterNormalizeLinear(unsigned char *Src, unsigned char *Dest, unsigned int length, int Cmin,
 		int Cmax, int Nmin, int Nmax);
 
+	//  SDL_imageFilterConvolveKernel3x3Divide: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel3x3Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel5x5Divide: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel5x5Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel7x7Divide: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel7x7Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel9x9Divide: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel9x9Divide(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char Divisor);
+
+	//  SDL_imageFilterConvolveKernel3x3ShiftRight: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel3x3ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel5x5ShiftRight: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel5x5ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel7x7ShiftRight: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel7x7ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterConvolveKernel9x9ShiftRight: Dij = saturation0and255( ... )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterConvolveKernel9x9ShiftRight(unsigned char *Src, unsigned char *Dest, int rows,
+		int columns, signed short *Kernel, unsigned char NRightShift);
+
+	//  SDL_imageFilterSobelX: Dij = saturation255( | Sobel-X sum | )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterSobelX(unsigned char *Src, unsigned char *Dest, int rows, int columns);
+
+	//  SDL_imageFilterSobelXShiftRight: Dij = saturation255( | Sobel-X sum of (S >> N) | )
+	SDL2_IMAGEFILTER_SCOPE int SDL_imageFilterSobelXShiftRight(unsigned char *Src, unsigned char *Dest, int rows, int columns,
+		unsigned char NRightShift);
+
 	/* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -55,6 +55,15 @@ typedef struct tColorY {
 	Uint8 y;
 } tColorY;
 
+/*!
+\brief Use GCC/clang vector extensions for the bilinear interpolation if available.
+*/
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 9))
+#define USE_VECTOR_EXT
+typedef Uint8 VecU8x4 __attribute__((vector_size(4)));
+typedef Sint32 VecS32x4 __attribute__((vector_size(16)));
+#endif
+
 /*! 
 \brief Returns maximum of two numbers a and b.
 */
@@ -259,76 +268,358 @@ int _shrinkSurfaceY(SDL_Surface * src, SDL_Surface * dst, int factorx, int facto
 	return (0);
 }
 
-/*! 
-\brief Internal 32 bit Zoomer with optional anti-aliasing by bilinear interpolation.
+/* ---- Tiled rendering on a worker pool */
 
-Zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface.
-Assumes src and dst surfaces are of 32 bit depth.
-Assumes dst surface was allocated with the correct dimensions.
+/*!
+\brief Width of a destination tile in pixels.
+*/
+#define TILE_WIDTH	64
 
-\param src The surface to zoom (input).
-\param dst The zoomed surface (output).
-\param flipx Flag indicating if the image should be horizontally flipped.
-\param flipy Flag indicating if the image should be vertically flipped.
-\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+/*!
+\brief Height of a destination tile in pixels.
+*/
+#define TILE_HEIGHT	32
+
+/*!
+\brief Minimum number of destination pixels for which the worker pool is used.
+*/
+#define TILED_MIN_PIXELS	(128 * 128)
+
+/*!
+\brief Maximum number of threads (including the caller) rendering tiles.
+*/
+#define MAX_TILE_THREADS	8
+
+/*!
+\brief Renders the destination pixels [x0,x1) x [y0,y1) of a job.
+*/
+typedef void (*tTileFunc)(void *data, int x0, int y0, int x1, int y1);
+
+/*!
+\brief A tiled rendering job shared by the calling thread and the workers.
+*/
+typedef struct tTileJob {
+	tTileFunc func;
+	void *data;
+	int w;
+	int h;
+	int tilesx;
+	int numtiles;
+	SDL_atomic_t next;
+} tTileJob;
+
+/*!
+\brief The worker pool. Jobs are serialized by 'lock'; the caller renders tiles too.
+
+'requested' is atomic as it is read without the lock to skip the pool altogether.
+*/
+static struct {
+	SDL_SpinLock initlock;
+	SDL_mutex *lock;
+	SDL_sem *start;
+	SDL_sem *done;
+	SDL_Thread *threads[MAX_TILE_THREADS];
+	int numthreads;
+	SDL_atomic_t requested;
+	int initialized;
+	volatile int quit;
+	tTileJob *job;
+} _tilePool;
+
+/*!
+\brief Renders tiles of a job until none are left.
+
+\param job The job to render.
+*/
+static void _runTiles(tTileJob *job)
+{
+	int tile, tx, ty, x0, y0;
+
+	while ((tile = SDL_AtomicAdd(&job->next, 1)) < job->numtiles) {
+		tx = tile % job->tilesx;
+		ty = tile / job->tilesx;
+		x0 = tx * TILE_WIDTH;
+		y0 = ty * TILE_HEIGHT;
+		job->func(job->data, x0, y0,
+			(x0 + TILE_WIDTH < job->w) ? x0 + TILE_WIDTH : job->w,
+			(y0 + TILE_HEIGHT < job->h) ? y0 + TILE_HEIGHT : job->h);
+	}
+}
+
+/*!
+\brief Worker thread: renders tiles of the current job each time it is started.
+*/
+static int _tileWorker(void *unused)
+{
+	for (;;) {
+		SDL_SemWait(_tilePool.start);
+		if (_tilePool.quit) {
+			break;
+		}
+		_runTiles(_tilePool.job);
+		SDL_SemPost(_tilePool.done);
+	}
+	return 0;
+}
+
+/*!
+\brief Stops and joins all worker threads. Call with the pool lock held (or before it exists).
+*/
+static void _stopTileWorkers(void)
+{
+	int i;
+
+	_tilePool.quit = 1;
+	for (i = 0; i < _tilePool.numthreads; i++) {
+		SDL_SemPost(_tilePool.start);
+	}
+	for (i = 0; i < _tilePool.numthreads; i++) {
+		SDL_WaitThread(_tilePool.threads[i], NULL);
+		_tilePool.threads[i] = NULL;
+	}
+	_tilePool.numthreads = 0;
+	_tilePool.quit = 0;
+}
+
+/*!
+\brief Starts the worker threads for the requested thread count. Call with the pool lock held.
+*/
+static void _startTileWorkers(void)
+{
+	int wanted;
+
+	wanted = SDL_AtomicGet(&_tilePool.requested);
+	if (wanted < 1) {
+		wanted = SDL_GetCPUCount();
+	}
+	if (wanted > MAX_TILE_THREADS) {
+		wanted = MAX_TILE_THREADS;
+	}
+
+	/* The calling thread renders tiles too */
+	while (_tilePool.numthreads < wanted - 1) {
+		_tilePool.threads[_tilePool.numthreads] = SDL_CreateThread(_tileWorker, "rotozoom", NULL);
+		if (_tilePool.threads[_tilePool.numthreads] == NULL) {
+			break;
+		}
+		_tilePool.numthreads++;
+	}
+}
+
+/*!
+\brief Creates the pool lock and semaphores on first use.
 
 \return 0 for success or -1 for error.
 */
-int _zoomSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int smooth)
+static int _initTilePool(void)
 {
-	int x, y, sx, sy, ssx, ssy, *sax, *say, *csax, *csay, *salast, csx, csy, ex, ey, cx, cy, sstep, sstepx, sstepy;
-	tColorRGBA *c00, *c01, *c10, *c11;
-	tColorRGBA *sp, *csp, *dp;
-	int spixelgap, spixelw, spixelh, dgap, t1, t2;
+	int result = 0;
+
+	SDL_AtomicLock(&_tilePool.initlock);
+	if (!_tilePool.initialized) {
+		_tilePool.lock = SDL_CreateMutex();
+		_tilePool.start = SDL_CreateSemaphore(0);
+		_tilePool.done = SDL_CreateSemaphore(0);
+		if ((_tilePool.lock == NULL) || (_tilePool.start == NULL) || (_tilePool.done == NULL)) {
+			if (_tilePool.lock) SDL_DestroyMutex(_tilePool.lock);
+			if (_tilePool.start) SDL_DestroySemaphore(_tilePool.start);
+			if (_tilePool.done) SDL_DestroySemaphore(_tilePool.done);
+			_tilePool.lock = NULL;
+			_tilePool.start = NULL;
+			_tilePool.done = NULL;
+			result = -1;
+		} else {
+			_tilePool.initialized = 1;
+		}
+	}
+	SDL_AtomicUnlock(&_tilePool.initlock);
 
-	/*
-	* Allocate memory for row/column increments 
-	*/
-	if ((sax = (int *) malloc((dst->w + 1) * sizeof(Uint32))) == NULL) {
-		return (-1);
+	return result;
+}
+
+/*!
+\brief Renders a w x h destination area in tiles, spread over the worker pool.
+
+Small areas, or a pool limited to one thread, are rendered on the calling thread.
+
+\param func The tile rendering function.
+\param data The job data passed to the tile function.
+\param w The width of the destination area.
+\param h The height of the destination area.
+*/
+static void _renderTiled(tTileFunc func, void *data, int w, int h)
+{
+	tTileJob job;
+	int i, numthreads;
+
+	job.func = func;
+	job.data = data;
+	job.w = w;
+	job.h = h;
+	job.tilesx = (w + TILE_WIDTH - 1) / TILE_WIDTH;
+	job.numtiles = job.tilesx * ((h + TILE_HEIGHT - 1) / TILE_HEIGHT);
+	SDL_AtomicSet(&job.next, 0);
+
+	if ((w * h < TILED_MIN_PIXELS) || (SDL_AtomicGet(&_tilePool.requested) == 1) || (_initTilePool() < 0)) {
+		_runTiles(&job);
+		return;
 	}
-	if ((say = (int *) malloc((dst->h + 1) * sizeof(Uint32))) == NULL) {
-		free(sax);
-		return (-1);
+
+	SDL_LockMutex(_tilePool.lock);
+	_startTileWorkers();
+	numthreads = _tilePool.numthreads;
+	_tilePool.job = &job;
+	for (i = 0; i < numthreads; i++) {
+		SDL_SemPost(_tilePool.start);
+	}
+	_runTiles(&job);
+	for (i = 0; i < numthreads; i++) {
+		SDL_SemWait(_tilePool.done);
+	}
+	_tilePool.job = NULL;
+	SDL_UnlockMutex(_tilePool.lock);
+}
+
+/*!
+\brief Sets the number of threads used by the rotozoom and zoom functions.
+
+Destination surfaces are split into tiles which are rendered by the calling thread
+and a pool of worker threads. The pool is started on first use.
+
+\param numThreads Total number of rendering threads including the caller; 0 uses the
+number of CPU cores, 1 renders on the calling thread only and stops the workers.
+*/
+void rotozoomSetThreads(int numThreads)
+{
+	if (numThreads < 0) {
+		numThreads = 0;
 	}
+	if (_initTilePool() < 0) {
+		SDL_AtomicSet(&_tilePool.requested, numThreads);
+		return;
+	}
+
+	SDL_LockMutex(_tilePool.lock);
+	_stopTileWorkers();
+	SDL_AtomicSet(&_tilePool.requested, numThreads);
+	SDL_UnlockMutex(_tilePool.lock);
+}
+
+/*!
+\brief Bilinear interpolation of one 32 bit pixel from its 4 neighbours.
+
+All 4 channels are interpolated at once with vector extensions if available; the
+result is identical to the per-channel fixed point code.
+
+\param c00 Top left source pixel.
+\param c01 Top right source pixel.
+\param c10 Bottom left source pixel.
+\param c11 Bottom right source pixel.
+\param ex Horizontal 16.16 fraction.
+\param ey Vertical 16.16 fraction.
+\param dp Destination pixel.
+*/
+static SDL_INLINE void _interpolateRGBA(const tColorRGBA *c00, const tColorRGBA *c01, const tColorRGBA *c10, const tColorRGBA *c11,
+	int ex, int ey, tColorRGBA *dp)
+{
+#ifdef USE_VECTOR_EXT
+	VecU8x4 p;
+	VecS32x4 v00, v01, v10, v11, t1, t2;
+
+	memcpy(&p, c00, 4);
+	v00 = __builtin_convertvector(p, VecS32x4);
+	memcpy(&p, c01, 4);
+	v01 = __builtin_convertvector(p, VecS32x4);
+	memcpy(&p, c10, 4);
+	v10 = __builtin_convertvector(p, VecS32x4);
+	memcpy(&p, c11, 4);
+	v11 = __builtin_convertvector(p, VecS32x4);
+	t1 = ((((v01 - v00) * ex) >> 16) + v00) & 0xff;
+	t2 = ((((v11 - v10) * ex) >> 16) + v10) & 0xff;
+	p = __builtin_convertvector((((t2 - t1) * ey) >> 16) + t1, VecU8x4);
+	memcpy(dp, &p, 4);
+#else
+	int t1, t2;
+
+	t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
+	t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
+	dp->r = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
+	t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
+	dp->g = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
+	t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
+	dp->b = (((t2 - t1) * ey) >> 16) + t1;
+	t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
+	t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
+	dp->a = (((t2 - t1) * ey) >> 16) + t1;
+#endif
+}
+
+/* ---- Zoom plans */
+
+/*!
+\brief Precomputed source coordinates for zooming between two surface sizes.
+
+For 32 bit surfaces 'sax'/'say' hold 16.16 fixed point source coordinates for each
+destination column/row; for 8 bit surfaces they hold signed source pixel/row offsets.
+*/
+struct tZoomPlan {
+	int srcw;
+	int srch;
+	int dstw;
+	int dsth;
+	int is32bit;
+	int flipx;
+	int flipy;
+	int smooth;
+	int *sax;
+	int *say;
+};
+
+/*!
+\brief Calculates the 32 bit zoomer source coordinates of a plan.
+
+\param plan The plan with sizes and flags set and coordinate tables allocated.
+*/
+static void _zoomPlanSetupRGBA(tZoomPlan *plan)
+{
+	int x, y, sx, sy, ssx, ssy, csx, csy;
+	int spixelw, spixelh;
 
 	/*
-	* Precalculate row increments 
+	* Precalculate row increments
 	*/
-	spixelw = (src->w - 1);
-	spixelh = (src->h - 1);
-	if (smooth) {
-		sx = (int) (65536.0 * (float) spixelw / (float) (dst->w - 1));
-		sy = (int) (65536.0 * (float) spixelh / (float) (dst->h - 1));
+	spixelw = (plan->srcw - 1);
+	spixelh = (plan->srch - 1);
+	if (plan->smooth) {
+		sx = (plan->dstw > 1) ? (int) (65536.0 * (float) spixelw / (float) (plan->dstw - 1)) : 0;
+		sy = (plan->dsth > 1) ? (int) (65536.0 * (float) spixelh / (float) (plan->dsth - 1)) : 0;
 	} else {
-		sx = (int) (65536.0 * (float) (src->w) / (float) (dst->w));
-		sy = (int) (65536.0 * (float) (src->h) / (float) (dst->h));
+		sx = (int) (65536.0 * (float) (plan->srcw) / (float) (plan->dstw));
+		sy = (int) (65536.0 * (float) (plan->srch) / (float) (plan->dsth));
 	}
 
 	/* Maximum scaled source size */
-	ssx = (src->w << 16) - 1;
-	ssy = (src->h << 16) - 1;
+	ssx = (plan->srcw << 16) - 1;
+	ssy = (plan->srch << 16) - 1;
 
 	/* Precalculate horizontal row increments */
 	csx = 0;
-	csax = sax;
-	for (x = 0; x <= dst->w; x++) {
-		*csax = csx;
-		csax++;
+	for (x = 0; x <= plan->dstw; x++) {
+		plan->sax[x] = csx;
 		csx += sx;
 
 		/* Guard from overflows */
-		if (csx > ssx) { 
-			csx = ssx; 
+		if (csx > ssx) {
+			csx = ssx;
 		}
 	}
 
 	/* Precalculate vertical row increments */
 	csy = 0;
-	csay = say;
-	for (y = 0; y <= dst->h; y++) {
-		*csay = csy;
-		csay++;
+	for (y = 0; y <= plan->dsth; y++) {
+		plan->say[y] = csy;
 		csy += sy;
 
 		/* Guard from overflows */
@@ -336,163 +627,258 @@ int _zoomSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy,
 			csy = ssy;
 		}
 	}
+}
 
-	sp = (tColorRGBA *) src->pixels;
-	dp = (tColorRGBA *) dst->pixels;
-	dgap = dst->pitch - dst->w * 4;
-	spixelgap = src->pitch/4;
+/*!
+\brief Calculates the 8 bit zoomer source offsets of a plan.
 
-	if (flipx) sp += spixelw;
-	if (flipy) sp += (spixelgap * spixelh);
+\param plan The plan with sizes and flags set and coordinate tables allocated.
+*/
+static void _zoomPlanSetupY(tZoomPlan *plan)
+{
+	int x, y, csx, csy, step, offset;
 
-	/*
-	* Switch between interpolating and non-interpolating code 
-	*/
-	if (smooth) {
+	csx = 0;
+	offset = 0;
+	for (x = 0; x < plan->dstw; x++) {
+		plan->sax[x] = offset;
+		csx += plan->srcw;
+		step = 0;
+		while (csx >= plan->dstw) {
+			csx -= plan->dstw;
+			step++;
+		}
+		offset += step * (plan->flipx ? -1 : 1);
+	}
+	csy = 0;
+	offset = 0;
+	for (y = 0; y < plan->dsth; y++) {
+		plan->say[y] = offset;
+		csy += plan->srch;
+		step = 0;
+		while (csy >= plan->dsth) {
+			csy -= plan->dsth;
+			step++;
+		}
+		offset += step * (plan->flipy ? -1 : 1);
+	}
+}
 
-		/*
-		* Interpolating Zoom 
-		*/
-		csay = say;
-		for (y = 0; y < dst->h; y++) {
-			csp = sp;
-			csax = sax;
-			for (x = 0; x < dst->w; x++) {
-				/*
-				* Setup color source pointers 
-				*/
-				ex = (*csax & 0xffff);
-				ey = (*csay & 0xffff);
-				cx = (*csax >> 16);
-				cy = (*csay >> 16);
-				sstepx = cx < spixelw;
-				sstepy = cy < spixelh;
-				c00 = sp;
-				c01 = sp;
-				c10 = sp;
-				if (sstepy) {
-					if (flipy) {
-						c10 -= spixelgap;
-					} else {
-						c10 += spixelgap;
-					}
-				}
-				c11 = c10;
-				if (sstepx) {
-					if (flipx) {
-						c01--;
-						c11--;
-					} else {
-						c01++;
-						c11++;
-					}
-				}
+/*!
+\brief Creates a plan for repeatedly zooming between two fixed surface sizes.
 
-				/*
-				* Draw and interpolate colors 
-				*/
-				t1 = ((((c01->r - c00->r) * ex) >> 16) + c00->r) & 0xff;
-				t2 = ((((c11->r - c10->r) * ex) >> 16) + c10->r) & 0xff;
-				dp->r = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->g - c00->g) * ex) >> 16) + c00->g) & 0xff;
-				t2 = ((((c11->g - c10->g) * ex) >> 16) + c10->g) & 0xff;
-				dp->g = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->b - c00->b) * ex) >> 16) + c00->b) & 0xff;
-				t2 = ((((c11->b - c10->b) * ex) >> 16) + c10->b) & 0xff;
-				dp->b = (((t2 - t1) * ey) >> 16) + t1;
-				t1 = ((((c01->a - c00->a) * ex) >> 16) + c00->a) & 0xff;
-				t2 = ((((c11->a - c10->a) * ex) >> 16) + c10->a) & 0xff;
-				dp->a = (((t2 - t1) * ey) >> 16) + t1;				
-				/*
-				* Advance source pointer x
-				*/
-				salast = csax;
-				csax++;				
-				sstep = (*csax >> 16) - (*salast >> 16);
-				if (flipx) {
-					sp -= sstep;
-				} else {
-					sp += sstep;
-				}
+The plan holds the precalculated source coordinates of every destination row and
+column, so zoomSurfaceWithPlan() only renders pixels. It can be used with any pair
+of surfaces of the planned sizes and depth.
 
-				/*
-				* Advance destination pointer x
-				*/
-				dp++;
-			}
-			/*
-			* Advance source pointer y
-			*/
-			salast = csay;
-			csay++;
-			sstep = (*csay >> 16) - (*salast >> 16);
-			sstep *= spixelgap;
-			if (flipy) { 
-				sp = csp - sstep;
-			} else {
-				sp = csp + sstep;
-			}
+\param srcw The width of the source surfaces.
+\param srch The height of the source surfaces.
+\param dstw The width of the destination surfaces.
+\param dsth The height of the destination surfaces.
+\param bitsPerPixel The depth of source and destination surfaces (8 or 32).
+\param flipx Flag indicating if the image should be horizontally flipped.
+\param flipy Flag indicating if the image should be vertically flipped.
+\param smooth Antialiasing flag (32 bit only); set to SMOOTHING_ON to enable.
+
+\return The new plan or NULL for error.
+*/
+tZoomPlan *zoomPlanCreate(int srcw, int srch, int dstw, int dsth, int bitsPerPixel, int flipx, int flipy, int smooth)
+{
+	tZoomPlan *plan;
+
+	if ((srcw < 1) || (srch < 1) || (dstw < 1) || (dsth < 1) || ((bitsPerPixel != 8) && (bitsPerPixel != 32))) {
+		SDL_SetError("Invalid zoom plan dimensions or depth");
+		return NULL;
+	}
+
+	plan = (tZoomPlan *) malloc(sizeof(tZoomPlan));
+	if (plan == NULL) {
+		SDL_OutOfMemory();
+		return NULL;
+	}
+	plan->srcw = srcw;
+	plan->srch = srch;
+	plan->dstw = dstw;
+	plan->dsth = dsth;
+	plan->is32bit = (bitsPerPixel == 32);
+	plan->flipx = flipx;
+	plan->flipy = flipy;
+	plan->smooth = ((plan->is32bit) && (smooth)) ? SMOOTHING_ON : SMOOTHING_OFF;
+	plan->sax = (int *) malloc((dstw + 1) * sizeof(int));
+	plan->say = (int *) malloc((dsth + 1) * sizeof(int));
+	if ((plan->sax == NULL) || (plan->say == NULL)) {
+		zoomPlanFree(plan);
+		SDL_OutOfMemory();
+		return NULL;
+	}
+
+	if (plan->is32bit) {
+		_zoomPlanSetupRGBA(plan);
+	} else {
+		_zoomPlanSetupY(plan);
+	}
+
+	return plan;
+}
+
+/*!
+\brief Frees a zoom plan.
+
+\param plan The plan to free (can be NULL).
+*/
+void zoomPlanFree(tZoomPlan *plan)
+{
+	if (plan == NULL) {
+		return;
+	}
+	free(plan->sax);
+	free(plan->say);
+	free(plan);
+}
 
+/*!
+\brief Job data of a zoom.
+*/
+typedef struct tZoomJob {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	const tZoomPlan *plan;
+} tZoomJob;
+
+/*!
+\brief Renders one destination tile of a 32 bit zoom.
+*/
+static void _zoomTileRGBA(void *data, int x0, int y0, int x1, int y1)
+{
+	tZoomJob *job = (tZoomJob *) data;
+	const tZoomPlan *plan = job->plan;
+	SDL_Surface *src = job->src;
+	SDL_Surface *dst = job->dst;
+	int x, y, cx, cy, ex, ey, sstepy;
+	int spixelw, spixelh, spixelgap, xstep, ystep;
+	tColorRGBA *c00, *c01, *c10, *c11;
+	tColorRGBA *sp, *csp, *dp;
+
+	spixelw = (src->w - 1);
+	spixelh = (src->h - 1);
+	spixelgap = src->pitch/4;
+	xstep = (plan->flipx) ? -1 : 1;
+	ystep = (plan->flipy) ? -spixelgap : spixelgap;
+
+	sp = (tColorRGBA *) src->pixels;
+	if (plan->flipx) sp += spixelw;
+	if (plan->flipy) sp += (spixelgap * spixelh);
+
+	for (y = y0; y < y1; y++) {
+		csp = sp + (plan->say[y] >> 16) * ystep;
+		dp = (tColorRGBA *) ((Uint8 *) dst->pixels + y * dst->pitch) + x0;
+		if (plan->smooth) {
 			/*
-			* Advance destination pointer y
+			* Interpolating Zoom
 			*/
-			dp = (tColorRGBA *) ((Uint8 *) dp + dgap);
-		}
-	} else {
-		/*
-		* Non-Interpolating Zoom 
-		*/		
-		csay = say;
-		for (y = 0; y < dst->h; y++) {
-			csp = sp;
-			csax = sax;
-			for (x = 0; x < dst->w; x++) {
-				/*
-				* Draw 
-				*/
-				*dp = *sp;
-
-				/*
-				* Advance source pointer x
-				*/
-				salast = csax;
-				csax++;				
-				sstep = (*csax >> 16) - (*salast >> 16);
-				if (flipx) sstep = -sstep;
-				sp += sstep;
-
-				/*
-				* Advance destination pointer x
-				*/
+			cy = (plan->say[y] >> 16);
+			ey = (plan->say[y] & 0xffff);
+			sstepy = cy < spixelh;
+			for (x = x0; x < x1; x++) {
+				cx = (plan->sax[x] >> 16);
+				ex = (plan->sax[x] & 0xffff);
+				c00 = csp + cx * xstep;
+				c10 = (sstepy) ? c00 + ystep : c00;
+				if (cx < spixelw) {
+					c01 = c00 + xstep;
+					c11 = c10 + xstep;
+				} else {
+					c01 = c00;
+					c11 = c10;
+				}
+				_interpolateRGBA(c00, c01, c10, c11, ex, ey, dp);
 				dp++;
 			}
+		} else {
 			/*
-			* Advance source pointer y
+			* Non-Interpolating Zoom
 			*/
-			salast = csay;
-			csay++;
-			sstep = (*csay >> 16) - (*salast >> 16);
-			sstep *= spixelgap;
-			if (flipy) sstep = -sstep;			
-			sp = csp + sstep;
+			for (x = x0; x < x1; x++) {
+				*dp = *(csp + (plan->sax[x] >> 16) * xstep);
+				dp++;
+			}
+		}
+	}
+}
 
-			/*
-			* Advance destination pointer y
-			*/
-			dp = (tColorRGBA *) ((Uint8 *) dp + dgap);
+/*!
+\brief Renders one destination tile of an 8 bit zoom.
+*/
+static void _zoomTileY(void *data, int x0, int y0, int x1, int y1)
+{
+	tZoomJob *job = (tZoomJob *) data;
+	const tZoomPlan *plan = job->plan;
+	SDL_Surface *src = job->src;
+	SDL_Surface *dst = job->dst;
+	int x, y;
+	Uint8 *sp, *csp, *dp;
+
+	sp = (Uint8 *) src->pixels;
+	if (plan->flipx) sp += (src->w-1);
+	if (plan->flipy) sp += src->pitch*(src->h-1);
+
+	for (y = y0; y < y1; y++) {
+		csp = sp + plan->say[y] * src->pitch;
+		dp = (Uint8 *) dst->pixels + y * dst->pitch + x0;
+		for (x = x0; x < x1; x++) {
+			*dp = csp[plan->sax[x]];
+			dp++;
 		}
 	}
+}
 
-	/*
-	* Remove temp arrays 
-	*/
-	free(sax);
-	free(say);
+/*!
+\brief Zooms 'src' into 'dst' following a plan, on the worker pool.
+
+\param plan The zoom plan matching the surface sizes.
+\param src The surface to zoom (input).
+\param dst The zoomed surface (output).
+*/
+static void _zoomSurfacePlanned(const tZoomPlan *plan, SDL_Surface * src, SDL_Surface * dst)
+{
+	tZoomJob job;
+
+	job.src = src;
+	job.dst = dst;
+	job.plan = plan;
+	_renderTiled((plan->is32bit) ? _zoomTileRGBA : _zoomTileY, &job, dst->w, dst->h);
+}
+
+/*!
+\brief Internal 32 bit Zoomer with optional anti-aliasing by bilinear interpolation.
+
+Zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface.
+Assumes src and dst surfaces are of 32 bit depth.
+Assumes dst surface was allocated with the correct dimensions.
+
+\param src The surface to zoom (input).
+\param dst The zoomed surface (output).
+\param flipx Flag indicating if the image should be horizontally flipped.
+\param flipy Flag indicating if the image should be vertically flipped.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+
+\return 0 for success or -1 for error.
+*/
+int _zoomSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int smooth)
+{
+	tZoomPlan *plan;
+
+	plan = zoomPlanCreate(src->w, src->h, dst->w, dst->h, 32, flipx, flipy, smooth);
+	if (plan == NULL) {
+		return (-1);
+	}
+	_zoomSurfacePlanned(plan, src, dst);
+	zoomPlanFree(plan);
 
 	return (0);
 }
 
-/*! 
+/*!
 
 \brief Internal 8 bit Zoomer without smoothing.
 
@@ -509,157 +895,74 @@ Assumes dst surface was allocated with the correct dimensions.
 */
 int _zoomSurfaceY(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy)
 {
-	int x, y;
-	Uint32 *sax, *say, *csax, *csay;
-	int csx, csy;
-	Uint8 *sp, *dp, *csp;
-	int dgap;
+	tZoomPlan *plan;
 
-	/*
-	* Allocate memory for row increments 
-	*/
-	if ((sax = (Uint32 *) malloc((dst->w + 1) * sizeof(Uint32))) == NULL) {
-		return (-1);
-	}
-	if ((say = (Uint32 *) malloc((dst->h + 1) * sizeof(Uint32))) == NULL) {
-		free(sax);
+	plan = zoomPlanCreate(src->w, src->h, dst->w, dst->h, 8, flipx, flipy, SMOOTHING_OFF);
+	if (plan == NULL) {
 		return (-1);
 	}
+	_zoomSurfacePlanned(plan, src, dst);
+	zoomPlanFree(plan);
 
-	/*
-	* Pointer setup 
-	*/
-	sp = csp = (Uint8 *) src->pixels;
-	dp = (Uint8 *) dst->pixels;
-	dgap = dst->pitch - dst->w;
+	return (0);
+}
 
-	if (flipx) csp += (src->w-1);
-	if (flipy) csp  = ( (Uint8*)csp + src->pitch*(src->h-1) );
-
-	/*
-	* Precalculate row increments 
-	*/
-	csx = 0;
-	csax = sax;
-	for (x = 0; x < dst->w; x++) {
-		csx += src->w;
-		*csax = 0;
-		while (csx >= dst->w) {
-			csx -= dst->w;
-			(*csax)++;
-		}
-		(*csax) = (*csax) * (flipx ? -1 : 1);
-		csax++;
-	}
-	csy = 0;
-	csay = say;
-	for (y = 0; y < dst->h; y++) {
-		csy += src->h;
-		*csay = 0;
-		while (csy >= dst->h) {
-			csy -= dst->h;
-			(*csay)++;
-		}
-		(*csay) = (*csay) * (flipy ? -1 : 1);
-		csay++;
-	}
-
-	/*
-	* Draw 
-	*/
-	csay = say;
-	for (y = 0; y < dst->h; y++) {
-		csax = sax;
-		sp = csp;
-		for (x = 0; x < dst->w; x++) {
-			/*
-			* Draw 
-			*/
-			*dp = *sp;
-			/*
-			* Advance source pointers 
-			*/
-			sp += (*csax);
-			csax++;
-			/*
-			* Advance destination pointer 
-			*/
-			dp++;
-		}
-		/*
-		* Advance source pointer (for row) 
-		*/
-		csp += ((*csay) * src->pitch);
-		csay++;
-
-		/*
-		* Advance destination pointers 
-		*/
-		dp += dgap;
-	}
-
-	/*
-	* Remove temp arrays 
-	*/
-	free(sax);
-	free(say);
-
-	return (0);
-}
-
-/*! 
-\brief Internal 32 bit rotozoomer with optional anti-aliasing.
+/*!
+\brief Job data of a rotozoom.
+*/
+typedef struct tTransformJob {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	int cx;
+	int cy;
+	int isin;
+	int icos;
+	int flipx;
+	int flipy;
+	int smooth;
+	Uint8 colorkey;
+} tTransformJob;
 
-Rotates and zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control 
-parameters by scanning the destination surface and applying optionally anti-aliasing
-by bilinear interpolation.
-Assumes src and dst surfaces are of 32 bit depth.
-Assumes dst surface was allocated with the correct dimensions.
+/*!
+\brief Renders one destination tile of a 32 bit rotozoom.
 
-\param src Source surface.
-\param dst Destination surface.
-\param cx Horizontal center coordinate.
-\param cy Vertical center coordinate.
-\param isin Integer version of sine of angle.
-\param icos Integer version of cosine of angle.
-\param flipx Flag indicating horizontal mirroring should be applied.
-\param flipy Flag indicating vertical mirroring should be applied.
-\param smooth Flag indicating anti-aliasing should be used.
+Destination pixels outside the rotated source are cleared to 0.
 */
-void _transformSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy, int smooth)
+static void _transformTileRGBA(void *data, int x0, int y0, int x1, int y1)
 {
-	int x, y, t1, t2, dx, dy, xd, yd, sdx, sdy, ax, ay, ex, ey, sw, sh;
+	tTransformJob *job = (tTransformJob *) data;
+	SDL_Surface *src = job->src;
+	SDL_Surface *dst = job->dst;
+	int isin = job->isin;
+	int icos = job->icos;
+	int x, y, dx, dy, xd, yd, sdx, sdy, ax, ay, sw, sh;
 	tColorRGBA c00, c01, c10, c11, cswap;
 	tColorRGBA *pc, *sp;
-	int gap;
+	static const tColorRGBA clear = { 0, 0, 0, 0 };
 
 	/*
-	* Variable setup 
+	* Variable setup
 	*/
 	xd = ((src->w - dst->w) << 15);
 	yd = ((src->h - dst->h) << 15);
-	ax = (cx << 16) - (icos * cx);
-	ay = (cy << 16) - (isin * cx);
+	ax = (job->cx << 16) - (icos * job->cx);
+	ay = (job->cy << 16) - (isin * job->cx);
 	sw = src->w - 1;
 	sh = src->h - 1;
-	pc = (tColorRGBA*) dst->pixels;
-	gap = dst->pitch - dst->w * 4;
 
-	/*
-	* Switch between interpolating and non-interpolating code 
-	*/
-	if (smooth) {
-		for (y = 0; y < dst->h; y++) {
-			dy = cy - y;
-			sdx = (ax + (isin * dy)) + xd;
-			sdy = (ay - (icos * dy)) + yd;
-			for (x = 0; x < dst->w; x++) {
+	for (y = y0; y < y1; y++) {
+		dy = job->cy - y;
+		sdx = (ax + (isin * dy)) + xd + icos * x0;
+		sdy = (ay - (icos * dy)) + yd + isin * x0;
+		pc = (tColorRGBA *) ((Uint8 *) dst->pixels + y * dst->pitch) + x0;
+		if (job->smooth) {
+			for (x = x0; x < x1; x++) {
 				dx = (sdx >> 16);
 				dy = (sdy >> 16);
-				if (flipx) dx = sw - dx;
-				if (flipy) dy = sh - dy;
+				if (job->flipx) dx = sw - dx;
+				if (job->flipy) dy = sh - dy;
 				if ((dx > -1) && (dy > -1) && (dx < (src->w-1)) && (dy < (src->h-1))) {
-					sp = (tColorRGBA *)src->pixels;;
+					sp = (tColorRGBA *)src->pixels;
 					sp += ((src->pitch/4) * dy);
 					sp += dx;
 					c00 = *sp;
@@ -669,122 +972,902 @@ void _transformSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int cx, int cy,
 					c11 = *sp;
 					sp -= 1;
 					c10 = *sp;
-					if (flipx) {
+					if (job->flipx) {
 						cswap = c00; c00=c01; c01=cswap;
 						cswap = c10; c10=c11; c11=cswap;
 					}
-					if (flipy) {
+					if (job->flipy) {
 						cswap = c00; c00=c10; c10=cswap;
 						cswap = c01; c01=c11; c11=cswap;
 					}
 					/*
-					* Interpolate colors 
+					* Interpolate colors
 					*/
-					ex = (sdx & 0xffff);
-					ey = (sdy & 0xffff);
-					t1 = ((((c01.r - c00.r) * ex) >> 16) + c00.r) & 0xff;
-					t2 = ((((c11.r - c10.r) * ex) >> 16) + c10.r) & 0xff;
-					pc->r = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.g - c00.g) * ex) >> 16) + c00.g) & 0xff;
-					t2 = ((((c11.g - c10.g) * ex) >> 16) + c10.g) & 0xff;
-					pc->g = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.b - c00.b) * ex) >> 16) + c00.b) & 0xff;
-					t2 = ((((c11.b - c10.b) * ex) >> 16) + c10.b) & 0xff;
-					pc->b = (((t2 - t1) * ey) >> 16) + t1;
-					t1 = ((((c01.a - c00.a) * ex) >> 16) + c00.a) & 0xff;
-					t2 = ((((c11.a - c10.a) * ex) >> 16) + c10.a) & 0xff;
-					pc->a = (((t2 - t1) * ey) >> 16) + t1;
+					_interpolateRGBA(&c00, &c01, &c10, &c11, (sdx & 0xffff), (sdy & 0xffff), pc);
+				} else {
+					*pc = clear;
+				}
+				sdx += icos;
+				sdy += isin;
+				pc++;
+			}
+		} else {
+			for (x = x0; x < x1; x++) {
+				dx = (short) (sdx >> 16);
+				dy = (short) (sdy >> 16);
+				if (job->flipx) dx = (src->w-1)-dx;
+				if (job->flipy) dy = (src->h-1)-dy;
+				if ((dx >= 0) && (dy >= 0) && (dx < src->w) && (dy < src->h)) {
+					sp = (tColorRGBA *) ((Uint8 *) src->pixels + src->pitch * dy);
+					sp += dx;
+					*pc = *sp;
+				} else {
+					*pc = clear;
 				}
 				sdx += icos;
 				sdy += isin;
 				pc++;
 			}
-			pc = (tColorRGBA *) ((Uint8 *) pc + gap);
 		}
+	}
+}
+
+/*!
+\brief Renders one destination tile of an 8 bit rotozoom.
+
+Destination pixels outside the rotated source are set to the source colorkey.
+*/
+static void _transformTileY(void *data, int x0, int y0, int x1, int y1)
+{
+	tTransformJob *job = (tTransformJob *) data;
+	SDL_Surface *src = job->src;
+	SDL_Surface *dst = job->dst;
+	int isin = job->isin;
+	int icos = job->icos;
+	int x, y, dx, dy, xd, yd, sdx, sdy, ax, ay;
+	tColorY *pc, *sp;
+
+	/*
+	* Variable setup
+	*/
+	xd = ((src->w - dst->w) << 15);
+	yd = ((src->h - dst->h) << 15);
+	ax = (job->cx << 16) - (icos * job->cx);
+	ay = (job->cy << 16) - (isin * job->cx);
+
+	for (y = y0; y < y1; y++) {
+		dy = job->cy - y;
+		sdx = (ax + (isin * dy)) + xd + icos * x0;
+		sdy = (ay - (icos * dy)) + yd + isin * x0;
+		pc = (tColorY *) ((Uint8 *) dst->pixels + y * dst->pitch) + x0;
+		for (x = x0; x < x1; x++) {
+			dx = (short) (sdx >> 16);
+			dy = (short) (sdy >> 16);
+			if (job->flipx) dx = (src->w-1)-dx;
+			if (job->flipy) dy = (src->h-1)-dy;
+			if ((dx >= 0) && (dy >= 0) && (dx < src->w) && (dy < src->h)) {
+				sp = (tColorY *) (src->pixels);
+				sp += (src->pitch * dy + dx);
+				*pc = *sp;
+			} else {
+				pc->y = job->colorkey;
+			}
+			sdx += icos;
+			sdy += isin;
+			pc++;
+		}
+	}
+}
+
+/*!
+\brief Internal 32 bit rotozoomer with optional anti-aliasing.
+
+Rotates and zooms 32 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control
+parameters by scanning the destination surface and applying optionally anti-aliasing
+by bilinear interpolation. The destination is rendered in tiles on the worker pool;
+pixels outside the rotated source are cleared.
+Assumes src and dst surfaces are of 32 bit depth.
+Assumes dst surface was allocated with the correct dimensions.
+
+\param src Source surface.
+\param dst Destination surface.
+\param cx Horizontal center coordinate.
+\param cy Vertical center coordinate.
+\param isin Integer version of sine of angle.
+\param icos Integer version of cosine of angle.
+\param flipx Flag indicating horizontal mirroring should be applied.
+\param flipy Flag indicating vertical mirroring should be applied.
+\param smooth Flag indicating anti-aliasing should be used.
+*/
+void _transformSurfaceRGBA(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy, int smooth)
+{
+	tTransformJob job;
+
+	job.src = src;
+	job.dst = dst;
+	job.cx = cx;
+	job.cy = cy;
+	job.isin = isin;
+	job.icos = icos;
+	job.flipx = flipx;
+	job.flipy = flipy;
+	job.smooth = smooth;
+	job.colorkey = 0;
+	_renderTiled(_transformTileRGBA, &job, dst->w, dst->h);
+}
+
+/*!
+
+\brief Rotates and zooms 8 bit palette/Y 'src' surface to 'dst' surface without smoothing.
+
+Rotates and zooms 8 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control
+parameters by scanning the destination surface. The destination is rendered in tiles
+on the worker pool; pixels outside the rotated source are set to the colorkey.
+Assumes src and dst surfaces are of 8 bit depth.
+Assumes dst surface was allocated with the correct dimensions.
+
+\param src Source surface.
+\param dst Destination surface.
+\param cx Horizontal center coordinate.
+\param cy Vertical center coordinate.
+\param isin Integer version of sine of angle.
+\param icos Integer version of cosine of angle.
+\param flipx Flag indicating horizontal mirroring should be applied.
+\param flipy Flag indicating vertical mirroring should be applied.
+*/
+void transformSurfaceY(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy)
+{
+	tTransformJob job;
+
+	job.src = src;
+	job.dst = dst;
+	job.cx = cx;
+	job.cy = cy;
+	job.isin = isin;
+	job.icos = icos;
+	job.flipx = flipx;
+	job.flipy = flipy;
+	job.smooth = SMOOTHING_OFF;
+	job.colorkey = (Uint8) (_colorkey(src) & 0xff);
+	_renderTiled(_transformTileY, &job, dst->w, dst->h);
+}
+
+/* ---- Palette helper */
+
+/*!
+\brief Copies the palette of an 8 bit source surface to the destination surface.
+
+\param src The source surface.
+\param dst The destination surface.
+*/
+static void _copyPalette(SDL_Surface * src, SDL_Surface * dst)
+{
+	int i;
+
+	if ((src->format->palette == NULL) || (dst->format->palette == NULL) || (src->format->palette == dst->format->palette)) {
+		return;
+	}
+	for (i = 0; (i < src->format->palette->ncolors) && (i < dst->format->palette->ncolors); i++) {
+		dst->format->palette->colors[i] = src->format->palette->colors[i];
+	}
+}
+
+/* ---- Filtered resampling */
+
+/*!
+\brief Number of fraction bits of the resampling filter weights.
+*/
+#define FILTER_SHIFT	14
+
+/*!
+\brief Radius of the Lanczos filter in (destination) pixels.
+*/
+#define LANCZOS_RADIUS	3
+
+/*!
+\brief Precalculated filter taps for resampling one axis.
+
+Destination pixel i is the sum of 'count[i]' source pixels starting at 'start[i]',
+weighted by 'weights[i * maxtaps + k]' (fixed point with FILTER_SHIFT fraction bits).
+*/
+typedef struct tFilterTaps {
+	int *start;
+	int *count;
+	Sint32 *weights;
+	int maxtaps;
+} tFilterTaps;
+
+/*!
+\brief The Lanczos kernel.
+*/
+static double _lanczos(double x)
+{
+	if (x == 0.0) {
+		return 1.0;
+	}
+	if ((x <= -LANCZOS_RADIUS) || (x >= LANCZOS_RADIUS)) {
+		return 0.0;
+	}
+	x *= M_PI;
+	return (LANCZOS_RADIUS * sin(x) * sin(x / LANCZOS_RADIUS)) / (x * x);
+}
+
+/*!
+\brief Frees the tables of a set of filter taps.
+*/
+static void _freeFilterTaps(tFilterTaps *taps)
+{
+	free(taps->start);
+	free(taps->count);
+	free(taps->weights);
+}
+
+/*!
+\brief Calculates the filter taps for resampling an axis of 'srcsize' pixels to 'dstsize' pixels.
+
+The box filter averages the source area covered by a destination pixel; the Lanczos
+filter is widened by the shrinking ratio. Taps outside the source are folded onto the
+edge pixels and the weights of each destination pixel add up to 1.
+
+\param srcsize The number of source pixels.
+\param dstsize The number of destination pixels.
+\param filter The filter to use (MIPFILTER_BOX or MIPFILTER_LANCZOS).
+\param taps The taps to set up.
+
+\return 0 for success or -1 for error.
+*/
+static int _buildFilterTaps(int srcsize, int dstsize, int filter, tFilterTaps *taps)
+{
+	double scale, fscale, support, center, lo, hi, sum, w;
+	double *fweights;
+	int i, j, k, first, last, n, total, maxk;
+	Sint32 *iweights;
+
+	scale = (double) srcsize / (double) dstsize;
+	fscale = (scale > 1.0) ? scale : 1.0;
+	support = (filter == MIPFILTER_LANCZOS) ? LANCZOS_RADIUS * fscale : 0.5 * fscale;
+
+	taps->maxtaps = (int) ceil(2.0 * support) + 2;
+	taps->start = (int *) malloc(dstsize * sizeof(int));
+	taps->count = (int *) malloc(dstsize * sizeof(int));
+	taps->weights = (Sint32 *) malloc(dstsize * taps->maxtaps * sizeof(Sint32));
+	fweights = (double *) malloc(taps->maxtaps * sizeof(double));
+	if ((taps->start == NULL) || (taps->count == NULL) || (taps->weights == NULL) || (fweights == NULL)) {
+		_freeFilterTaps(taps);
+		free(fweights);
+		return (-1);
+	}
+
+	for (i = 0; i < dstsize; i++) {
+		if (filter == MIPFILTER_LANCZOS) {
+			center = (i + 0.5) * scale - 0.5;
+			first = (int) ceil(center - support);
+			last = (int) floor(center + support);
+		} else {
+			lo = i * scale;
+			hi = (i + 1) * scale;
+			center = 0.0;
+			first = (int) floor(lo);
+			last = (int) ceil(hi) - 1;
+		}
+
+		/* Clip to the source; outside taps are folded onto the edges */
+		taps->start[i] = (first > 0) ? first : 0;
+		n = ((last < srcsize - 1) ? last : srcsize - 1) - taps->start[i] + 1;
+		if (n < 1) {
+			taps->start[i] = (first < srcsize - 1) ? ((first > 0) ? first : 0) : srcsize - 1;
+			n = 1;
+		}
+		taps->count[i] = n;
+		for (k = 0; k < n; k++) {
+			fweights[k] = 0.0;
+		}
+		sum = 0.0;
+		for (j = first; j <= last; j++) {
+			if (filter == MIPFILTER_LANCZOS) {
+				w = _lanczos((j - center) / fscale);
+			} else {
+				w = ((hi < j + 1) ? hi : j + 1) - ((lo > j) ? lo : j);
+			}
+			k = j - taps->start[i];
+			if (k < 0) k = 0;
+			if (k > n - 1) k = n - 1;
+			fweights[k] += w;
+			sum += w;
+		}
+		if (sum == 0.0) {
+			fweights[0] = 1.0;
+			sum = 1.0;
+		}
+
+		/* Convert to fixed point and put the rounding error on the largest tap */
+		iweights = taps->weights + i * taps->maxtaps;
+		total = 0;
+		maxk = 0;
+		for (k = 0; k < n; k++) {
+			iweights[k] = (Sint32) floor(fweights[k] / sum * (1 << FILTER_SHIFT) + 0.5);
+			total += iweights[k];
+			if (iweights[k] > iweights[maxk]) {
+				maxk = k;
+			}
+		}
+		iweights[maxk] += (1 << FILTER_SHIFT) - total;
+	}
+
+	free(fweights);
+	return (0);
+}
+
+/*!
+\brief Rounds and clamps a filtered fixed point value to a byte.
+*/
+static SDL_INLINE Uint8 _clampFiltered(Sint32 v)
+{
+	v = (v + (1 << (FILTER_SHIFT - 1))) >> FILTER_SHIFT;
+	return (Uint8) ((v < 0) ? 0 : ((v > 255) ? 255 : v));
+}
+
+/*!
+\brief Job data of a separable resampling.
+*/
+typedef struct tResampleJob {
+	SDL_Surface *src;
+	SDL_Surface *dst;
+	int channels;
+	Uint8 *tmp;
+	int tmppitch;
+	tFilterTaps xtaps;
+	tFilterTaps ytaps;
+} tResampleJob;
+
+/*!
+\brief Horizontal resampling pass: filters source rows into the intermediate buffer.
+*/
+static void _resampleTileH(void *data, int x0, int y0, int x1, int y1)
+{
+	tResampleJob *job = (tResampleJob *) data;
+	int x, y, k, n;
+	const Sint32 *w;
+	const Uint8 *sp, *s;
+	Uint8 *tp;
+	Sint32 sum;
+#ifdef USE_VECTOR_EXT
+	VecU8x4 p;
+	VecS32x4 acc;
+#else
+	Sint32 r, g, b, a;
+#endif
+
+	for (y = y0; y < y1; y++) {
+		sp = (const Uint8 *) job->src->pixels + y * job->src->pitch;
+		tp = job->tmp + y * job->tmppitch + x0 * job->channels;
+		for (x = x0; x < x1; x++) {
+			w = job->xtaps.weights + x * job->xtaps.maxtaps;
+			n = job->xtaps.count[x];
+			s = sp + job->xtaps.start[x] * job->channels;
+			if (job->channels == 4) {
+#ifdef USE_VECTOR_EXT
+				acc = (VecS32x4) { 0, 0, 0, 0 };
+				for (k = 0; k < n; k++) {
+					memcpy(&p, s + 4 * k, 4);
+					acc += __builtin_convertvector(p, VecS32x4) * w[k];
+				}
+				tp[0] = _clampFiltered(acc[0]);
+				tp[1] = _clampFiltered(acc[1]);
+				tp[2] = _clampFiltered(acc[2]);
+				tp[3] = _clampFiltered(acc[3]);
+#else
+				r = g = b = a = 0;
+				for (k = 0; k < n; k++) {
+					r += s[4 * k] * w[k];
+					g += s[4 * k + 1] * w[k];
+					b += s[4 * k + 2] * w[k];
+					a += s[4 * k + 3] * w[k];
+				}
+				tp[0] = _clampFiltered(r);
+				tp[1] = _clampFiltered(g);
+				tp[2] = _clampFiltered(b);
+				tp[3] = _clampFiltered(a);
+#endif
+				tp += 4;
+			} else {
+				sum = 0;
+				for (k = 0; k < n; k++) {
+					sum += s[k] * w[k];
+				}
+				*tp = _clampFiltered(sum);
+				tp++;
+			}
+		}
+	}
+}
+
+/*!
+\brief Vertical resampling pass: filters the intermediate buffer into destination rows.
+*/
+static void _resampleTileV(void *data, int x0, int y0, int x1, int y1)
+{
+	tResampleJob *job = (tResampleJob *) data;
+	int y, i, k, n, bytes;
+	const Sint32 *w;
+	const Uint8 *tp;
+	Uint8 *dp;
+	Sint32 acc[TILE_WIDTH * 4];
+
+	bytes = (x1 - x0) * job->channels;
+	for (y = y0; y < y1; y++) {
+		w = job->ytaps.weights + y * job->ytaps.maxtaps;
+		n = job->ytaps.count[y];
+		tp = job->tmp + job->ytaps.start[y] * job->tmppitch + x0 * job->channels;
+		for (i = 0; i < bytes; i++) {
+			acc[i] = 0;
+		}
+		for (k = 0; k < n; k++) {
+			for (i = 0; i < bytes; i++) {
+				acc[i] += tp[i] * w[k];
+			}
+			tp += job->tmppitch;
+		}
+		dp = (Uint8 *) job->dst->pixels + y * job->dst->pitch + x0 * job->channels;
+		for (i = 0; i < bytes; i++) {
+			dp[i] = _clampFiltered(acc[i]);
+		}
+	}
+}
+
+/*!
+\brief Internal separable resampler with box or Lanczos filtering.
+
+Resamples 32 bit RGBA/ABGR or 8 bit Y 'src' surface to 'dst' surface at any ratio,
+first horizontally into an intermediate buffer, then vertically. Both passes are
+rendered on the worker pool.
+Assumes src and dst surfaces are of the same depth.
+
+\param src The surface to resample (input).
+\param dst The resampled surface (output).
+\param filter The filter to use (MIPFILTER_BOX or MIPFILTER_LANCZOS).
+
+\return 0 for success or -1 for error.
+*/
+int _resampleSurface(SDL_Surface * src, SDL_Surface * dst, int filter)
+{
+	tResampleJob job;
+
+	job.src = src;
+	job.dst = dst;
+	job.channels = src->format->BytesPerPixel;
+	job.tmppitch = dst->w * job.channels;
+	job.tmp = (Uint8 *) malloc(job.tmppitch * src->h);
+	if (job.tmp == NULL) {
+		return (-1);
+	}
+	if (_buildFilterTaps(src->w, dst->w, filter, &job.xtaps) < 0) {
+		free(job.tmp);
+		return (-1);
+	}
+	if (_buildFilterTaps(src->h, dst->h, filter, &job.ytaps) < 0) {
+		_freeFilterTaps(&job.xtaps);
+		free(job.tmp);
+		return (-1);
+	}
+
+	_renderTiled(_resampleTileH, &job, dst->w, src->h);
+	_renderTiled(_resampleTileV, &job, dst->w, dst->h);
+
+	_freeFilterTaps(&job.xtaps);
+	_freeFilterTaps(&job.ytaps);
+	free(job.tmp);
+
+	return (0);
+}
+
+/* ---- Mip chains */
+
+/*!
+\brief Maximum number of levels of a mip chain (including the source).
+*/
+#define MAX_MIP_LEVELS	32
+
+/*!
+\brief Maximum number of surfaces with cached mip levels; the least recently used are dropped.
+*/
+#define MAX_MIP_CHAINS	16
+
+/*!
+\brief The cached mip levels of a surface.
+
+The cache does not hold a reference on 'surface'; the pointer is only compared, and
+the levels are reused only while size, format and the hash of the pixels all match.
+*/
+typedef struct tMipChain {
+	SDL_Surface *surface;
+	void *pixels;
+	int w;
+	int h;
+	int pitch;
+	Uint32 format;
+	Uint32 signature;
+	int filter;
+	SDL_Surface *levels[MAX_MIP_LEVELS];
+	struct tMipChain *next;
+} tMipChain;
+
+/*!
+\brief The mip chain cache.
+*/
+static struct {
+	SDL_SpinLock initlock;
+	SDL_mutex *lock;
+	tMipChain *chains;
+} _mipCache;
+
+/*!
+\brief Number of mip levels, including the level 0 source, of a surface size.
+*/
+static int _mipLevelCount(int width, int height)
+{
+	int levels = 1;
+
+	while (((width > 1) || (height > 1)) && (levels < MAX_MIP_LEVELS)) {
+		width = MAX(width >> 1, 1);
+		height = MAX(height >> 1, 1);
+		levels++;
+	}
+	return levels;
+}
+
+/*!
+\brief Hashes all pixels (and the palette and colorkey of 8 bit surfaces) to detect changed content.
+*/
+static Uint32 _surfaceSignature(SDL_Surface *src)
+{
+	Uint32 hash = 2166136261u;
+	Uint32 word, key;
+	int x, y, bytes, words;
+	const Uint8 *p;
+	SDL_Palette *palette;
+
+	bytes = src->w * src->format->BytesPerPixel;
+	words = bytes / 4;
+	for (y = 0; y < src->h; y++) {
+		p = (const Uint8 *) src->pixels + y * src->pitch;
+		for (x = 0; x < words; x++) {
+			memcpy(&word, p + x * 4, 4);
+			hash = (hash ^ word) * 16777619u;
+		}
+		for (x = words * 4; x < bytes; x++) {
+			hash = (hash ^ p[x]) * 16777619u;
+		}
+	}
+
+	palette = src->format->palette;
+	if (palette != NULL) {
+		for (x = 0; x < palette->ncolors; x++) {
+			memcpy(&word, &palette->colors[x], 4);
+			hash = (hash ^ word) * 16777619u;
+		}
+	}
+	if (SDL_GetColorKey(src, &key) == 0) {
+		hash = (hash ^ key ^ 0x80000000u) * 16777619u;
+	}
+	return hash;
+}
+
+/*!
+\brief Creates an empty surface of the given size with the depth, masks and palette of 'src'.
+*/
+static SDL_Surface *_createLevelSurface(SDL_Surface *src, int width, int height)
+{
+	SDL_Surface *level;
+	Uint32 key;
+
+	if (src->format->BitsPerPixel == 32) {
+		return SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 32,
+			src->format->Rmask, src->format->Gmask,
+			src->format->Bmask, src->format->Amask);
+	}
+
+	level = SDL_CreateRGBSurface(SDL_SWSURFACE, width, height, 8, 0, 0, 0, 0);
+	if (level != NULL) {
+		_copyPalette(src, level);
+		if (SDL_GetColorKey(src, &key) == 0) {
+			SDL_SetColorKey(level, SDL_TRUE, key);
+		}
+	}
+	return level;
+}
+
+/*!
+\brief Frees the levels (but not the source) of a mip chain.
+*/
+static void _mipChainClear(tMipChain *chain)
+{
+	int i;
+
+	for (i = 1; i < MAX_MIP_LEVELS; i++) {
+		if (chain->levels[i] != NULL) {
+			SDL_FreeSurface(chain->levels[i]);
+			chain->levels[i] = NULL;
+		}
+	}
+}
+
+/*!
+\brief Returns a level of a mip chain, generating missing levels from the previous one.
+
+Call with the cache lock held and the source surface locked.
+
+\param chain The mip chain.
+\param level The level to return; clamped to the smallest level.
+
+\return The level surface or NULL for error.
+*/
+static SDL_Surface *_mipChainLevel(tMipChain *chain, int level)
+{
+	SDL_Surface *prev;
+	int i, numlevels;
+
+	numlevels = _mipLevelCount(chain->w, chain->h);
+	if (level > numlevels - 1) {
+		level = numlevels - 1;
+	}
+	if (level < 1) {
+		return chain->surface;
+	}
+
+	for (i = 1; i <= level; i++) {
+		if (chain->levels[i] != NULL) {
+			continue;
+		}
+		prev = (i == 1) ? chain->surface : chain->levels[i - 1];
+		chain->levels[i] = _createLevelSurface(prev, MAX(chain->w >> i, 1), MAX(chain->h >> i, 1));
+		if (chain->levels[i] == NULL) {
+			return NULL;
+		}
+		if (_resampleSurface(prev, chain->levels[i], chain->filter) < 0) {
+			SDL_FreeSurface(chain->levels[i]);
+			chain->levels[i] = NULL;
+			SDL_OutOfMemory();
+			return NULL;
+		}
+	}
+
+	return chain->levels[level];
+}
+
+/*!
+\brief Releases a cache entry.
+*/
+static void _mipChainFree(tMipChain *chain)
+{
+	_mipChainClear(chain);
+	free(chain);
+}
+
+/*!
+\brief Locks the mip cache, creating the lock on first use.
+
+\return 0 for success or -1 for error.
+*/
+static int _lockMipCache(void)
+{
+	SDL_AtomicLock(&_mipCache.initlock);
+	if (_mipCache.lock == NULL) {
+		_mipCache.lock = SDL_CreateMutex();
+	}
+	SDL_AtomicUnlock(&_mipCache.initlock);
+	if (_mipCache.lock == NULL) {
+		return (-1);
+	}
+	return SDL_LockMutex(_mipCache.lock);
+}
+
+/*!
+\brief Drops the least recently used entries beyond MAX_MIP_CHAINS. Call with the cache lock held.
+*/
+static void _pruneMipCache(void)
+{
+	tMipChain **link, *chain;
+	int count = 0;
+
+	link = &_mipCache.chains;
+	while (*link != NULL) {
+		chain = *link;
+		if (++count > MAX_MIP_CHAINS) {
+			*link = chain->next;
+			_mipChainFree(chain);
+		} else {
+			link = &chain->next;
+		}
+	}
+}
+
+/*!
+\brief Finds or creates the cached mip chain of a surface. Call with the cache lock held.
+
+Cached levels are discarded if the size, format or pixel hash of the surface changed.
+
+\param src The source surface (8 or 32 bit), locked by the caller.
+\param filter The filter used to generate the levels.
+
+\return The mip chain or NULL for error.
+*/
+static tMipChain *_getMipChain(SDL_Surface *src, int filter)
+{
+	tMipChain **link, *chain;
+	Uint32 signature;
+
+	signature = _surfaceSignature(src);
+	for (link = &_mipCache.chains; *link != NULL; link = &(*link)->next) {
+		if (((*link)->surface == src) && ((*link)->filter == filter)) {
+			break;
+		}
+	}
+
+	chain = *link;
+	if (chain == NULL) {
+		chain = (tMipChain *) calloc(1, sizeof(tMipChain));
+		if (chain == NULL) {
+			SDL_OutOfMemory();
+			return NULL;
+		}
+		chain->surface = src;
+		chain->filter = filter;
+		chain->next = _mipCache.chains;
+		_mipCache.chains = chain;
+		_pruneMipCache();
 	} else {
-		for (y = 0; y < dst->h; y++) {
-			dy = cy - y;
-			sdx = (ax + (isin * dy)) + xd;
-			sdy = (ay - (icos * dy)) + yd;
-			for (x = 0; x < dst->w; x++) {
-				dx = (short) (sdx >> 16);
-				dy = (short) (sdy >> 16);
-				if (flipx) dx = (src->w-1)-dx;
-				if (flipy) dy = (src->h-1)-dy;
-				if ((dx >= 0) && (dy >= 0) && (dx < src->w) && (dy < src->h)) {
-					sp = (tColorRGBA *) ((Uint8 *) src->pixels + src->pitch * dy);
-					sp += dx;
-					*pc = *sp;
-				}
-				sdx += icos;
-				sdy += isin;
-				pc++;
-			}
-			pc = (tColorRGBA *) ((Uint8 *) pc + gap);
+		/*
+		* Move to the front, keeping the list in order of use
+		*/
+		*link = chain->next;
+		chain->next = _mipCache.chains;
+		_mipCache.chains = chain;
+		if ((chain->pixels == src->pixels) && (chain->w == src->w) && (chain->h == src->h) &&
+			(chain->pitch == src->pitch) && (chain->format == src->format->format) && (chain->signature == signature)) {
+				return chain;
 		}
 	}
+
+	_mipChainClear(chain);
+	chain->pixels = src->pixels;
+	chain->w = src->w;
+	chain->h = src->h;
+	chain->pitch = src->pitch;
+	chain->format = src->format->format;
+	chain->signature = signature;
+
+	return chain;
 }
 
 /*!
+\brief Job data of blending two surfaces.
+*/
+typedef struct tBlendJob {
+	SDL_Surface *dst;
+	SDL_Surface *other;
+	int weight;
+} tBlendJob;
 
-\brief Rotates and zooms 8 bit palette/Y 'src' surface to 'dst' surface without smoothing.
+/*!
+\brief Blends a tile of 'other' into 'dst' by weight/256.
+*/
+static void _blendTile(void *data, int x0, int y0, int x1, int y1)
+{
+	tBlendJob *job = (tBlendJob *) data;
+	int y, i, bytes;
+	Uint8 *dp;
+	const Uint8 *op;
+
+	bytes = (x1 - x0) * 4;
+	for (y = y0; y < y1; y++) {
+		dp = (Uint8 *) job->dst->pixels + y * job->dst->pitch + x0 * 4;
+		op = (const Uint8 *) job->other->pixels + y * job->other->pitch + x0 * 4;
+		for (i = 0; i < bytes; i++) {
+			dp[i] = (Uint8) (dp[i] + (((op[i] - dp[i]) * job->weight) >> 8));
+		}
+	}
+}
 
-Rotates and zooms 8 bit RGBA/ABGR 'src' surface to 'dst' surface based on the control 
-parameters by scanning the destination surface.
-Assumes src and dst surfaces are of 8 bit depth.
+/*!
+\brief Internal trilinear zoomer.
+
+Zooms 'src' surface to 'dst' surface by sampling the mip levels of 'src'
+matching the shrinking ratio: 32 bit surfaces are bilinear interpolated from the two
+nearest levels and blended, 8 bit surfaces are zoomed from the nearest level.
+Magnification falls back to the bilinear (32 bit) or plain (8 bit) zoomer.
+Assumes src and dst surfaces are of the same depth (8 or 32 bit).
 Assumes dst surface was allocated with the correct dimensions.
 
-\param src Source surface.
-\param dst Destination surface.
-\param cx Horizontal center coordinate.
-\param cy Vertical center coordinate.
-\param isin Integer version of sine of angle.
-\param icos Integer version of cosine of angle.
-\param flipx Flag indicating horizontal mirroring should be applied.
-\param flipy Flag indicating vertical mirroring should be applied.
+\param src The surface to zoom (input).
+\param dst The zoomed surface (output).
+\param flipx Flag indicating if the image should be horizontally flipped.
+\param flipy Flag indicating if the image should be vertically flipped.
+\param cache Flag indicating if the levels are kept in the mip cache; clear it for
+temporary surfaces, whose levels are generated and freed in this call.
+
+\return 0 for success or -1 for error.
 */
-void transformSurfaceY(SDL_Surface * src, SDL_Surface * dst, int cx, int cy, int isin, int icos, int flipx, int flipy)
+int _zoomSurfaceTrilinear(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int cache)
 {
-	int x, y, dx, dy, xd, yd, sdx, sdy, ax, ay;
-	tColorY *pc, *sp;
-	int gap;
+	tMipChain *chain, temp;
+	SDL_Surface *level0, *level1, *other;
+	tBlendJob job;
+	double scale, lod;
+	int is32bit, l0, weight, result;
+
+	is32bit = (src->format->BitsPerPixel == 32);
+	scale = MAX((double) src->w / (double) dst->w, (double) src->h / (double) dst->h);
+	if (scale <= 1.0) {
+		return (is32bit) ? _zoomSurfaceRGBA(src, dst, flipx, flipy, SMOOTHING_ON) : _zoomSurfaceY(src, dst, flipx, flipy);
+	}
+
+	lod = log(scale) / log(2.0);
+	if (!is32bit) {
+		lod += 0.5;
+	}
+	l0 = (int) floor(lod);
+	weight = (int) ((lod - l0) * 256.0);
+
+	if (cache) {
+		if (_lockMipCache() < 0) {
+			return (-1);
+		}
+		chain = _getMipChain(src, MIPFILTER_BOX);
+	} else {
+		memset(&temp, 0, sizeof(temp));
+		temp.surface = src;
+		temp.w = src->w;
+		temp.h = src->h;
+		temp.filter = MIPFILTER_BOX;
+		chain = &temp;
+	}
+	result = -1;
+	if (chain == NULL) {
+		goto exitTrilinear;
+	}
+	level0 = _mipChainLevel(chain, l0);
+	if (level0 == NULL) {
+		goto exitTrilinear;
+	}
+	if (!is32bit) {
+		result = _zoomSurfaceY(level0, dst, flipx, flipy);
+		goto exitTrilinear;
+	}
+	level1 = _mipChainLevel(chain, l0 + 1);
+	if (level1 == NULL) {
+		goto exitTrilinear;
+	}
+
+	result = _zoomSurfaceRGBA(level0, dst, flipx, flipy, SMOOTHING_ON);
+	if ((result < 0) || (level1 == level0) || (weight == 0)) {
+		goto exitTrilinear;
+	}
 
 	/*
-	* Variable setup 
-	*/
-	xd = ((src->w - dst->w) << 15);
-	yd = ((src->h - dst->h) << 15);
-	ax = (cx << 16) - (icos * cx);
-	ay = (cy << 16) - (isin * cx);
-	pc = (tColorY*) dst->pixels;
-	gap = dst->pitch - dst->w;
-	/*
-	* Clear surface to colorkey 
-	*/ 	
-	memset(pc, (int)(_colorkey(src) & 0xff), dst->pitch * dst->h);
-	/*
-	* Iterate through destination surface 
+	* Blend in the next smaller level
 	*/
-	for (y = 0; y < dst->h; y++) {
-		dy = cy - y;
-		sdx = (ax + (isin * dy)) + xd;
-		sdy = (ay - (icos * dy)) + yd;
-		for (x = 0; x < dst->w; x++) {
-			dx = (short) (sdx >> 16);
-			dy = (short) (sdy >> 16);
-			if (flipx) dx = (src->w-1)-dx;
-			if (flipy) dy = (src->h-1)-dy;
-			if ((dx >= 0) && (dy >= 0) && (dx < src->w) && (dy < src->h)) {
-				sp = (tColorY *) (src->pixels);
-				sp += (src->pitch * dy + dx);
-				*pc = *sp;
-			}
-			sdx += icos;
-			sdy += isin;
-			pc++;
-		}
-		pc += gap;
+	other = _createLevelSurface(dst, dst->w, dst->h);
+	if (other == NULL) {
+		result = -1;
+		goto exitTrilinear;
+	}
+	result = _zoomSurfaceRGBA(level1, other, flipx, flipy, SMOOTHING_ON);
+	if (result == 0) {
+		job.dst = dst;
+		job.other = other;
+		job.weight = weight;
+		_renderTiled(_blendTile, &job, dst->w, dst->h);
+	}
+	SDL_FreeSurface(other);
+
+exitTrilinear:
+	if (cache) {
+		SDL_UnlockMutex(_mipCache.lock);
+	} else {
+		_mipChainClear(&temp);
 	}
+	return (result);
 }
 
 /*!
@@ -1028,7 +2111,8 @@ or 32bit RGBA/ABGR it will be converted into a 32bit RGBA format on the fly.
 \param src The surface to rotozoom.
 \param angle The angle to rotate in degrees.
 \param zoom The scaling factor.
-\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable or SMOOTHING_TRILINEAR
+to sample the mip levels of the source when shrinking.
 
 \return The new rotozoomed surface.
 */
@@ -1049,7 +2133,8 @@ or 32bit RGBA/ABGR it will be converted into a 32bit RGBA format on the fly.
 \param angle The angle to rotate in degrees.
 \param zoomx The horizontal scaling factor.
 \param zoomy The vertical scaling factor.
-\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable or SMOOTHING_TRILINEAR
+to sample the mip levels of the source when shrinking.
 
 \return The new rotozoomed surface.
 */
@@ -1258,7 +2343,11 @@ SDL_Surface *rotozoomSurfaceXY(SDL_Surface * src, double angle, double zoomx, do
 			/*
 			* Call the 32bit transformation routine to do the zooming (using alpha) 
 			*/
-			_zoomSurfaceRGBA(rz_src, rz_dst, flipx, flipy, smooth);
+			if (smooth == SMOOTHING_TRILINEAR) {
+				_zoomSurfaceTrilinear(rz_src, rz_dst, flipx, flipy, !src_converted);
+			} else {
+				_zoomSurfaceRGBA(rz_src, rz_dst, flipx, flipy, smooth);
+			}
 
 		} else {
 			/*
@@ -1272,7 +2361,11 @@ SDL_Surface *rotozoomSurfaceXY(SDL_Surface * src, double angle, double zoomx, do
 			/*
 			* Call the 8bit transformation routine to do the zooming 
 			*/
-			_zoomSurfaceY(rz_src, rz_dst, flipx, flipy);
+			if (smooth == SMOOTHING_TRILINEAR) {
+				_zoomSurfaceTrilinear(rz_src, rz_dst, flipx, flipy, !src_converted);
+			} else {
+				_zoomSurfaceY(rz_src, rz_dst, flipx, flipy);
+			}
 		}
 
 		/*
@@ -1354,7 +2447,8 @@ If zoom factors are negative, the image is flipped on the axes.
 \param src The surface to zoom.
 \param zoomx The horizontal zoom factor.
 \param zoomy The vertical zoom factor.
-\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable or SMOOTHING_TRILINEAR
+to sample the mip levels of the source when shrinking.
 
 \return The new, zoomed surface.
 */
@@ -1408,88 +2502,317 @@ SDL_Surface *zoomSurface(SDL_Surface * src, double zoomx, double zoomy, int smoo
 	flipy = (zoomy<0.0);
 	if (flipy) zoomy = -zoomy;
 
-	/* Get size if target */
-	zoomSurfaceSize(rz_src->w, rz_src->h, zoomx, zoomy, &dstwidth, &dstheight);
+	/* Get size if target */
+	zoomSurfaceSize(rz_src->w, rz_src->h, zoomx, zoomy, &dstwidth, &dstheight);
+
+	/*
+	* Alloc space to completely contain the zoomed surface 
+	*/
+	rz_dst = NULL;
+	if (is32bit) {
+		/*
+		* Target surface is 32bit with source RGBA/ABGR ordering 
+		*/
+		rz_dst =
+			SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 32,
+			rz_src->format->Rmask, rz_src->format->Gmask,
+			rz_src->format->Bmask, rz_src->format->Amask);
+	} else {
+		/*
+		* Target surface is 8bit 
+		*/
+		rz_dst = SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 8, 0, 0, 0, 0);
+	}
+
+	/* Check target */
+	if (rz_dst == NULL) {
+		/*
+		* Cleanup temp surface 
+		*/
+		if (src_converted) {
+			SDL_FreeSurface(rz_src);
+		}		
+		return NULL;
+	}
+
+	/* Adjust for guard rows */
+	rz_dst->h = dstheight;
+
+	/*
+	* Lock source surface 
+	*/
+	if (SDL_MUSTLOCK(rz_src)) {
+		SDL_LockSurface(rz_src);
+	}
+
+	/*
+	* Check which kind of surface we have 
+	*/
+	if (is32bit) {
+		/*
+		* Call the 32bit transformation routine to do the zooming (using alpha) 
+		*/
+		if (smooth == SMOOTHING_TRILINEAR) {
+			_zoomSurfaceTrilinear(rz_src, rz_dst, flipx, flipy, !src_converted);
+		} else {
+			_zoomSurfaceRGBA(rz_src, rz_dst, flipx, flipy, smooth);
+		}
+	} else {
+		/*
+		* Copy palette and colorkey info 
+		*/
+		for (i = 0; i < rz_src->format->palette->ncolors; i++) {
+			rz_dst->format->palette->colors[i] = rz_src->format->palette->colors[i];
+		}
+		rz_dst->format->palette->ncolors = rz_src->format->palette->ncolors;
+		/*
+		* Call the 8bit transformation routine to do the zooming 
+		*/
+		if (smooth == SMOOTHING_TRILINEAR) {
+			_zoomSurfaceTrilinear(rz_src, rz_dst, flipx, flipy, !src_converted);
+		} else {
+			_zoomSurfaceY(rz_src, rz_dst, flipx, flipy);
+		}
+	}
+	/*
+	* Unlock source surface 
+	*/
+	if (SDL_MUSTLOCK(rz_src)) {
+		SDL_UnlockSurface(rz_src);
+	}
+
+	/*
+	* Cleanup temp surface 
+	*/
+	if (src_converted) {
+		SDL_FreeSurface(rz_src);
+	}
+
+	/*
+	* Return destination surface 
+	*/
+	return (rz_dst);
+}
+
+/*!
+\brief Checks that a source and a caller provided destination surface can be used together.
+
+\param src The source surface.
+\param dst The destination surface.
+
+\return 1 if the surfaces are 32 bit, 0 if they are 8 bit or -1 for error.
+*/
+static int _checkIntoSurfaces(SDL_Surface * src, SDL_Surface * dst)
+{
+	if ((src == NULL) || (dst == NULL)) {
+		SDL_SetError("NULL source or destination surface");
+		return (-1);
+	}
+	if (src->format->BitsPerPixel != dst->format->BitsPerPixel) {
+		SDL_SetError("Source and destination surfaces must have the same depth");
+		return (-1);
+	}
+	if (src->format->BitsPerPixel == 32) {
+		return (1);
+	}
+	if (src->format->BitsPerPixel == 8) {
+		return (0);
+	}
+	SDL_SetError("Only 8 bit and 32 bit surfaces are supported");
+	return (-1);
+}
+
+/*!
+\brief Zooms a surface into a caller provided surface.
+
+Zooms a 32bit or 8bit 'src' surface to fill the existing 'dst' surface of the same
+depth, so the destination can be reused between frames. The zoom factors follow from
+the surface sizes. If 'smooth' is on then the destination 32bit surface is anti-aliased.
+For 8bit surfaces the palette is copied to the destination.
+
+\param src The surface to zoom.
+\param dst The destination surface (output).
+\param flipx Flag indicating if the image should be horizontally flipped.
+\param flipy Flag indicating if the image should be vertically flipped.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable or SMOOTHING_TRILINEAR
+to sample the mip levels of 'src'.
+
+\return 0 for success or -1 for error.
+*/
+int zoomSurfaceInto(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int smooth)
+{
+	tZoomPlan *plan;
+	int result;
+	int is32bit;
+
+	is32bit = _checkIntoSurfaces(src, dst);
+	if (is32bit < 0) {
+		return (-1);
+	}
+
+	if (smooth == SMOOTHING_TRILINEAR) {
+		if (SDL_MUSTLOCK(src)) {
+			SDL_LockSurface(src);
+		}
+		if (SDL_MUSTLOCK(dst)) {
+			SDL_LockSurface(dst);
+		}
+		if (!is32bit) {
+			_copyPalette(src, dst);
+		}
+		result = _zoomSurfaceTrilinear(src, dst, flipx, flipy, 1);
+		if (SDL_MUSTLOCK(dst)) {
+			SDL_UnlockSurface(dst);
+		}
+		if (SDL_MUSTLOCK(src)) {
+			SDL_UnlockSurface(src);
+		}
+		return (result);
+	}
+
+	plan = zoomPlanCreate(src->w, src->h, dst->w, dst->h, (is32bit) ? 32 : 8, flipx, flipy, smooth);
+	if (plan == NULL) {
+		return (-1);
+	}
+	result = zoomSurfaceWithPlan(plan, src, dst);
+	zoomPlanFree(plan);
+
+	return (result);
+}
+
+/*!
+\brief Zooms a surface into a caller provided surface using a precomputed plan.
+
+Renders 'src' into 'dst' with the source coordinates precalculated by zoomPlanCreate(),
+which avoids recalculating them for repeated zooms between the same sizes.
+For 8bit surfaces the palette is copied to the destination.
+
+\param plan The plan created for the surface sizes and depth.
+\param src The surface to zoom.
+\param dst The destination surface (output).
+
+\return 0 for success or -1 for error.
+*/
+int zoomSurfaceWithPlan(const tZoomPlan *plan, SDL_Surface * src, SDL_Surface * dst)
+{
+	int is32bit;
+
+	if (plan == NULL) {
+		SDL_SetError("NULL zoom plan");
+		return (-1);
+	}
+	is32bit = _checkIntoSurfaces(src, dst);
+	if (is32bit < 0) {
+		return (-1);
+	}
+	if ((is32bit != plan->is32bit) || (src->w != plan->srcw) || (src->h != plan->srch) ||
+		(dst->w != plan->dstw) || (dst->h != plan->dsth)) {
+			SDL_SetError("Surfaces do not match the zoom plan");
+			return (-1);
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_LockSurface(dst);
+	}
 
-	/*
-	* Alloc space to completely contain the zoomed surface 
-	*/
-	rz_dst = NULL;
-	if (is32bit) {
-		/*
-		* Target surface is 32bit with source RGBA/ABGR ordering 
-		*/
-		rz_dst =
-			SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 32,
-			rz_src->format->Rmask, rz_src->format->Gmask,
-			rz_src->format->Bmask, rz_src->format->Amask);
-	} else {
-		/*
-		* Target surface is 8bit 
-		*/
-		rz_dst = SDL_CreateRGBSurface(SDL_SWSURFACE, dstwidth, dstheight + GUARD_ROWS, 8, 0, 0, 0, 0);
+	if (!is32bit) {
+		_copyPalette(src, dst);
 	}
+	_zoomSurfacePlanned(plan, src, dst);
 
-	/* Check target */
-	if (rz_dst == NULL) {
-		/*
-		* Cleanup temp surface 
-		*/
-		if (src_converted) {
-			SDL_FreeSurface(rz_src);
-		}		
-		return NULL;
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_UnlockSurface(dst);
+	}
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
 	}
 
-	/* Adjust for guard rows */
-	rz_dst->h = dstheight;
+	return (0);
+}
+
+/*!
+\brief Rotates and zooms a surface into a caller provided surface.
+
+Rotates and zooms a 32bit or 8bit 'src' surface around the center of the existing
+'dst' surface of the same depth, so the destination can be reused between frames.
+Size 'dst' with rotozoomSurfaceSizeXY() to get the same result as rotozoomSurfaceXY().
+Destination pixels not covered by the source are cleared (32bit) or set to the
+colorkey (8bit). If the angle is 0 the source is zoomed to fill the destination.
+
+\param src The surface to rotozoom.
+\param dst The destination surface (output).
+\param angle The angle to rotate in degrees.
+\param zoomx The horizontal scaling factor.
+\param zoomy The vertical scaling factor.
+\param smooth Antialiasing flag; set to SMOOTHING_ON to enable.
+
+\return 0 for success or -1 for error.
+*/
+int rotozoomSurfaceXYInto(SDL_Surface * src, SDL_Surface * dst, double angle, double zoomx, double zoomy, int smooth)
+{
+	double zoominv;
+	double sanglezoom, canglezoom;
+	int dstwidth, dstheight;
+	int is32bit;
+	int flipx, flipy;
+
+	is32bit = _checkIntoSurfaces(src, dst);
+	if (is32bit < 0) {
+		return (-1);
+	}
 
 	/*
-	* Lock source surface 
+	* Sanity check zoom factor 
 	*/
-	if (SDL_MUSTLOCK(rz_src)) {
-		SDL_LockSurface(rz_src);
+	flipx = (zoomx<0.0);
+	if (flipx) zoomx=-zoomx;
+	flipy = (zoomy<0.0);
+	if (flipy) zoomy=-zoomy;
+	if (zoomx < VALUE_LIMIT) zoomx = VALUE_LIMIT;
+	if (zoomy < VALUE_LIMIT) zoomy = VALUE_LIMIT;
+
+	if (fabs(angle) <= VALUE_LIMIT) {
+		return zoomSurfaceInto(src, dst, flipx, flipy, smooth);
 	}
 
 	/*
-	* Check which kind of surface we have 
+	* Calculate target factors from sin/cos and zoom 
 	*/
+	_rotozoomSurfaceSizeTrig(src->w, src->h, angle, zoomx, zoomy, &dstwidth, &dstheight, &canglezoom, &sanglezoom);
+	zoominv = 65536.0 / (zoomx * zoomx);
+	sanglezoom *= zoominv;
+	canglezoom *= zoominv;
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_LockSurface(dst);
+	}
+
 	if (is32bit) {
-		/*
-		* Call the 32bit transformation routine to do the zooming (using alpha) 
-		*/
-		_zoomSurfaceRGBA(rz_src, rz_dst, flipx, flipy, smooth);
+		_transformSurfaceRGBA(src, dst, dst->w / 2, dst->h / 2,
+			(int) (sanglezoom), (int) (canglezoom),
+			flipx, flipy,
+			smooth);
 	} else {
-		/*
-		* Copy palette and colorkey info 
-		*/
-		for (i = 0; i < rz_src->format->palette->ncolors; i++) {
-			rz_dst->format->palette->colors[i] = rz_src->format->palette->colors[i];
-		}
-		rz_dst->format->palette->ncolors = rz_src->format->palette->ncolors;
-		/*
-		* Call the 8bit transformation routine to do the zooming 
-		*/
-		_zoomSurfaceY(rz_src, rz_dst, flipx, flipy);
-	}
-	/*
-	* Unlock source surface 
-	*/
-	if (SDL_MUSTLOCK(rz_src)) {
-		SDL_UnlockSurface(rz_src);
+		_copyPalette(src, dst);
+		transformSurfaceY(src, dst, dst->w / 2, dst->h / 2,
+			(int) (sanglezoom), (int) (canglezoom),
+			flipx, flipy);
 	}
 
-	/*
-	* Cleanup temp surface 
-	*/
-	if (src_converted) {
-		SDL_FreeSurface(rz_src);
+	if (SDL_MUSTLOCK(dst)) {
+		SDL_UnlockSurface(dst);
+	}
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
 	}
 
-	/*
-	* Return destination surface 
-	*/
-	return (rz_dst);
+	return (0);
 }
 
 /*! 
@@ -1661,3 +2984,250 @@ exitShrinkSurface:
 	*/
 	return (rz_dst);
 }
+
+/*!
+\brief Returns the number of mip levels of a surface size.
+
+Level 0 is the surface itself, each further level halves width and height
+(down to 1) until a 1x1 level is reached.
+
+\param width The surface width.
+\param height The surface height.
+
+\return The number of levels.
+*/
+int mipSurfaceLevelCount(int width, int height)
+{
+	if ((width < 1) || (height < 1)) {
+		return 0;
+	}
+	return _mipLevelCount(width, height);
+}
+
+/*!
+\brief Returns a mip level of a surface.
+
+Generates the mip chain of a 32bit or 8bit 'src' surface up to 'level' with the box or
+Lanczos filter and caches it with the surface, so repeated downscales of the same
+image reuse the levels. Level 0 is 'src' itself; higher levels are clamped to the
+smallest (1x1) level. The cache hashes all pixels of 'src' on every call and
+regenerates the levels when the size, format or content changed. It keeps the levels
+of the most recently used surfaces only and holds no reference on them; the levels of
+a surface can be released early with mipSurfaceInvalidate() or mipCacheFlush().
+
+\param src The source surface.
+\param level The level to return.
+\param filter The filter generating the levels; MIPFILTER_BOX or MIPFILTER_LANCZOS.
+
+\return The level surface which is owned by the cache and must not be freed,
+or NULL for error. It stays valid until the next mip call or until the levels of 'src' are invalidated.
+*/
+SDL_Surface *mipSurfaceLevel(SDL_Surface * src, int level, int filter)
+{
+	tMipChain *chain;
+	SDL_Surface *result = NULL;
+
+	/*
+	* Sanity check
+	*/
+	if (src == NULL) {
+		return (NULL);
+	}
+	if ((src->format->BitsPerPixel != 32) && (src->format->BitsPerPixel != 8)) {
+		SDL_SetError("Only 8 bit and 32 bit surfaces are supported");
+		return (NULL);
+	}
+	if (level < 1) {
+		return (src);
+	}
+
+	if (_lockMipCache() < 0) {
+		return (NULL);
+	}
+	if (SDL_MUSTLOCK(src)) {
+		SDL_LockSurface(src);
+	}
+
+	chain = _getMipChain(src, (filter == MIPFILTER_LANCZOS) ? MIPFILTER_LANCZOS : MIPFILTER_BOX);
+	if (chain != NULL) {
+		result = _mipChainLevel(chain, level);
+	}
+
+	if (SDL_MUSTLOCK(src)) {
+		SDL_UnlockSurface(src);
+	}
+	SDL_UnlockMutex(_mipCache.lock);
+
+	return (result);
+}
+
+/*!
+\brief Discards the cached mip levels of a surface.
+
+Call this to release the levels of a surface no longer zoomed, e.g. before freeing it.
+
+\param src The surface whose levels are discarded.
+*/
+void mipSurfaceInvalidate(SDL_Surface * src)
+{
+	tMipChain **link, *chain;
+
+	if ((src == NULL) || (_lockMipCache() < 0)) {
+		return;
+	}
+	link = &_mipCache.chains;
+	while (*link != NULL) {
+		chain = *link;
+		if (chain->surface == src) {
+			*link = chain->next;
+			_mipChainFree(chain);
+		} else {
+			link = &chain->next;
+		}
+	}
+	SDL_UnlockMutex(_mipCache.lock);
+}
+
+/*!
+\brief Discards all cached mip levels.
+*/
+void mipCacheFlush(void)
+{
+	tMipChain *chain;
+
+	if (_lockMipCache() < 0) {
+		return;
+	}
+	while (_mipCache.chains != NULL) {
+		chain = _mipCache.chains;
+		_mipCache.chains = chain->next;
+		_mipChainFree(chain);
+	}
+	SDL_UnlockMutex(_mipCache.lock);
+}
+
+/*!
+\brief Stops the worker threads and frees the cached mip levels.
+
+Call this before unloading the library or quitting SDL, when no other thread is
+using the rotozoom functions. The thread count set with rotozoomSetThreads() is
+kept, and the pool and cache are set up again if the functions are used later.
+*/
+void rotozoomQuit(void)
+{
+	SDL_AtomicLock(&_tilePool.initlock);
+	if (_tilePool.initialized) {
+		SDL_LockMutex(_tilePool.lock);
+		_stopTileWorkers();
+		SDL_UnlockMutex(_tilePool.lock);
+		SDL_DestroyMutex(_tilePool.lock);
+		SDL_DestroySemaphore(_tilePool.start);
+		SDL_DestroySemaphore(_tilePool.done);
+		_tilePool.lock = NULL;
+		_tilePool.start = NULL;
+		_tilePool.done = NULL;
+		_tilePool.initialized = 0;
+	}
+	SDL_AtomicUnlock(&_tilePool.initlock);
+
+	mipCacheFlush();
+	SDL_AtomicLock(&_mipCache.initlock);
+	if (_mipCache.lock != NULL) {
+		SDL_DestroyMutex(_mipCache.lock);
+		_mipCache.lock = NULL;
+	}
+	SDL_AtomicUnlock(&_mipCache.initlock);
+}
+
+/*! 
+\brief Shrink a surface by arbitrary ratios using a box or Lanczos filter.
+
+Shrinks a 32bit or 8bit 'src' surface to a newly created 'dst' surface.
+'factorx' and 'factory' are the shrinking ratios (i.e. 2.5=1/2.5 the size)
+and need not be integers. The destination surface is antialiased by averaging
+the covered source area (MIPFILTER_BOX) or by Lanczos filtering (MIPFILTER_LANCZOS).
+If the surface is not 8bit or 32bit RGBA/ABGR it will be converted into a 32bit
+RGBA format on the fly. The input surface is not modified. The output surface is
+newly allocated.
+
+\param src The surface to shrink.
+\param factorx The horizontal shrinking ratio.
+\param factory The vertical shrinking ratio.
+\param filter The filter to use; MIPFILTER_BOX or MIPFILTER_LANCZOS.
+
+\return The new, shrunken surface.
+*/
+/*@null@*/ 
+SDL_Surface *shrinkSurfaceFiltered(SDL_Surface *src, double factorx, double factory, int filter)
+{
+	SDL_Surface *rz_src;
+	SDL_Surface *rz_dst;
+	int dstwidth, dstheight;
+	int result;
+
+	/*
+	* Sanity check 
+	*/
+	if (src == NULL) {
+		return (NULL);
+	}
+	if (factorx < VALUE_LIMIT) factorx = VALUE_LIMIT;
+	if (factory < VALUE_LIMIT) factory = VALUE_LIMIT;
+
+	/*
+	* Determine if source surface is 32bit or 8bit 
+	*/
+	if ((src->format->BitsPerPixel == 32) || (src->format->BitsPerPixel == 8)) {
+		/*
+		* Use source surface 'as is' 
+		*/
+		rz_src = src;
+	} else {
+		/*
+		* New source surface is 32bit with a defined RGBA ordering 
+		*/
+		rz_src = SDL_CreateRGBSurface(SDL_SWSURFACE, src->w, src->h, 32, 
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+			0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000
+#else
+			0xff000000,  0x00ff0000, 0x0000ff00, 0x000000ff
+#endif
+			);
+		if (rz_src == NULL) {
+			return (NULL);
+		}
+		SDL_BlitSurface(src, NULL, rz_src, NULL);
+	}
+
+	/* Get size for target */
+	dstwidth = MAX((int) ((double) rz_src->w / factorx), 1);
+	dstheight = MAX((int) ((double) rz_src->h / factory), 1);
+
+	/*
+	* Alloc space to completely contain the shrunken surface
+	*/
+	rz_dst = _createLevelSurface(rz_src, dstwidth, dstheight);
+	if (rz_dst != NULL) {
+		if (SDL_MUSTLOCK(rz_src)) {
+			SDL_LockSurface(rz_src);
+		}
+		result = _resampleSurface(rz_src, rz_dst, (filter == MIPFILTER_LANCZOS) ? MIPFILTER_LANCZOS : MIPFILTER_BOX);
+		if (SDL_MUSTLOCK(rz_src)) {
+			SDL_UnlockSurface(rz_src);
+		}
+		if (result != 0) {
+			SDL_FreeSurface(rz_dst);
+			rz_dst = NULL;
+			SDL_OutOfMemory();
+		}
+	}
+
+	/*
+	* Cleanup temp surface 
+	*/
+	if (rz_src != src) {
+		SDL_FreeSurface(rz_src);
+	}
+
+	return (rz_dst);
+}
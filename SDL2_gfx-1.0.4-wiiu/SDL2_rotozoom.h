@@ -55,6 +55,26 @@ extern "C" {
 	*/
 #define SMOOTHING_ON		1
 
+	/*!
+	\brief Trilinear smoothing: zooms from the nearest mip levels of the source (see mipSurfaceLevel()).
+	*/
+#define SMOOTHING_TRILINEAR	2
+
+	/*!
+	\brief Box filter for mip levels and filtered shrinking.
+	*/
+#define MIPFILTER_BOX		0
+
+	/*!
+	\brief Lanczos filter for mip levels and filtered shrinking.
+	*/
+#define MIPFILTER_LANCZOS	1
+
+	/*!
+	\brief Precomputed source coordinates for repeated zooms between two surface sizes.
+	*/
+	typedef struct tZoomPlan tZoomPlan;
+
 	/* ---- Function Prototypes */
 
 #ifdef _MSC_VER
@@ -89,6 +109,13 @@ extern "C" {
 		(int width, int height, double angle, double zoomx, double zoomy, 
 		int *dstwidth, int *dstheight);
 
+	SDL2_ROTOZOOM_SCOPE int rotozoomSurfaceXYInto
+		(SDL_Surface * src, SDL_Surface * dst, double angle, double zoomx, double zoomy, int smooth);
+
+	SDL2_ROTOZOOM_SCOPE void rotozoomSetThreads(int numThreads);
+
+	SDL2_ROTOZOOM_SCOPE void rotozoomQuit(void);
+
 	/* 
 
 	Zooming functions
@@ -99,6 +126,15 @@ extern "C" {
 
 	SDL2_ROTOZOOM_SCOPE void zoomSurfaceSize(int width, int height, double zoomx, double zoomy, int *dstwidth, int *dstheight);
 
+	SDL2_ROTOZOOM_SCOPE int zoomSurfaceInto(SDL_Surface * src, SDL_Surface * dst, int flipx, int flipy, int smooth);
+
+	SDL2_ROTOZOOM_SCOPE tZoomPlan *zoomPlanCreate(int srcw, int srch, int dstw, int dsth, int bitsPerPixel,
+		int flipx, int flipy, int smooth);
+
+	SDL2_ROTOZOOM_SCOPE int zoomSurfaceWithPlan(const tZoomPlan *plan, SDL_Surface * src, SDL_Surface * dst);
+
+	SDL2_ROTOZOOM_SCOPE void zoomPlanFree(tZoomPlan *plan);
+
 	/* 
 
 	Shrinking functions
@@ -107,6 +143,22 @@ extern "C" {
 
 	SDL2_ROTOZOOM_SCOPE SDL_Surface *shrinkSurface(SDL_Surface * src, int factorx, int factory);
 
+	SDL2_ROTOZOOM_SCOPE SDL_Surface *shrinkSurfaceFiltered(SDL_Surface * src, double factorx, double factory, int filter);
+
+	/* 
+
+	Mipmap functions
+
+	*/
+
+	SDL2_ROTOZOOM_SCOPE int mipSurfaceLevelCount(int width, int height);
+
+	SDL2_ROTOZOOM_SCOPE SDL_Surface *mipSurfaceLevel(SDL_Surface * src, int level, int filter);
+
+	SDL2_ROTOZOOM_SCOPE void mipSurfaceInvalidate(SDL_Surface * src);
+
+	SDL2_ROTOZOOM_SCOPE void mipCacheFlush(void);
+
 	/* 
 
 	Specialized rotation functions
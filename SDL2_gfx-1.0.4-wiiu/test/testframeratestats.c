@@ -0,0 +1,105 @@
+/* 
+
+TestFramerateStats.c: test program for the framerate manager pacing and
+frame statistics, driven by a simulated clock
+
+This software is provided 'as-is', without any express or implied
+warranty.  In no event will the authors be held liable for any damages
+arising from the use of this software.
+
+Permission is granted to anyone to use this software for any purpose,
+including commercial applications, and to alter it and redistribute it
+freely.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "SDL.h"
+
+#include "SDL2_framerate.h"
+
+int total_count = 0;
+int ok_count = 0;
+
+/* Simulated clock in microseconds */
+Uint64 fake_now = 1000;
+
+Uint64 FakeCounter(void *userdata)
+{
+	return fake_now;
+}
+
+void FakeDelay(void *userdata, Uint32 ms)
+{
+	/* Sleeps overshoot by 0.3ms, yields take 20us */
+	fake_now += (ms > 0) ? (Uint64) ms * 1000 + 300 : 20;
+}
+
+void Check(const char *name, int ok)
+{
+	total_count++;
+	if (ok) {
+		ok_count++;
+	}
+	printf("%-48s %s\n", name, ok ? "OK" : "ERROR");
+}
+
+int CloseTo(float value, float expected, float tolerance)
+{
+	return (fabs(value - expected) <= tolerance);
+}
+
+int main(int argc, char *argv[])
+{
+	FPSmanager fpsm;
+	FPSstats stats;
+	Uint64 start;
+	int i;
+
+	SDL_initFramerate(&fpsm);
+	Check("SDL_setFramerateClock", SDL_setFramerateClock(&fpsm, FakeCounter, FakeDelay, 1000000, NULL) == 0);
+	Check("SDL_setFramerate 60Hz", SDL_setFramerate(&fpsm, 60) == 0);
+	Check("no stats before first frame", SDL_getFramePercentile(&fpsm, 50.0f) < 0.0f);
+
+	/* 300 frames with 5ms of work each hit the 16.67ms deadlines exactly */
+	start = fake_now;
+	for (i = 0; i < 300; i++) {
+		fake_now += 5000;
+		SDL_framerateDelay(&fpsm);
+	}
+	Check("paced 300 frames to 5s", (fake_now - start) >= 4999980 && (fake_now - start) <= 5000020);
+	SDL_getFramerateStats(&fpsm, &stats);
+	printf("  frames=%u p50=%.2f p95=%.2f p99=%.2f max=%.2f missed=%u\n",
+		stats.frames, stats.p50, stats.p95, stats.p99, stats.max, stats.missed);
+	Check("history is limited", stats.frames == FPS_HISTORY_SIZE);
+	Check("p50 is the frame period", CloseTo(stats.p50, 16.75f, 0.26f));
+	Check("p99 is the frame period", CloseTo(stats.p99, 16.75f, 0.26f));
+	Check("no missed deadlines", stats.missed == 0);
+
+	/* Every 10th frame takes 40ms of work and misses its deadline */
+	SDL_resetFramerateStats(&fpsm);
+	for (i = 0; i < 100; i++) {
+		fake_now += (i % 10 == 9) ? 40000 : 5000;
+		SDL_framerateDelay(&fpsm);
+	}
+	SDL_getFramerateStats(&fpsm, &stats);
+	printf("  frames=%u p50=%.2f p95=%.2f p99=%.2f max=%.2f missed=%u\n",
+		stats.frames, stats.p50, stats.p95, stats.p99, stats.max, stats.missed);
+	Check("missed deadlines are counted", stats.missed == 10);
+	Check("p50 is the frame period", CloseTo(stats.p50, 16.75f, 0.26f));
+	Check("p95 is the long frame", CloseTo(stats.p95, 40.0f, 0.26f));
+
+	/* A 200ms hitch lands beyond the histogram and is reported exactly */
+	fake_now += 200000;
+	SDL_framerateDelay(&fpsm);
+	Check("long frame percentile is exact", CloseTo(SDL_getFramePercentile(&fpsm, 100.0f), 200.0f, 0.001f));
+
+	SDL_resetFramerateStats(&fpsm);
+	SDL_getFramerateStats(&fpsm, &stats);
+	Check("SDL_resetFramerateStats", stats.frames == 0 && stats.missed == 0);
+
+	printf("%i of %i tests OK\n", ok_count, total_count);
+	return (ok_count == total_count) ? 0 : 1;
+}
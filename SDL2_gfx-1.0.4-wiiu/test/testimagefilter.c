@@ -162,6 +162,7 @@ int main(int argc, char *argv[])
 			setup_src(src1, src2);
 
 			SDL_imageFilterMMXon();
+			SDL_imageFilterSIMDon();
 			funcs[k].f(src1, src2, dstm, SRC_SIZE);
 			print_result(TEST_MMX, funcs[k].name, src1, src2, dstm);
 			start = SDL_GetTicks();
@@ -171,6 +172,7 @@ int main(int argc, char *argv[])
 			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 			
 			SDL_imageFilterMMXoff();
+			SDL_imageFilterSIMDoff();
 			funcs[k].f(src1, src2, dstc, SRC_SIZE);
 			print_result(TEST_C, funcs[k].name, src1, src2, dstc);
 			start = SDL_GetTicks();
@@ -211,6 +213,7 @@ int main(int argc, char *argv[])
 		setup_src(src1, src2);
 		
 		SDL_imageFilterMMXon();
+		SDL_imageFilterSIMDon();
 		SDL_imageFilterBitNegation(src1, dstm, SRC_SIZE);
 		print_result(TEST_MMX, call, src1, NULL, dstm);
 		start = SDL_GetTicks();
@@ -220,6 +223,7 @@ int main(int argc, char *argv[])
 		printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 		
 		SDL_imageFilterMMXoff();
+		SDL_imageFilterSIMDoff();
 		SDL_imageFilterBitNegation(src1, dstc, SRC_SIZE);
 		print_result(TEST_C, call, src1, NULL, dstc);
 		start = SDL_GetTicks();
@@ -264,6 +268,7 @@ int main(int argc, char *argv[])
 			setup_src(src1, src2);
 
 			SDL_imageFilterMMXon();
+			SDL_imageFilterSIMDon();
 			funcs[k].f(src1, dstm, SRC_SIZE, funcs[k].arg);
 			print_result(TEST_MMX, call, src1, NULL, dstm);
 			start = SDL_GetTicks();
@@ -273,6 +278,7 @@ int main(int argc, char *argv[])
 			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 			
 			SDL_imageFilterMMXoff();
+			SDL_imageFilterSIMDoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg);
 			print_result(TEST_C, call, src1, NULL, dstc);
 			start = SDL_GetTicks();
@@ -310,6 +316,7 @@ int main(int argc, char *argv[])
 			setup_src(src1, src2);
 
 			SDL_imageFilterMMXon();
+			SDL_imageFilterSIMDon();
 			funcs[k].f(src1, dstm, SRC_SIZE, funcs[k].arg1, funcs[k].arg2);
 			print_result(TEST_MMX, call, src1, NULL, dstm);
 			start = SDL_GetTicks();
@@ -319,6 +326,7 @@ int main(int argc, char *argv[])
 			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 			
 			SDL_imageFilterMMXoff();
+			SDL_imageFilterSIMDoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg1, funcs[k].arg2);
 			print_result(TEST_C, call, src1, NULL, dstc);
 			start = SDL_GetTicks();
@@ -342,6 +350,7 @@ int main(int argc, char *argv[])
 		setup_src(src1, src2);
 		
 		SDL_imageFilterMMXon();
+		SDL_imageFilterSIMDon();
 		SDL_imageFilterNormalizeLinear(src1, dstm, SRC_SIZE, 0,33, 0,255);
 		print_result(TEST_MMX, call, src1, NULL, dstm);
 		start = SDL_GetTicks();
@@ -351,6 +360,7 @@ int main(int argc, char *argv[])
 		printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 		
 		SDL_imageFilterMMXoff();
+		SDL_imageFilterSIMDoff();
 		SDL_imageFilterNormalizeLinear(src1, dstc, SRC_SIZE, 0,33, 0,255);
 		print_result(TEST_C, call, src1, NULL, dstc);
 		start = SDL_GetTicks();
@@ -389,6 +399,7 @@ int main(int argc, char *argv[])
 			setup_src(src1, src2);
 
 			SDL_imageFilterMMXon();
+			SDL_imageFilterSIMDon();
 			funcs[k].f(src1, dstm, SRC_SIZE, funcs[k].arg);
 			print_result(TEST_MMX, call, src1, NULL, dstm);
 			start = SDL_GetTicks();
@@ -398,6 +409,7 @@ int main(int argc, char *argv[])
 			printf("MMX %dx%dk: %dms\n", i, size/1024, SDL_GetTicks() - start);
 			
 			SDL_imageFilterMMXoff();
+			SDL_imageFilterSIMDoff();
 			funcs[k].f(src1, dstc, SRC_SIZE, funcs[k].arg);
 			print_result(TEST_C, call, src1, NULL, dstc);
 			start = SDL_GetTicks();
@@ -412,6 +424,70 @@ int main(int argc, char *argv[])
         }
 
 
+
+	/* Convolution functions */
+	{
+#define CONV_ROWS 37
+#define CONV_COLUMNS 61
+		unsigned char *csrc = (unsigned char *)SDL_malloc(CONV_ROWS * CONV_COLUMNS);
+		unsigned char *cdstm = (unsigned char *)SDL_malloc(CONV_ROWS * CONV_COLUMNS);
+		unsigned char *cdstc = (unsigned char *)SDL_malloc(CONV_ROWS * CONV_COLUMNS);
+		/* separable (binomial) and non-separable 3x3 kernels, rows padded to 4 shorts */
+		signed short blur3[12] = { 1, 2, 1, 0,  2, 4, 2, 0,  1, 2, 1, 0 };
+		signed short sharpen3[12] = { 0, -1, 0, 0,  -1, 5, -1, 0,  0, -1, 0, 0 };
+		/* 5x5 box and 9x9 Laplacian-like kernels */
+		signed short box5[40], lap9[108];
+		char *names[] = { "ConvolveKernel3x3Divide(blur)", "ConvolveKernel3x3Divide(sharpen)",
+			"ConvolveKernel5x5ShiftRight(box)", "ConvolveKernel9x9Divide(laplace)", "SobelX", "SobelXShiftRight(1)" };
+		int k, j, result_m = -1, result_c = -1;
+		Uint32 start;
+
+		for (i = 0; i < 40; i++) box5[i] = ((i & 7) < 5) ? 1 : 0;
+		for (i = 0; i < 108; i++) lap9[i] = ((i % 12) < 9) ? -1 : 0;
+		lap9[4 * 12 + 4] = 80;
+		for (i = 0; i < CONV_ROWS * CONV_COLUMNS; i++) csrc[i] = rand();
+
+		for (k = 0; k < 6; k++) {
+			for (j = 0; j < 2; j++) {
+				unsigned char *cdst = (j == 0) ? cdstm : cdstc;
+				if (j == 0) {
+					SDL_imageFilterMMXon();
+					SDL_imageFilterSIMDon();
+				} else {
+					SDL_imageFilterMMXoff();
+					SDL_imageFilterSIMDoff();
+				}
+				memset(cdst, 0, CONV_ROWS * CONV_COLUMNS);
+				start = SDL_GetTicks();
+				for (i = 0; i < 50; i++) {
+					switch (k) {
+					case 0: result_c = SDL_imageFilterConvolveKernel3x3Divide(csrc, cdst, CONV_ROWS, CONV_COLUMNS, blur3, 16); break;
+					case 1: result_c = SDL_imageFilterConvolveKernel3x3Divide(csrc, cdst, CONV_ROWS, CONV_COLUMNS, sharpen3, 1); break;
+					case 2: result_c = SDL_imageFilterConvolveKernel5x5ShiftRight(csrc, cdst, CONV_ROWS, CONV_COLUMNS, box5, 5); break;
+					case 3: result_c = SDL_imageFilterConvolveKernel9x9Divide(csrc, cdst, CONV_ROWS, CONV_COLUMNS, lap9, 3); break;
+					case 4: result_c = SDL_imageFilterSobelX(csrc, cdst, CONV_ROWS, CONV_COLUMNS); break;
+					default: result_c = SDL_imageFilterSobelXShiftRight(csrc, cdst, CONV_ROWS, CONV_COLUMNS, 1); break;
+					}
+				}
+				if (j == 0) result_m = result_c;
+				printf("%s %s 50x%dx%d: %dms (result %d)\n", (j == 0) ? "MMX" : " C ", names[k],
+					CONV_COLUMNS, CONV_ROWS, SDL_GetTicks() - start, result_c);
+			}
+			total_count++;
+			if ((result_m == 0) && (result_c == 0) && (memcmp(cdstm, cdstc, CONV_ROWS * CONV_COLUMNS) == 0)) {
+				printf ("OK\n");
+				ok_count++;
+			} else {
+				printf ("ERROR\n");
+			}
+			print_line();
+		}
+
+		SDL_free(cdstc);
+		SDL_free(cdstm);
+		SDL_free(csrc);
+	}
+
 	SDL_imageFilterMMXon();
 	if (SDL_imageFilterMMXdetect())
 	{
@@ -421,6 +497,15 @@ int main(int argc, char *argv[])
 	{
 		printf("MMX was NOT detected\n\n");
 	}
+	SDL_imageFilterSIMDon();
+	if (SDL_imageFilterSIMDdetect())
+	{
+		printf("Vector routines are available\n\n");
+	}
+	else
+	{
+		printf("Vector routines are NOT available\n\n");
+	}
 
 	printf ("Result: %i of %i passed OK.\n", ok_count, total_count);
 
@@ -161,6 +161,18 @@ extern DECLSPEC int SDLCALL Mix_QuerySpec(int *frequency,Uint16 *format,int *cha
 /* Load a wave file or a music (.mod .s3m .it .xm) file */
 extern DECLSPEC Mix_Chunk * SDLCALL Mix_LoadWAV_RW(SDL_RWops *src, int freesrc);
 #define Mix_LoadWAV(file)   Mix_LoadWAV_RW(SDL_RWFromFile(file, "rb"), 1)
+
+/* Keep the chunks loaded from compressed formats (Ogg, FLAC, MP3 and so
+   on, not WAV, AIFF or VOC) from now on compressed in memory, and decode
+   them when they're first played instead of when they're loaded. Their
+   decoded audio is kept for the next time they're played, as long as all
+   of it fits in 'bytes'; past that, the least recently played chunks that
+   aren't playing are dropped, to be decoded again next time. Until it's
+   decoded a chunk's abuf is NULL and its alen 0. 0, the default, decodes
+   chunks when they're loaded. Returns the previous setting; a negative
+   'bytes' only returns it.
+*/
+extern DECLSPEC int SDLCALL Mix_SetChunkCache(int bytes);
 extern DECLSPEC Mix_Music * SDLCALL Mix_LoadMUS(const char *file);
 
 /* Load a music file from an SDL_RWop object (Ogg and MikMod specific currently)
@@ -170,6 +182,27 @@ extern DECLSPEC Mix_Music * SDLCALL Mix_LoadMUS_RW(SDL_RWops *src, int freesrc);
 /* Load a music file from an SDL_RWop object assuming a specific format */
 extern DECLSPEC Mix_Music * SDLCALL Mix_LoadMUSType_RW(SDL_RWops *src, Mix_MusicType type, int freesrc);
 
+/* Load a list of wave (or any other Mix_LoadWAV_RW()) files on threads of
+   their own, several at a time, for loading a lot of sounds at once. This
+   returns right away; each chunk is put in 'chunks' (NULL if it couldn't be
+   loaded) as it's loaded, and 'loaded', if it's not NULL, is called with
+   its index in the list, from one of the loading threads. The names are
+   copied; the data sources and 'chunks' have to stay valid until
+   Mix_WaitChunkBatch(). Returns NULL if the loading couldn't be started.
+ */
+typedef struct _Mix_ChunkBatch Mix_ChunkBatch;
+extern DECLSPEC Mix_ChunkBatch * SDLCALL Mix_LoadWAVBatch(const char * const *files, int count, Mix_Chunk **chunks, void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk), void *udata);
+extern DECLSPEC Mix_ChunkBatch * SDLCALL Mix_LoadWAVBatch_RW(SDL_RWops * const *srcs, int count, int freesrc, Mix_Chunk **chunks, void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk), void *udata);
+
+/* How many of the chunks in a batch have been loaded (or failed to) so far */
+extern DECLSPEC int SDLCALL Mix_ChunkBatchProgress(Mix_ChunkBatch *batch);
+
+/* Wait until all the chunks in a batch are loaded, and free the batch.
+   Every batch has to be waited for, even after its progress shows it's
+   done. Returns how many of the chunks were loaded.
+ */
+extern DECLSPEC int SDLCALL Mix_WaitChunkBatch(Mix_ChunkBatch *batch);
+
 /* Load a wave file of the mixer format from a memory buffer */
 extern DECLSPEC Mix_Chunk * SDLCALL Mix_QuickLoad_WAV(Uint8 *mem);
 
@@ -301,6 +334,9 @@ typedef void (SDLCALL *Mix_EffectDone_t)(int chan, void *udata);
  *  any functions you've registered. The list of registered effects for a
  *  channel is reset when a chunk finishes playing, so you need to explicitly
  *  set them with each call to Mix_PlayChannel*().
+ * Effects aren't run while a channel is virtual (see Mix_Virtual()): it
+ *  isn't being mixed, so there is no audio to hand them, and an effect that
+ *  keeps state between calls, like an echo, won't see the part it skipped.
  * You may also register a special effect function that is to be run after
  *  final mixing occurs. The rules for these callbacks are identical to those
  *  in Mix_RegisterEffect, but they are run after all the channels and the
@@ -417,6 +453,11 @@ extern DECLSPEC int SDLCALL Mix_SetPanning(int channel, Uint8 left, Uint8 right)
  *  correct. You can convert them to mono through SDL before giving them to
  *  the mixer in the first place if you like.
  *
+ * Quad, 5.1 and 7.1 devices are positioned around the listener too, in
+ *  SDL's channel order; the LFE channel only gets the distance attenuation.
+ *  Moving a sound that's already positioned glides it to the new place
+ *  over about 10 milliseconds instead of jumping, so it doesn't click.
+ *
  * Setting (channel) to MIX_CHANNEL_POST registers this as a posteffect, and
  *  the positioning will be done to the final mixed stream before passing it
  *  on to the audio device.
@@ -548,11 +589,55 @@ extern DECLSPEC int SDLCALL Mix_GroupNewer(int tag);
 #define Mix_PlayChannel(channel,chunk,loops) Mix_PlayChannelTimed(channel,chunk,loops,-1)
 /* The same as above, but the sound is played at most 'ticks' milliseconds */
 extern DECLSPEC int SDLCALL Mix_PlayChannelTimed(int channel, Mix_Chunk *chunk, int loops, int ticks);
+
+/* Voice priorities.
+   Sounds played with Mix_PlayChannelTimed() or the fade-in functions have
+   priority MIX_DEFAULT_PRIORITY. Mix_PlayChannelPriority() is the same as
+   Mix_PlayChannelTimed() with the sound's priority given, and if 'channel'
+   is -1 and every unreserved channel is busy, it takes over the least
+   important one: the lowest priority, then the quietest, then the oldest.
+   A channel is only taken from a sound of lower priority, or of the same
+   priority if that sound is virtual (see Mix_Virtual() below.)
+   Mix_SetChannelPriority() changes the priority of the sound on a channel,
+   or all of them if 'channel' is -1, and returns how many it changed.
+*/
+#define MIX_DEFAULT_PRIORITY 0
+extern DECLSPEC int SDLCALL Mix_PlayChannelPriority(int channel, Mix_Chunk *chunk, int loops, int ticks, int priority);
+extern DECLSPEC int SDLCALL Mix_SetChannelPriority(int channel, int priority);
+
+/* Virtual voices.
+   A playing channel that can't be heard, because its volume (or its
+   chunk's) is 0 or it's been put at distance 255 with Mix_SetDistance()
+   or Mix_SetPosition(), is virtual: it keeps its place in the sound, and
+   loops, expires and fades on time, but isn't mixed and its effects
+   aren't run. Mix_LimitMixedChannels() makes at most 'num' channels be
+   mixed at once, the rest of the playing ones going virtual in the order
+   described above. 0 removes the limit, which is the default, and -1
+   leaves it alone. Returns the limit.
+   Mix_Virtual() says whether a channel was virtual in the last mix, or
+   how many were if 'channel' is -1.
+*/
+extern DECLSPEC int SDLCALL Mix_LimitMixedChannels(int num);
+extern DECLSPEC int SDLCALL Mix_Virtual(int channel);
 extern DECLSPEC int SDLCALL Mix_PlayMusic(Mix_Music *music, int loops);
 
 /* Fade in music or a channel over "ms" milliseconds, same semantics as the "Play" functions */
 extern DECLSPEC int SDLCALL Mix_FadeInMusic(Mix_Music *music, int loops, int ms);
 extern DECLSPEC int SDLCALL Mix_FadeInMusicPos(Mix_Music *music, int loops, int ms, double position);
+
+/* Start playing music while the music that's playing now fades out, both
+   over "ms" milliseconds, same semantics as the "Play" functions otherwise.
+   The new music is started and its first block decoded before this returns,
+   so it starts in the very next callback, and once the crossfade is over it
+   is the music that's playing. Until then the old music is the one the
+   other music functions see, except that Mix_HaltMusic() and
+   Mix_FadeOutMusic() stop both. Only music SDL_mixer decodes itself can be
+   faded in like this (not MUS_CMD or native MIDI). If a crossfade is
+   already going this waits for it to complete; if no music is playing it
+   is the same as Mix_FadeInMusicPos().
+ */
+extern DECLSPEC int SDLCALL Mix_CrossFadeMusic(Mix_Music *music, int loops, int ms);
+extern DECLSPEC int SDLCALL Mix_CrossFadeMusicPos(Mix_Music *music, int loops, int ms, double position);
 #define Mix_FadeInChannel(channel,chunk,loops,ms) Mix_FadeInChannelTimed(channel,chunk,loops,ms,-1)
 extern DECLSPEC int SDLCALL Mix_FadeInChannelTimed(int channel, Mix_Chunk *chunk, int loops, int ms, int ticks);
 
@@ -607,6 +692,33 @@ extern DECLSPEC int SDLCALL Mix_PausedMusic(void);
 */
 extern DECLSPEC int SDLCALL Mix_SetMusicPosition(double position);
 
+/* Loop only part of the music: from the start to 'loop_end', then back to
+   'loop_start', sample accurately and without a gap, for as many times as
+   Mix_PlayMusic() was asked to play it. The last time around the music
+   plays on past 'loop_end' to its end, so a track can have an intro and an
+   outro. Both are in the music's own sample frames, at its own sample rate;
+   a 'loop_end' of 0 is the end of the music, and a negative 'loop_start'
+   removes the loop points. They replace any the file came with (Ogg
+   LOOPSTART/LOOPLENGTH/LOOPEND tags, WAV sampler loops). This works for
+   OGG and WAV music, at the moment. Changes made while the music plays
+   take effect from what is decoded next, which can be up to the
+   Mix_SetMusicDecodeAhead() time later.
+   Returns 0 on success, or -1 on error.
+*/
+extern DECLSPEC int SDLCALL Mix_SetMusicLoopPoints(Mix_Music *music, Sint64 loop_start, Sint64 loop_end);
+
+/* Get the playing music's position in output sample frames (at the rate
+   the audio device was opened with): how much of it has been mixed, counted
+   from where it was started or last set with Mix_SetMusicPosition(). It is
+   counted as the music is mixed, not as it is decoded, so music decoded
+   ahead isn't in it, and it keeps counting through loops, so it's a clock
+   that runs in step with the output. During a crossfade this is the music
+   fading out; the music fading in has been counting since the crossfade
+   started. Returns -1 if no music is playing, or it's music SDL_mixer
+   doesn't mix itself (MUS_CMD or native MIDI).
+*/
+extern DECLSPEC Sint64 SDLCALL Mix_GetMusicPositionFrames(void);
+
 /* Check the status of a specific channel.
    If the specified channel is -1, check all channels.
 */
@@ -616,6 +728,16 @@ extern DECLSPEC int SDLCALL Mix_PlayingMusic(void);
 /* Stop music and set external music playback command */
 extern DECLSPEC int SDLCALL Mix_SetMusicCMD(const char *command);
 
+/* Decode music on a thread of its own, 'ms' milliseconds ahead of what's
+   playing, so the audio callback only has to copy it out and a slow stretch
+   of decoding (an Ogg page, a FLAC seek) doesn't cause a dropout. 0, the
+   default, decodes in the audio callback. This takes effect the next time
+   music starts playing, and only for music SDL_mixer decodes itself (not
+   MUS_CMD or native MIDI). Returns the previous setting; a negative 'ms'
+   only returns it.
+*/
+extern DECLSPEC int SDLCALL Mix_SetMusicDecodeAhead(int ms);
+
 /* Synchro value is set by MikMod from modules while playing */
 extern DECLSPEC int SDLCALL Mix_SetSynchroValue(int value);
 extern DECLSPEC int SDLCALL Mix_GetSynchroValue(void);
@@ -625,6 +747,25 @@ extern DECLSPEC int SDLCALL Mix_SetSoundFonts(const char *paths);
 extern DECLSPEC const char* SDLCALL Mix_GetSoundFonts(void);
 extern DECLSPEC int SDLCALL Mix_EachSoundFont(int (SDLCALL *function)(const char*, void*), void *data);
 
+/* Load the instruments of one of the Timidity config's tone banks (or drum
+   sets, if 'drums' is nonzero) now, on a thread of its own if 'background'
+   is nonzero, so MIDI music that uses them loads without going to disk.
+   They stay loaded until the audio device is closed. Songs share the
+   instruments they use anyway, and keep some around after they're freed.
+   Returns 0 on success, or -1 if there's no such bank or Timidity isn't
+   being used for MIDI.
+*/
+extern DECLSPEC int SDLCALL Mix_PreloadMIDIBank(int bank, int drums, int background);
+
+/* Keep the parsed events of the MIDI files Timidity loads in 'directory',
+   which must exist and be writable, so loading the same file again reads
+   them back in one go instead of parsing it. Files are named after a hash
+   of the MIDI data, so it doesn't matter where the MIDI came from. NULL
+   stops using the cache. This lasts until the audio device is closed.
+   Returns 0 on success, or -1 if Timidity isn't being used for MIDI.
+*/
+extern DECLSPEC int SDLCALL Mix_SetMIDIEventCache(const char *directory);
+
 /* Get the Mix_Chunk currently associated with a mixer channel
     Returns NULL if it's an invalid channel, or there's no chunk associated.
 */
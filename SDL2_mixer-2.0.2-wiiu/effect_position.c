@@ -59,29 +59,43 @@
 
 typedef struct _Eff_positionargs
 {
-    volatile float left_f;
-    volatile float right_f;
-    volatile Uint8 left_u8;
-    volatile Uint8 right_u8;
-    volatile float left_rear_f;
-    volatile float right_rear_f;
-    volatile float center_f;
-    volatile float lfe_f;
-    volatile Uint8 left_rear_u8;
-    volatile Uint8 right_rear_u8;
-    volatile Uint8 center_u8;
-    volatile Uint8 lfe_u8;
-    volatile float distance_f;
-    volatile Uint8 distance_u8;
-    volatile Sint16 room_angle;
-    volatile int in_use;
-    volatile int channels;
+    Mix_GainMatrix matrix;
+    float speaker_f[MIX_MATRIX_CHANNELS];   /* gain of each output speaker. */
+    float distance_f;
+    Uint8 left_u8;
+    Uint8 right_u8;
+    Uint8 distance_u8;
+    Sint16 room_angle;
+    int in_use;
+    int channels;
+    Uint16 format;
 } position_args;
 
 static position_args **pos_args_array = NULL;
 static position_args *pos_args_global = NULL;
 static int position_channels = 0;
 
+/* How long a move takes to glide over to its new position. */
+#define POSITION_RAMP_MS 10
+
+/*
+ * Where each output speaker is, in degrees clockwise from due north, in
+ *  SDL's channel order for each layout we support. The LFE (-1) isn't
+ *  anywhere. Stereo speakers are put at due west and east, so that turning
+ *  the room around swaps them.
+ */
+static const int speaker_angles[MIX_MATRIX_CHANNELS + 1][MIX_MATRIX_CHANNELS] = {
+    { 0 },
+    { 0 },                                  /* mono */
+    { 270, 90 },                            /* stereo: FL FR */
+    { 0 },
+    { 315, 45, 225, 135 },                  /* quad: FL FR BL BR */
+    { 0 },
+    { 315, 45, 0, -1, 225, 135 },           /* 5.1: FL FR FC LFE BL BR */
+    { 0 },
+    { 315, 45, 0, -1, 225, 135, 270, 90 }   /* 7.1: FL FR FC LFE BL BR SL SR */
+};
+
 void _Eff_PositionDeinit(void)
 {
     int i;
@@ -111,1390 +125,104 @@ static void SDLCALL _Eff_PositionDone(int channel, void *udata)
     else if (pos_args_array[channel] != NULL) {
         SDL_free(pos_args_array[channel]);
         pos_args_array[channel] = NULL;
-    }
-}
-
-
-static void SDLCALL _Eff_position_u8(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 2) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else for (i = 0; i < len; i += sizeof (Uint8) * 2) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-    }
-}
-static void SDLCALL _Eff_position_u8_c4(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 0)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 90)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 270)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-    }
-}
-
-
-static void SDLCALL _Eff_position_u8_c6(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Uint16) != 0) {
-        *ptr = (Uint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 0)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->center_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 90)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
-    }
-    else if (args->room_angle == 270)
-    for (i = 0; i < len; i += sizeof (Uint8) * 6) {
-        /* must adjust the sample so that 0 is the center */
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_rear_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->right_f) * args->distance_f) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_f) * args->distance_f/2) + 128)
-            + (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->left_rear_f) * args->distance_f/2) + 128);
-        ptr++;
-        *ptr = (Uint8) ((Sint8) ((((float) (Sint8) (*ptr - 128))
-            * args->lfe_f) * args->distance_f) + 128);
-        ptr++;
+        _Mix_SetDistanceGain_locked(channel, 1.0f);
     }
 }
 
 
 /*
- * This one runs about 10.1 times faster than the non-table version, with
- *  no loss in quality. It does, however, require 64k of memory for the
- *  lookup table. Also, this will only update position information once per
- *  call; the non-table version always checks the arguments for each sample,
- *  in case the user has called Mix_SetPanning() or whatnot again while this
- *  callback is running.
+ * The mixer usually applies the matrix itself as it mixes the channel, so
+ *  this only runs for posteffects, or when other effects come after it.
  */
-static void SDLCALL _Eff_position_table_u8(int chan, void *stream, int len, void *udata)
+static void SDLCALL _Eff_position(int chan, void *stream, int len, void *udata)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint8 *ptr = (Uint8 *) stream;
-    Uint32 *p;
-    int i;
-    Uint8 *l = ((Uint8 *) _Eff_volume_table) + (256 * args->left_u8);
-    Uint8 *r = ((Uint8 *) _Eff_volume_table) + (256 * args->right_u8);
-    Uint8 *d = ((Uint8 *) _Eff_volume_table) + (256 * args->distance_u8);
-
-    if (args->room_angle == 180) {
-        Uint8 *temp = l;
-        l = r;
-        r = temp;
-    }
-        /*
-         * if there's only a mono channnel, then l[] and r[] are always
-         *  volume 255, and are therefore throwaways. Still, we have to
-         *  be sure not to overrun the audio buffer...
-         */
-    while (len % sizeof (Uint32) != 0) {
-        *ptr = d[l[*ptr]];
-        ptr++;
-        if (args->channels > 1) {
-            *ptr = d[r[*ptr]];
-            ptr++;
-        }
-        len -= args->channels;
-    }
-
-    p = (Uint32 *) ptr;
-
-    for (i = 0; i < len; i += sizeof (Uint32)) {
-#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-        *p = (d[l[(*p & 0xFF000000) >> 24]] << 24) |
-             (d[r[(*p & 0x00FF0000) >> 16]] << 16) |
-             (d[l[(*p & 0x0000FF00) >>  8]] <<  8) |
-             (d[r[(*p & 0x000000FF)      ]]     ) ;
-#else
-        *p = (d[r[(*p & 0xFF000000) >> 24]] << 24) |
-             (d[l[(*p & 0x00FF0000) >> 16]] << 16) |
-             (d[r[(*p & 0x0000FF00) >>  8]] <<  8) |
-             (d[l[(*p & 0x000000FF)      ]]     ) ;
-#endif
-        ++p;
-    }
+    position_args *args = (position_args *) udata;
+    _Mix_ApplyGainMatrix((Uint8 *) stream, args->format, args->channels, len, &args->matrix);
 }
 
 
-static void SDLCALL _Eff_position_s8(int chan, void *stream, int len, void *udata)
+/* Which input speaker is at this angle, or -1. */
+static int speaker_at(int channels, int angle)
 {
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
     int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    if (args->room_angle == 180)
-    for (i = 0; i < len; i += sizeof (Sint8) * 2) {
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f);
-        ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f);
-        ptr++;
-    }
-    else
-    for (i = 0; i < len; i += sizeof (Sint8) * 2) {
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f);
-        ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f);
-        ptr++;
-    }
-}
-static void SDLCALL _Eff_position_s8_c4(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    for (i = 0; i < len; i += sizeof (Sint8) * 4) {
-      switch (args->room_angle) {
-       case 0:
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-    break;
-       case 90:
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-    break;
-       case 180:
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-    break;
-       case 270:
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-    break;
-      }
-    }
-}
-static void SDLCALL _Eff_position_s8_c6(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
-    int i;
-
-        /*
-         * if there's only a mono channnel (the only way we wouldn't have
-         *  a len divisible by 2 here), then left_f and right_f are always
-         *  1.0, and are therefore throwaways.
-         */
-    if (len % sizeof (Sint16) != 0) {
-        *ptr = (Sint8) (((float) *ptr) * args->distance_f);
-        ptr++;
-        len--;
-    }
-
-    for (i = 0; i < len; i += sizeof (Sint8) * 6) {
-      switch (args->room_angle) {
-       case 0:
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->center_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 90:
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->right_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 180:
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-       case 270:
-        *ptr = (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_rear_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->right_f) * args->distance_f); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->left_f) * args->distance_f / 2)
-           + (Sint8)((((float) *ptr) * args->left_rear_f) * args->distance_f / 2); ptr++;
-        *ptr = (Sint8)((((float) *ptr) * args->lfe_f) * args->distance_f); ptr++;
-    break;
-      }
+    for (i = 0; i < channels; i++) {
+        if (speaker_angles[channels][i] == angle) {
+            return(i);
+        }
     }
+    return(-1);
 }
 
 
 /*
- * This one runs about 10.1 times faster than the non-table version, with
- *  no loss in quality. It does, however, require 64k of memory for the
- *  lookup table. Also, this will only update position information once per
- *  call; the non-table version always checks the arguments for each sample,
- *  in case the user has called Mix_SetPanning() or whatnot again while this
- *  callback is running.
+ * Build the gain matrix from the speaker gains, distance and room angle.
+ *  Turning the room around moves the sound field along: each speaker plays
+ *  the input that's room_angle degrees clockwise of it, or half of each of
+ *  the two either side of that if there's no speaker there. A new effect
+ *  starts right where it's put; changes after that glide over.
  */
-static void SDLCALL _Eff_position_table_s8(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint8 *ptr = (Sint8 *) stream;
-    Uint32 *p;
-    int i;
-    Sint8 *l = ((Sint8 *) _Eff_volume_table) + (256 * args->left_u8);
-    Sint8 *r = ((Sint8 *) _Eff_volume_table) + (256 * args->right_u8);
-    Sint8 *d = ((Sint8 *) _Eff_volume_table) + (256 * args->distance_u8);
-
-    if (args->room_angle == 180) {
-        Sint8 *temp = l;
-        l = r;
-        r = temp;
-    }
-
-
-    while (len % sizeof (Uint32) != 0) {
-        *ptr = d[l[*ptr]];
-        ptr++;
-        if (args->channels > 1) {
-            *ptr = d[r[*ptr]];
-            ptr++;
+static void update_position_matrix(position_args *args, int glide)
+{
+    Mix_GainMatrix *matrix = &args->matrix;
+    const int channels = args->channels;
+    float to[MIX_MATRIX_CHANNELS][MIX_MATRIX_CHANNELS];
+    int frequency = 0;
+    int o, i;
+
+    SDL_memset(to, '\0', sizeof (to));
+    for (o = 0; o < channels; o++) {
+        const float gain = args->speaker_f[o] * args->distance_f;
+        const int angle = speaker_angles[channels][o];
+        if ((channels == 1) || (angle < 0)) {
+            to[o][o] = gain;
+        } else {
+            const int source = (angle + args->room_angle) % 360;
+            i = speaker_at(channels, source);
+            if (i >= 0) {
+                to[o][i] = gain;
+            } else {
+                const int a = speaker_at(channels, (source + 315) % 360);
+                const int b = speaker_at(channels, (source + 45) % 360);
+                if ((a >= 0) && (b >= 0)) {
+                    to[o][a] = gain * 0.5f;
+                    to[o][b] = gain * 0.5f;
+                }
+            }
         }
-        len -= args->channels;
-    }
-
-    p = (Uint32 *) ptr;
-
-    for (i = 0; i < len; i += sizeof (Uint32)) {
-#if (SDL_BYTEORDER == SDL_BIG_ENDIAN)
-        *p = (d[l[((Sint16)(Sint8)((*p & 0xFF000000) >> 24))+128]] << 24) |
-             (d[r[((Sint16)(Sint8)((*p & 0x00FF0000) >> 16))+128]] << 16) |
-             (d[l[((Sint16)(Sint8)((*p & 0x0000FF00) >>  8))+128]] <<  8) |
-             (d[r[((Sint16)(Sint8)((*p & 0x000000FF)     ))+128]]     ) ;
-#else
-        *p = (d[r[((Sint16)(Sint8)((*p & 0xFF000000) >> 24))+128]] << 24) |
-             (d[l[((Sint16)(Sint8)((*p & 0x00FF0000) >> 16))+128]] << 16) |
-             (d[r[((Sint16)(Sint8)((*p & 0x0000FF00) >>  8))+128]] <<  8) |
-             (d[l[((Sint16)(Sint8)((*p & 0x000000FF)     ))+128]]     ) ;
-#endif
-        ++p;
-    }
-
-
-}
-
-
-/* !!! FIXME : Optimize the code for 16-bit samples? */
-
-static void SDLCALL _Eff_position_u16lsb(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Uint16) * 2) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-
-    if (args->room_angle == 180) {
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-    }
-    else {
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-            *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-    }
-    }
-}
-static void SDLCALL _Eff_position_u16lsb_c4(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Uint16) * 4) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapLE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapLE16(*(ptr+3)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-            break;
-    }
-    }
-}
-static void SDLCALL _Eff_position_u16lsb_c6(int chan, void *stream, int len, void *udata)
-{
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Uint16) * 6) {
-        Sint16 sampl = (Sint16) (SDL_SwapLE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapLE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapLE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapLE16(*(ptr+3)) - 32768);
-        Sint16 sampce = (Sint16) (SDL_SwapLE16(*(ptr+4)) - 32768);
-        Sint16 sampwf = (Sint16) (SDL_SwapLE16(*(ptr+5)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapce = (Uint16) ((Sint16) (((float) sampce * args->center_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapwf = (Uint16) ((Sint16) (((float) sampwf * args->lfe_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapce);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr)/2 + (Uint16) SDL_SwapLE16(swaprr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr)/2 + (Uint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapl)/2 + (Uint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapLE16(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s16lsb(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-#if 0
-    if (len % (sizeof(Sint16) * 2)) {
-        fprintf(stderr,"Not an even number of frames! len=%d\n", len);
-        return;
-    }
-#endif
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-    if (args->room_angle == 180) {
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-    }
-    else {
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-            *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-    }
-    }
-}
-static void SDLCALL _Eff_position_s16lsb_c4(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+2))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s16lsb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint16 swapce = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint16 swapwf = (Sint16) ((((float) (Sint16) SDL_SwapLE16(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapce);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr)/2 + (Sint16) SDL_SwapLE16(swaprr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr)/2 + (Sint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapl)/2 + (Sint16) SDL_SwapLE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapLE16(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_u16msb(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-
-    if (args->room_angle == 180) {
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-    }
-    else {
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-            *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-    }
-    }
-}
-static void SDLCALL _Eff_position_u16msb_c4(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapBE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapBE16(*(ptr+3)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-            break;
-    }
-    }
-}
-static void SDLCALL _Eff_position_u16msb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Uint16 *ptr = (Uint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 sampl = (Sint16) (SDL_SwapBE16(*(ptr+0)) - 32768);
-        Sint16 sampr = (Sint16) (SDL_SwapBE16(*(ptr+1)) - 32768);
-        Sint16 samplr = (Sint16) (SDL_SwapBE16(*(ptr+2)) - 32768);
-        Sint16 samprr = (Sint16) (SDL_SwapBE16(*(ptr+3)) - 32768);
-        Sint16 sampce = (Sint16) (SDL_SwapBE16(*(ptr+4)) - 32768);
-        Sint16 sampwf = (Sint16) (SDL_SwapBE16(*(ptr+5)) - 32768);
-
-        Uint16 swapl = (Uint16) ((Sint16) (((float) sampl * args->left_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapr = (Uint16) ((Sint16) (((float) sampr * args->right_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaplr = (Uint16) ((Sint16) (((float) samplr * args->left_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swaprr = (Uint16) ((Sint16) (((float) samprr * args->right_rear_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapce = (Uint16) ((Sint16) (((float) sampce * args->center_f)
-                                    * args->distance_f) + 32768);
-        Uint16 swapwf = (Uint16) ((Sint16) (((float) sampwf * args->lfe_f)
-                                    * args->distance_f) + 32768);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapce);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr)/2 + (Uint16) SDL_SwapBE16(swaprr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr)/2 + (Uint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapl)/2 + (Uint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Uint16) SDL_SwapBE16(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s16msb(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 2) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-        *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-    }
-}
-static void SDLCALL _Eff_position_s16msb_c4(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 4) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-            break;
-    }
-    }
-}
-static void SDLCALL _Eff_position_s16msb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 16 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint16 *ptr = (Sint16 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint16) * 6) {
-        Sint16 swapl = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint16 swapr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint16 swaplr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint16 swaprr = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint16 swapce = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint16 swapwf = (Sint16) ((((float) (Sint16) SDL_SwapBE16(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapce);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr)/2 + (Sint16) SDL_SwapBE16(swaprr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr)/2 + (Sint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaplr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swaprr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapr);
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapl)/2 + (Sint16) SDL_SwapBE16(swaplr)/2;
-                *(ptr++) = (Sint16) SDL_SwapBE16(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s32lsb(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-#if 0
-    if (len % (sizeof(Sint32) * 2)) {
-        fprintf(stderr,"Not an even number of frames! len=%d\n", len);
-        return;
-    }
-#endif
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 2) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-    if (args->room_angle == 180) {
-            *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-            *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-    }
-    else {
-            *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-            *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-    }
-    }
-}
-static void SDLCALL _Eff_position_s32lsb_c4(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 4) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint32 swaplr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+1))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint32 swaprr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+2))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s32lsb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 6) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint32 swaplr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint32 swaprr = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint32 swapce = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint32 swapwf = (Sint32) ((((float) (Sint32) SDL_SwapLE32(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapce);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr)/2 + (Sint32) SDL_SwapLE32(swaprr)/2;
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr)/2 + (Sint32) SDL_SwapLE32(swaplr)/2;
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapl)/2 + (Sint32) SDL_SwapLE32(swaplr)/2;
-                *(ptr++) = (Sint32) SDL_SwapLE32(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_s32msb(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 2) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-        *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-    }
-}
-static void SDLCALL _Eff_position_s32msb_c4(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 4) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint32 swaplr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint32 swaprr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-            break;
-        case 90:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-            break;
-        case 180:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-            break;
-        case 270:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-            break;
-    }
     }
-}
-static void SDLCALL _Eff_position_s32msb_c6(int chan, void *stream, int len, void *udata)
-{
-    /* 32 signed bits (lsb) * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    Sint32 *ptr = (Sint32 *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (Sint32) * 6) {
-        Sint32 swapl = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+0))) *
-                                    args->left_f) * args->distance_f);
-        Sint32 swapr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+1))) *
-                                    args->right_f) * args->distance_f);
-        Sint32 swaplr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+2))) *
-                                    args->left_rear_f) * args->distance_f);
-        Sint32 swaprr = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+3))) *
-                                    args->right_rear_f) * args->distance_f);
-        Sint32 swapce = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+4))) *
-                                    args->center_f) * args->distance_f);
-        Sint32 swapwf = (Sint32) ((((float) (Sint32) SDL_SwapBE32(*(ptr+5))) *
-                                    args->lfe_f) * args->distance_f);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapce);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapwf);
-            break;
-        case 90:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr)/2 + (Sint32) SDL_SwapBE32(swaprr)/2;
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapwf);
-            break;
-        case 180:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr)/2 + (Sint32) SDL_SwapBE32(swaplr)/2;
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapwf);
-            break;
-        case 270:
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaplr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swaprr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapr);
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapl)/2 + (Sint32) SDL_SwapBE32(swaplr)/2;
-                *(ptr++) = (Sint32) SDL_SwapBE32(swapwf);
-            break;
-    }
-    }
-}
-
-static void SDLCALL _Eff_position_f32sys(int chan, void *stream, int len, void *udata)
-{
-    /* float * 2 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    float *ptr = (float *) stream;
-    int i;
-
-    for (i = 0; i < len; i += sizeof (float) * 2) {
-        float swapl = ((*(ptr+0) * args->left_f) * args->distance_f);
-        float swapr = ((*(ptr+1) * args->right_f) * args->distance_f);
-        *(ptr++) = swapl;
-        *(ptr++) = swapr;
-    }
-}
-static void SDLCALL _Eff_position_f32sys_c4(int chan, void *stream, int len, void *udata)
-{
-    /* float * 4 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    float *ptr = (float *) stream;
-    int i;
 
-    for (i = 0; i < len; i += sizeof (float) * 4) {
-        float swapl = ((*(ptr+0) * args->left_f) * args->distance_f);
-        float swapr = ((*(ptr+1) * args->right_f) * args->distance_f);
-        float swaplr = ((*(ptr+2) * args->left_rear_f) * args->distance_f);
-        float swaprr = ((*(ptr+3) * args->right_rear_f) * args->distance_f);
-        switch (args->room_angle) {
-        case 0:
-                *(ptr++) = swapl;
-                *(ptr++) = swapr;
-                *(ptr++) = swaplr;
-                *(ptr++) = swaprr;
-            break;
-        case 90:
-                *(ptr++) = swapr;
-                *(ptr++) = swaprr;
-                *(ptr++) = swapl;
-                *(ptr++) = swaplr;
-            break;
-        case 180:
-                *(ptr++) = swaprr;
-                *(ptr++) = swaplr;
-                *(ptr++) = swapr;
-                *(ptr++) = swapl;
-            break;
-        case 270:
-                *(ptr++) = swaplr;
-                *(ptr++) = swapl;
-                *(ptr++) = swaprr;
-                *(ptr++) = swapr;
-            break;
+    if (glide) {
+        /* start from wherever the last glide has got to. */
+        const float t = (matrix->ramp_position < matrix->ramp_length) ?
+                            ((float) matrix->ramp_position) / ((float) matrix->ramp_length) : 1.0f;
+        for (o = 0; o < MIX_MATRIX_CHANNELS; o++) {
+            for (i = 0; i < MIX_MATRIX_CHANNELS; i++) {
+                matrix->from[o][i] += (matrix->to[o][i] - matrix->from[o][i]) * t;
+            }
         }
+        Mix_QuerySpec(&frequency, NULL, NULL);
+        matrix->ramp_length = (Uint32) ((frequency * POSITION_RAMP_MS) / 1000);
+        matrix->ramp_position = 0;
+    } else {
+        SDL_memcpy(matrix->from, to, sizeof (to));
+        matrix->ramp_length = matrix->ramp_position = 0;
     }
+    SDL_memcpy(matrix->to, to, sizeof (to));
 }
-static void SDLCALL _Eff_position_f32sys_c6(int chan, void *stream, int len, void *udata)
-{
-    /* float * 6 channels. */
-    volatile position_args *args = (volatile position_args *) udata;
-    float *ptr = (float *) stream;
-    int i;
 
-    for (i = 0; i < len; i += sizeof (float) * 6) {
-        float swapl = ((*(ptr+0) * args->left_f) * args->distance_f);
-        float swapr = ((*(ptr+1) * args->right_f) * args->distance_f);
-        float swaplr = ((*(ptr+2) * args->left_rear_f) * args->distance_f);
-        float swaprr = ((*(ptr+3) * args->right_rear_f) * args->distance_f);
-        float swapce = ((*(ptr+4) * args->center_f) * args->distance_f);
-        float swapwf = ((*(ptr+5) * args->lfe_f) * args->distance_f);
-
-    switch (args->room_angle) {
-        case 0:
-                *(ptr++) = swapl;
-                *(ptr++) = swapr;
-                *(ptr++) = swaplr;
-                *(ptr++) = swaprr;
-                *(ptr++) = swapce;
-                *(ptr++) = swapwf;
-            break;
-        case 90:
-                *(ptr++) = swapr;
-                *(ptr++) = swaprr;
-                *(ptr++) = swapl;
-                *(ptr++) = swaplr;
-                *(ptr++) = swapr/2.0f + swaprr/2.0f;
-                *(ptr++) = swapwf;
-            break;
-        case 180:
-                *(ptr++) = swaprr;
-                *(ptr++) = swaplr;
-                *(ptr++) = swapr;
-                *(ptr++) = swapl;
-                *(ptr++) = swaprr/2.0f + swaplr/2.0f;
-                *(ptr++) = swapwf;
-            break;
-        case 270:
-                *(ptr++) = swaplr;
-                *(ptr++) = swapl;
-                *(ptr++) = swaprr;
-                *(ptr++) = swapr;
-                *(ptr++) = swapl/2.0f + swaplr/2.0f;
-                *(ptr++) = swapwf;
-            break;
-    }
-    }
-}
 
 static void init_position_args(position_args *args)
 {
+    int i;
     SDL_memset(args, '\0', sizeof (position_args));
     args->in_use = 0;
     args->room_angle = 0;
     args->left_u8 = args->right_u8 = args->distance_u8 = 255;
-    args->left_f  = args->right_f  = args->distance_f  = 1.0f;
-    args->left_rear_u8 = args->right_rear_u8 = args->center_u8 = args->lfe_u8 = 255;
-    args->left_rear_f = args->right_rear_f = args->center_f = args->lfe_f = 1.0f;
-    Mix_QuerySpec(NULL, NULL, (int *) &args->channels);
+    args->distance_f = 1.0f;
+    for (i = 0; i < MIX_MATRIX_CHANNELS; i++) {
+        args->speaker_f[i] = 1.0f;
+    }
+    Mix_QuerySpec(NULL, &args->format, &args->channels);
 }
 
 
@@ -1542,186 +270,40 @@ static position_args *get_position_arg(int channel)
 }
 
 
-static Mix_EffectFunc_t get_position_effect_func(Uint16 format, int channels)
+static Mix_EffectFunc_t get_position_effect_func(int channels)
 {
-    Mix_EffectFunc_t f = NULL;
-
-    switch (format) {
-        case AUDIO_U8:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = (_Eff_build_volume_table_u8()) ? _Eff_position_table_u8 :
-                                                        _Eff_position_u8;
-                break;
-            case 4:
-                f = _Eff_position_u8_c4;
-                break;
-            case 6:
-                f = _Eff_position_u8_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_S8:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = (_Eff_build_volume_table_s8()) ? _Eff_position_table_s8 :
-                                                        _Eff_position_s8;
-                break;
-            case 4:
-                f = _Eff_position_s8_c4;
-                break;
-            case 6:
-                f = _Eff_position_s8_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_U16LSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_u16lsb;
-                break;
-            case 4:
-                f = _Eff_position_u16lsb_c4;
-                break;
-            case 6:
-                f = _Eff_position_u16lsb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_S16LSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_s16lsb;
-                break;
-            case 4:
-                f = _Eff_position_s16lsb_c4;
-                break;
-            case 6:
-                f = _Eff_position_s16lsb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_U16MSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_u16msb;
-                break;
-            case 4:
-                f = _Eff_position_u16msb_c4;
-                break;
-            case 6:
-                f = _Eff_position_u16msb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_S16MSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_s16msb;
-                break;
-            case 4:
-                f = _Eff_position_s16msb_c4;
-                break;
-            case 6:
-                f = _Eff_position_s16msb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_S32MSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_s32msb;
-                break;
-            case 4:
-                f = _Eff_position_s32msb_c4;
-                break;
-            case 6:
-                f = _Eff_position_s32msb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_S32LSB:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_s32lsb;
-                break;
-            case 4:
-                f = _Eff_position_s32lsb_c4;
-                break;
-            case 6:
-                f = _Eff_position_s32lsb_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
-        case AUDIO_F32SYS:
-        switch (channels) {
-            case 1:
-            case 2:
-                f = _Eff_position_f32sys;
-                break;
-            case 4:
-                f = _Eff_position_f32sys_c4;
-                break;
-            case 6:
-                f = _Eff_position_f32sys_c6;
-                break;
-            default:
-                Mix_SetError("Unsupported audio channels");
-                break;
-        }
-        break;
-
+    switch (channels) {
+        case 1:
+        case 2:
+        case 4:
+        case 6:
+        case 8:
+            return(_Eff_position);
         default:
-            Mix_SetError("Unsupported audio format");
-            break;
+            Mix_SetError("Unsupported audio channels");
+            return(NULL);
     }
+}
 
-    return(f);
+
+/* Put the effect's new matrix in place, registering it if it's new. */
+static int set_position_args(int channel, Mix_EffectFunc_t f, position_args *args)
+{
+    int retval = 1;
+
+    update_position_matrix(args, args->in_use);
+    _Mix_SetDistanceGain_locked(channel, args->distance_f);
+    if (!args->in_use) {
+        args->in_use = 1;
+        retval = _Mix_RegisterMatrixEffect_locked(channel, f, _Eff_PositionDone,
+                                                  (void *) args, &args->matrix);
+    }
+    return(retval);
 }
 
-static Uint8 speaker_amplitude[6];
 
-static void set_amplitudes(int channels, int angle, int room_angle)
+/* The gain of each output speaker for a sound at this angle. */
+static void set_amplitudes(int channels, int angle, float *speaker_f)
 {
     int left = 255, right = 255;
     int left_rear = 255, right_rear = 255, center = 255;
@@ -1751,7 +333,7 @@ static void set_amplitudes(int channels, int angle, int room_angle)
         }
     }
 
-    if (channels == 4 || channels == 6)
+    if (channels == 4 || channels == 6 || channels == 8)
     {
         /*
          *  An angle that's due north does not attenuate the center channel.
@@ -1816,38 +398,33 @@ static void set_amplitudes(int channels, int angle, int room_angle)
     if (right_rear < 0) right_rear = 0; if (right_rear > 255) right_rear = 255;
     if (center < 0) center = 0; if (center > 255) center = 255;
 
-    if (room_angle == 90) {
-        speaker_amplitude[0] = (Uint8)left_rear;
-        speaker_amplitude[1] = (Uint8)left;
-        speaker_amplitude[2] = (Uint8)right_rear;
-        speaker_amplitude[3] = (Uint8)right;
-    }
-    else if (room_angle == 180) {
-    if (channels == 2) {
-            speaker_amplitude[0] = (Uint8)right;
-            speaker_amplitude[1] = (Uint8)left;
-    }
-    else {
-            speaker_amplitude[0] = (Uint8)right_rear;
-            speaker_amplitude[1] = (Uint8)left_rear;
-            speaker_amplitude[2] = (Uint8)right;
-            speaker_amplitude[3] = (Uint8)left;
-    }
-    }
-    else if (room_angle == 270) {
-        speaker_amplitude[0] = (Uint8)right;
-        speaker_amplitude[1] = (Uint8)right_rear;
-        speaker_amplitude[2] = (Uint8)left;
-        speaker_amplitude[3] = (Uint8)left_rear;
-    }
-    else {
-        speaker_amplitude[0] = (Uint8)left;
-        speaker_amplitude[1] = (Uint8)right;
-        speaker_amplitude[2] = (Uint8)left_rear;
-        speaker_amplitude[3] = (Uint8)right_rear;
+    switch (channels) {
+        case 2:
+            speaker_f[0] = ((float) left) / 255.0f;
+            speaker_f[1] = ((float) right) / 255.0f;
+            break;
+        case 4:
+            speaker_f[0] = ((float) left) / 255.0f;
+            speaker_f[1] = ((float) right) / 255.0f;
+            speaker_f[2] = ((float) left_rear) / 255.0f;
+            speaker_f[3] = ((float) right_rear) / 255.0f;
+            break;
+        case 8:
+            /* the sides are halfway between the front and back. */
+            speaker_f[6] = ((float) (left + left_rear)) / 510.0f;
+            speaker_f[7] = ((float) (right + right_rear)) / 510.0f;
+            /* fall through */
+        case 6:
+            speaker_f[0] = ((float) left) / 255.0f;
+            speaker_f[1] = ((float) right) / 255.0f;
+            speaker_f[2] = ((float) center) / 255.0f;
+            speaker_f[3] = 1.0f;
+            speaker_f[4] = ((float) left_rear) / 255.0f;
+            speaker_f[5] = ((float) right_rear) / 255.0f;
+            break;
+        default:
+            break;
     }
-    speaker_amplitude[4] = (Uint8)center;
-    speaker_amplitude[5] = 255;
 }
 
 int Mix_SetPosition(int channel, Sint16 angle, Uint8 distance);
@@ -1856,13 +433,12 @@ int Mix_SetPanning(int channel, Uint8 left, Uint8 right)
 {
     Mix_EffectFunc_t f = NULL;
     int channels;
-    Uint16 format;
     position_args *args = NULL;
     int retval = 1;
 
-    Mix_QuerySpec(NULL, &format, &channels);
+    Mix_QuerySpec(NULL, NULL, &channels);
 
-    if (channels != 2 && channels != 4 && channels != 6)    /* it's a no-op; we call that successful. */
+    if (channels != 2 && channels != 4 && channels != 6 && channels != 8)    /* it's a no-op; we call that successful. */
         return(1);
 
     if (channels > 2) {
@@ -1878,7 +454,7 @@ int Mix_SetPanning(int channel, Uint8 left, Uint8 right)
         return(Mix_SetPosition(channel, angle, 0));
     }
 
-    f = get_position_effect_func(format, channels);
+    f = get_position_effect_func(channels);
     if (f == NULL)
         return(0);
 
@@ -1902,15 +478,11 @@ int Mix_SetPanning(int channel, Uint8 left, Uint8 right)
     }
 
     args->left_u8 = left;
-    args->left_f = ((float) left) / 255.0f;
     args->right_u8 = right;
-    args->right_f = ((float) right) / 255.0f;
+    args->speaker_f[0] = ((float) left) / 255.0f;
+    args->speaker_f[1] = ((float) right) / 255.0f;
     args->room_angle = 0;
-
-    if (!args->in_use) {
-        args->in_use = 1;
-        retval=_Mix_RegisterEffect_locked(channel, f, _Eff_PositionDone, (void*)args);
-    }
+    retval = set_position_args(channel, f, args);
 
     Mix_UnlockAudio();
     return(retval);
@@ -1920,13 +492,12 @@ int Mix_SetPanning(int channel, Uint8 left, Uint8 right)
 int Mix_SetDistance(int channel, Uint8 distance)
 {
     Mix_EffectFunc_t f = NULL;
-    Uint16 format;
     position_args *args = NULL;
     int channels;
     int retval = 1;
 
-    Mix_QuerySpec(NULL, &format, &channels);
-    f = get_position_effect_func(format, channels);
+    Mix_QuerySpec(NULL, NULL, &channels);
+    f = get_position_effect_func(channels);
     if (f == NULL)
         return(0);
 
@@ -1953,10 +524,7 @@ int Mix_SetDistance(int channel, Uint8 distance)
 
     args->distance_u8 = distance;
     args->distance_f = ((float) distance) / 255.0f;
-    if (!args->in_use) {
-        args->in_use = 1;
-        retval = _Mix_RegisterEffect_locked(channel, f, _Eff_PositionDone, (void *) args);
-    }
+    retval = set_position_args(channel, f, args);
 
     Mix_UnlockAudio();
     return(retval);
@@ -1966,14 +534,13 @@ int Mix_SetDistance(int channel, Uint8 distance)
 int Mix_SetPosition(int channel, Sint16 angle, Uint8 distance)
 {
     Mix_EffectFunc_t f = NULL;
-    Uint16 format;
     int channels;
     position_args *args = NULL;
     Sint16 room_angle = 0;
     int retval = 1;
 
-    Mix_QuerySpec(NULL, &format, &channels);
-    f = get_position_effect_func(format, channels);
+    Mix_QuerySpec(NULL, NULL, &channels);
+    f = get_position_effect_func(channels);
     if (f == NULL)
         return(0);
 
@@ -2005,7 +572,7 @@ int Mix_SetPosition(int channel, Sint16 angle, Uint8 distance)
     else room_angle = 0;
     }
 
-    if (channels == 4 || channels == 6)
+    if (channels == 4 || channels == 6 || channels == 8)
     {
     if (angle > 315) room_angle = 0;
     else if (angle > 225) room_angle = 270;
@@ -2017,27 +584,14 @@ int Mix_SetPosition(int channel, Sint16 angle, Uint8 distance)
 
     distance = 255 - distance;  /* flip it to scale Mix_SetDistance() uses. */
 
-    set_amplitudes(channels, angle, room_angle);
-
-    args->left_u8 = speaker_amplitude[0];
-    args->left_f = ((float) speaker_amplitude[0]) / 255.0f;
-    args->right_u8 = speaker_amplitude[1];
-    args->right_f = ((float) speaker_amplitude[1]) / 255.0f;
-    args->left_rear_u8 = speaker_amplitude[2];
-    args->left_rear_f = ((float) speaker_amplitude[2]) / 255.0f;
-    args->right_rear_u8 = speaker_amplitude[3];
-    args->right_rear_f = ((float) speaker_amplitude[3]) / 255.0f;
-    args->center_u8 = speaker_amplitude[4];
-    args->center_f = ((float) speaker_amplitude[4]) / 255.0f;
-    args->lfe_u8 = speaker_amplitude[5];
-    args->lfe_f = ((float) speaker_amplitude[5]) / 255.0f;
+    set_amplitudes(channels, angle, args->speaker_f);
+
+    args->left_u8 = (Uint8) (args->speaker_f[0] * 255.0f);
+    args->right_u8 = (Uint8) (args->speaker_f[(channels > 1) ? 1 : 0] * 255.0f);
     args->distance_u8 = distance;
     args->distance_f = ((float) distance) / 255.0f;
     args->room_angle = room_angle;
-    if (!args->in_use) {
-        args->in_use = 1;
-        retval = _Mix_RegisterEffect_locked(channel, f, _Eff_PositionDone, (void *) args);
-    }
+    retval = set_position_args(channel, f, args);
 
     Mix_UnlockAudio();
     return(retval);
@@ -31,9 +31,22 @@
 #include "SDL_mixer.h"
 
 extern int _Mix_effects_max_speed;
-extern void *_Eff_volume_table;
-void *_Eff_build_volume_table_u8(void);
-void *_Eff_build_volume_table_s8(void);
+
+/* A speaker gain matrix, gains[output][input], moving from 'from' to 'to'
+   over ramp_length output frames. An effect registered with one is just
+   this matrix, so the mixer can apply it while it mixes the channel
+   rather than calling the effect on a copy of the data first. */
+#define MIX_MATRIX_CHANNELS 8
+typedef struct _Mix_GainMatrix
+{
+    float from[MIX_MATRIX_CHANNELS][MIX_MATRIX_CHANNELS];
+    float to[MIX_MATRIX_CHANNELS][MIX_MATRIX_CHANNELS];
+    Uint32 ramp_length;
+    Uint32 ramp_position;   /* == ramp_length once it gets to 'to'. */
+} Mix_GainMatrix;
+
+/* Apply a gain matrix to audio in place, moving it along its ramp. */
+void _Mix_ApplyGainMatrix(Uint8 *data, SDL_AudioFormat format, int channels, int len, Mix_GainMatrix *matrix);
 
 void _Mix_InitEffects(void);
 void _Mix_DeinitEffects(void);
@@ -41,9 +54,15 @@ void _Eff_PositionDeinit(void);
 
 int _Mix_RegisterEffect_locked(int channel, Mix_EffectFunc_t f,
                                Mix_EffectDone_t d, void *arg);
+int _Mix_RegisterMatrixEffect_locked(int channel, Mix_EffectFunc_t f,
+                                     Mix_EffectDone_t d, void *arg,
+                                     Mix_GainMatrix *matrix);
 int _Mix_UnregisterEffect_locked(int channel, Mix_EffectFunc_t f);
 int _Mix_UnregisterAllEffects_locked(int channel);
 
+/* The position effect's distance attenuation, for ranking the channel. */
+void _Mix_SetDistanceGain_locked(int channel, float gain);
+
 #endif /* _INCLUDE_EFFECTS_INTERNAL_H_ */
 
 /* vi: set ts=4 sw=4 expandtab: */
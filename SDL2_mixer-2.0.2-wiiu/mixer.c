@@ -46,11 +46,16 @@ static int audio_opened = 0;
 static SDL_AudioSpec mixer;
 static SDL_AudioDeviceID audio_device;
 
+/* Decoding a chunk through a music interface takes this, so chunks being
+   loaded on several threads at once never use one together. */
+static SDL_mutex *mix_decode_lock = NULL;
+
 typedef struct _Mix_effectinfo
 {
     Mix_EffectFunc_t callback;
     Mix_EffectDone_t done_callback;
     void *udata;
+    Mix_GainMatrix *matrix;     /* if the effect is just a gain matrix. */
     struct _Mix_effectinfo *next;
 } effect_info;
 
@@ -62,21 +67,58 @@ static struct _Mix_Channel {
     int volume;
     int looping;
     int tag;
-    Uint32 expire;
+    Uint32 expire;          /* output frames left to play, 0 if there's no limit. */
     Uint32 start_time;
     Mix_Fading fading;
     int fade_volume;
     int fade_volume_reset;
-    Uint32 fade_length;
-    Uint32 ticks_fade;
+    Uint32 fade_length;     /* in output frames. */
+    Uint32 fade_position;   /* output frames since the fade started. */
     effect_info *effects;
+    int priority;
+    float distance_gain;    /* set by the position effect, 0.0 is out of earshot. */
+    float audibility;       /* how loud the channel is, as of the last mix. */
+    int is_virtual;         /* playing, but not mixed in the last mix. */
+    int free_listed;        /* in free_voices. */
 } *mix_channel = NULL;
 
 static effect_info *posteffects = NULL;
 
+/* The channels are summed here before being clipped to the output format.
+   Sized for one callback's worth of audio when the device is opened, and
+   NULL if the output format isn't one mix_bus_load() understands. */
+static void *mix_bus = NULL;
+static int mix_bus_len = 0;
+
+/* Channel effects work on a copy of the channel's data, made here. */
+static Uint8 *mix_effect_buf = NULL;
+static int mix_effect_len = 0;
+
 static int num_channels;
 static int reserved_channels = 0;
 
+/* A binary heap of channel numbers, 'before' deciding which goes on top. */
+typedef struct _Mix_VoiceHeap {
+    int *voices;
+    int count;
+    SDL_bool (*before)(int a, int b);
+} voice_heap;
+
+/* The free channels past the reserved ones wait here, lowest first, so
+   playing on channel -1 doesn't have to look for one. Channels are put
+   back when they stop, and anything that was taken some other way in
+   the meantime is skipped when it comes to the top. */
+static voice_heap free_voices;
+
+/* Every mix ranks the playing unreserved channels here, least important
+   on top, for when a sound has to take over one of them. */
+static voice_heap steal_voices;
+
+/* The channels that get mixed under Mix_LimitMixedChannels(), least
+   important on top so it can be swapped out for a more important one. */
+static voice_heap mixed_voices;
+static int mixed_voices_limit = 0;
+
 
 /* Support for hooking into the mixer callback system */
 static void (SDLCALL *mix_postmix)(void *udata, Uint8 *stream, int len) = NULL;
@@ -187,6 +229,246 @@ void Mix_Quit()
 
 static int _Mix_remove_all_effects(int channel, effect_info **e);
 
+static void voice_heap_sift_up(voice_heap *heap, int i)
+{
+    int *voices = heap->voices;
+
+    while (i > 0) {
+        const int parent = (i - 1) / 2;
+        const int tmp = voices[parent];
+        if (!heap->before(voices[i], tmp)) {
+            break;
+        }
+        voices[parent] = voices[i];
+        voices[i] = tmp;
+        i = parent;
+    }
+}
+
+static void voice_heap_sift_down(voice_heap *heap, int i)
+{
+    int *voices = heap->voices;
+
+    for (;;) {
+        int child = (2 * i) + 1;
+        int tmp;
+        if (child >= heap->count) {
+            break;
+        }
+        if ((child + 1) < heap->count && heap->before(voices[child + 1], voices[child])) {
+            ++child;
+        }
+        if (!heap->before(voices[child], voices[i])) {
+            break;
+        }
+        tmp = voices[child];
+        voices[child] = voices[i];
+        voices[i] = tmp;
+        i = child;
+    }
+}
+
+static void voice_heap_push(voice_heap *heap, int chan)
+{
+    heap->voices[heap->count] = chan;
+    voice_heap_sift_up(heap, heap->count++);
+}
+
+static int voice_heap_pop(voice_heap *heap)
+{
+    const int top = heap->voices[0];
+    heap->voices[0] = heap->voices[--heap->count];
+    voice_heap_sift_down(heap, 0);
+    return top;
+}
+
+static void voice_heap_replace_top(voice_heap *heap, int chan)
+{
+    heap->voices[0] = chan;
+    voice_heap_sift_down(heap, 0);
+}
+
+static void voice_heap_build(voice_heap *heap)
+{
+    int i;
+    for (i = (heap->count / 2) - 1; i >= 0; --i) {
+        voice_heap_sift_down(heap, i);
+    }
+}
+
+static SDL_bool voice_lower_channel(int a, int b)
+{
+    return (a < b) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Whether the sound on channel a matters less than the one on channel b */
+static SDL_bool voice_less_important(int a, int b)
+{
+    const struct _Mix_Channel *ca = &mix_channel[a];
+    const struct _Mix_Channel *cb = &mix_channel[b];
+
+    if (ca->priority != cb->priority) {
+        return (ca->priority < cb->priority) ? SDL_TRUE : SDL_FALSE;
+    }
+    if (ca->audibility != cb->audibility) {
+        return (ca->audibility < cb->audibility) ? SDL_TRUE : SDL_FALSE;
+    }
+    if (ca->start_time != cb->start_time) {
+        return (ca->start_time < cb->start_time) ? SDL_TRUE : SDL_FALSE;
+    }
+    return (a > b) ? SDL_TRUE : SDL_FALSE;
+}
+
+/* Size the voice heaps for num_channels channels. Without them, channels
+   are found by searching and there's no stealing or mixing limit. */
+static void voice_heaps_reset(void)
+{
+    int i;
+
+    /* ascending order is already a heap. */
+    free_voices.count = 0;
+    steal_voices.count = 0;
+    mixed_voices.count = 0;
+    for (i = 0; i < num_channels; ++i) {
+        mix_channel[i].free_listed = 0;
+        if (free_voices.voices && i >= reserved_channels && mix_channel[i].playing <= 0) {
+            mix_channel[i].free_listed = 1;
+            free_voices.voices[free_voices.count++] = i;
+        }
+    }
+}
+
+static void voice_heaps_alloc(void)
+{
+    int *voices = NULL;
+
+    if (num_channels > 0) {
+        voices = (int *) SDL_realloc(free_voices.voices, 3 * num_channels * sizeof(int));
+    }
+    if (voices == NULL) {
+        /* no channels, or out of memory: go back to searching */
+        SDL_free(free_voices.voices);
+    }
+    free_voices.voices = voices;
+    free_voices.before = voice_lower_channel;
+    steal_voices.voices = voices ? (voices + num_channels) : NULL;
+    steal_voices.before = voice_less_important;
+    mixed_voices.voices = voices ? (voices + (2 * num_channels)) : NULL;
+    mixed_voices.before = voice_less_important;
+    voice_heaps_reset();
+}
+
+static void voice_heaps_free(void)
+{
+    SDL_free(free_voices.voices);
+    SDL_zero(free_voices);
+    SDL_zero(steal_voices);
+    SDL_zero(mixed_voices);
+}
+
+/* Put a channel that's stopped back in the free list */
+static void voice_freed(int chan)
+{
+    if (free_voices.voices && !mix_channel[chan].free_listed && chan >= reserved_channels) {
+        mix_channel[chan].free_listed = 1;
+        voice_heap_push(&free_voices, chan);
+    }
+}
+
+/* The first free unreserved channel, or -1 */
+static int voice_find_free(void)
+{
+    int i;
+
+    if (free_voices.voices == NULL) {
+        for (i=reserved_channels; i<num_channels; ++i) {
+            if (mix_channel[i].playing <= 0)
+                return(i);
+        }
+        return(-1);
+    }
+    while (free_voices.count > 0) {
+        i = voice_heap_pop(&free_voices);
+        mix_channel[i].free_listed = 0;
+        if (i >= reserved_channels && mix_channel[i].playing <= 0) {
+            return(i);
+        }
+    }
+    return(-1);
+}
+
+/* The channel a sound of this priority can take over, or -1 */
+static int voice_find_steal(int priority)
+{
+    while (steal_voices.count > 0) {
+        const int chan = steal_voices.voices[0];
+        const struct _Mix_Channel *channel = &mix_channel[chan];
+
+        /* the ranking is from the last mix, skip what's changed since. */
+        if (chan < reserved_channels || channel->playing <= 0) {
+            voice_heap_pop(&steal_voices);
+            continue;
+        }
+        if (channel->priority < priority ||
+            (channel->priority == priority && channel->is_virtual)) {
+            voice_heap_pop(&steal_voices);
+            return(chan);
+        }
+        break;
+    }
+    return(-1);
+}
+
+/* How loud a channel is going to be, 0.0 if it can't be heard at all */
+static float voice_audibility(int chan)
+{
+    const struct _Mix_Channel *channel = &mix_channel[chan];
+    /* rank fades by where they're going (or coming from), so fade-ins start audible. */
+    const int volume = (channel->fading != MIX_NO_FADING) ? channel->fade_volume : channel->volume;
+
+    return ((float)(volume * channel->chunk->volume) * channel->distance_gain) / (MIX_MAX_VOLUME * MIX_MAX_VOLUME);
+}
+
+/* Work out which channels get mixed this time, and rank them for stealing */
+static void voice_rank(void)
+{
+    const SDL_bool limited = (mixed_voices_limit > 0 && mixed_voices.voices != NULL);
+    int i;
+
+    steal_voices.count = 0;
+    mixed_voices.count = 0;
+    for (i=0; i<num_channels; ++i) {
+        struct _Mix_Channel *channel = &mix_channel[i];
+        if (channel->playing <= 0) {
+            continue;
+        }
+        channel->audibility = voice_audibility(i);
+        channel->is_virtual = (channel->audibility <= 0.0f);
+        if (steal_voices.voices && i >= reserved_channels) {
+            steal_voices.voices[steal_voices.count++] = i;
+        }
+        if (limited && !channel->paused && !channel->is_virtual) {
+            if (mixed_voices.count < mixed_voices_limit) {
+                voice_heap_push(&mixed_voices, i);
+            } else if (voice_less_important(mixed_voices.voices[0], i)) {
+                mix_channel[mixed_voices.voices[0]].is_virtual = 1;
+                voice_heap_replace_top(&mixed_voices, i);
+            } else {
+                channel->is_virtual = 1;
+            }
+        }
+    }
+    voice_heap_build(&steal_voices);
+}
+
+/* The position effect tells us how far away it's put a channel */
+void _Mix_SetDistanceGain_locked(int channel, float gain)
+{
+    if (mix_channel && channel >= 0 && channel < num_channels) {
+        mix_channel[channel].distance_gain = gain;
+    }
+}
+
 /*
  * rcg06122001 Cleanup effect callbacks.
  *  MAKE SURE Mix_LockAudio() is called before this (or you're in the
@@ -203,44 +485,913 @@ static void _Mix_channel_done_playing(int channel)
      *   inside audio callback.
      */
     _Mix_remove_all_effects(channel, &mix_channel[channel].effects);
+
+    voice_freed(channel);
 }
 
 
-static void *Mix_DoEffects(int chan, void *snd, int len)
+/* Run the effects up to (but not including) 'stop', which is NULL to run them all. */
+static void *mix_do_effects(int chan, void *snd, int len, const effect_info *stop)
 {
     int posteffect = (chan == MIX_CHANNEL_POST);
     effect_info *e = ((posteffect) ? posteffects : mix_channel[chan].effects);
     void *buf = snd;
 
-    if (e != NULL) {    /* are there any registered effects? */
+    if (e != stop) {    /* are there any registered effects? */
         /* if this is the postmix, we can just overwrite the original. */
         if (!posteffect) {
-            buf = SDL_malloc(len);
-            if (buf == NULL) {
-                return(snd);
+            /* channels are mixed one at a time, so they can all share this. */
+            if (len <= mix_effect_len) {
+                buf = mix_effect_buf;
+            } else {
+                buf = SDL_malloc(len);
+                if (buf == NULL) {
+                    return(snd);
+                }
             }
             SDL_memcpy(buf, snd, len);
         }
 
-        for (; e != NULL; e = e->next) {
+        for (; e != stop; e = e->next) {
             if (e->callback != NULL) {
                 e->callback(chan, buf, len, e->udata);
             }
         }
     }
 
-    /* be sure to SDL_free() the return value if != snd ... */
+    /* be sure to SDL_free() the return value if != snd and != mix_effect_buf ... */
     return(buf);
 }
 
+static void *Mix_DoEffects(int chan, void *snd, int len)
+{
+    return mix_do_effects(chan, snd, len, NULL);
+}
+
+
+/* The formats the mixing bus knows how to load and store. */
+static SDL_bool mix_bus_supported(SDL_AudioFormat format)
+{
+    switch (format) {
+    case AUDIO_U8:
+    case AUDIO_S8:
+    case AUDIO_S16LSB:
+    case AUDIO_S16MSB:
+    case AUDIO_F32LSB:
+    case AUDIO_F32MSB:
+        return SDL_TRUE;
+    default:
+        return SDL_FALSE;
+    }
+}
+
+/* GCC and clang's generic vector extensions, which turn into SIMD code where
+   the CPU has it. The scalar loops after them finish whatever is left. */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 9))
+#define MIX_BUS_VECTORS 1
+typedef Sint32 mix_S32x4 __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Uint32 mix_U32x4 __attribute__((vector_size(16), aligned(1), may_alias));
+typedef float mix_F32x4 __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Sint16 mix_S16x4 __attribute__((vector_size(8), aligned(1), may_alias));
+typedef Uint16 mix_U16x4 __attribute__((vector_size(8), aligned(1), may_alias));
+#define MIX_SWAP16x4(v) (((v) << 8) | ((v) >> 8))
+#define MIX_SWAP32x4(v) (((v) << 24) | (((v) << 8) & 0x00FF0000) | (((v) >> 8) & 0x0000FF00) | ((v) >> 24))
+
+static SDL_INLINE int mix_bus_load_s16_vector(Sint32 *bus, const Uint8 *src, int samples, SDL_bool swap)
+{
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_U16x4 in = *(const mix_U16x4 *)(src + i * 2);
+        if (swap) {
+            in = MIX_SWAP16x4(in);
+        }
+        *(mix_S32x4 *)(bus + i) = __builtin_convertvector((mix_S16x4)in, mix_S32x4);
+    }
+    return i;
+}
+
+/* sample * volume fits in a float's mantissa and dividing by MIX_MAX_VOLUME only
+   changes the exponent, so this is exact and truncates just like the integer
+   version, without needing a 32-bit vector multiply (which SSE2 doesn't have). */
+static SDL_INLINE int mix_bus_add_s16_vector(Sint32 *bus, const Uint8 *src, int samples, int volume, SDL_bool swap)
+{
+    const float fvolume = ((float)volume) / ((float)MIX_MAX_VOLUME);
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_U16x4 in = *(const mix_U16x4 *)(src + i * 2);
+        mix_S32x4 sample;
+        if (swap) {
+            in = MIX_SWAP16x4(in);
+        }
+        sample = __builtin_convertvector((mix_S16x4)in, mix_S32x4);
+        if (volume != MIX_MAX_VOLUME) {
+            sample = __builtin_convertvector(__builtin_convertvector(sample, mix_F32x4) * fvolume, mix_S32x4);
+        }
+        *(mix_S32x4 *)(bus + i) += sample;
+    }
+    return i;
+}
+
+static SDL_INLINE int mix_bus_store_s16_vector(Uint8 *dst, const Sint32 *bus, int samples, SDL_bool swap)
+{
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_S32x4 sample = *(const mix_S32x4 *)(bus + i);
+        mix_S32x4 mask;
+        mix_U16x4 out;
+        mask = (sample > 32767);
+        sample = (sample & ~mask) | (mask & 32767);
+        mask = (sample < -32768);
+        sample = (sample & ~mask) | (mask & -32768);
+        out = (mix_U16x4)__builtin_convertvector(sample, mix_S16x4);
+        if (swap) {
+            out = MIX_SWAP16x4(out);
+        }
+        *(mix_U16x4 *)(dst + i * 2) = out;
+    }
+    return i;
+}
+
+static SDL_INLINE int mix_bus_add_f32_vector(float *bus, const Uint8 *src, int samples, int volume, SDL_bool swap)
+{
+    const float fvolume = (float)volume;
+    const float fmaxvolume = 1.0f / ((float)MIX_MAX_VOLUME);
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_U32x4 in = *(const mix_U32x4 *)(src + i * 4);
+        mix_F32x4 sample;
+        if (swap) {
+            in = MIX_SWAP32x4(in);
+        }
+        sample = (mix_F32x4)in;
+        if (volume != MIX_MAX_VOLUME) {
+            sample = (sample * fvolume) * fmaxvolume;
+        }
+        *(mix_F32x4 *)(bus + i) += sample;
+    }
+    return i;
+}
+
+static SDL_INLINE int mix_bus_store_f32_vector(Uint8 *dst, const float *bus, int samples, SDL_bool swap)
+{
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_F32x4 sample = *(const mix_F32x4 *)(bus + i);
+        mix_S32x4 mask;
+        mix_U32x4 out;
+        mask = (sample > 3.402823466e+38F);
+        sample = (mix_F32x4)(((mix_S32x4)sample & ~mask) | (mask & (mix_S32x4)((mix_F32x4){0} + 3.402823466e+38F)));
+        mask = (sample < -3.402823466e+38F);
+        sample = (mix_F32x4)(((mix_S32x4)sample & ~mask) | (mask & (mix_S32x4)((mix_F32x4){0} - 3.402823466e+38F)));
+        out = (mix_U32x4)sample;
+        if (swap) {
+            out = MIX_SWAP32x4(out);
+        }
+        *(mix_U32x4 *)(dst + i * 4) = out;
+    }
+    return i;
+}
+
+/* A gain matrix that only scales each channel, at a steady volume, is one
+   multiply per sample when four samples hold a whole number of frames. */
+static SDL_INLINE int mix_bus_add_s16_gains_vector(Sint32 *bus, const Uint8 *src, int samples, mix_F32x4 gains, SDL_bool swap)
+{
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_U16x4 in = *(const mix_U16x4 *)(src + i * 2);
+        mix_F32x4 sample;
+        if (swap) {
+            in = MIX_SWAP16x4(in);
+        }
+        sample = __builtin_convertvector(__builtin_convertvector((mix_S16x4)in, mix_S32x4), mix_F32x4);
+        *(mix_S32x4 *)(bus + i) += __builtin_convertvector(sample * gains, mix_S32x4);
+    }
+    return i;
+}
+
+static SDL_INLINE int mix_bus_add_f32_gains_vector(float *bus, const Uint8 *src, int samples, mix_F32x4 gains, SDL_bool swap)
+{
+    int i;
+    for (i = 0; i + 4 <= samples; i += 4) {
+        mix_U32x4 in = *(const mix_U32x4 *)(src + i * 4);
+        if (swap) {
+            in = MIX_SWAP32x4(in);
+        }
+        *(mix_F32x4 *)(bus + i) += ((mix_F32x4)in) * gains;
+    }
+    return i;
+}
+#else
+#define MIX_BUS_VECTORS 0
+#endif
+
+/* Load what's already in the stream (the music) onto the bus.
+   Integer samples are held as signed 32-bit values, floats as floats. */
+static void mix_bus_load(const Uint8 *stream, int len)
+{
+    int i = 0, samples = len / (SDL_AUDIO_BITSIZE(mixer.format) / 8);
+    Sint32 *bus = (Sint32 *)mix_bus;
+    float *fbus = (float *)mix_bus;
+
+    switch (mixer.format) {
+    case AUDIO_U8:
+        for (i = 0; i < samples; ++i) {
+            bus[i] = stream[i] - 128;
+        }
+        break;
+    case AUDIO_S8:
+        for (i = 0; i < samples; ++i) {
+            bus[i] = ((const Sint8 *)stream)[i];
+        }
+        break;
+    case AUDIO_S16SYS:
+#if MIX_BUS_VECTORS
+        i = mix_bus_load_s16_vector(bus, stream, samples, SDL_FALSE);
+#endif
+        for (; i < samples; ++i) {
+            bus[i] = ((const Sint16 *)stream)[i];
+        }
+        break;
+    case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+#if MIX_BUS_VECTORS
+        i = mix_bus_load_s16_vector(bus, stream, samples, SDL_TRUE);
+#endif
+        for (; i < samples; ++i) {
+            bus[i] = (Sint16)SDL_Swap16(((const Uint16 *)stream)[i]);
+        }
+        break;
+    case AUDIO_F32SYS:
+        SDL_memcpy(fbus, stream, len);
+        break;
+    case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        for (i = 0; i < samples; ++i) {
+            fbus[i] = SDL_SwapFloat(((const float *)stream)[i]);
+        }
+        break;
+    }
+}
+
+/* Add a channel onto the bus at the given volume, without clipping. */
+static void mix_bus_add(int offset, const Uint8 *src, int len, int volume)
+{
+    const int size = SDL_AUDIO_BITSIZE(mixer.format) / 8;
+    int i = 0, samples = len / size;
+    Sint32 *bus = (Sint32 *)mix_bus + (offset / size);
+    float *fbus = (float *)mix_bus + (offset / size);
+
+    if (volume == 0) {
+        return;
+    }
+
+    switch (mixer.format) {
+    case AUDIO_U8:
+        for (i = 0; i < samples; ++i) {
+            bus[i] += ((src[i] - 128) * volume) / MIX_MAX_VOLUME;
+        }
+        break;
+    case AUDIO_S8:
+        for (i = 0; i < samples; ++i) {
+            bus[i] += (((const Sint8 *)src)[i] * volume) / MIX_MAX_VOLUME;
+        }
+        break;
+    case AUDIO_S16SYS:
+#if MIX_BUS_VECTORS
+        i = mix_bus_add_s16_vector(bus, src, samples, volume, SDL_FALSE);
+#endif
+        for (; i < samples; ++i) {
+            bus[i] += (((const Sint16 *)src)[i] * volume) / MIX_MAX_VOLUME;
+        }
+        break;
+    case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+#if MIX_BUS_VECTORS
+        i = mix_bus_add_s16_vector(bus, src, samples, volume, SDL_TRUE);
+#endif
+        for (; i < samples; ++i) {
+            bus[i] += ((Sint16)SDL_Swap16(((const Uint16 *)src)[i]) * volume) / MIX_MAX_VOLUME;
+        }
+        break;
+    case AUDIO_F32SYS:
+    case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        {
+            const float fvolume = (float)volume;
+            const float fmaxvolume = 1.0f / ((float)MIX_MAX_VOLUME);
+            const SDL_bool swap = (mixer.format != AUDIO_F32SYS);
+#if MIX_BUS_VECTORS
+            if (swap) {
+                i = mix_bus_add_f32_vector(fbus, src, samples, volume, SDL_TRUE);
+            } else {
+                i = mix_bus_add_f32_vector(fbus, src, samples, volume, SDL_FALSE);
+            }
+#endif
+            for (; i < samples; ++i) {
+                float sample = ((const float *)src)[i];
+                if (swap) {
+                    sample = SDL_SwapFloat(sample);
+                }
+                if (volume != MIX_MAX_VOLUME) {
+                    sample = (sample * fvolume) * fmaxvolume;
+                }
+                fbus[i] += sample;
+            }
+        }
+        break;
+    }
+}
+
+/* Clip the bus to the output format and write it to the stream. */
+static void mix_bus_store(Uint8 *stream, int len)
+{
+    int i = 0, samples = len / (SDL_AUDIO_BITSIZE(mixer.format) / 8);
+    const Sint32 *bus = (const Sint32 *)mix_bus;
+    const float *fbus = (const float *)mix_bus;
+
+    switch (mixer.format) {
+    case AUDIO_U8:
+        /* SDL_MixAudioFormat() tops out at 0xFE for U8, so do we. */
+        for (i = 0; i < samples; ++i) {
+            const Sint32 sample = bus[i] + 128;
+            stream[i] = (Uint8)((sample < 0) ? 0 : (sample > 0xFE) ? 0xFE : sample);
+        }
+        break;
+    case AUDIO_S8:
+        for (i = 0; i < samples; ++i) {
+            const Sint32 sample = bus[i];
+            ((Sint8 *)stream)[i] = (Sint8)((sample < -128) ? -128 : (sample > 127) ? 127 : sample);
+        }
+        break;
+    case AUDIO_S16SYS:
+#if MIX_BUS_VECTORS
+        i = mix_bus_store_s16_vector(stream, bus, samples, SDL_FALSE);
+#endif
+        for (; i < samples; ++i) {
+            const Sint32 sample = bus[i];
+            ((Sint16 *)stream)[i] = (Sint16)((sample < -32768) ? -32768 : (sample > 32767) ? 32767 : sample);
+        }
+        break;
+    case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+#if MIX_BUS_VECTORS
+        i = mix_bus_store_s16_vector(stream, bus, samples, SDL_TRUE);
+#endif
+        for (; i < samples; ++i) {
+            const Sint32 sample = bus[i];
+            ((Uint16 *)stream)[i] = SDL_Swap16((Uint16)((sample < -32768) ? -32768 : (sample > 32767) ? 32767 : sample));
+        }
+        break;
+    case AUDIO_F32SYS:
+    case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        {
+            const SDL_bool swap = (mixer.format != AUDIO_F32SYS);
+#if MIX_BUS_VECTORS
+            if (swap) {
+                i = mix_bus_store_f32_vector(stream, fbus, samples, SDL_TRUE);
+            } else {
+                i = mix_bus_store_f32_vector(stream, fbus, samples, SDL_FALSE);
+            }
+#endif
+            for (; i < samples; ++i) {
+                float sample = fbus[i];
+                /* like SDL_MixAudioFormat(), only keep it out of infinity. */
+                if (sample > 3.402823466e+38F) {
+                    sample = 3.402823466e+38F;
+                } else if (sample < -3.402823466e+38F) {
+                    sample = -3.402823466e+38F;
+                }
+                ((float *)stream)[i] = swap ? SDL_SwapFloat(sample) : sample;
+            }
+        }
+        break;
+    }
+}
+
+/* Add a channel onto the bus with its volume going from vol0 to vol1 over
+   the data, so fades move every sample frame instead of every callback. */
+#define MIX_RAMP_LOOP(statement) \
+    for (i = 0; i < frames; ++i) { \
+        const float gain = gain0 + (step * i); \
+        for (c = 0; c < channels; ++c, ++j) { \
+            statement; \
+        } \
+    }
+
+static void mix_bus_add_ramp(int offset, const Uint8 *src, int len, float vol0, float vol1)
+{
+    const int size = SDL_AUDIO_BITSIZE(mixer.format) / 8;
+    const int channels = mixer.channels;
+    const int frames = len / (size * channels);
+    const float gain0 = vol0 / MIX_MAX_VOLUME;
+    const float step = (frames > 0) ? ((vol1 - vol0) / MIX_MAX_VOLUME) / frames : 0.0f;
+    Sint32 *bus = (Sint32 *)mix_bus + (offset / size);
+    float *fbus = (float *)mix_bus + (offset / size);
+    int i, c, j = 0;
+
+    switch (mixer.format) {
+    case AUDIO_U8:
+        MIX_RAMP_LOOP(bus[j] += (Sint32)((src[j] - 128) * gain));
+        break;
+    case AUDIO_S8:
+        MIX_RAMP_LOOP(bus[j] += (Sint32)(((const Sint8 *)src)[j] * gain));
+        break;
+    case AUDIO_S16SYS:
+        MIX_RAMP_LOOP(bus[j] += (Sint32)(((const Sint16 *)src)[j] * gain));
+        break;
+    case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        MIX_RAMP_LOOP(bus[j] += (Sint32)((Sint16)SDL_Swap16(((const Uint16 *)src)[j]) * gain));
+        break;
+    case AUDIO_F32SYS:
+        MIX_RAMP_LOOP(fbus[j] += ((const float *)src)[j] * gain);
+        break;
+    case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        MIX_RAMP_LOOP(fbus[j] += SDL_SwapFloat(((const float *)src)[j]) * gain);
+        break;
+    }
+}
+
+#define MIX_RAMP_SAMPLES(type, read, write) \
+    { \
+        type *p = (type *)data; \
+        int j = 0; \
+        MIX_RAMP_LOOP(p[j] = write(read(p[j]) * gain)); \
+    }
+#define MIX_READ_U8(x)      ((x) - 128)
+#define MIX_WRITE_U8(x)     ((Uint8)((Sint32)(x) + 128))
+#define MIX_READ_S8(x)      (x)
+#define MIX_WRITE_S8(x)     ((Sint8)(x))
+#define MIX_READ_U16LSB(x)  ((Sint32)SDL_SwapLE16(x) - 32768)
+#define MIX_WRITE_U16LSB(x) SDL_SwapLE16((Uint16)((Sint32)(x) + 32768))
+#define MIX_READ_U16MSB(x)  ((Sint32)SDL_SwapBE16(x) - 32768)
+#define MIX_WRITE_U16MSB(x) SDL_SwapBE16((Uint16)((Sint32)(x) + 32768))
+#define MIX_READ_S16LSB(x)  ((Sint16)SDL_SwapLE16(x))
+#define MIX_WRITE_S16LSB(x) SDL_SwapLE16((Uint16)(Sint16)(x))
+#define MIX_READ_S16MSB(x)  ((Sint16)SDL_SwapBE16(x))
+#define MIX_WRITE_S16MSB(x) SDL_SwapBE16((Uint16)(Sint16)(x))
+#define MIX_READ_S32LSB(x)  ((double)(Sint32)SDL_SwapLE32(x))
+#define MIX_WRITE_S32LSB(x) SDL_SwapLE32((Uint32)(Sint32)(x))
+#define MIX_READ_S32MSB(x)  ((double)(Sint32)SDL_SwapBE32(x))
+#define MIX_WRITE_S32MSB(x) SDL_SwapBE32((Uint32)(Sint32)(x))
+
+/* Scale audio in place, with the gain going from gain0 to gain1 over it. */
+void Mix_RampVolume(Uint8 *data, SDL_AudioFormat format, int channels, int len, float gain0, float gain1)
+{
+    const int frames = len / ((SDL_AUDIO_BITSIZE(format) / 8) * channels);
+    const float step = (frames > 0) ? (gain1 - gain0) / frames : 0.0f;
+    int i, c;
+
+    switch (format) {
+    case AUDIO_U8:
+        MIX_RAMP_SAMPLES(Uint8, MIX_READ_U8, MIX_WRITE_U8);
+        break;
+    case AUDIO_S8:
+        MIX_RAMP_SAMPLES(Sint8, MIX_READ_S8, MIX_WRITE_S8);
+        break;
+    case AUDIO_U16LSB:
+        MIX_RAMP_SAMPLES(Uint16, MIX_READ_U16LSB, MIX_WRITE_U16LSB);
+        break;
+    case AUDIO_U16MSB:
+        MIX_RAMP_SAMPLES(Uint16, MIX_READ_U16MSB, MIX_WRITE_U16MSB);
+        break;
+    case AUDIO_S16LSB:
+        MIX_RAMP_SAMPLES(Uint16, MIX_READ_S16LSB, MIX_WRITE_S16LSB);
+        break;
+    case AUDIO_S16MSB:
+        MIX_RAMP_SAMPLES(Uint16, MIX_READ_S16MSB, MIX_WRITE_S16MSB);
+        break;
+    case AUDIO_S32LSB:
+        MIX_RAMP_SAMPLES(Uint32, MIX_READ_S32LSB, MIX_WRITE_S32LSB);
+        break;
+    case AUDIO_S32MSB:
+        MIX_RAMP_SAMPLES(Uint32, MIX_READ_S32MSB, MIX_WRITE_S32MSB);
+        break;
+    case AUDIO_F32LSB:
+        MIX_RAMP_SAMPLES(float, SDL_SwapFloatLE, SDL_SwapFloatLE);
+        break;
+    case AUDIO_F32MSB:
+        MIX_RAMP_SAMPLES(float, SDL_SwapFloatBE, SDL_SwapFloatBE);
+        break;
+    }
+}
+
+/* The nonzero gains of a gain matrix, for where its ramp is up to. */
+typedef struct _Mix_MatrixTap
+{
+    int out;
+    int in;
+    float gain;
+} mix_matrix_tap;
+
+static int mix_matrix_taps(const Mix_GainMatrix *matrix, int channels, mix_matrix_tap *taps)
+{
+    float t = 1.0f;
+    int o, i, count = 0;
+
+    if (matrix->ramp_position < matrix->ramp_length) {
+        t = (float)matrix->ramp_position / (float)matrix->ramp_length;
+    }
+    for (o = 0; o < channels; ++o) {
+        for (i = 0; i < channels; ++i) {
+            const float gain = matrix->from[o][i] + ((matrix->to[o][i] - matrix->from[o][i]) * t);
+            if (gain != 0.0f) {
+                taps[count].out = o;
+                taps[count].in = i;
+                taps[count].gain = gain;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+/* Whether each output of a matrix takes at most two inputs, which it
+   usually does: it scales the channels, moves them around for room_angle,
+   or splits one between the two speakers next to where it's moved to.
+   Outputs with one input get the same input twice, at zero gain. */
+static SDL_bool mix_matrix_routed(const mix_matrix_tap *taps, int count, int channels, int (*route)[2], float (*gains)[2])
+{
+    int t, c;
+
+    for (c = 0; c < channels; ++c) {
+        route[c][0] = route[c][1] = c;
+        gains[c][0] = gains[c][1] = 0.0f;
+    }
+    for (t = 0; t < count; ++t) {
+        const int o = taps[t].out;
+        if ((t > 1) && (taps[t - 2].out == o)) {
+            return SDL_FALSE;
+        } else if ((t > 0) && (taps[t - 1].out == o)) {
+            route[o][1] = taps[t].in;
+            gains[o][1] = taps[t].gain;
+        } else {
+            route[o][0] = route[o][1] = taps[t].in;
+            gains[o][0] = taps[t].gain;
+        }
+    }
+    return SDL_TRUE;
+}
+
+/* Run frames f to 'end' through the matrix, scaled by a volume going from
+   gain0 to gain1. 'get' reads sample k and 'put' stores x as sample k. The
+   taps are worked out again every frame while the matrix is ramping. */
+#define MIX_MATRIX_LOOP(get, put) \
+    for (; f < end; ++f, j += channels) { \
+        float in[MIX_MATRIX_CHANNELS], out[MIX_MATRIX_CHANNELS]; \
+        const float gain = gain0 + (step * f); \
+        for (c = 0; c < channels; ++c) { \
+            const int k = j + c; \
+            in[c] = (float)(get); \
+            out[c] = 0.0f; \
+        } \
+        for (t = 0; t < count; ++t) { \
+            out[taps[t].out] += in[taps[t].in] * taps[t].gain; \
+        } \
+        for (c = 0; c < channels; ++c) { \
+            const int k = j + c; \
+            const float x = out[c] * gain; \
+            put; \
+        } \
+        if (ramping) { \
+            ++matrix->ramp_position; \
+            count = mix_matrix_taps(matrix, channels, taps); \
+        } \
+    }
+
+/* The same for a matrix that mixes at most two inputs into each output. */
+#define MIX_MATRIX_ROUTED_LOOP(get, put) \
+    for (; f < end; ++f, j += channels) { \
+        const float gain = gain0 + (step * f); \
+        for (c = 0; c < channels; ++c) { \
+            float x; \
+            { \
+                const int k = j + route[c][0]; \
+                x = (float)(get) * gains[c][0]; \
+            } \
+            if (gains[c][1] != 0.0f) { \
+                const int k = j + route[c][1]; \
+                x += (float)(get) * gains[c][1]; \
+            } \
+            x *= gain; \
+            { \
+                const int k = j + c; \
+                put; \
+            } \
+        } \
+    }
+
+/* Go through the data in two parts: the rest of the matrix's ramp, if
+   it's ramping, then the rest at its final gains. */
+#define MIX_MATRIX_FORMAT(get, put) \
+    while (f < frames) { \
+        const Uint32 ramp_left = matrix->ramp_length - matrix->ramp_position; \
+        const SDL_bool ramping = (ramp_left > 0); \
+        end = (ramping && ramp_left < (Uint32)(frames - f)) ? (f + (int)ramp_left) : frames; \
+        if (!ramping && mix_matrix_routed(taps, count, channels, route, gains)) { \
+            MIX_MATRIX_ROUTED_LOOP(get, put); \
+        } else { \
+            MIX_MATRIX_LOOP(get, put); \
+        } \
+    }
+
+/* Mix a channel onto the bus through a gain matrix, so positioned sounds
+   are panned as they're mixed instead of in a pass of their own. */
+static void mix_bus_add_matrix(int offset, const Uint8 *src, int len, float vol0, float vol1, Mix_GainMatrix *matrix)
+{
+    const int size = SDL_AUDIO_BITSIZE(mixer.format) / 8;
+    const int channels = mixer.channels;
+    const int frames = len / (size * channels);
+    const float gain0 = vol0 / MIX_MAX_VOLUME;
+    const float step = (frames > 0) ? ((vol1 - vol0) / MIX_MAX_VOLUME) / frames : 0.0f;
+    const Sint8 *src8 = (const Sint8 *)src;
+    const Sint16 *src16 = (const Sint16 *)src;
+    const float *src32 = (const float *)src;
+    Sint32 *bus = (Sint32 *)mix_bus + (offset / size);
+    float *fbus = (float *)mix_bus + (offset / size);
+    mix_matrix_tap taps[MIX_MATRIX_CHANNELS * MIX_MATRIX_CHANNELS];
+    float gains[MIX_MATRIX_CHANNELS][2];
+    int route[MIX_MATRIX_CHANNELS][2];
+    int count = mix_matrix_taps(matrix, channels, taps);
+    int f = 0, end, c, t, j = 0;
+
+#if MIX_BUS_VECTORS
+    if ((matrix->ramp_position >= matrix->ramp_length) && (vol0 == vol1) && ((4 % channels) == 0) &&
+        mix_matrix_routed(taps, count, channels, route, gains)) {
+        SDL_bool diagonal = SDL_TRUE;
+        mix_F32x4 lanes;
+        for (c = 0; c < 4; ++c) {
+            const int o = c % channels;
+            if ((route[o][0] != o) || (gains[o][1] != 0.0f)) {
+                diagonal = SDL_FALSE;
+            }
+            lanes[c] = gains[o][0] * gain0;
+        }
+        if (diagonal) {
+            switch (mixer.format) {
+            case AUDIO_S16SYS:
+                j = mix_bus_add_s16_gains_vector(bus, src, frames * channels, lanes, SDL_FALSE);
+                break;
+            case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+                j = mix_bus_add_s16_gains_vector(bus, src, frames * channels, lanes, SDL_TRUE);
+                break;
+            case AUDIO_F32SYS:
+                j = mix_bus_add_f32_gains_vector(fbus, src, frames * channels, lanes, SDL_FALSE);
+                break;
+            case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+                j = mix_bus_add_f32_gains_vector(fbus, src, frames * channels, lanes, SDL_TRUE);
+                break;
+            }
+            f = j / channels;
+        }
+    }
+#endif
+
+    switch (mixer.format) {
+    case AUDIO_U8:
+        MIX_MATRIX_FORMAT(src[k] - 128, bus[k] += (Sint32)x);
+        break;
+    case AUDIO_S8:
+        MIX_MATRIX_FORMAT(src8[k], bus[k] += (Sint32)x);
+        break;
+    case AUDIO_S16SYS:
+        MIX_MATRIX_FORMAT(src16[k], bus[k] += (Sint32)x);
+        break;
+    case AUDIO_S16SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        MIX_MATRIX_FORMAT((Sint16)SDL_Swap16((Uint16)src16[k]), bus[k] += (Sint32)x);
+        break;
+    case AUDIO_F32SYS:
+        MIX_MATRIX_FORMAT(src32[k], fbus[k] += x);
+        break;
+    case AUDIO_F32SYS ^ SDL_AUDIO_MASK_ENDIAN:
+        MIX_MATRIX_FORMAT(SDL_SwapFloat(src32[k]), fbus[k] += x);
+        break;
+    }
+}
+
+/* The matrix can add a few channels into one, so this clamps. */
+#define MIX_MATRIX_SAMPLES(type, read, write, lo, hi) \
+    { \
+        type *p = (type *)data; \
+        MIX_MATRIX_FORMAT(read(p[k]), p[k] = write((x < lo) ? lo : (x > hi) ? hi : x)); \
+    }
+
+/* Apply a gain matrix to audio in place, moving it along its ramp. */
+void _Mix_ApplyGainMatrix(Uint8 *data, SDL_AudioFormat format, int channels, int len, Mix_GainMatrix *matrix)
+{
+    const int frames = len / ((SDL_AUDIO_BITSIZE(format) / 8) * channels);
+    const float gain0 = 1.0f, step = 0.0f;
+    mix_matrix_tap taps[MIX_MATRIX_CHANNELS * MIX_MATRIX_CHANNELS];
+    float gains[MIX_MATRIX_CHANNELS][2];
+    int route[MIX_MATRIX_CHANNELS][2];
+    int count = mix_matrix_taps(matrix, channels, taps);
+    int f = 0, end, c, t, j = 0;
+
+    switch (format) {
+    case AUDIO_U8:
+        MIX_MATRIX_SAMPLES(Uint8, MIX_READ_U8, MIX_WRITE_U8, -128.0f, 127.0f);
+        break;
+    case AUDIO_S8:
+        MIX_MATRIX_SAMPLES(Sint8, MIX_READ_S8, MIX_WRITE_S8, -128.0f, 127.0f);
+        break;
+    case AUDIO_U16LSB:
+        MIX_MATRIX_SAMPLES(Uint16, MIX_READ_U16LSB, MIX_WRITE_U16LSB, -32768.0f, 32767.0f);
+        break;
+    case AUDIO_U16MSB:
+        MIX_MATRIX_SAMPLES(Uint16, MIX_READ_U16MSB, MIX_WRITE_U16MSB, -32768.0f, 32767.0f);
+        break;
+    case AUDIO_S16LSB:
+        MIX_MATRIX_SAMPLES(Uint16, MIX_READ_S16LSB, MIX_WRITE_S16LSB, -32768.0f, 32767.0f);
+        break;
+    case AUDIO_S16MSB:
+        MIX_MATRIX_SAMPLES(Uint16, MIX_READ_S16MSB, MIX_WRITE_S16MSB, -32768.0f, 32767.0f);
+        break;
+    case AUDIO_S32LSB:
+        /* 2147483520 is the largest float below 2^31. */
+        MIX_MATRIX_SAMPLES(Uint32, MIX_READ_S32LSB, MIX_WRITE_S32LSB, -2147483648.0f, 2147483520.0f);
+        break;
+    case AUDIO_S32MSB:
+        MIX_MATRIX_SAMPLES(Uint32, MIX_READ_S32MSB, MIX_WRITE_S32MSB, -2147483648.0f, 2147483520.0f);
+        break;
+    case AUDIO_F32LSB:
+        MIX_MATRIX_SAMPLES(float, SDL_SwapFloatLE, SDL_SwapFloatLE, -3.402823466e+38F, 3.402823466e+38F);
+        break;
+    case AUDIO_F32MSB:
+        MIX_MATRIX_SAMPLES(float, SDL_SwapFloatBE, SDL_SwapFloatBE, -3.402823466e+38F, 3.402823466e+38F);
+        break;
+    }
+}
+
+/* Run a channel's effects on some of its data and mix it in, with the
+   volume going from vol0 to vol1 (which are usually the same.) */
+static void mix_channel_data(int chan, Uint8 *stream, int index, Uint8 *samples, int len, float vol0, float vol1, SDL_bool use_bus)
+{
+    effect_info *last = mix_channel[chan].effects;
+    Uint8 *mix_input;
+
+    /* A gain matrix at the end of the chain gets mixed through, not run. */
+    while (last && last->next) {
+        last = last->next;
+    }
+    if (use_bus && last && last->matrix) {
+        mix_input = mix_do_effects(chan, samples, len, last);
+        mix_bus_add_matrix(index, mix_input, len, vol0, vol1, last->matrix);
+        if (mix_input != samples && mix_input != mix_effect_buf) {
+            SDL_free(mix_input);
+        }
+        return;
+    }
+
+    mix_input = Mix_DoEffects(chan, samples, len);
+    if (vol0 == vol1) {
+        const int volume = (int)vol0;
+        if (use_bus) {
+            mix_bus_add(index, mix_input, len, volume);
+        } else {
+            SDL_MixAudioFormat(stream+index, mix_input, mixer.format, len, volume);
+        }
+    } else if (use_bus) {
+        mix_bus_add_ramp(index, mix_input, len, vol0, vol1);
+    } else {
+        /* ramp a copy of the data, if we have somewhere to put it. */
+        if (mix_input == samples && len <= mix_effect_len) {
+            SDL_memcpy(mix_effect_buf, samples, len);
+            mix_input = mix_effect_buf;
+        }
+        if (mix_input != samples) {
+            Mix_RampVolume(mix_input, mixer.format, mixer.channels, len, vol0 / MIX_MAX_VOLUME, vol1 / MIX_MAX_VOLUME);
+            SDL_MixAudioFormat(stream+index, mix_input, mixer.format, len, MIX_MAX_VOLUME);
+        } else {
+            SDL_MixAudioFormat(stream+index, mix_input, mixer.format, len, (int)((vol0 + vol1) / 2));
+        }
+    }
+    if (mix_input != samples && mix_input != mix_effect_buf) {
+        SDL_free(mix_input);
+    }
+}
+
+/* Keep a virtual channel's gain matrices moving along with it. */
+static void mix_channel_skip_effects(int chan, Uint32 frames)
+{
+    effect_info *e;
+
+    for (e = mix_channel[chan].effects; e != NULL; e = e->next) {
+        Mix_GainMatrix *matrix = e->matrix;
+        if (matrix && matrix->ramp_position < matrix->ramp_length) {
+            matrix->ramp_position += SDL_min(frames, matrix->ramp_length - matrix->ramp_position);
+        }
+    }
+}
+
+/* The channel's volume, fade included, this many frames into its fade. */
+static float mix_channel_fade_volume(int chan, Uint32 position)
+{
+    const float volume = (float)mix_channel[chan].fade_volume;
+    const float length = (float)mix_channel[chan].fade_length;
+
+    if (position >= mix_channel[chan].fade_length) {
+        return (mix_channel[chan].fading == MIX_FADING_OUT) ? 0.0f : volume;
+    } else if (mix_channel[chan].fading == MIX_FADING_OUT) {
+        return (volume * (length - position)) / length;
+    } else {
+        return (volume * position) / length;
+    }
+}
+
+/* Stop a channel that's run out of data, time or volume */
+static void mix_channel_stop(int chan)
+{
+    mix_channel[chan].playing = 0;
+    mix_channel[chan].looping = 0;
+    mix_channel[chan].expire = 0;
+    if (mix_channel[chan].fading != MIX_NO_FADING) {
+        mix_channel[chan].volume = mix_channel[chan].fade_volume_reset;
+        mix_channel[chan].fading = MIX_NO_FADING;
+    }
+    _Mix_channel_done_playing(chan);
+}
+
+/* Mix a channel into the output. The buffer is split wherever the chunk
+   ends, the channel expires or its fade finishes, so all of those happen
+   on the exact sample frame they're due. Virtual channels go through all
+   the same motions, they just don't get mixed. */
+static void mix_one_channel(int chan, Uint8 *stream, int len, SDL_bool use_bus)
+{
+    struct _Mix_Channel *channel = &mix_channel[chan];
+    const int frame_size = (SDL_AUDIO_BITSIZE(mixer.format) / 8) * mixer.channels;
+    int index = 0;
+
+    while (channel->playing > 0 && index < len) {
+        Uint32 frames = (len - index) / frame_size;
+        int mixable;
+        float vol0, vol1;
+
+        if (channel->fading != MIX_NO_FADING &&
+            channel->fade_position >= channel->fade_length) {
+            const Mix_Fading fading = channel->fading;
+            channel->volume = channel->fade_volume_reset;  /* Restore the volume */
+            channel->fading = MIX_NO_FADING;
+            if (fading == MIX_FADING_OUT) {
+                mix_channel_stop(chan);
+                break;
+            }
+        }
+
+        if (channel->expire > 0 && channel->expire < frames) {
+            frames = channel->expire;
+        }
+        if (channel->fading != MIX_NO_FADING &&
+            (channel->fade_length - channel->fade_position) < frames) {
+            frames = channel->fade_length - channel->fade_position;
+        }
+        mixable = (int)(frames * frame_size);
+        if (mixable > channel->playing) {
+            mixable = channel->playing;
+            frames = mixable / frame_size;
+        }
+
+        if (channel->fading != MIX_NO_FADING) {
+            vol0 = mix_channel_fade_volume(chan, channel->fade_position) * channel->chunk->volume / MIX_MAX_VOLUME;
+            vol1 = mix_channel_fade_volume(chan, channel->fade_position + frames) * channel->chunk->volume / MIX_MAX_VOLUME;
+            channel->fade_position += frames;
+            channel->volume = (int)mix_channel_fade_volume(chan, channel->fade_position);
+        } else {
+            vol0 = vol1 = (float)((channel->volume * channel->chunk->volume) / MIX_MAX_VOLUME);
+        }
+        if (!channel->is_virtual) {
+            mix_channel_data(chan, stream, index, channel->samples, mixable, vol0, vol1, use_bus);
+        } else {
+            mix_channel_skip_effects(chan, frames);
+        }
+
+        channel->samples += mixable;
+        channel->playing -= mixable;
+        index += mixable;
+
+        if (channel->expire > 0) {
+            channel->expire -= frames;
+            if (channel->expire == 0) {
+                /* Expiration delay for that channel is reached */
+                mix_channel_stop(chan);
+                break;
+            }
+        }
+
+        if (!channel->playing) {
+            if (channel->looping) {
+                if (channel->looping > 0) {
+                    --channel->looping;
+                }
+                channel->samples = channel->chunk->abuf;
+                channel->playing = channel->chunk->alen;
+            } else {
+                /* rcg06072001 Alert app if channel is done playing. */
+                mix_channel_stop(chan);
+            }
+        }
+    }
+}
 
 /* Mixing function */
 static void SDLCALL
 mix_channels(void *udata, Uint8 *stream, int len)
 {
-    Uint8 *mix_input;
-    int i, mixable, volume = MIX_MAX_VOLUME;
-    Uint32 sdl_ticks;
+    int i;
+    SDL_bool use_bus;
 
 #if SDL_VERSION_ATLEAST(1, 3, 0)
     /* Need to initialize the stream in SDL 1.3+ */
@@ -250,95 +1401,25 @@ mix_channels(void *udata, Uint8 *stream, int len)
     /* Mix the music (must be done before the channels are added) */
     mix_music(music_data, stream, len);
 
+    /* Sum the channels on the bus and clip once at the end, rather than
+       clipping the stream after every channel. */
+    use_bus = (mix_bus != NULL) && (len <= mix_bus_len);
+    if (use_bus) {
+        mix_bus_load(stream, len);
+    }
+
     /* Mix any playing channels... */
-    sdl_ticks = SDL_GetTicks();
+    voice_rank();
     for (i=0; i<num_channels; ++i) {
         if (!mix_channel[i].paused) {
-            if (mix_channel[i].expire > 0 && mix_channel[i].expire < sdl_ticks) {
-                /* Expiration delay for that channel is reached */
-                mix_channel[i].playing = 0;
-                mix_channel[i].looping = 0;
-                mix_channel[i].fading = MIX_NO_FADING;
-                mix_channel[i].expire = 0;
-                _Mix_channel_done_playing(i);
-            } else if (mix_channel[i].fading != MIX_NO_FADING) {
-                Uint32 ticks = sdl_ticks - mix_channel[i].ticks_fade;
-                if (ticks >= mix_channel[i].fade_length) {
-                    Mix_Volume(i, mix_channel[i].fade_volume_reset); /* Restore the volume */
-                    if(mix_channel[i].fading == MIX_FADING_OUT) {
-                        mix_channel[i].playing = 0;
-                        mix_channel[i].looping = 0;
-                        mix_channel[i].expire = 0;
-                        _Mix_channel_done_playing(i);
-                    }
-                    mix_channel[i].fading = MIX_NO_FADING;
-                } else {
-                    if (mix_channel[i].fading == MIX_FADING_OUT) {
-                        Mix_Volume(i, (mix_channel[i].fade_volume * (mix_channel[i].fade_length-ticks))
-                                   / mix_channel[i].fade_length);
-                    } else {
-                        Mix_Volume(i, (mix_channel[i].fade_volume * ticks) / mix_channel[i].fade_length);
-                    }
-                }
-            }
-            if (mix_channel[i].playing > 0) {
-                int index = 0;
-                int remaining = len;
-                while (mix_channel[i].playing > 0 && index < len) {
-                    remaining = len - index;
-                    volume = (mix_channel[i].volume*mix_channel[i].chunk->volume) / MIX_MAX_VOLUME;
-                    mixable = mix_channel[i].playing;
-                    if (mixable > remaining) {
-                        mixable = remaining;
-                    }
-
-                    mix_input = Mix_DoEffects(i, mix_channel[i].samples, mixable);
-                    SDL_MixAudioFormat(stream+index,mix_input,mixer.format,mixable,volume);
-                    if (mix_input != mix_channel[i].samples)
-                        SDL_free(mix_input);
-
-                    mix_channel[i].samples += mixable;
-                    mix_channel[i].playing -= mixable;
-                    index += mixable;
-
-                    /* rcg06072001 Alert app if channel is done playing. */
-                    if (!mix_channel[i].playing && !mix_channel[i].looping) {
-                        _Mix_channel_done_playing(i);
-                    }
-                }
-
-                /* If looping the sample and we are at its end, make sure
-                   we will still return a full buffer */
-                while (mix_channel[i].looping && index < len) {
-                    int alen = mix_channel[i].chunk->alen;
-                    remaining = len - index;
-                    if (remaining > alen) {
-                        remaining = alen;
-                    }
-
-                    mix_input = Mix_DoEffects(i, mix_channel[i].chunk->abuf, remaining);
-                    SDL_MixAudioFormat(stream+index, mix_input, mixer.format, remaining, volume);
-                    if (mix_input != mix_channel[i].chunk->abuf)
-                        SDL_free(mix_input);
-
-                    if (mix_channel[i].looping > 0) {
-                        --mix_channel[i].looping;
-                    }
-                    mix_channel[i].samples = mix_channel[i].chunk->abuf + remaining;
-                    mix_channel[i].playing = mix_channel[i].chunk->alen - remaining;
-                    index += remaining;
-                }
-                if (! mix_channel[i].playing && mix_channel[i].looping) {
-                    if (mix_channel[i].looping > 0) {
-                        --mix_channel[i].looping;
-                    }
-                    mix_channel[i].samples = mix_channel[i].chunk->abuf;
-                    mix_channel[i].playing = mix_channel[i].chunk->alen;
-                }
-            }
+            mix_one_channel(i, stream, len, use_bus);
         }
     }
 
+    if (use_bus) {
+        mix_bus_store(stream, len);
+    }
+
     /* rcg06122001 run posteffects... */
     Mix_DoEffects(MIX_CHANNEL_POST, stream, len);
 
@@ -410,6 +1491,20 @@ int Mix_OpenAudioDevice(int frequency, Uint16 format, int nchannels, int chunksi
     num_channels = MIX_CHANNELS;
     mix_channel = (struct _Mix_Channel *) SDL_malloc(num_channels * sizeof(struct _Mix_Channel));
 
+    /* Allocate the mixing scratch space now, not in the audio callback.
+       Without it we just mix the old way. */
+    if (mix_bus_supported(mixer.format)) {
+        const int samples = mixer.size / (SDL_AUDIO_BITSIZE(mixer.format) / 8);
+        mix_bus = SDL_malloc(samples * 4);
+        if (mix_bus) {
+            mix_bus_len = mixer.size;
+        }
+    }
+    mix_effect_buf = (Uint8 *) SDL_malloc(mixer.size);
+    if (mix_effect_buf) {
+        mix_effect_len = mixer.size;
+    }
+
     /* Clear out the audio channels */
     for (i=0; i<num_channels; ++i) {
         mix_channel[i].chunk = NULL;
@@ -423,7 +1518,12 @@ int Mix_OpenAudioDevice(int frequency, Uint16 format, int nchannels, int chunksi
         mix_channel[i].expire = 0;
         mix_channel[i].effects = NULL;
         mix_channel[i].paused = 0;
+        mix_channel[i].priority = MIX_DEFAULT_PRIORITY;
+        mix_channel[i].distance_gain = 1.0f;
+        mix_channel[i].audibility = 0.0f;
+        mix_channel[i].is_virtual = 0;
     }
+    voice_heaps_alloc();
     Mix_VolumeMusic(SDL_MIX_MAXVOLUME);
 
     _Mix_InitEffects();
@@ -447,6 +1547,8 @@ int Mix_OpenAudioDevice(int frequency, Uint16 format, int nchannels, int chunksi
         add_chunk_decoder("FLAC");
     }
 
+    mix_decode_lock = SDL_CreateMutex();
+
     audio_opened = 1;
     SDL_PauseAudioDevice(audio_device, 0);
     return(0);
@@ -494,9 +1596,14 @@ int Mix_AllocateChannels(int numchans)
             mix_channel[i].expire = 0;
             mix_channel[i].effects = NULL;
             mix_channel[i].paused = 0;
+            mix_channel[i].priority = MIX_DEFAULT_PRIORITY;
+            mix_channel[i].distance_gain = 1.0f;
+            mix_channel[i].audibility = 0.0f;
+            mix_channel[i].is_virtual = 0;
         }
     }
     num_channels = numchans;
+    voice_heaps_alloc();
     Mix_UnlockAudio();
     return(num_channels);
 }
@@ -577,11 +1684,13 @@ static SDL_AudioSpec *Mix_LoadMusic_RW(Mix_MusicType music_type, SDL_RWops *src,
         return NULL;
     }
 
+    /* The audio lock is only held a fragment at a time, so the mixer isn't
+       held up for as long as it takes to decode the whole file. */
     Mix_LockAudio();
-
     if (interface->Play) {
         interface->Play(music, 1);
     }
+    Mix_UnlockAudio();
     playing = SDL_TRUE;
 
     while (playing) {
@@ -600,12 +1709,14 @@ static SDL_AudioSpec *Mix_LoadMusic_RW(Mix_MusicType music_type, SDL_RWops *src,
         }
         fragment->next = NULL;
 
+        Mix_LockAudio();
         left = interface->GetAudio(music, fragment->data, fragment_size);
         if (left > 0) {
             playing = SDL_FALSE;
         } else if (interface->IsPlaying) {
             playing = interface->IsPlaying(music);
         }
+        Mix_UnlockAudio();
         fragment->size = (fragment_size - left);
 
         if (!first) {
@@ -618,55 +1729,304 @@ static SDL_AudioSpec *Mix_LoadMusic_RW(Mix_MusicType music_type, SDL_RWops *src,
         ++count;
     }
 
+    Mix_LockAudio();
     if (interface->Stop) {
         interface->Stop(music);
     }
 
-    if (music) {
-        interface->Delete(music);
+    if (music) {
+        interface->Delete(music);
+    }
+    Mix_UnlockAudio();
+
+    if (count > 0) {
+        *audio_len = (count - 1) * fragment_size + fragment->size;
+        *audio_buf = (Uint8 *)SDL_malloc(*audio_len);
+        if (*audio_buf) {
+            Uint8 *dst = *audio_buf;
+            for (fragment = first; fragment; fragment = fragment->next) {
+                SDL_memcpy(dst, fragment->data, fragment->size);
+                dst += fragment->size;
+            }
+        } else {
+            SDL_OutOfMemory();
+            spec = NULL;
+        }
+    } else {
+        Mix_SetError("No audio data");
+        spec = NULL;
+    }
+
+    while (first) {
+        fragment = first;
+        first = first->next;
+        SDL_free(fragment->data);
+        SDL_free(fragment);
+    }
+
+    if (freesrc) {
+        SDL_RWclose(src);
+    }
+    return spec;
+}
+
+/* Decode an audio file into the mixer's format */
+static int mix_decode_wav(SDL_RWops *src, int freesrc, Uint8 **abuf, Uint32 *alen)
+{
+    Uint8 magic[4];
+    SDL_AudioSpec wavespec, *loaded;
+    SDL_AudioCVT wavecvt;
+    int samplesize;
+
+    /* Find out what kind of audio file this is */
+    if (SDL_RWread(src, magic, 1, 4) != 4) {
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        Mix_SetError("Couldn't read first 4 bytes of audio data");
+        return(-1);
+    }
+    /* Seek backwards for compatibility with older loaders */
+    SDL_RWseek(src, -4, RW_SEEK_CUR);
+
+    if (SDL_memcmp(magic, "WAVE", 4) == 0 || SDL_memcmp(magic, "RIFF", 4) == 0) {
+        loaded = SDL_LoadWAV_RW(src, freesrc, &wavespec, abuf, alen);
+    } else if (SDL_memcmp(magic, "FORM", 4) == 0) {
+        loaded = Mix_LoadAIFF_RW(src, freesrc, &wavespec, abuf, alen);
+    } else if (SDL_memcmp(magic, "CREA", 4) == 0) {
+        loaded = Mix_LoadVOC_RW(src, freesrc, &wavespec, abuf, alen);
+    } else {
+        /* The music interfaces don't all expect to be used from several
+           threads at once (Timidity's MIDI reader, for one, doesn't) */
+        Mix_MusicType music_type = detect_music_type_from_magic(magic);
+        if (mix_decode_lock) {
+            SDL_LockMutex(mix_decode_lock);
+        }
+        loaded = Mix_LoadMusic_RW(music_type, src, freesrc, &wavespec, abuf, alen);
+        if (mix_decode_lock) {
+            SDL_UnlockMutex(mix_decode_lock);
+        }
+    }
+    if (!loaded) {
+        /* The individual loaders have closed src if needed */
+        return(-1);
+    }
+
+#if 0
+    PrintFormat("Audio device", &mixer);
+    PrintFormat("-- Wave file", &wavespec);
+#endif
+
+    /* Build the audio converter and create conversion buffers */
+    if (wavespec.format != mixer.format ||
+         wavespec.channels != mixer.channels ||
+         wavespec.freq != mixer.freq) {
+        if (SDL_BuildAudioCVT(&wavecvt,
+                wavespec.format, wavespec.channels, wavespec.freq,
+                mixer.format, mixer.channels, mixer.freq) < 0) {
+            SDL_free(*abuf);
+            return(-1);
+        }
+        samplesize = ((wavespec.format & 0xFF)/8)*wavespec.channels;
+        wavecvt.len = *alen & ~(samplesize-1);
+        wavecvt.buf = (Uint8 *)SDL_calloc(1, wavecvt.len*wavecvt.len_mult);
+        if (wavecvt.buf == NULL) {
+            SDL_SetError("Out of memory");
+            SDL_free(*abuf);
+            return(-1);
+        }
+        SDL_memcpy(wavecvt.buf, *abuf, wavecvt.len);
+        SDL_free(*abuf);
+
+        /* Run the audio converter */
+        if (SDL_ConvertAudio(&wavecvt) < 0) {
+            SDL_free(wavecvt.buf);
+            return(-1);
+        }
+
+        *abuf = wavecvt.buf;
+        *alen = wavecvt.len_cvt;
+    }
+    return(0);
+}
+
+
+/* Chunks loaded from compressed formats while there's a budget for them
+   (see Mix_SetChunkCache()) keep the file in memory and are only decoded
+   when they're played. Their decoded audio stays around, in a list with
+   the most recently played first, until they take up more than the budget
+   and the least recently played ones that aren't playing are dropped.
+   Everything here is done with the audio lock held, except decoding.
+ */
+#define MIX_CHUNK_COMPRESSED 2  /* Mix_Chunk.allocated of a compressed_chunk */
+
+typedef struct _Mix_CompressedChunk {
+    Mix_Chunk chunk;        /* abuf is NULL while it's not decoded. */
+    Uint8 *data;            /* the file, as it was loaded. */
+    size_t size;
+    Uint32 decoded;         /* bytes of decoded audio counted in chunk_cache_used. */
+    struct _Mix_CompressedChunk *prev;
+    struct _Mix_CompressedChunk *next;
+} compressed_chunk;
+
+static int chunk_cache_size = 0;
+static Uint32 chunk_cache_used = 0;
+static compressed_chunk *chunk_cache_first = NULL;
+static compressed_chunk *chunk_cache_last = NULL;
+
+static void chunk_cache_unlink(compressed_chunk *c)
+{
+    if (c->prev) {
+        c->prev->next = c->next;
+    } else if (chunk_cache_first == c) {
+        chunk_cache_first = c->next;
+    } else {
+        return;     /* not in the list */
+    }
+    if (c->next) {
+        c->next->prev = c->prev;
+    } else {
+        chunk_cache_last = c->prev;
+    }
+    c->prev = c->next = NULL;
+}
+
+/* Note the chunk as the most recently played */
+static void chunk_cache_touch(compressed_chunk *c)
+{
+    chunk_cache_unlink(c);
+    c->next = chunk_cache_first;
+    if (chunk_cache_first) {
+        chunk_cache_first->prev = c;
+    } else {
+        chunk_cache_last = c;
+    }
+    chunk_cache_first = c;
+}
+
+static SDL_bool chunk_in_use(Mix_Chunk *chunk)
+{
+    int i;
+
+    for (i = 0; mix_channel && i < num_channels; ++i) {
+        if (mix_channel[i].chunk == chunk && (mix_channel[i].playing > 0 || mix_channel[i].looping)) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+/* Drop the decoded audio of the least recently played chunks until it all
+   fits in the budget, except for 'keep' and any that are playing */
+static void chunk_cache_trim(compressed_chunk *keep)
+{
+    compressed_chunk *c, *prev;
+
+    for (c = chunk_cache_last; c && chunk_cache_used > (Uint32)chunk_cache_size; c = prev) {
+        prev = c->prev;
+        if (c == keep || chunk_in_use(&c->chunk)) {
+            continue;
+        }
+        chunk_cache_unlink(c);
+        chunk_cache_used -= c->decoded;
+        c->decoded = 0;
+        SDL_free(c->chunk.abuf);
+        c->chunk.abuf = NULL;
+        c->chunk.alen = 0;
+    }
+}
+
+/* Make sure a chunk's audio is decoded, before it's played. On success
+   this returns with the audio lock held, so the audio can't be dropped
+   again by another thread before the chunk is on a channel. */
+static int mix_chunk_decode(Mix_Chunk *chunk)
+{
+    compressed_chunk *c = (compressed_chunk *)chunk;
+    SDL_RWops *src;
+    Uint8 *abuf;
+    Uint32 alen;
+
+    Mix_LockAudio();
+    if (chunk->allocated != MIX_CHUNK_COMPRESSED) {
+        return(0);
+    }
+    if (chunk->abuf) {
+        chunk_cache_touch(c);
+        return(0);
+    }
+    Mix_UnlockAudio();
+
+    src = SDL_RWFromConstMem(c->data, (int)c->size);
+    if (!src || mix_decode_wav(src, 1, &abuf, &alen) < 0) {
+        return(-1);
+    }
+
+    Mix_LockAudio();
+    if (chunk->abuf) {
+        /* Another thread got there first */
+        SDL_free(abuf);
+    } else {
+        chunk->abuf = abuf;
+        chunk->alen = alen;
+        c->decoded = alen;
+        chunk_cache_used += alen;
     }
+    chunk_cache_touch(c);
+    chunk_cache_trim(c);
+    return(0);
+}
 
-    Mix_UnlockAudio();
+/* Keep the rest of 'src' as a chunk to be decoded when it's played */
+static Mix_Chunk *mix_load_compressed(SDL_RWops *src, int freesrc, size_t size)
+{
+    compressed_chunk *c;
 
-    if (count > 0) {
-        *audio_len = (count - 1) * fragment_size + fragment->size;
-        *audio_buf = (Uint8 *)SDL_malloc(*audio_len);
-        if (*audio_buf) {
-            Uint8 *dst = *audio_buf;
-            for (fragment = first; fragment; fragment = fragment->next) {
-                SDL_memcpy(dst, fragment->data, fragment->size);
-                dst += fragment->size;
-            }
-        } else {
-            SDL_OutOfMemory();
-            spec = NULL;
-        }
+    c = (compressed_chunk *)SDL_calloc(1, sizeof(*c));
+    if (c) {
+        c->data = (Uint8 *)SDL_malloc(size);
+    }
+    if (!c || !c->data) {
+        SDL_SetError("Out of memory");
+    } else if (SDL_RWread(src, c->data, 1, size) != size) {
+        Mix_SetError("Couldn't read audio data");
     } else {
-        Mix_SetError("No audio data");
-        spec = NULL;
+        if (freesrc) {
+            SDL_RWclose(src);
+        }
+        c->size = size;
+        c->chunk.allocated = MIX_CHUNK_COMPRESSED;
+        c->chunk.volume = MIX_MAX_VOLUME;
+        return(&c->chunk);
     }
 
-    while (first) {
-        fragment = first;
-        first = first->next;
-        SDL_free(fragment->data);
-        SDL_free(fragment);
+    if (c) {
+        SDL_free(c->data);
+        SDL_free(c);
     }
-
     if (freesrc) {
         SDL_RWclose(src);
     }
-    return spec;
+    return(NULL);
+}
+
+int Mix_SetChunkCache(int bytes)
+{
+    int prev_bytes;
+
+    Mix_LockAudio();
+    prev_bytes = chunk_cache_size;
+    if (bytes >= 0) {
+        chunk_cache_size = bytes;
+        chunk_cache_trim(NULL);
+    }
+    Mix_UnlockAudio();
+    return(prev_bytes);
 }
 
 /* Load a wave file */
 Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
 {
-    Uint8 magic[4];
     Mix_Chunk *chunk;
-    SDL_AudioSpec wavespec, *loaded;
-    SDL_AudioCVT wavecvt;
-    int samplesize;
 
     /* rcg06012001 Make sure src is valid */
     if (!src) {
@@ -683,6 +2043,24 @@ Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
         return(NULL);
     }
 
+    /* Keep compressed files compressed, if there's a budget for them */
+    if (chunk_cache_size > 0) {
+        const Sint64 start = SDL_RWtell(src);
+        const Sint64 size = SDL_RWsize(src) - start;
+        Uint8 magic[4];
+
+        if (start >= 0 && size > 4 && size <= SDL_MAX_SINT32 &&
+            SDL_RWread(src, magic, 1, 4) == 4) {
+            SDL_RWseek(src, start, RW_SEEK_SET);
+            if (SDL_memcmp(magic, "WAVE", 4) != 0 && SDL_memcmp(magic, "RIFF", 4) != 0 &&
+                SDL_memcmp(magic, "FORM", 4) != 0 && SDL_memcmp(magic, "CREA", 4) != 0 &&
+                has_music(detect_music_type_from_magic(magic))) {
+                return mix_load_compressed(src, freesrc, (size_t)size);
+            }
+        }
+        SDL_RWseek(src, start, RW_SEEK_SET);
+    }
+
     /* Allocate the chunk memory */
     chunk = (Mix_Chunk *)SDL_malloc(sizeof(Mix_Chunk));
     if (chunk == NULL) {
@@ -693,76 +2071,208 @@ Mix_Chunk *Mix_LoadWAV_RW(SDL_RWops *src, int freesrc)
         return(NULL);
     }
 
-    /* Find out what kind of audio file this is */
-    if (SDL_RWread(src, magic, 1, 4) != 4) {
-        if (freesrc) {
-            SDL_RWclose(src);
+    if (mix_decode_wav(src, freesrc, (Uint8 **)&chunk->abuf, &chunk->alen) < 0) {
+        SDL_free(chunk);
+        return(NULL);
+    }
+
+    chunk->allocated = 1;
+    chunk->volume = MIX_MAX_VOLUME;
+
+    return(chunk);
+}
+
+/* Chunks being loaded on threads of their own, see Mix_LoadWAVBatch().
+   Each thread takes the next chunk on the list until there are none left. */
+#define MIX_BATCH_THREADS 8
+
+struct _Mix_ChunkBatch {
+    char **files;           /* if loading from files, */
+    SDL_RWops **srcs;       /* or else from these. */
+    int freesrc;
+    int count;
+    Mix_Chunk **chunks;
+    void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk);
+    void *udata;
+    SDL_atomic_t next;      /* the next chunk to load. */
+    SDL_atomic_t finished;
+    SDL_atomic_t succeeded;
+    SDL_Thread *threads[MIX_BATCH_THREADS];
+    int num_threads;
+};
+
+static int SDLCALL mix_batch_run(void *data)
+{
+    Mix_ChunkBatch *batch = (Mix_ChunkBatch *)data;
+    int i;
+
+    while ((i = SDL_AtomicAdd(&batch->next, 1)) < batch->count) {
+        Mix_Chunk *chunk;
+
+        if (batch->files) {
+            chunk = Mix_LoadWAV_RW(SDL_RWFromFile(batch->files[i], "rb"), 1);
+        } else {
+            chunk = Mix_LoadWAV_RW(batch->srcs[i], batch->freesrc);
         }
-        Mix_SetError("Couldn't read first 4 bytes of audio data");
-        return NULL;
+        batch->chunks[i] = chunk;
+        if (chunk) {
+            SDL_AtomicIncRef(&batch->succeeded);
+        }
+        if (batch->loaded) {
+            batch->loaded(batch->udata, i, chunk);
+        }
+        SDL_AtomicIncRef(&batch->finished);
     }
-    /* Seek backwards for compatibility with older loaders */
-    SDL_RWseek(src, -4, RW_SEEK_CUR);
+    return(0);
+}
 
-    if (SDL_memcmp(magic, "WAVE", 4) == 0 || SDL_memcmp(magic, "RIFF", 4) == 0) {
-        loaded = SDL_LoadWAV_RW(src, freesrc, &wavespec, (Uint8 **)&chunk->abuf, &chunk->alen);
-    } else if (SDL_memcmp(magic, "FORM", 4) == 0) {
-        loaded = Mix_LoadAIFF_RW(src, freesrc, &wavespec, (Uint8 **)&chunk->abuf, &chunk->alen);
-    } else if (SDL_memcmp(magic, "CREA", 4) == 0) {
-        loaded = Mix_LoadVOC_RW(src, freesrc, &wavespec, (Uint8 **)&chunk->abuf, &chunk->alen);
-    } else {
-        Mix_MusicType music_type = detect_music_type_from_magic(magic);
-        loaded = Mix_LoadMusic_RW(music_type, src, freesrc, &wavespec, (Uint8 **)&chunk->abuf, &chunk->alen);
+static void mix_batch_free(Mix_ChunkBatch *batch)
+{
+    int i;
+
+    if (batch->files) {
+        for (i = 0; i < batch->count; ++i) {
+            SDL_free(batch->files[i]);
+        }
+        SDL_free(batch->files);
     }
-    if (!loaded) {
-        /* The individual loaders have closed src if needed */
-        SDL_free(chunk);
+    SDL_free(batch->srcs);
+    SDL_free(batch);
+}
+
+static Mix_ChunkBatch *mix_batch_start(Mix_ChunkBatch *batch)
+{
+    int i, threads = SDL_GetCPUCount();
+
+    if (threads > MIX_BATCH_THREADS) {
+        threads = MIX_BATCH_THREADS;
+    }
+    if (threads > batch->count) {
+        threads = batch->count;
+    }
+    for (i = 0; i < threads; ++i) {
+        batch->threads[i] = SDL_CreateThread(mix_batch_run, "SDL_mixer loader", batch);
+        if (!batch->threads[i]) {
+            break;
+        }
+        ++batch->num_threads;
+    }
+    if (batch->num_threads == 0) {
+        /* No threads, load them all now */
+        mix_batch_run(batch);
+    }
+    return(batch);
+}
+
+static Mix_ChunkBatch *mix_batch_alloc(int count, Mix_Chunk **chunks,
+                                       void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk),
+                                       void *udata)
+{
+    Mix_ChunkBatch *batch;
+    int i;
+
+    if (!audio_opened) {
+        SDL_SetError("Audio device hasn't been opened");
+        return(NULL);
+    }
+    if (count < 0 || !chunks) {
+        SDL_InvalidParamError(chunks ? "count" : "chunks");
         return(NULL);
     }
 
-#if 0
-    PrintFormat("Audio device", &mixer);
-    PrintFormat("-- Wave file", &wavespec);
-#endif
+    batch = (Mix_ChunkBatch *)SDL_calloc(1, sizeof(*batch));
+    if (!batch) {
+        SDL_OutOfMemory();
+        return(NULL);
+    }
+    batch->count = count;
+    batch->chunks = chunks;
+    batch->loaded = loaded;
+    batch->udata = udata;
+    for (i = 0; i < count; ++i) {
+        chunks[i] = NULL;
+    }
+    return(batch);
+}
 
-    /* Build the audio converter and create conversion buffers */
-    if (wavespec.format != mixer.format ||
-         wavespec.channels != mixer.channels ||
-         wavespec.freq != mixer.freq) {
-        if (SDL_BuildAudioCVT(&wavecvt,
-                wavespec.format, wavespec.channels, wavespec.freq,
-                mixer.format, mixer.channels, mixer.freq) < 0) {
-            SDL_free(chunk->abuf);
-            SDL_free(chunk);
-            return(NULL);
-        }
-        samplesize = ((wavespec.format & 0xFF)/8)*wavespec.channels;
-        wavecvt.len = chunk->alen & ~(samplesize-1);
-        wavecvt.buf = (Uint8 *)SDL_calloc(1, wavecvt.len*wavecvt.len_mult);
-        if (wavecvt.buf == NULL) {
-            SDL_SetError("Out of memory");
-            SDL_free(chunk->abuf);
-            SDL_free(chunk);
-            return(NULL);
-        }
-        SDL_memcpy(wavecvt.buf, chunk->abuf, wavecvt.len);
-        SDL_free(chunk->abuf);
+Mix_ChunkBatch *Mix_LoadWAVBatch(const char * const *files, int count, Mix_Chunk **chunks,
+                                 void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk),
+                                 void *udata)
+{
+    Mix_ChunkBatch *batch;
+    int i;
 
-        /* Run the audio converter */
-        if (SDL_ConvertAudio(&wavecvt) < 0) {
-            SDL_free(wavecvt.buf);
-            SDL_free(chunk);
-            return(NULL);
+    if (!files) {
+        SDL_InvalidParamError("files");
+        return(NULL);
+    }
+    batch = mix_batch_alloc(count, chunks, loaded, udata);
+    if (!batch) {
+        return(NULL);
+    }
+
+    /* The names are copied, so the caller doesn't need to keep them */
+    batch->files = (char **)SDL_calloc(count + 1, sizeof(char *));
+    for (i = 0; batch->files && i < count; ++i) {
+        if (!(batch->files[i] = SDL_strdup(files[i] ? files[i] : ""))) {
+            break;
         }
+    }
+    if (!batch->files || i < count) {
+        mix_batch_free(batch);
+        SDL_OutOfMemory();
+        return(NULL);
+    }
+    return mix_batch_start(batch);
+}
+
+Mix_ChunkBatch *Mix_LoadWAVBatch_RW(SDL_RWops * const *srcs, int count, int freesrc, Mix_Chunk **chunks,
+                                    void (SDLCALL *loaded)(void *udata, int index, Mix_Chunk *chunk),
+                                    void *udata)
+{
+    Mix_ChunkBatch *batch;
 
-        chunk->abuf = wavecvt.buf;
-        chunk->alen = wavecvt.len_cvt;
+    if (!srcs) {
+        SDL_InvalidParamError("srcs");
+        return(NULL);
+    }
+    batch = mix_batch_alloc(count, chunks, loaded, udata);
+    if (!batch) {
+        return(NULL);
     }
 
-    chunk->allocated = 1;
-    chunk->volume = MIX_MAX_VOLUME;
+    batch->srcs = (SDL_RWops **)SDL_malloc((count + 1) * sizeof(SDL_RWops *));
+    if (!batch->srcs) {
+        mix_batch_free(batch);
+        SDL_OutOfMemory();
+        return(NULL);
+    }
+    SDL_memcpy(batch->srcs, srcs, count * sizeof(SDL_RWops *));
+    batch->freesrc = freesrc;
+    return mix_batch_start(batch);
+}
 
-    return(chunk);
+int Mix_ChunkBatchProgress(Mix_ChunkBatch *batch)
+{
+    if (!batch) {
+        return(0);
+    }
+    return SDL_AtomicGet(&batch->finished);
+}
+
+int Mix_WaitChunkBatch(Mix_ChunkBatch *batch)
+{
+    int i, succeeded;
+
+    if (!batch) {
+        return(0);
+    }
+    for (i = 0; i < batch->num_threads; ++i) {
+        SDL_WaitThread(batch->threads[i], NULL);
+    }
+    succeeded = SDL_AtomicGet(&batch->succeeded);
+    mix_batch_free(batch);
+    return(succeeded);
 }
 
 /* Load a wave file of the mixer format from a memory buffer */
@@ -841,9 +2351,16 @@ void Mix_FreeChunk(Mix_Chunk *chunk)
                 if (chunk == mix_channel[i].chunk) {
                     mix_channel[i].playing = 0;
                     mix_channel[i].looping = 0;
+                    voice_freed(i);
                 }
             }
         }
+        if (chunk->allocated == MIX_CHUNK_COMPRESSED) {
+            compressed_chunk *c = (compressed_chunk *)chunk;
+            chunk_cache_unlink(c);
+            chunk_cache_used -= c->decoded;
+            SDL_free(c->data);
+        }
         Mix_UnlockAudio();
         /* Actually free the chunk */
         if (chunk->allocated) {
@@ -904,7 +2421,12 @@ int Mix_ReserveChannels(int num)
 {
     if (num > num_channels)
         num = num_channels;
+    Mix_LockAudio();
     reserved_channels = num;
+    if (mix_channel) {
+        voice_heaps_reset();
+    }
+    Mix_UnlockAudio();
     return num;
 }
 
@@ -918,40 +2440,47 @@ static int checkchunkintegral(Mix_Chunk *chunk)
     return chunk->alen;
 }
 
+/* How many output frames the given number of milliseconds lasts, at least one */
+static Uint32 ms_to_frames(int ms)
+{
+    const Uint32 frames = (Uint32)(((Uint64)ms * mixer.freq) / 1000);
+    return (frames > 0) ? frames : 1;
+}
+
 /* Play an audio chunk on a specific channel.
-   If the specified channel is -1, play on the first free channel.
+   If the specified channel is -1, play on the first free channel, or if
+   'steal' is set and there isn't one, on the one playing the least
+   important sound if it's less important than this one.
    'ticks' is the number of milliseconds at most to play the sample, or -1
    if there is no limit.
    Returns which channel was used to play the sound.
 */
-int Mix_PlayChannelTimed(int which, Mix_Chunk *chunk, int loops, int ticks)
+static int mix_play_channel(int which, Mix_Chunk *chunk, int loops, int ticks, int priority, SDL_bool steal)
 {
-    int i;
-
     /* Don't play null pointers :-) */
     if (chunk == NULL) {
         Mix_SetError("Tried to play a NULL chunk");
         return(-1);
     }
+    /* This locks the mixer while modifying the playing channels */
+    if (mix_chunk_decode(chunk) < 0) {
+        return(-1);
+    }
     if (!checkchunkintegral(chunk)) {
+        Mix_UnlockAudio();
         Mix_SetError("Tried to play a chunk with a bad frame");
         return(-1);
     }
 
-    /* Lock the mixer while modifying the playing channels */
-    Mix_LockAudio();
     {
         /* If which is -1, play on the first free channel */
         if (which == -1) {
-            for (i=reserved_channels; i<num_channels; ++i) {
-                if (mix_channel[i].playing <= 0)
-                    break;
+            which = voice_find_free();
+            if (which == -1 && steal) {
+                which = voice_find_steal(priority);
             }
-            if (i == num_channels) {
+            if (which == -1) {
                 Mix_SetError("No free channels available");
-                which = -1;
-            } else {
-                which = i;
             }
         }
 
@@ -967,7 +2496,12 @@ int Mix_PlayChannelTimed(int which, Mix_Chunk *chunk, int loops, int ticks)
             mix_channel[which].paused = 0;
             mix_channel[which].fading = MIX_NO_FADING;
             mix_channel[which].start_time = sdl_ticks;
-            mix_channel[which].expire = (ticks>0) ? (sdl_ticks + ticks) : 0;
+            mix_channel[which].expire = (ticks>0) ? ms_to_frames(ticks) : 0;
+            mix_channel[which].priority = priority;
+            mix_channel[which].is_virtual = 0;
+            if (mix_channel[which].playing <= 0) {
+                voice_freed(which);
+            }
         }
     }
     Mix_UnlockAudio();
@@ -976,6 +2510,47 @@ int Mix_PlayChannelTimed(int which, Mix_Chunk *chunk, int loops, int ticks)
     return(which);
 }
 
+int Mix_PlayChannelTimed(int which, Mix_Chunk *chunk, int loops, int ticks)
+{
+    return mix_play_channel(which, chunk, loops, ticks, MIX_DEFAULT_PRIORITY, SDL_FALSE);
+}
+
+int Mix_PlayChannelPriority(int which, Mix_Chunk *chunk, int loops, int ticks, int priority)
+{
+    return mix_play_channel(which, chunk, loops, ticks, priority, SDL_TRUE);
+}
+
+/* Change the priority of the sound on a channel */
+int Mix_SetChannelPriority(int which, int priority)
+{
+    int status = 0;
+
+    if (which == -1) {
+        int i;
+        for (i=0; i < num_channels; ++i) {
+            status += Mix_SetChannelPriority(i, priority);
+        }
+    } else if (which >= 0 && which < num_channels) {
+        Mix_LockAudio();
+        mix_channel[which].priority = priority;
+        voice_heap_build(&steal_voices);  /* it's likely moved. */
+        Mix_UnlockAudio();
+        ++status;
+    }
+    return(status);
+}
+
+/* Mix at most this many channels at a time */
+int Mix_LimitMixedChannels(int num)
+{
+    if (num >= 0) {
+        Mix_LockAudio();
+        mixed_voices_limit = num;
+        Mix_UnlockAudio();
+    }
+    return(mixed_voices_limit);
+}
+
 /* Change the expiration delay for a channel */
 int Mix_ExpireChannel(int which, int ticks)
 {
@@ -988,7 +2563,7 @@ int Mix_ExpireChannel(int which, int ticks)
         }
     } else if (which < num_channels) {
         Mix_LockAudio();
-        mix_channel[which].expire = (ticks>0) ? (SDL_GetTicks() + ticks) : 0;
+        mix_channel[which].expire = (ticks>0) ? ms_to_frames(ticks) : 0;
         Mix_UnlockAudio();
         ++ status;
     }
@@ -998,31 +2573,24 @@ int Mix_ExpireChannel(int which, int ticks)
 /* Fade in a sound on a channel, over ms milliseconds */
 int Mix_FadeInChannelTimed(int which, Mix_Chunk *chunk, int loops, int ms, int ticks)
 {
-    int i;
-
     /* Don't play null pointers :-) */
     if (chunk == NULL) {
         return(-1);
     }
+    /* This locks the mixer while modifying the playing channels */
+    if (mix_chunk_decode(chunk) < 0) {
+        return(-1);
+    }
     if (!checkchunkintegral(chunk)) {
+        Mix_UnlockAudio();
         Mix_SetError("Tried to play a chunk with a bad frame");
         return(-1);
     }
 
-    /* Lock the mixer while modifying the playing channels */
-    Mix_LockAudio();
     {
         /* If which is -1, play on the first free channel */
         if (which == -1) {
-            for (i=reserved_channels; i<num_channels; ++i) {
-                if (mix_channel[i].playing <= 0)
-                    break;
-            }
-            if (i == num_channels) {
-                which = -1;
-            } else {
-                which = i;
-            }
+            which = voice_find_free();
         }
 
         /* Queue up the audio data for this channel */
@@ -1039,9 +2607,15 @@ int Mix_FadeInChannelTimed(int which, Mix_Chunk *chunk, int loops, int ms, int t
             mix_channel[which].fade_volume = mix_channel[which].volume;
             mix_channel[which].fade_volume_reset = mix_channel[which].volume;
             mix_channel[which].volume = 0;
-            mix_channel[which].fade_length = (Uint32)ms;
-            mix_channel[which].start_time = mix_channel[which].ticks_fade = sdl_ticks;
-            mix_channel[which].expire = (ticks > 0) ? (sdl_ticks+ticks) : 0;
+            mix_channel[which].fade_length = (ms > 0) ? ms_to_frames(ms) : 0;
+            mix_channel[which].fade_position = 0;
+            mix_channel[which].start_time = sdl_ticks;
+            mix_channel[which].expire = (ticks > 0) ? ms_to_frames(ticks) : 0;
+            mix_channel[which].priority = MIX_DEFAULT_PRIORITY;
+            mix_channel[which].is_virtual = 0;
+            if (mix_channel[which].playing <= 0) {
+                voice_freed(which);
+            }
         }
     }
     Mix_UnlockAudio();
@@ -1143,15 +2717,14 @@ int Mix_FadeOutChannel(int which, int ms)
             if (mix_channel[which].playing &&
                 (mix_channel[which].volume > 0) &&
                 (mix_channel[which].fading != MIX_FADING_OUT)) {
-                mix_channel[which].fade_volume = mix_channel[which].volume;
-                mix_channel[which].fading = MIX_FADING_OUT;
-                mix_channel[which].fade_length = (Uint32)ms;
-                mix_channel[which].ticks_fade = SDL_GetTicks();
-
                 /* only change fade_volume_reset if we're not fading. */
                 if (mix_channel[which].fading == MIX_NO_FADING) {
                     mix_channel[which].fade_volume_reset = mix_channel[which].volume;
                 }
+                mix_channel[which].fade_volume = mix_channel[which].volume;
+                mix_channel[which].fading = MIX_FADING_OUT;
+                mix_channel[which].fade_length = (ms > 0) ? ms_to_frames(ms) : 0;
+                mix_channel[which].fade_position = 0;
                 ++status;
             }
             Mix_UnlockAudio();
@@ -1209,6 +2782,27 @@ int Mix_Playing(int which)
     return(status);
 }
 
+/* Check whether a channel (or how many) was left out of the last mix */
+int Mix_Virtual(int which)
+{
+    int status = 0;
+
+    if (which == -1) {
+        int i;
+
+        for (i=0; i<num_channels; ++i) {
+            if (mix_channel[i].playing > 0 && mix_channel[i].is_virtual) {
+                ++status;
+            }
+        }
+    } else if (which >= 0 && which < num_channels) {
+        if (mix_channel[which].playing > 0 && mix_channel[which].is_virtual) {
+            ++status;
+        }
+    }
+    return(status);
+}
+
 /* rcg06072001 Get the chunk associated with a channel. */
 Mix_Chunk *Mix_GetChunk(int channel)
 {
@@ -1240,6 +2834,17 @@ void Mix_CloseAudio(void)
             audio_device = 0;
             SDL_free(mix_channel);
             mix_channel = NULL;
+            voice_heaps_free();
+            SDL_free(mix_bus);
+            mix_bus = NULL;
+            mix_bus_len = 0;
+            SDL_free(mix_effect_buf);
+            mix_effect_buf = NULL;
+            mix_effect_len = 0;
+            if (mix_decode_lock) {
+                SDL_DestroyMutex(mix_decode_lock);
+                mix_decode_lock = NULL;
+            }
 
             /* rcg06042009 report available decoders at runtime. */
             SDL_free((void *)chunk_decoders);
@@ -1272,23 +2877,17 @@ void Mix_Pause(int which)
 /* Resume a paused channel */
 void Mix_Resume(int which)
 {
-    Uint32 sdl_ticks = SDL_GetTicks();
-
     Mix_LockAudio();
     if (which == -1) {
         int i;
 
         for (i=0; i<num_channels; ++i) {
             if (mix_channel[i].playing > 0) {
-                if(mix_channel[i].expire > 0)
-                    mix_channel[i].expire += sdl_ticks - mix_channel[i].paused;
                 mix_channel[i].paused = 0;
             }
         }
     } else if (which < num_channels) {
         if (mix_channel[which].playing > 0) {
-            if(mix_channel[which].expire > 0)
-                mix_channel[which].expire += sdl_ticks - mix_channel[which].paused;
             mix_channel[which].paused = 0;
         }
     }
@@ -1400,7 +2999,7 @@ int Mix_GroupNewer(int tag)
 
 /* MAKE SURE you hold the audio lock (Mix_LockAudio()) before calling this! */
 static int _Mix_register_effect(effect_info **e, Mix_EffectFunc_t f,
-                Mix_EffectDone_t d, void *arg)
+                Mix_EffectDone_t d, void *arg, Mix_GainMatrix *matrix)
 {
     effect_info *new_e;
 
@@ -1423,6 +3022,7 @@ static int _Mix_register_effect(effect_info **e, Mix_EffectFunc_t f,
     new_e->callback = f;
     new_e->done_callback = d;
     new_e->udata = arg;
+    new_e->matrix = matrix;
     new_e->next = NULL;
 
     /* add new effect to end of linked list... */
@@ -1503,8 +3103,8 @@ static int _Mix_remove_all_effects(int channel, effect_info **e)
 
 
 /* MAKE SURE you hold the audio lock (Mix_LockAudio()) before calling this! */
-int _Mix_RegisterEffect_locked(int channel, Mix_EffectFunc_t f,
-            Mix_EffectDone_t d, void *arg)
+int _Mix_RegisterMatrixEffect_locked(int channel, Mix_EffectFunc_t f,
+            Mix_EffectDone_t d, void *arg, Mix_GainMatrix *matrix)
 {
     effect_info **e = NULL;
 
@@ -1518,7 +3118,14 @@ int _Mix_RegisterEffect_locked(int channel, Mix_EffectFunc_t f,
         e = &mix_channel[channel].effects;
     }
 
-    return _Mix_register_effect(e, f, d, arg);
+    return _Mix_register_effect(e, f, d, arg, matrix);
+}
+
+/* MAKE SURE you hold the audio lock (Mix_LockAudio()) before calling this! */
+int _Mix_RegisterEffect_locked(int channel, Mix_EffectFunc_t f,
+            Mix_EffectDone_t d, void *arg)
+{
+    return _Mix_RegisterMatrixEffect_locked(channel, f, d, arg, NULL);
 }
 
 int Mix_RegisterEffect(int channel, Mix_EffectFunc_t f,
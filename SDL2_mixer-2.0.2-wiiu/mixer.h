@@ -23,4 +23,8 @@
 extern void Mix_LockAudio(void);
 extern void Mix_UnlockAudio(void);
 
+/* Scale audio in place, with the gain going from gain0 to gain1 (1.0 is
+   unchanged) over the length of it. Used for sample-accurate fades. */
+extern void Mix_RampVolume(Uint8 *data, SDL_AudioFormat format, int channels, int len, float gain0, float gain1);
+
 /* vi: set ts=4 sw=4 expandtab: */
@@ -20,8 +20,11 @@
 */
 #include <string.h> /* for strtok() and strtok_s() */
 
+#include "SDL_atomic.h"
 #include "SDL_hints.h"
 #include "SDL_log.h"
+#include "SDL_mutex.h"
+#include "SDL_thread.h"
 #include "SDL_timer.h"
 
 #include "SDL_mixer.h"
@@ -55,12 +58,21 @@ struct _Mix_Music {
 
     SDL_bool playing;
     Mix_Fading fading;
-    int fade_step;
-    int fade_steps;
+    int fade_step;      /* output frames since the fade started. */
+    int fade_steps;     /* length of the fade in output frames. */
+    Sint64 position;    /* output frames mixed, from where it was started or set. */
 };
 
-/* Used to calculate fading steps */
-static int ms_per_step;
+/* Output frames per second, to time fades with. 0 while the audio is closed. */
+static int music_freq;
+
+/* The music Mix_CrossFadeMusic() is fading in while music_playing fades
+   out, and the start of it, decoded before the crossfade began. It becomes
+   music_playing when its fade is over. */
+static Mix_Music * volatile music_incoming = NULL;
+static Uint8 *music_prime = NULL;
+static int music_prime_size = 0;
+static int music_prime_pos = 0;
 
 /* rcg06042009 report available decoders at runtime. */
 static const char **music_decoders = NULL;
@@ -150,6 +162,235 @@ static int  music_internal_play(Mix_Music *music, int play_count, double positio
 static int  music_internal_position(double position);
 static SDL_bool music_internal_playing(void);
 static void music_internal_halt(void);
+static void music_internal_fade_out(Mix_Music *music, int fade_steps);
+
+
+/* Music decoded ahead on a thread of its own, see Mix_SetMusicDecodeAhead().
+   The thread is the only one that writes to the ring and the audio callback
+   the only one that reads from it, so all they share is the two counters
+   (in frames, running on past the ring's size, which is a power of two).
+   Everything else that touches the decoder takes music_ahead_lock on top
+   of the audio lock. When the ring runs dry the callback only tries to
+   take it, but halting the music and handing over at the end of a
+   crossfade wait for it, which is at most one slice of decoding.
+ */
+#define MUSIC_AHEAD_SLICE 1024  /* frames decoded at a time, so the lock is never held long */
+
+static int music_ahead_ms = 0;
+static int music_ahead_ring_ms = 0;     /* what the running thread was set up for */
+static SDL_Thread *music_ahead_thread = NULL;
+static SDL_mutex *music_ahead_lock = NULL;
+static SDL_sem *music_ahead_wake = NULL;
+static Uint8 *music_ahead_ring = NULL;
+static Uint32 music_ahead_frames = 0;
+static SDL_atomic_t music_ahead_written;
+static SDL_atomic_t music_ahead_read;
+static SDL_atomic_t music_ahead_done;   /* the decoder has no more to give */
+static SDL_atomic_t music_ahead_quit;
+
+/* Whether the music is decoded ahead, instead of in music_mixer() */
+static SDL_bool music_ahead(Mix_Music *music)
+{
+    return (music_ahead_thread && music->interface->GetAudio) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void music_ahead_lock_decoder(void)
+{
+    if (music_ahead_lock) {
+        SDL_LockMutex(music_ahead_lock);
+    }
+}
+
+static void music_ahead_unlock_decoder(void)
+{
+    if (music_ahead_lock) {
+        SDL_UnlockMutex(music_ahead_lock);
+    }
+}
+
+/* Throw away what was decoded ahead, after the decoder's been moved.
+   The caller holds both locks, so neither side is using the ring. */
+static void music_ahead_flush(void)
+{
+    if (music_ahead_thread) {
+        SDL_AtomicSet(&music_ahead_written, 0);
+        SDL_AtomicSet(&music_ahead_read, 0);
+        SDL_AtomicSet(&music_ahead_done, SDL_FALSE);
+        SDL_SemPost(music_ahead_wake);
+    }
+}
+
+static int SDLCALL music_ahead_run(void *unused)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+
+    while (!SDL_AtomicGet(&music_ahead_quit)) {
+        SDL_bool decoded = SDL_FALSE;
+
+        SDL_LockMutex(music_ahead_lock);
+        if (music_playing && music_playing->interface->GetAudio && !SDL_AtomicGet(&music_ahead_done)) {
+            const Uint32 written = (Uint32)SDL_AtomicGet(&music_ahead_written);
+            const Uint32 read = (Uint32)SDL_AtomicGet(&music_ahead_read);
+            const Uint32 offset = written & (music_ahead_frames - 1);
+            Uint32 frames = music_ahead_frames - (written - read);
+
+            /* The callback is done with the frames before 'read' */
+            SDL_MemoryBarrierAcquire();
+
+            if (frames > music_ahead_frames - offset) {
+                frames = music_ahead_frames - offset;
+            }
+            if (frames > MUSIC_AHEAD_SLICE) {
+                frames = MUSIC_AHEAD_SLICE;
+            }
+            if (frames > 0) {
+                Uint8 *data = music_ahead_ring + (offset * frame_size);
+                const int bytes = (int)frames * frame_size;
+                int left;
+
+                SDL_memset(data, music_spec.silence, bytes);
+                left = music_playing->interface->GetAudio(music_playing->context, data, bytes);
+                SDL_MemoryBarrierRelease();
+                if (left >= 0) {
+                    SDL_AtomicSet(&music_ahead_written, (int)(written + (Uint32)((bytes - left) / frame_size)));
+                }
+                if (left != 0) {
+                    /* Either an error or finished playing with room left */
+                    SDL_MemoryBarrierRelease();
+                    SDL_AtomicSet(&music_ahead_done, SDL_TRUE);
+                }
+                decoded = SDL_TRUE;
+            }
+        }
+        SDL_UnlockMutex(music_ahead_lock);
+
+        if (!decoded) {
+            SDL_SemWait(music_ahead_wake);
+        }
+    }
+    return 0;
+}
+
+static void music_ahead_stop(void)
+{
+    if (music_ahead_thread) {
+        SDL_AtomicSet(&music_ahead_quit, SDL_TRUE);
+        SDL_SemPost(music_ahead_wake);
+        SDL_WaitThread(music_ahead_thread, NULL);
+        music_ahead_thread = NULL;
+    }
+    if (music_ahead_lock) {
+        SDL_DestroyMutex(music_ahead_lock);
+        music_ahead_lock = NULL;
+    }
+    if (music_ahead_wake) {
+        SDL_DestroySemaphore(music_ahead_wake);
+        music_ahead_wake = NULL;
+    }
+    SDL_free(music_ahead_ring);
+    music_ahead_ring = NULL;
+    music_ahead_frames = 0;
+    music_ahead_ring_ms = 0;
+}
+
+/* Start (or stop) the thread if the setting has changed since music last
+   started playing. If it can't be started music is decoded in the
+   callback, like it is without it. */
+static void music_ahead_start(void)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+    Uint32 frames = (Uint32)(((Sint64)music_ahead_ms * music_freq) / 1000);
+
+    if (music_ahead_ms == music_ahead_ring_ms) {
+        return;
+    }
+    music_ahead_stop();
+    if (music_ahead_ms <= 0) {
+        return;
+    }
+    music_ahead_ring_ms = music_ahead_ms;
+
+    music_ahead_frames = MUSIC_AHEAD_SLICE;
+    while (music_ahead_frames < frames) {
+        music_ahead_frames *= 2;
+    }
+    music_ahead_ring = (Uint8 *)SDL_malloc(music_ahead_frames * frame_size);
+    music_ahead_lock = SDL_CreateMutex();
+    music_ahead_wake = SDL_CreateSemaphore(0);
+    if (!music_ahead_ring || !music_ahead_lock || !music_ahead_wake) {
+        music_ahead_stop();
+        music_ahead_ring_ms = music_ahead_ms;
+        return;
+    }
+    SDL_AtomicSet(&music_ahead_written, 0);
+    SDL_AtomicSet(&music_ahead_read, 0);
+    SDL_AtomicSet(&music_ahead_done, SDL_FALSE);
+    SDL_AtomicSet(&music_ahead_quit, SDL_FALSE);
+    music_ahead_thread = SDL_CreateThread(music_ahead_run, "SDL_mixer music", NULL);
+    if (!music_ahead_thread) {
+        music_ahead_stop();
+        music_ahead_ring_ms = music_ahead_ms;
+    }
+}
+
+/* Copy music out of the ring, returning the number of bytes left, like
+   GetAudio(). If it has run dry before the decoder's finished this decodes
+   the rest here, unless the thread is busy decoding, in which case it sets
+   'underrun' and the rest of the callback stays silent. */
+static int music_ahead_get(Uint8 *stream, int bytes, SDL_bool *underrun)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+    const SDL_bool done = (SDL_bool)SDL_AtomicGet(&music_ahead_done);
+    const Uint32 read = (Uint32)SDL_AtomicGet(&music_ahead_read);
+    const Uint32 written = (Uint32)SDL_AtomicGet(&music_ahead_written);
+    Uint32 available, frames, offset, first;
+    int left = bytes;
+
+    /* The thread's writes to the ring up to 'written' have to be seen first */
+    SDL_MemoryBarrierAcquire();
+    available = written - read;
+    if (available == 0) {
+        if (done) {
+            return bytes;
+        }
+        *underrun = SDL_TRUE;
+        if (SDL_TryLockMutex(music_ahead_lock) == 0) {
+            if ((Uint32)SDL_AtomicGet(&music_ahead_written) == read && !SDL_AtomicGet(&music_ahead_done)) {
+                left = music_playing->interface->GetAudio(music_playing->context, stream, bytes);
+                if (left != 0) {
+                    SDL_AtomicSet(&music_ahead_done, SDL_TRUE);
+                }
+                *underrun = SDL_FALSE;
+            }
+            SDL_UnlockMutex(music_ahead_lock);
+        }
+        return left;
+    }
+
+    frames = (Uint32)(bytes / frame_size);
+    if (frames > available) {
+        frames = available;
+    }
+    offset = read & (music_ahead_frames - 1);
+    first = music_ahead_frames - offset;
+    if (first > frames) {
+        first = frames;
+    }
+    SDL_memcpy(stream, music_ahead_ring + (offset * frame_size), first * frame_size);
+    SDL_memcpy(stream + (first * frame_size), music_ahead_ring, (frames - first) * frame_size);
+    SDL_MemoryBarrierRelease();
+    SDL_AtomicSet(&music_ahead_read, (int)(read + frames));
+    if (SDL_SemValue(music_ahead_wake) == 0) {
+        SDL_SemPost(music_ahead_wake);
+    }
+
+    left = bytes - (int)(frames * frame_size);
+    if (left > 0 && !done) {
+        const int copied = bytes - left;
+        return music_ahead_get(stream + copied, left, underrun);
+    }
+    return left;
+}
 
 
 /* Support for hooking when the music has finished */
@@ -198,44 +439,87 @@ int music_pcm_getaudio(void *context, void *data, int bytes, int volume,
     return len;
 }
 
-/* Mixing function */
-void SDLCALL music_mixer(void *udata, Uint8 *stream, int len)
+/* The fade's gain (1.0 is the music volume) this many frames into it */
+static float music_fade_gain(Mix_Music *music, int fade_step)
 {
+    if (fade_step >= music->fade_steps) {
+        return (music->fading == MIX_FADING_OUT) ? 0.0f : 1.0f;
+    } else if (music->fading == MIX_FADING_OUT) {
+        return (float)(music->fade_steps - fade_step) / music->fade_steps;
+    } else {
+        return (float)fade_step / music->fade_steps;
+    }
+}
+
+/* Mix music_playing into the stream. While a crossfade is going, the
+   music fading out finishing isn't the end of the music. */
+static void music_mix_playing(Uint8 *stream, int len)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+
     while (music_playing && music_active && len > 0) {
-        /* Handle fading */
-        if (music_playing->fading != MIX_NO_FADING) {
-            if (music_playing->fade_step++ < music_playing->fade_steps) {
-                int volume;
-                int fade_step = music_playing->fade_step;
-                int fade_steps = music_playing->fade_steps;
+        int mixlen = len;
+        int frames = len / frame_size;
+        float gain0 = 1.0f, gain1 = 1.0f;
 
-                if (music_playing->fading == MIX_FADING_OUT) {
-                    volume = (music_volume * (fade_steps-fade_step)) / fade_steps;
-                } else { /* Fading in */
-                    volume = (music_volume * fade_step) / fade_steps;
-                }
-                music_internal_volume(volume);
-            } else {
+        /* Handle fading. Music we decode ourselves gets a gain ramp over
+           exactly the frames the fade covers, the rest steps its volume
+           once per callback. */
+        if (music_playing->fading != MIX_NO_FADING) {
+            if (music_playing->fade_step >= music_playing->fade_steps) {
                 if (music_playing->fading == MIX_FADING_OUT) {
                     music_internal_halt();
-                    if (music_finished_hook) {
+                    if (music_finished_hook && !music_incoming) {
                         music_finished_hook();
                     }
                     return;
                 }
                 music_playing->fading = MIX_NO_FADING;
+                music_internal_volume(music_volume);
+            } else {
+                if (frames > music_playing->fade_steps - music_playing->fade_step) {
+                    frames = music_playing->fade_steps - music_playing->fade_step;
+                }
+                gain0 = music_fade_gain(music_playing, music_playing->fade_step);
+                gain1 = music_fade_gain(music_playing, music_playing->fade_step + frames);
+                music_playing->fade_step += frames;
+                if (music_playing->interface->GetAudio) {
+                    mixlen = frames * frame_size;
+                } else {
+                    music_internal_volume((int)(music_volume * gain0));
+                }
             }
         }
 
         if (music_playing->interface->GetAudio) {
-            int left = music_playing->interface->GetAudio(music_playing->context, stream, len);
-            if (left != 0) {
+            SDL_bool underrun = SDL_FALSE;
+            int left;
+            if (music_ahead(music_playing)) {
+                /* the volume wasn't applied when it was decoded */
+                const float volume = (float)music_volume / MIX_MAX_VOLUME;
+                gain0 *= volume;
+                gain1 *= volume;
+                left = music_ahead_get(stream, mixlen, &underrun);
+            } else {
+                left = music_playing->interface->GetAudio(music_playing->context, stream, mixlen);
+            }
+            if (left != 0 && !underrun) {
                 /* Either an error or finished playing with data left */
                 music_playing->playing = SDL_FALSE;
             }
-            if (left > 0) {
-                stream += (len - left);
-                len = left;
+            if (left >= 0) {
+                const int consumed = mixlen - left;
+                music_playing->position += consumed / frame_size;
+                if (gain0 != 1.0f || gain1 != 1.0f) {
+                    /* the music is all that's in the stream so far */
+                    const float gain_end = gain0 + ((gain1 - gain0) * (consumed / frame_size)) / frames;
+                    Mix_RampVolume(stream, music_spec.format, music_spec.channels, consumed, gain0, gain_end);
+                }
+                stream += consumed;
+                len -= consumed;
+                if (underrun) {
+                    len = 0;
+                }
             } else {
                 len = 0;
             }
@@ -245,13 +529,131 @@ void SDLCALL music_mixer(void *udata, Uint8 *stream, int len)
 
         if (!music_internal_playing()) {
             music_internal_halt();
-            if (music_finished_hook) {
+            if (music_finished_hook && !music_incoming) {
                 music_finished_hook();
             }
         }
     }
 }
 
+/* Mix the music being crossfaded in over what's in the stream */
+static void music_mix_incoming(Uint8 *stream, int len)
+{
+    Mix_Music *music = music_incoming;
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+    const int frames = len / frame_size;
+    const float volume = (float)music_volume / MIX_MAX_VOLUME;
+    Uint8 *data = SDL_stack_alloc(Uint8, len);
+    int primed = 0, left = 0;
+
+    if (music_prime_pos < music_prime_size) {
+        primed = SDL_min(len, music_prime_size - music_prime_pos);
+        SDL_memcpy(data, music_prime + music_prime_pos, primed);
+        music_prime_pos += primed;
+    }
+    SDL_memset(data + primed, music_spec.silence, len - primed);
+    if (primed < len && music->playing) {
+        left = music->interface->GetAudio(music->context, data + primed, len - primed);
+        if (left != 0) {
+            /* Either an error or finished playing with data left */
+            music->playing = SDL_FALSE;
+        }
+    } else if (primed < len) {
+        left = len - primed;
+    }
+    music->position += (len - SDL_max(left, 0)) / frame_size;
+
+    Mix_RampVolume(data, music_spec.format, music_spec.channels, len,
+                   music_fade_gain(music, music->fade_step) * volume,
+                   music_fade_gain(music, music->fade_step + frames) * volume);
+    SDL_MixAudioFormat(stream, data, music_spec.format, (Uint32)len, MIX_MAX_VOLUME);
+    music->fade_step += frames;
+    SDL_stack_free(data);
+}
+
+static void music_free_prime(void)
+{
+    SDL_free(music_prime);
+    music_prime = NULL;
+    music_prime_size = 0;
+    music_prime_pos = 0;
+}
+
+/* Stop the music being crossfaded in */
+static void music_internal_halt_incoming(void)
+{
+    Mix_Music *music = music_incoming;
+
+    if (music->interface->Stop) {
+        music->interface->Stop(music->context);
+    }
+    music->playing = SDL_FALSE;
+    music->fading = MIX_NO_FADING;
+    music_incoming = NULL;
+    music_free_prime();
+}
+
+/* The crossfade is over, the music that was fading in takes over from the
+   music that was fading out. Unless it's been faded out too since. */
+static void music_internal_end_crossfade(void)
+{
+    Mix_Music *music = music_incoming;
+
+    if (music->fading == MIX_FADING_OUT) {
+        music_internal_halt_incoming();
+        if (!music_playing && music_finished_hook) {
+            music_finished_hook();
+        }
+        return;
+    }
+
+    if (music_playing) {
+        music_internal_halt();
+    }
+    music_incoming = NULL;
+    music_free_prime();
+
+    music_playing = music;
+    music_playing->fading = MIX_NO_FADING;
+    music_internal_initialize_volume();
+    music_ahead_flush();
+}
+
+/* Mixing function */
+void SDLCALL music_mixer(void *udata, Uint8 *stream, int len)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+
+    if (music_incoming && music_active) {
+        Mix_Music *music = music_incoming;
+        int frames = len / frame_size;
+
+        if (frames > music->fade_steps - music->fade_step) {
+            frames = SDL_max(music->fade_steps - music->fade_step, 0);
+        }
+        if (frames > 0) {
+            const int bytes = frames * frame_size;
+            music_mix_playing(stream, bytes);
+            music_mix_incoming(stream, bytes);
+            stream += bytes;
+            len -= bytes;
+        }
+        if (music->fade_step < music->fade_steps) {
+            return;
+        }
+
+        /* The rest of the stream comes from the music that took over. The
+           thread hasn't decoded any of it yet, so it's decoded right here. */
+        music_ahead_lock_decoder();
+        music_internal_end_crossfade();
+        music_mix_playing(stream, len);
+        music_ahead_unlock_decoder();
+        return;
+    }
+
+    music_mix_playing(stream, len);
+}
+
 /* Load the music interface libraries */
 int load_music(void)
 {
@@ -340,8 +742,8 @@ int open_music(const SDL_AudioSpec *spec)
 
     Mix_VolumeMusic(MIX_MAX_VOLUME);
 
-    /* Calculate the number of ms for each callback */
-    ms_per_step = (int) (((float)spec->samples * 1000.0) / spec->freq);
+    /* Fades are timed in output frames */
+    music_freq = spec->freq;
 
     return 0;
 }
@@ -565,6 +967,9 @@ void Mix_FreeMusic(Mix_Music *music)
                 music_internal_halt();
             }
         }
+        if (music == music_incoming) {
+            music_internal_halt_incoming();
+        }
         Mix_UnlockAudio();
 
         music->interface->Delete(music->context);
@@ -609,9 +1014,14 @@ static int music_internal_play(Mix_Music *music, int play_count, double position
 #endif
 
     /* Note the music we're playing */
+    if (music_incoming) {
+        music_internal_halt_incoming();
+    }
     if (music_playing) {
         music_internal_halt();
     }
+    music_ahead_start();
+    music_ahead_lock_decoder();
     music_playing = music;
     music_playing->playing = SDL_TRUE;
 
@@ -637,7 +1047,11 @@ static int music_internal_play(Mix_Music *music, int play_count, double position
     if (retval < 0) {
         music->playing = SDL_FALSE;
         music_playing = NULL;
+    } else {
+        music->position = (Sint64)(SDL_max(position, 0.0) * music_freq);
     }
+    music_ahead_flush();
+    music_ahead_unlock_decoder();
     return(retval);
 }
 
@@ -645,7 +1059,7 @@ int Mix_FadeInMusicPos(Mix_Music *music, int loops, int ms, double position)
 {
     int retval;
 
-    if (ms_per_step == 0) {
+    if (music_freq == 0) {
         SDL_SetError("Audio device hasn't been opened");
         return(-1);
     }
@@ -663,7 +1077,7 @@ int Mix_FadeInMusicPos(Mix_Music *music, int loops, int ms, double position)
         music->fading = MIX_NO_FADING;
     }
     music->fade_step = 0;
-    music->fade_steps = ms/ms_per_step;
+    music->fade_steps = (int)(((Sint64)ms * music_freq) / 1000);
 
     /* Play the puppy */
     Mix_LockAudio();
@@ -691,6 +1105,125 @@ int Mix_PlayMusic(Mix_Music *music, int loops)
     return Mix_FadeInMusicPos(music, loops, 0, 0.0);
 }
 
+/* Start the music in the calling thread and decode its first block, so
+   all the mixer has to do when the crossfade starts is copy it. The music
+   isn't known to the mixer yet, so this doesn't need the audio lock. */
+static int music_internal_prime(Mix_Music *music, int play_count, double position, int frames, Uint8 **prime, int *prime_size)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music_spec.format) / 8) * music_spec.channels;
+    int retval;
+
+    *prime = NULL;
+    *prime_size = 0;
+
+    music->playing = SDL_TRUE;
+    retval = music->interface->Play(music->context, play_count);
+    if (retval == 0) {
+        if (position > 0.0) {
+            if (!music->interface->Seek || music->interface->Seek(music->context, position) < 0) {
+                Mix_SetError("Position not implemented for music type");
+                retval = -1;
+            }
+        } else if (music->interface->Seek) {
+            music->interface->Seek(music->context, 0.0);
+        }
+    }
+    if (retval < 0) {
+        music->playing = SDL_FALSE;
+        return retval;
+    }
+    music->position = (Sint64)(SDL_max(position, 0.0) * music_freq);
+
+    /* music_mixer() applies the volume to music being crossfaded in */
+    if (music->interface->SetVolume) {
+        music->interface->SetVolume(music->context, MIX_MAX_VOLUME);
+    }
+
+    /* If there's no memory for it, it'll just be decoded in the callback */
+    if (frames > 0 && (*prime = (Uint8 *)SDL_malloc(frames * frame_size)) != NULL) {
+        *prime_size = frames * frame_size;
+        SDL_memset(*prime, music_spec.silence, *prime_size);
+        if (music->interface->GetAudio(music->context, *prime, *prime_size) != 0) {
+            music->playing = SDL_FALSE;
+        }
+    }
+    return 0;
+}
+
+int Mix_CrossFadeMusicPos(Mix_Music *music, int loops, int ms, double position)
+{
+    Uint8 *prime;
+    int prime_size;
+    int fade_steps;
+    int retval;
+
+    if (music_freq == 0) {
+        SDL_SetError("Audio device hasn't been opened");
+        return(-1);
+    }
+    if (music == NULL) {
+        Mix_SetError("music parameter was NULL");
+        return(-1);
+    }
+    if (!music->interface->GetAudio) {
+        Mix_SetError("Music type can't be crossfaded");
+        return(-1);
+    }
+    if (ms < 0) {
+        ms = 0;
+    }
+    fade_steps = (int)(((Sint64)ms * music_freq) / 1000);
+    if (loops == 0) {
+        loops = 1;
+    }
+
+    Mix_LockAudio();
+    /* If a crossfade is already going, wait for it to complete */
+    while (music_incoming) {
+        Mix_UnlockAudio();
+        SDL_Delay(100);
+        Mix_LockAudio();
+    }
+    if (!music_playing) {
+        Mix_UnlockAudio();
+        return Mix_FadeInMusicPos(music, loops, ms, position);
+    }
+    if (music == music_playing) {
+        Mix_UnlockAudio();
+        Mix_SetError("Music is already playing");
+        return(-1);
+    }
+    Mix_UnlockAudio();
+
+    retval = music_internal_prime(music, loops, position, SDL_min(fade_steps, (int)music_spec.samples), &prime, &prime_size);
+    if (retval < 0) {
+        return(retval);
+    }
+
+    Mix_LockAudio();
+    if (music_incoming) {
+        /* another thread got a crossfade in first */
+        music_internal_halt_incoming();
+    }
+    music_prime = prime;
+    music_prime_size = prime_size;
+    music_prime_pos = 0;
+    music->fading = (fade_steps > 0) ? MIX_FADING_IN : MIX_NO_FADING;
+    music->fade_step = 0;
+    music->fade_steps = fade_steps;
+    if (music_playing) {
+        music_internal_fade_out(music_playing, fade_steps);
+    }
+    music_incoming = music;
+    Mix_UnlockAudio();
+
+    return(0);
+}
+int Mix_CrossFadeMusic(Mix_Music *music, int loops, int ms)
+{
+    return Mix_CrossFadeMusicPos(music, loops, ms, 0.0);
+}
+
 /* Set the playing music position */
 int music_internal_position(double position)
 {
@@ -705,10 +1238,55 @@ int Mix_SetMusicPosition(double position)
 
     Mix_LockAudio();
     if (music_playing) {
+        music_ahead_lock_decoder();
         retval = music_internal_position(position);
         if (retval < 0) {
             Mix_SetError("Position not implemented for music type");
+        } else {
+            music_playing->position = (Sint64)(SDL_max(position, 0.0) * music_freq);
+            music_ahead_flush();
         }
+        music_ahead_unlock_decoder();
+    } else {
+        Mix_SetError("Music isn't playing");
+        retval = -1;
+    }
+    Mix_UnlockAudio();
+
+    return(retval);
+}
+
+/* Set the part of the music that loops */
+int Mix_SetMusicLoopPoints(Mix_Music *music, Sint64 loop_start, Sint64 loop_end)
+{
+    int retval;
+
+    if (!music) {
+        Mix_SetError("music parameter was NULL");
+        return(-1);
+    }
+    if (!music->interface->SetLoopPoints) {
+        Mix_SetError("Loop points not implemented for music type");
+        return(-1);
+    }
+
+    Mix_LockAudio();
+    music_ahead_lock_decoder();
+    retval = music->interface->SetLoopPoints(music->context, loop_start, loop_end);
+    music_ahead_unlock_decoder();
+    Mix_UnlockAudio();
+
+    return(retval);
+}
+
+/* Get how many output frames into the playing music the mixer is */
+Sint64 Mix_GetMusicPositionFrames(void)
+{
+    Sint64 retval;
+
+    Mix_LockAudio();
+    if (music_playing && music_playing->interface->GetAudio) {
+        retval = music_playing->position;
     } else {
         Mix_SetError("Music isn't playing");
         retval = -1;
@@ -721,7 +1299,16 @@ int Mix_SetMusicPosition(double position)
 /* Set the music's initial volume */
 static void music_internal_initialize_volume(void)
 {
-    if (music_playing->fading == MIX_FADING_IN) {
+    if (music_ahead(music_playing)) {
+        /* music_mixer() applies the volume to music decoded ahead */
+        if (music_playing->interface->SetVolume) {
+            music_playing->interface->SetVolume(music_playing->context, MIX_MAX_VOLUME);
+        }
+        return;
+    }
+
+    /* music_mixer() fades music with GetAudio() in itself */
+    if (music_playing->fading == MIX_FADING_IN && !music_playing->interface->GetAudio) {
         music_internal_volume(0);
     } else {
         music_internal_volume(music_volume);
@@ -731,6 +1318,9 @@ static void music_internal_initialize_volume(void)
 /* Set the music volume */
 static void music_internal_volume(int volume)
 {
+    if (music_ahead(music_playing)) {
+        return;
+    }
     if (music_playing->interface->SetVolume) {
         music_playing->interface->SetVolume(music_playing->context, volume);
     }
@@ -758,6 +1348,9 @@ int Mix_VolumeMusic(int volume)
 /* Halt playing of music */
 static void music_internal_halt(void)
 {
+    /* From music_mixer() this waits for the thread's slice of decoding,
+       if it's in the middle of one. */
+    music_ahead_lock_decoder();
     if (music_playing->interface->Stop) {
         music_playing->interface->Stop(music_playing->context);
     }
@@ -765,12 +1358,19 @@ static void music_internal_halt(void)
     music_playing->playing = SDL_FALSE;
     music_playing->fading = MIX_NO_FADING;
     music_playing = NULL;
+    music_ahead_flush();
+    music_ahead_unlock_decoder();
 }
 int Mix_HaltMusic(void)
 {
     Mix_LockAudio();
-    if (music_playing) {
-        music_internal_halt();
+    if (music_playing || music_incoming) {
+        if (music_incoming) {
+            music_internal_halt_incoming();
+        }
+        if (music_playing) {
+            music_internal_halt();
+        }
         if (music_finished_hook) {
             music_finished_hook();
         }
@@ -780,12 +1380,37 @@ int Mix_HaltMusic(void)
     return(0);
 }
 
+/* Start fading the music out over 'fade_steps' frames */
+static void music_internal_fade_out(Mix_Music *music, int fade_steps)
+{
+    int old_fade_steps = music->fade_steps;
+
+    if (music->fading == MIX_NO_FADING || old_fade_steps <= 0) {
+        music->fade_step = 0;
+    } else {
+        /* carry on from the same gain the current fade has reached */
+        Sint64 step;
+        if (music->fade_step > old_fade_steps) {
+            music->fade_step = old_fade_steps;
+        }
+        if (music->fading == MIX_FADING_OUT) {
+            step = music->fade_step;
+        } else {
+            step = old_fade_steps - music->fade_step;
+        }
+        music->fade_step = (int)((step * fade_steps) / old_fade_steps);
+    }
+    music->fading = MIX_FADING_OUT;
+    music->fade_steps = fade_steps;
+}
+
 /* Progressively stop the music */
 int Mix_FadeOutMusic(int ms)
 {
+    int fade_steps = (int)(((Sint64)ms * music_freq + 999) / 1000);
     int retval = 0;
 
-    if (ms_per_step == 0) {
+    if (music_freq == 0) {
         SDL_SetError("Audio device hasn't been opened");
         return 0;
     }
@@ -797,21 +1422,11 @@ int Mix_FadeOutMusic(int ms)
 
     Mix_LockAudio();
     if (music_playing) {
-        int fade_steps = (ms + ms_per_step - 1) / ms_per_step;
-        if (music_playing->fading == MIX_NO_FADING) {
-            music_playing->fade_step = 0;
-        } else {
-            int step;
-            int old_fade_steps = music_playing->fade_steps;
-            if (music_playing->fading == MIX_FADING_OUT) {
-                step = music_playing->fade_step;
-            } else {
-                step = old_fade_steps - music_playing->fade_step + 1;
-            }
-            music_playing->fade_step = (step * fade_steps) / old_fade_steps;
-        }
-        music_playing->fading = MIX_FADING_OUT;
-        music_playing->fade_steps = fade_steps;
+        music_internal_fade_out(music_playing, fade_steps);
+        retval = 1;
+    }
+    if (music_incoming) {
+        music_internal_fade_out(music_incoming, fade_steps);
         retval = 1;
     }
     Mix_UnlockAudio();
@@ -874,6 +1489,12 @@ static SDL_bool music_internal_playing(void)
         return SDL_FALSE;
     }
 
+    /* the decoder gets to the end before what it decoded ahead is played,
+       music_mixer() notices once it has played it all */
+    if (music_ahead(music_playing)) {
+        return music_playing->playing;
+    }
+
     if (music_playing->interface->IsPlaying) {
         music_playing->playing = music_playing->interface->IsPlaying(music_playing->context);
     }
@@ -884,7 +1505,7 @@ int Mix_PlayingMusic(void)
     SDL_bool playing;
 
     Mix_LockAudio();
-    playing = music_internal_playing();
+    playing = music_internal_playing() || music_incoming;
     Mix_UnlockAudio();
 
     return playing ? 1 : 0;
@@ -909,6 +1530,19 @@ int Mix_SetMusicCMD(const char *command)
     return 0;
 }
 
+int Mix_SetMusicDecodeAhead(int ms)
+{
+    int prev_ms;
+
+    Mix_LockAudio();
+    prev_ms = music_ahead_ms;
+    if (ms >= 0) {
+        music_ahead_ms = ms;
+    }
+    Mix_UnlockAudio();
+    return prev_ms;
+}
+
 int Mix_SetSynchroValue(int i)
 {
     /* Not supported by any players at this time */
@@ -928,6 +1562,7 @@ void close_music(void)
     int i;
 
     Mix_HaltMusic();
+    music_ahead_stop();
 
     for (i = 0; i < SDL_arraysize(s_music_interfaces); ++i) {
         Mix_MusicInterface *interface = s_music_interfaces[i];
@@ -953,7 +1588,7 @@ void close_music(void)
     }
     num_decoders = 0;
 
-    ms_per_step = 0;
+    music_freq = 0;
 }
 
 /* Unload the music interface libraries */
@@ -973,6 +1608,32 @@ void unload_music(void)
     }
 }
 
+int Mix_PreloadMIDIBank(int bank, int drums, int background)
+{
+#ifdef MUSIC_MID_TIMIDITY
+    if (Mix_MusicInterface_TIMIDITY.opened) {
+        return TIMIDITY_PreloadBank(bank, drums, background);
+    }
+#endif
+    Mix_SetError("Timidity isn't being used for MIDI");
+    return -1;
+}
+
+int Mix_SetMIDIEventCache(const char *directory)
+{
+#ifdef MUSIC_MID_TIMIDITY
+    if (Mix_MusicInterface_TIMIDITY.opened) {
+        if (TIMIDITY_SetEventCache(directory) < 0) {
+            Mix_SetError("Insufficient memory to set MIDI event cache");
+            return -1;
+        }
+        return 0;
+    }
+#endif
+    Mix_SetError("Timidity isn't being used for MIDI");
+    return -1;
+}
+
 int Mix_SetSoundFonts(const char *paths)
 {
     if (soundfont_paths) {
@@ -82,6 +82,10 @@ typedef struct
     /* Seek to a play position (in seconds) */
     int (*Seek)(void *music, double position);
 
+    /* Set the part of the music that loops, in the music's own sample
+       frames. A negative start goes back to looping the whole music. */
+    int (*SetLoopPoints)(void *music, Sint64 start, Sint64 end);
+
     /* Pause playing music */
     void (*Pause)(void *music);
 
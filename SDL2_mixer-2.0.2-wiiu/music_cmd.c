@@ -279,6 +279,7 @@ Mix_MusicInterface Mix_MusicInterface_CMD =
     MusicCMD_IsPlaying,
     NULL,   /* GetAudio */
     NULL,   /* Seek */
+    NULL,   /* SetLoopPoints */
     MusicCMD_Pause,
     MusicCMD_Resume,
     MusicCMD_Stop,
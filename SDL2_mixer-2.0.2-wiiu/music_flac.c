@@ -554,6 +554,7 @@ Mix_MusicInterface Mix_MusicInterface_FLAC =
     NULL,   /* IsPlaying */
     FLAC_GetAudio,
     FLAC_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
@@ -296,6 +296,7 @@ Mix_MusicInterface Mix_MusicInterface_FLUIDSYNTH =
     FLUIDSYNTH_IsPlaying,
     FLUIDSYNTH_GetAudio,
     NULL,   /* Seek */
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     FLUIDSYNTH_Stop,
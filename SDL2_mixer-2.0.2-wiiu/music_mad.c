@@ -444,6 +444,7 @@ Mix_MusicInterface Mix_MusicInterface_MAD =
     NULL,   /* IsPlaying */
     MAD_GetAudio,
     MAD_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
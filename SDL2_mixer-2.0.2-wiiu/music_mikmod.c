@@ -474,6 +474,7 @@ Mix_MusicInterface Mix_MusicInterface_MIKMOD =
     MIKMOD_IsPlaying,
     MIKMOD_GetAudio,
     MIKMOD_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     MIKMOD_Stop,
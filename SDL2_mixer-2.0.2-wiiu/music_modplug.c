@@ -297,6 +297,7 @@ Mix_MusicInterface Mix_MusicInterface_MODPLUG =
     NULL,   /* IsPlaying */
     MODPLUG_GetAudio,
     MODPLUG_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
@@ -418,6 +418,7 @@ Mix_MusicInterface Mix_MusicInterface_MPG123 =
     NULL,   /* IsPlaying */
     MPG123_GetAudio,
     MPG123_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
@@ -136,7 +136,6 @@ typedef struct {
     ogg_int64_t loop_start;
     ogg_int64_t loop_end;
     ogg_int64_t loop_len;
-    ogg_int64_t channels;
 } OGG_music;
 
 
@@ -296,6 +295,7 @@ static void *OGG_CreateFromRW(SDL_RWops *src, int freesrc)
          (music->loop_end <= fullLength)) {
         if (music->loop_start < 0) music->loop_start = 0;
         if (music->loop_end == 0)  music->loop_end = fullLength;
+        music->loop_len = music->loop_end - music->loop_start;
         music->loop = 1;
     }
 
@@ -324,7 +324,7 @@ static int OGG_GetSome(void *context, void *data, int bytes, SDL_bool *done)
     OGG_music *music = (OGG_music *)context;
     SDL_bool looped = SDL_FALSE;
     int filled, amount, result;
-    int section;
+    int section, frame_size;
     ogg_int64_t pcmPos;
 
     filled = SDL_AudioStreamGet(music->stream, data, bytes);
@@ -338,6 +338,7 @@ static int OGG_GetSome(void *context, void *data, int bytes, SDL_bool *done)
         return 0;
     }
 
+    pcmPos = vorbis.ov_pcm_tell(&music->vf);
     section = music->section;
 #ifdef OGG_USE_TREMOR
     amount = vorbis.ov_read(&music->vf, music->buffer, music->buffer_size, &section);
@@ -356,14 +357,21 @@ static int OGG_GetSome(void *context, void *data, int bytes, SDL_bool *done)
         }
     }
 
-    pcmPos = vorbis.ov_pcm_tell(&music->vf);
-    if ((music->loop == 1) && (pcmPos >= music->loop_end)) {
-        amount -= (int)((pcmPos - music->loop_end) * music->channels) * sizeof(Sint16);
+    /* Cut the read off exactly at the loop end and carry on from the loop
+       start, without flushing the stream, so the seam has no gap. The last
+       time around the music plays on past the loop end to its real end. */
+    frame_size = music->vi.channels * (int)sizeof(Sint16);
+    if ((music->loop == 1) && (music->play_count != 1) &&
+        (pcmPos < music->loop_end) && (pcmPos + (amount / frame_size) >= music->loop_end)) {
+        amount = (int)(music->loop_end - pcmPos) * frame_size;
         result = vorbis.ov_pcm_seek(&music->vf, music->loop_start);
         if (result < 0) {
             set_ov_error("ov_pcm_seek", result);
             return -1;
         }
+        if (music->play_count > 0) {
+            --music->play_count;
+        }
         looped = SDL_TRUE;
     }
 
@@ -409,6 +417,30 @@ static int OGG_Seek(void *context, double time)
     return 0;
 }
 
+/* Loop between two sample frames instead of the LOOPSTART/LOOPEND tags */
+static int OGG_SetLoopPoints(void *context, Sint64 start, Sint64 end)
+{
+    OGG_music *music = (OGG_music *)context;
+    ogg_int64_t fullLength = vorbis.ov_pcm_total(&music->vf, -1);
+
+    if (start < 0) {
+        music->loop = 0;
+        return 0;
+    }
+    if (end <= 0 || end > fullLength) {
+        end = fullLength;
+    }
+    if (start >= end) {
+        Mix_SetError("Loop start is past the loop end");
+        return -1;
+    }
+    music->loop_start = start;
+    music->loop_end = end;
+    music->loop_len = end - start;
+    music->loop = 1;
+    return 0;
+}
+
 /* Close the given OGG stream */
 static void OGG_Delete(void *context)
 {
@@ -443,6 +475,7 @@ Mix_MusicInterface Mix_MusicInterface_OGG =
     NULL,   /* IsPlaying */
     OGG_GetAudio,
     OGG_Seek,
+    OGG_SetLoopPoints,
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
@@ -223,6 +223,7 @@ Mix_MusicInterface Mix_MusicInterface_SMPEG =
     SMPEG_IsPlaying,
     SMPEG_GetAudio,
     SMPEG_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     SMPEG_Stop,
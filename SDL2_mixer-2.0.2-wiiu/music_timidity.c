@@ -38,6 +38,19 @@ typedef struct
 } TIMIDITY_Music;
 
 
+int TIMIDITY_PreloadBank(int bank, int drums, int background)
+{
+    SDL_AudioSpec spec;
+
+    SDL_memcpy(&spec, &music_spec, sizeof(spec));
+    return Timidity_PreloadBank(&spec, drums, bank, background);
+}
+
+int TIMIDITY_SetEventCache(const char *directory)
+{
+    return Timidity_SetEventCache(directory);
+}
+
 static int TIMIDITY_Seek(void *context, double position);
 static void TIMIDITY_Delete(void *context);
 
@@ -207,6 +220,7 @@ Mix_MusicInterface Mix_MusicInterface_TIMIDITY =
     NULL,   /* IsPlaying */
     TIMIDITY_GetAudio,
     TIMIDITY_Seek,
+    NULL,   /* SetLoopPoints */
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
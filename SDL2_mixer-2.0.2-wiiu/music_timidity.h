@@ -25,4 +25,7 @@
 
 extern Mix_MusicInterface Mix_MusicInterface_TIMIDITY;
 
+extern int TIMIDITY_PreloadBank(int bank, int drums, int background);
+extern int TIMIDITY_SetEventCache(const char *directory);
+
 /* vi: set ts=4 sw=4 expandtab: */
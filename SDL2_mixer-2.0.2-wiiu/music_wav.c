@@ -40,12 +40,16 @@ typedef struct {
     SDL_AudioSpec spec;
     int volume;
     int play_count;
-    Sint64 start;
+    Sint64 start;       /* AIFF only, WAV data is read through the decoder. */
     Sint64 stop;
+    SDL_WAVDecoder *decoder;
+    Uint32 frames;      /* length in sample frames. */
     Uint8 *buffer;
     SDL_AudioStream *stream;
     int numloops;
     WAVLoopPoint *loops;
+    Sint64 loop_start;  /* from Mix_SetMusicLoopPoints(), -1 if not set. */
+    Sint64 loop_end;
 } WAV_Music;
 
 /*
@@ -61,26 +65,7 @@ typedef struct {
 /*******************************************/
 #define RIFF        0x46464952      /* "RIFF" */
 #define WAVE        0x45564157      /* "WAVE" */
-#define FMT         0x20746D66      /* "fmt " */
-#define DATA        0x61746164      /* "data" */
 #define SMPL        0x6c706d73      /* "smpl" */
-#define PCM_CODE    1
-#define ADPCM_CODE  2
-#define WAVE_MONO   1
-#define WAVE_STEREO 2
-
-typedef struct {
-/* Not saved in the chunk we read:
-    Uint32  chunkID;
-    Uint32  chunkLen;
-*/
-    Uint16  encoding;
-    Uint16  channels;       /* 1 = mono, 2 = stereo */
-    Uint32  frequency;      /* One of 11025, 22050, or 44100 Hz */
-    Uint32  byterate;       /* Average bytes per second */
-    Uint16  blockalign;     /* Bytes per sample block */
-    Uint16  bitspersample;      /* One of 8, 12, 16, or 4 for ADPCM */
-} WaveFMT;
 
 typedef struct {
     Uint32 identifier;
@@ -118,7 +103,7 @@ typedef struct {
 
 
 /* Function to load the WAV/AIFF stream */
-static SDL_bool LoadWAVMusic(WAV_Music *wave);
+static SDL_bool LoadWAVMusic(WAV_Music *wave, Sint64 file_start);
 static SDL_bool LoadAIFFMusic(WAV_Music *wave);
 
 static void WAV_Delete(void *context);
@@ -128,6 +113,7 @@ static void *WAV_CreateFromRW(SDL_RWops *src, int freesrc)
 {
     WAV_Music *music;
     Uint32 magic;
+    Sint64 file_start;
     SDL_bool loaded = SDL_FALSE;
 
     music = (WAV_Music *)SDL_calloc(1, sizeof(*music));
@@ -137,19 +123,25 @@ static void *WAV_CreateFromRW(SDL_RWops *src, int freesrc)
     }
     music->src = src;
     music->volume = MIX_MAX_VOLUME;
+    music->loop_start = -1;
 
+    file_start = SDL_RWtell(src);
     magic = SDL_ReadLE32(src);
     if (magic == RIFF || magic == WAVE) {
-        loaded = LoadWAVMusic(music);
+        loaded = LoadWAVMusic(music, file_start);
     } else if (magic == FORM) {
         loaded = LoadAIFFMusic(music);
     } else {
         Mix_SetError("Unknown WAVE format");
     }
     if (!loaded) {
-        SDL_free(music);
+        WAV_Delete(music);
         return NULL;
     }
+    /* SDL_CalculateAudioSpec */
+    music->spec.size = SDL_AUDIO_BITSIZE(music->spec.format) / 8;
+    music->spec.size *= music->spec.channels;
+    music->spec.size *= music->spec.samples;
     music->buffer = (Uint8*)SDL_malloc(music->spec.size);
     if (!music->buffer) {
         WAV_Delete(music);
@@ -173,6 +165,46 @@ static void WAV_SetVolume(void *context, int volume)
     music->volume = volume;
 }
 
+/* The sample frame the next read starts at */
+static Uint32 WAV_TellFrame(WAV_Music *music)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music->spec.format) / 8) * music->spec.channels;
+    if (music->decoder) {
+        return SDL_WAVDecoderTell(music->decoder);
+    }
+    return (Uint32)((SDL_RWtell(music->src) - music->start) / frame_size);
+}
+
+static int WAV_SeekFrame(WAV_Music *music, Uint32 frame)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music->spec.format) / 8) * music->spec.channels;
+    if (music->decoder) {
+        return SDL_WAVDecoderSeek(music->decoder, frame);
+    }
+    if (SDL_RWseek(music->src, music->start + (Sint64)frame * frame_size, RW_SEEK_SET) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Decode up to the given number of sample frames into the audio stream */
+static int WAV_PutFrames(WAV_Music *music, Uint32 frames)
+{
+    const int frame_size = (SDL_AUDIO_BITSIZE(music->spec.format) / 8) * music->spec.channels;
+    int amount;
+
+    if (music->decoder) {
+        return SDL_WAVDecoderPutAudioStream(music->decoder, music->stream, (int)frames * frame_size);
+    }
+    amount = (int)SDL_RWread(music->src, music->buffer, 1, frames * frame_size);
+    if (amount > 0) {
+        if (SDL_AudioStreamPut(music->stream, music->buffer, amount) < 0) {
+            return -1;
+        }
+    }
+    return amount;
+}
+
 /* Start playback of a given WAV stream */
 static int WAV_Play(void *context, int play_count)
 {
@@ -184,7 +216,7 @@ static int WAV_Play(void *context, int play_count)
         loop->current_play_count = loop->initial_play_count;
     }
     music->play_count = play_count;
-    if (SDL_RWseek(music->src, music->start, RW_SEEK_SET) < 0) {
+    if (WAV_SeekFrame(music, 0) < 0) {
         return -1;
     }
     return 0;
@@ -199,8 +231,9 @@ static int WAV_GetSome(void *context, void *data, int bytes, SDL_bool *done)
     Sint64 loop_start;
     Sint64 loop_stop;
     SDL_bool looped = SDL_FALSE;
+    SDL_bool user_loop = SDL_FALSE;
     int i;
-    int filled, amount, result;
+    int filled, amount;
 
     filled = SDL_AudioStreamGet(music->stream, data, bytes);
     if (filled != 0) {
@@ -213,51 +246,62 @@ static int WAV_GetSome(void *context, void *data, int bytes, SDL_bool *done)
         return 0;
     }
 
-    pos = SDL_RWtell(music->src);
-    stop = music->stop;
+    /* Positions are in sample frames. Never read past the end of a loop
+       we haven't reached yet, or a short loop after the intro is skipped. */
+    pos = WAV_TellFrame(music);
+    stop = music->frames;
     loop = NULL;
+    loop_start = 0;
     for (i = 0; i < music->numloops; ++i) {
-        loop = &music->loops[i];
-        if (loop->active) {
-            const int bytes_per_sample = (SDL_AUDIO_BITSIZE(music->spec.format) / 8) * music->spec.channels;
-            loop_start = music->start + loop->start * bytes_per_sample;
-            loop_stop = music->start + (loop->stop + 1) * bytes_per_sample;
-            if (pos >= loop_start && pos < loop_stop)
-            {
+        WAVLoopPoint *next = &music->loops[i];
+        if (next->active) {
+            loop_stop = (Sint64)next->stop + 1;
+            if (pos < loop_stop && loop_stop <= stop) {
+                loop = next;
+                loop_start = next->start;
                 stop = loop_stop;
-                break;
             }
         }
-        loop = NULL;
+    }
+    /* Loop points set through the API use up the play count, the last
+       time around the music plays on past the loop end to the end. */
+    if (music->loop_start >= 0 && music->play_count != 1 &&
+        pos < music->loop_end && music->loop_end <= stop) {
+        stop = music->loop_end;
+        user_loop = SDL_TRUE;
     }
 
-    amount = music->spec.size;
+    amount = music->spec.samples;
     if ((stop - pos) < amount) {
         amount = (int)(stop - pos);
     }
-    amount = (int)SDL_RWread(music->src, music->buffer, 1, amount);
     if (amount > 0) {
-        result = SDL_AudioStreamPut(music->stream, music->buffer, amount);
-        if (result < 0) {
+        if (WAV_PutFrames(music, (Uint32)amount) < 0) {
             return -1;
         }
     } else {
         /* We might be looping, continue */
     }
 
-    if (loop && SDL_RWtell(music->src) >= stop) {
+    if (loop && WAV_TellFrame(music) >= stop) {
         if (loop->current_play_count == 1) {
             loop->active = SDL_FALSE;
         } else {
             if (loop->current_play_count > 0) {
                 --loop->current_play_count;
             }
-            SDL_RWseek(music->src, loop_start, RW_SEEK_SET);
+            WAV_SeekFrame(music, (Uint32)loop_start);
             looped = SDL_TRUE;
         }
+    } else if (user_loop && WAV_TellFrame(music) >= stop) {
+        if (music->play_count > 0) {
+            --music->play_count;
+        }
+        WAV_SeekFrame(music, (Uint32)music->loop_start);
+        looped = SDL_TRUE;
     }
 
-    if (!looped && SDL_RWtell(music->src) >= music->stop) {
+    if (!looped && WAV_TellFrame(music) >= music->frames) {
         if (music->play_count == 1) {
             music->play_count = 0;
             SDL_AudioStreamFlush(music->stream);
@@ -282,6 +326,48 @@ static int WAV_GetAudio(void *context, void *data, int bytes)
     return music_pcm_getaudio(context, data, bytes, music->volume, WAV_GetSome);
 }
 
+/* Jump (within the current song) to the given position in seconds */
+static int WAV_Seek(void *context, double position)
+{
+    WAV_Music *music = (WAV_Music *)context;
+    double frame = position * music->spec.freq;
+
+    if (frame < 0.0) {
+        frame = 0.0;
+    } else if (frame > (double)music->frames) {
+        frame = (double)music->frames;
+    }
+    if (WAV_SeekFrame(music, (Uint32)frame) < 0) {
+        return -1;
+    }
+    SDL_AudioStreamClear(music->stream);
+    return 0;
+}
+
+/* Loop between two sample frames, in place of any loops in the file */
+static int WAV_SetLoopPoints(void *context, Sint64 start, Sint64 end)
+{
+    WAV_Music *music = (WAV_Music *)context;
+
+    if (start >= 0) {
+        if (end <= 0 || end > (Sint64)music->frames) {
+            end = music->frames;
+        }
+        if (start >= end) {
+            Mix_SetError("Loop start is past the loop end");
+            return -1;
+        }
+    }
+    if (music->loops) {
+        SDL_free(music->loops);
+        music->loops = NULL;
+        music->numloops = 0;
+    }
+    music->loop_start = start;
+    music->loop_end = end;
+    return 0;
+}
+
 /* Close the given WAV stream */
 static void WAV_Delete(void *context)
 {
@@ -297,78 +383,15 @@ static void WAV_Delete(void *context)
     if (music->buffer) {
         SDL_free(music->buffer);
     }
+    if (music->decoder) {
+        SDL_FreeWAVDecoder(music->decoder);
+    }
     if (music->freesrc) {
         SDL_RWclose(music->src);
     }
     SDL_free(music);
 }
 
-static SDL_bool ParseFMT(WAV_Music *wave, Uint32 chunk_length)
-{
-    SDL_AudioSpec *spec = &wave->spec;
-    WaveFMT *format;
-    Uint8 *data;
-    SDL_bool loaded = SDL_FALSE;
-
-    if (chunk_length < sizeof(*format)) {
-        Mix_SetError("Wave format chunk too small");
-        return SDL_FALSE;
-    }
-
-    data = (Uint8 *)SDL_malloc(chunk_length);
-    if (!data) {
-        Mix_SetError("Out of memory");
-        return SDL_FALSE;
-    }
-    if (!SDL_RWread(wave->src, data, chunk_length, 1)) {
-        Mix_SetError("Couldn't read %d bytes from WAV file", chunk_length);
-        return SDL_FALSE;
-    }
-    format = (WaveFMT *)data;
-
-    /* Decode the audio data format */
-    switch (SDL_SwapLE16(format->encoding)) {
-        case PCM_CODE:
-            /* We can understand this */
-            break;
-        default:
-            Mix_SetError("Unknown WAVE data format");
-            goto done;
-    }
-    spec->freq = SDL_SwapLE32(format->frequency);
-    switch (SDL_SwapLE16(format->bitspersample)) {
-        case 8:
-            spec->format = AUDIO_U8;
-            break;
-        case 16:
-            spec->format = AUDIO_S16;
-            break;
-        default:
-            Mix_SetError("Unknown PCM data format");
-            goto done;
-    }
-    spec->channels = (Uint8) SDL_SwapLE16(format->channels);
-    spec->samples = 4096;       /* Good default buffer size */
-    /* SDL_CalculateAudioSpec */
-    spec->size = SDL_AUDIO_BITSIZE(spec->format) / 8;
-    spec->size *= spec->channels;
-    spec->size *= spec->samples;
-
-    loaded = SDL_TRUE;
-
-done:
-    SDL_free(data);
-    return loaded;
-}
-
-static SDL_bool ParseDATA(WAV_Music *wave, Uint32 chunk_length)
-{
-    wave->start = SDL_RWtell(wave->src);
-    wave->stop = wave->start + chunk_length;
-    SDL_RWseek(wave->src, chunk_length, RW_SEEK_CUR);
-    return SDL_TRUE;
-}
-
 static SDL_bool AddLoopPoint(WAV_Music *wave, Uint32 play_count, Uint32 start, Uint32 stop)
 {
     WAVLoopPoint *loop;
@@ -420,13 +443,11 @@ static SDL_bool ParseSMPL(WAV_Music *wave, Uint32 chunk_length)
     return loaded;
 }
 
-static SDL_bool LoadWAVMusic(WAV_Music *wave)
+static SDL_bool LoadWAVMusic(WAV_Music *wave, Sint64 file_start)
 {
     SDL_RWops *src = wave->src;
     Uint32 chunk_type;
     Uint32 chunk_length;
-    SDL_bool found_FMT = SDL_FALSE;
-    SDL_bool found_DATA = SDL_FALSE;
 
     /* WAV magic header */
     Uint32 wavelen;
@@ -436,7 +457,7 @@ static SDL_bool LoadWAVMusic(WAV_Music *wave)
     wavelen = SDL_ReadLE32(src);
     WAVEmagic = SDL_ReadLE32(src);
 
-    /* Read the chunks */
+    /* Look for loop points, the decoder takes care of everything else */
     for (; ;) {
         chunk_type = SDL_ReadLE32(src);
         chunk_length = SDL_ReadLE32(src);
@@ -446,16 +467,6 @@ static SDL_bool LoadWAVMusic(WAV_Music *wave)
 
         switch (chunk_type)
         {
-        case FMT:
-            found_FMT = SDL_TRUE;
-            if (!ParseFMT(wave, chunk_length))
-                return SDL_FALSE;
-            break;
-        case DATA:
-            found_DATA = SDL_TRUE;
-            if (!ParseDATA(wave, chunk_length))
-                return SDL_FALSE;
-            break;
         case SMPL:
             if (!ParseSMPL(wave, chunk_length))
                 return SDL_FALSE;
@@ -466,15 +477,15 @@ static SDL_bool LoadWAVMusic(WAV_Music *wave)
         }
     }
 
-    if (!found_FMT) {
-        Mix_SetError("Bad WAV file (no FMT chunk)");
+    /* The data is decoded a block at a time as it plays */
+    if (SDL_RWseek(src, file_start, RW_SEEK_SET) < 0) {
         return SDL_FALSE;
     }
-
-    if (!found_DATA) {
-        Mix_SetError("Bad WAV file (no DATA chunk)");
+    wave->decoder = SDL_NewWAVDecoder_RW(src, 0, &wave->spec);
+    if (!wave->decoder) {
         return SDL_FALSE;
     }
+    wave->frames = SDL_WAVDecoderLength(wave->decoder);
 
     return SDL_TRUE;
 }
@@ -587,6 +598,7 @@ static SDL_bool LoadAIFFMusic(WAV_Music *wave)
     }
 
     wave->stop = wave->start + channels * numsamples * (samplesize / 8);
+    wave->frames = numsamples;
 
     /* Decode the audio data format */
     SDL_memset(spec, 0, (sizeof *spec));
@@ -624,7 +636,8 @@ Mix_MusicInterface Mix_MusicInterface_WAV =
     WAV_Play,
     NULL,   /* IsPlaying */
     WAV_GetAudio,
-    NULL,   /* Seek */
+    WAV_Seek,
+    WAV_SetLoopPoints,
     NULL,   /* Pause */
     NULL,   /* Resume */
     NULL,   /* Stop */
@@ -29,6 +29,39 @@
 #include "resample.h"
 #include "tables.h"
 
+/* Instruments are shared by all the songs that use them, and kept after
+   the last one is freed (up to INSTRUMENT_CACHE_BYTES of them), so the
+   next song doesn't have to load them from disk all over again. The
+   patch and what the config says to do with it are the key, along with
+   the output rate: that's all load_instrument() uses from the song. */
+typedef struct _CachedInstrument {
+  char *name;
+  int panning, amp, note_to_use, strip_loop, strip_envelope, strip_tail;
+  Sint32 rate, control_ratio;
+  Instrument *ip;
+  int refcount;
+  int preloaded;
+  size_t size;
+  struct _CachedInstrument *next;
+} CachedInstrument;
+
+static CachedInstrument *instrument_cache = NULL; /* most recently used first */
+static size_t unused_instrument_bytes = 0;
+static SDL_mutex *instrument_cache_lock = NULL;
+static int instrument_cache_open = 0;
+
+static void lock_instrument_cache(void)
+{
+  if (instrument_cache_lock)
+    SDL_LockMutex(instrument_cache_lock);
+}
+
+static void unlock_instrument_cache(void)
+{
+  if (instrument_cache_lock)
+    SDL_UnlockMutex(instrument_cache_lock);
+}
+
 static void free_instrument(Instrument *ip)
 {
   Sample *sp;
@@ -43,6 +76,65 @@ static void free_instrument(Instrument *ip)
   free(ip);
 }
 
+static size_t instrument_size(Instrument *ip)
+{
+  size_t size = sizeof(Instrument) + ip->samples * sizeof(Sample);
+  int i;
+  for (i=0; i<ip->samples; i++)
+    size += ((ip->sample[i].data_length >> FRACTION_BITS) + 2) * sizeof(sample_t);
+  return size;
+}
+
+static void free_cached_instrument(CachedInstrument *c)
+{
+  free_instrument(c->ip);
+  free(c->name);
+  free(c);
+}
+
+/* Free the least recently used instruments no song is using, until the
+   ones that are left fit in the budget. The caller holds the lock. */
+static void trim_instrument_cache(size_t budget)
+{
+  while (unused_instrument_bytes > budget)
+    {
+      CachedInstrument *c, *prev=0, *victim=0, *victim_prev=0;
+      for (c=instrument_cache; c; prev=c, c=c->next)
+	if (!c->refcount)
+	  {
+	    victim=c;
+	    victim_prev=prev;
+	  }
+      if (!victim)
+	break;
+      if (victim_prev)
+	victim_prev->next=victim->next;
+      else
+	instrument_cache=victim->next;
+      unused_instrument_bytes -= victim->size;
+      free_cached_instrument(victim);
+    }
+}
+
+static void release_instrument(Instrument *ip)
+{
+  CachedInstrument *c;
+
+  lock_instrument_cache();
+  for (c=instrument_cache; c; c=c->next)
+    if (c->ip == ip)
+      break;
+  if (!c)
+    free_instrument(ip); /* not one of ours */
+  else if (!--c->refcount)
+    {
+      unused_instrument_bytes += c->size;
+      /* Once Timidity_Exit() has been and gone nothing's kept */
+      trim_instrument_cache(instrument_cache_open ? INSTRUMENT_CACHE_BYTES : 0);
+    }
+  unlock_instrument_cache();
+}
+
 static void free_bank(MidiSong *song, int dr, int b)
 {
   int i;
@@ -52,7 +144,7 @@ static void free_bank(MidiSong *song, int dr, int b)
       {
 	/* Not that this could ever happen, of course */
 	if (bank->instrument[i] != MAGIC_LOAD_INSTRUMENT)
-	  free_instrument(bank->instrument[i]);
+	  release_instrument(bank->instrument[i]);
 	bank->instrument[i]=0;
       }
 }
@@ -507,6 +599,84 @@ static Instrument *load_instrument(MidiSong *song, char *name, int percussion,
   return ip;
 }
 
+/* load_instrument(), from the cache if it's there. The lock is held while
+   it loads, so two threads never load the same patch at once. */
+static Instrument *get_instrument(MidiSong *song, char *name, int percussion,
+				  int panning, int amp, int note_to_use,
+				  int strip_loop, int strip_envelope,
+				  int strip_tail)
+{
+  CachedInstrument *c, *prev=0;
+  Instrument *ip;
+
+  if (!name) return 0;
+
+  lock_instrument_cache();
+  for (c=instrument_cache; c; prev=c, c=c->next)
+    {
+      if (c->panning==panning && c->amp==amp && c->note_to_use==note_to_use &&
+	  c->strip_loop==strip_loop && c->strip_envelope==strip_envelope &&
+	  c->strip_tail==strip_tail && c->rate==song->rate &&
+	  c->control_ratio==song->control_ratio && !strcmp(c->name, name))
+	{
+	  if (prev)
+	    {
+	      prev->next=c->next;
+	      c->next=instrument_cache;
+	      instrument_cache=c;
+	    }
+	  if (!c->refcount++)
+	    unused_instrument_bytes -= c->size;
+	  unlock_instrument_cache();
+	  return c->ip;
+	}
+    }
+
+  ip=load_instrument(song, name, percussion, panning, amp, note_to_use,
+		     strip_loop, strip_envelope, strip_tail);
+  if (ip && (c=safe_malloc(sizeof(CachedInstrument))) != NULL)
+    {
+      c->name=safe_malloc(strlen(name)+1);
+      if (!c->name)
+	{
+	  free(c);
+	  unlock_instrument_cache();
+	  return ip;
+	}
+      strcpy(c->name, name);
+      c->panning=panning;
+      c->amp=amp;
+      c->note_to_use=note_to_use;
+      c->strip_loop=strip_loop;
+      c->strip_envelope=strip_envelope;
+      c->strip_tail=strip_tail;
+      c->rate=song->rate;
+      c->control_ratio=song->control_ratio;
+      c->ip=ip;
+      c->refcount=1;
+      c->preloaded=0;
+      c->size=instrument_size(ip);
+      c->next=instrument_cache;
+      instrument_cache=c;
+    }
+  unlock_instrument_cache();
+  return ip;
+}
+
+/* Load the instrument for program i of a tone bank or drum set. */
+static Instrument *get_tone(MidiSong *song, int dr, ToneBankElement *tone, int i)
+{
+  return get_instrument(song,
+			tone->name,
+			(dr) ? 1 : 0,
+			tone->pan,
+			tone->amp,
+			(tone->note!=-1) ? tone->note : ((dr) ? i : -1),
+			(tone->strip_loop!=-1) ? tone->strip_loop : ((dr) ? 1 : -1),
+			(tone->strip_envelope != -1) ? tone->strip_envelope : ((dr) ? 1 : -1),
+			tone->strip_tail);
+}
+
 static int fill_bank(MidiSong *song, int dr, int b)
 {
   int i, errors=0;
@@ -547,21 +717,7 @@ static int fill_bank(MidiSong *song, int dr, int b)
 	      errors++;
 	    }
 	  else if (!(bank->instrument[i] =
-		     load_instrument(song,
-				     bank->tone[i].name, 
-				     (dr) ? 1 : 0,
-				     bank->tone[i].pan,
-				     bank->tone[i].amp,
-				     (bank->tone[i].note!=-1) ? 
-				     bank->tone[i].note :
-				     ((dr) ? i : -1),
-				     (bank->tone[i].strip_loop!=-1) ?
-				     bank->tone[i].strip_loop :
-				     ((dr) ? 1 : -1),
-				     (bank->tone[i].strip_envelope != -1) ? 
-				     bank->tone[i].strip_envelope :
-				     ((dr) ? 1 : -1),
-				     bank->tone[i].strip_tail )))
+		     get_tone(song, dr, &bank->tone[i], i)))
 	    {
 	      SNDDBG(("Couldn't load instrument %s (%s %d, program %d)\n",
 		   bank->tone[i].name,
@@ -596,14 +752,86 @@ void free_instruments(MidiSong *song)
       if (song->drumset[i])
 	free_bank(song, 1, i);
     }
+  if (song->default_instrument)
+    {
+      release_instrument(song->default_instrument);
+      song->default_instrument = 0;
+    }
 }
 
 int set_default_instrument(MidiSong *song, char *name)
 {
   Instrument *ip;
-  if (!(ip=load_instrument(song, name, 0, -1, -1, -1, 0, 0, 0)))
+  if (!(ip=get_instrument(song, name, 0, -1, -1, -1, 0, 0, 0)))
     return -1;
   song->default_instrument = ip;
   song->default_program = SPECIAL_PROGRAM;
   return 0;
 }
+
+/* Load all of a bank's instruments into the cache for songs at the given
+   song's rate, and keep them there until Timidity_Exit(). Returns the
+   number that couldn't be loaded. */
+int preload_instruments(MidiSong *song, int dr, ToneBank *bank)
+{
+  CachedInstrument *c;
+  int i, errors=0;
+
+  for (i=0; i<MAXBANK; i++)
+    {
+      Instrument *ip;
+      if (!bank->tone[i].name)
+	continue;
+      if (!(ip=get_tone(song, dr, &bank->tone[i], i)))
+	{
+	  errors++;
+	  continue;
+	}
+      /* keep the reference, unless it was preloaded already */
+      lock_instrument_cache();
+      for (c=instrument_cache; c && c->ip!=ip; c=c->next)
+	;
+      if (c && !c->preloaded)
+	{
+	  c->preloaded=1;
+	  ip=0;
+	}
+      unlock_instrument_cache();
+      if (ip)
+	release_instrument(ip);
+    }
+  return errors;
+}
+
+int init_instrument_cache(void)
+{
+  if (!instrument_cache_lock)
+    instrument_cache_lock = SDL_CreateMutex();
+  instrument_cache_open = 1;
+  return (instrument_cache_lock) ? 0 : -1;
+}
+
+/* Let go of the preloaded instruments and free all those that aren't being
+   used. Those that are go when their songs are freed. */
+void quit_instrument_cache(void)
+{
+  CachedInstrument *c;
+
+  lock_instrument_cache();
+  instrument_cache_open = 0;
+  for (c=instrument_cache; c; c=c->next)
+    if (c->preloaded)
+      {
+	c->preloaded=0;
+	if (!--c->refcount)
+	  unused_instrument_bytes += c->size;
+      }
+  trim_instrument_cache(0);
+  unlock_instrument_cache();
+
+  if (instrument_cache_lock)
+    {
+      SDL_DestroyMutex(instrument_cache_lock);
+      instrument_cache_lock = NULL;
+    }
+}
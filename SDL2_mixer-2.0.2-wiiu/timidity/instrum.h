@@ -28,3 +28,6 @@
 extern int load_missing_instruments(MidiSong *song);
 extern void free_instruments(MidiSong *song);
 extern int set_default_instrument(MidiSong *song, char *name);
+extern int preload_instruments(MidiSong *song, int dr, ToneBank *bank);
+extern int init_instrument_cache(void);
+extern void quit_instrument_cache(void);
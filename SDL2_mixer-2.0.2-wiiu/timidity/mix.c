@@ -176,6 +176,103 @@ static int update_signal(MidiSong *song, int v)
 
 #define MIXATION(a)	*lp++ += (a)*s;
 
+/* The inner loops of the mixers below. Each adds count samples from sp,
+   scaled by the voice's volume, into the (interleaved, in stereo) 32-bit
+   buffer at lp. Four samples at a time where vector extensions are
+   available, with the scalar loop finishing the rest. */
+
+static SDL_INLINE void mix_run_mystery(const sample_t *sp, Sint32 *lp,
+				       final_volume_t left,
+				       final_volume_t right, int count)
+{
+  sample_t s;
+#if TIMIDITY_VECTORS
+  const s32x4_t lr = { left, right, left, right };
+  s32x4_t v;
+  for (; count >= 4; count -= 4)
+    {
+      v = __builtin_convertvector(*(const s16x4_t *)sp, s32x4_t);
+      *(s32x4_t *)lp += (s32x4_t) { v[0], v[0], v[1], v[1] } * lr;
+      *(s32x4_t *)(lp + 4) += (s32x4_t) { v[2], v[2], v[3], v[3] } * lr;
+      sp += 4;
+      lp += 8;
+    }
+#endif
+  while (count--)
+    {
+      s = *sp++;
+      MIXATION(left);
+      MIXATION(right);
+    }
+}
+
+static SDL_INLINE void mix_run_center(const sample_t *sp, Sint32 *lp,
+				      final_volume_t left, int count)
+{
+  sample_t s;
+#if TIMIDITY_VECTORS
+  s32x4_t v;
+  for (; count >= 4; count -= 4)
+    {
+      v = __builtin_convertvector(*(const s16x4_t *)sp, s32x4_t) * left;
+      *(s32x4_t *)lp += (s32x4_t) { v[0], v[0], v[1], v[1] };
+      *(s32x4_t *)(lp + 4) += (s32x4_t) { v[2], v[2], v[3], v[3] };
+      sp += 4;
+      lp += 8;
+    }
+#endif
+  while (count--)
+    {
+      s = *sp++;
+      MIXATION(left);
+      MIXATION(left);
+    }
+}
+
+static SDL_INLINE void mix_run_single(const sample_t *sp, Sint32 *lp,
+				      final_volume_t left, int count)
+{
+  sample_t s;
+#if TIMIDITY_VECTORS
+  /* lp may point at the right channel, so the last vector would reach one
+     past the end of the buffer. Leave the final four to the scalar loop. */
+  s32x4_t v;
+  for (; count > 4; count -= 4)
+    {
+      v = __builtin_convertvector(*(const s16x4_t *)sp, s32x4_t) * left;
+      *(s32x4_t *)lp += (s32x4_t) { v[0], 0, v[1], 0 };
+      *(s32x4_t *)(lp + 4) += (s32x4_t) { v[2], 0, v[3], 0 };
+      sp += 4;
+      lp += 8;
+    }
+#endif
+  while (count--)
+    {
+      s = *sp++;
+      MIXATION(left);
+      lp++;
+    }
+}
+
+static SDL_INLINE void mix_run_mono(const sample_t *sp, Sint32 *lp,
+				    final_volume_t left, int count)
+{
+  sample_t s;
+#if TIMIDITY_VECTORS
+  for (; count >= 4; count -= 4)
+    {
+      *(s32x4_t *)lp += __builtin_convertvector(*(const s16x4_t *)sp, s32x4_t) * left;
+      sp += 4;
+      lp += 4;
+    }
+#endif
+  while (count--)
+    {
+      s = *sp++;
+      MIXATION(left);
+    }
+}
+
 static void mix_mystery_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
 			       int count)
 {
@@ -184,7 +281,6 @@ static void mix_mystery_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     left=vp->left_mix, 
     right=vp->right_mix;
   int cc;
-  sample_t s;
 
   if (!(cc = vp->control_counter))
     {
@@ -199,12 +295,9 @@ static void mix_mystery_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     if (cc < count)
       {
 	count -= cc;
-	while (cc--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    MIXATION(right);
-	  }
+	mix_run_mystery(sp, lp, left, right, cc);
+	sp += cc;
+	lp += cc*2;
 	cc = song->control_ratio;
 	if (update_signal(song, v))
 	  return;	/* Envelope ran out */
@@ -214,12 +307,7 @@ static void mix_mystery_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     else
       {
 	vp->control_counter = cc - count;
-	while (count--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    MIXATION(right);
-	  }
+	mix_run_mystery(sp, lp, left, right, count);
 	return;
       }
 }
@@ -231,7 +319,6 @@ static void mix_center_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
   final_volume_t 
     left=vp->left_mix;
   int cc;
-  sample_t s;
 
   if (!(cc = vp->control_counter))
     {
@@ -245,12 +332,9 @@ static void mix_center_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     if (cc < count)
       {
 	count -= cc;
-	while (cc--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    MIXATION(left);
-	  }
+	mix_run_center(sp, lp, left, cc);
+	sp += cc;
+	lp += cc*2;
 	cc = song->control_ratio;
 	if (update_signal(song, v))
 	  return;	/* Envelope ran out */
@@ -259,12 +343,7 @@ static void mix_center_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     else
       {
 	vp->control_counter = cc - count;
-	while (count--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    MIXATION(left);
-	  }
+	mix_run_center(sp, lp, left, count);
 	return;
       }
 }
@@ -276,7 +355,6 @@ static void mix_single_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
   final_volume_t 
     left=vp->left_mix;
   int cc;
-  sample_t s;
   
   if (!(cc = vp->control_counter))
     {
@@ -290,12 +368,9 @@ static void mix_single_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     if (cc < count)
       {
 	count -= cc;
-	while (cc--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    lp++;
-	  }
+	mix_run_single(sp, lp, left, cc);
+	sp += cc;
+	lp += cc*2;
 	cc = song->control_ratio;
 	if (update_signal(song, v))
 	  return;	/* Envelope ran out */
@@ -304,12 +379,7 @@ static void mix_single_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     else
       {
 	vp->control_counter = cc - count;
-	while (count--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	    lp++;
-	  }
+	mix_run_single(sp, lp, left, count);
 	return;
       }
 }
@@ -321,7 +391,6 @@ static void mix_mono_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
   final_volume_t 
     left=vp->left_mix;
   int cc;
-  sample_t s;
   
   if (!(cc = vp->control_counter))
     {
@@ -335,11 +404,9 @@ static void mix_mono_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     if (cc < count)
       {
 	count -= cc;
-	while (cc--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	  }
+	mix_run_mono(sp, lp, left, cc);
+	sp += cc;
+	lp += cc;
 	cc = song->control_ratio;
 	if (update_signal(song, v))
 	  return;	/* Envelope ran out */
@@ -348,69 +415,29 @@ static void mix_mono_signal(MidiSong *song, sample_t *sp, Sint32 *lp, int v,
     else
       {
 	vp->control_counter = cc - count;
-	while (count--)
-	  {
-	    s = *sp++;
-	    MIXATION(left);
-	  }
+	mix_run_mono(sp, lp, left, count);
 	return;
       }
 }
 
 static void mix_mystery(MidiSong *song, sample_t *sp, Sint32 *lp, int v, int count)
 {
-  final_volume_t 
-    left = song->voice[v].left_mix, 
-    right = song->voice[v].right_mix;
-  sample_t s;
-  
-  while (count--)
-    {
-      s = *sp++;
-      MIXATION(left);
-      MIXATION(right);
-    }
+  mix_run_mystery(sp, lp, song->voice[v].left_mix, song->voice[v].right_mix, count);
 }
 
 static void mix_center(MidiSong *song, sample_t *sp, Sint32 *lp, int v, int count)
 {
-  final_volume_t 
-    left = song->voice[v].left_mix;
-  sample_t s;
-  
-  while (count--)
-    {
-      s = *sp++;
-      MIXATION(left);
-      MIXATION(left);
-    }
+  mix_run_center(sp, lp, song->voice[v].left_mix, count);
 }
 
 static void mix_single(MidiSong *song, sample_t *sp, Sint32 *lp, int v, int count)
 {
-  final_volume_t 
-    left = song->voice[v].left_mix;
-  sample_t s;
-  
-  while (count--)
-    {
-      s = *sp++;
-      MIXATION(left);
-      lp++;
-    }
+  mix_run_single(sp, lp, song->voice[v].left_mix, count);
 }
 
 static void mix_mono(MidiSong *song, sample_t *sp, Sint32 *lp, int v, int count)
 {
-  final_volume_t 
-    left = song->voice[v].left_mix;
-  sample_t s;
-  
-  while (count--)
-    {
-      s = *sp++;
-      MIXATION(left);
-    }
+  mix_run_mono(sp, lp, song->voice[v].left_mix, count);
 }
 
 /* Ramp a note out in c samples */
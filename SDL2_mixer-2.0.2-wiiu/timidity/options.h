@@ -69,6 +69,10 @@
 
 #define MAX_AMPLIFICATION 800
 
+/* How much memory instruments no song is using may keep taking up, so
+   the next song that uses them doesn't have to load them again. */
+#define INSTRUMENT_CACHE_BYTES (16*1024*1024)
+
 /* You could specify a complete path, e.g. "/etc/timidity.cfg", and
    then specify the library directory in the configuration file. */
 #define CONFIG_FILE	"timidity.cfg"
@@ -114,4 +118,21 @@
 #  define PATH_SEP '/'
 #endif
 
+/* GCC and clang's generic vector extensions, for the mixing and output
+   loops. They turn into SIMD code where the CPU has it, and into plain
+   unrolled code where it doesn't. */
+#if defined(__clang__) || (defined(__GNUC__) && (__GNUC__ >= 9))
+#define TIMIDITY_VECTORS 1
+typedef Sint32 s32x4_t __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Uint32 u32x4_t __attribute__((vector_size(16), aligned(1), may_alias));
+typedef float f32x4_t __attribute__((vector_size(16), aligned(1), may_alias));
+typedef Sint16 s16x4_t __attribute__((vector_size(8), aligned(1), may_alias));
+typedef Uint16 u16x4_t __attribute__((vector_size(8), aligned(1), may_alias));
+typedef Sint8 s8x4_t __attribute__((vector_size(4), aligned(1), may_alias));
+#define SWAP16x4(v) (((v) << 8) | ((v) >> 8))
+#define SWAP32x4(v) (((v) << 24) | (((v) << 8) & 0x00FF0000) | (((v) >> 8) & 0x0000FF00) | ((v) >> 24))
+#else
+#define TIMIDITY_VECTORS 0
+#endif
+
 #define SNDDBG(X)
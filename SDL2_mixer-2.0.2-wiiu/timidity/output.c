@@ -23,10 +23,29 @@
 /*****************************************************************/
 /* Some functions to convert signed 32-bit data to other formats */
 
+#if TIMIDITY_VECTORS
+/* Shift four samples down to bits bits and clamp them to that range. */
+static SDL_INLINE s32x4_t clamp_x4(const Sint32 *lp, int bits)
+{
+  const Sint32 hi = (1 << (bits-1)) - 1, lo = -(1 << (bits-1));
+  s32x4_t l = *(const s32x4_t *)lp >> (32-bits-GUARD_BITS);
+  s32x4_t mask;
+  mask = (l > hi);
+  l = (l & ~mask) | (mask & hi);
+  mask = (l < lo);
+  l = (l & ~mask) | (mask & lo);
+  return l;
+}
+#endif
+
 void s32tos8(void *dp, Sint32 *lp, Sint32 c)
 {
   Sint8 *cp=(Sint8 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, cp += 4)
+    *(s8x4_t *)cp = __builtin_convertvector(clamp_x4(lp, 8), s8x4_t);
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-8-GUARD_BITS);
@@ -40,6 +59,10 @@ void s32tou8(void *dp, Sint32 *lp, Sint32 c)
 {
   Uint8 *cp=(Uint8 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, cp += 4)
+    *(s8x4_t *)cp = __builtin_convertvector(clamp_x4(lp, 8) ^ 0x80, s8x4_t);
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-8-GUARD_BITS);
@@ -53,6 +76,10 @@ void s32tos16(void *dp, Sint32 *lp, Sint32 c)
 {
   Sint16 *sp=(Sint16 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    *(s16x4_t *)sp = __builtin_convertvector(clamp_x4(lp, 16), s16x4_t);
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-16-GUARD_BITS);
@@ -66,6 +93,10 @@ void s32tou16(void *dp, Sint32 *lp, Sint32 c)
 {
   Uint16 *sp=(Uint16 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    *(s16x4_t *)sp = __builtin_convertvector(clamp_x4(lp, 16) ^ 0x8000, s16x4_t);
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-16-GUARD_BITS);
@@ -79,6 +110,13 @@ void s32tos16x(void *dp, Sint32 *lp, Sint32 c)
 {
   Sint16 *sp=(Sint16 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    {
+      u16x4_t out = (u16x4_t)__builtin_convertvector(clamp_x4(lp, 16), s16x4_t);
+      *(u16x4_t *)sp = SWAP16x4(out);
+    }
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-16-GUARD_BITS);
@@ -92,6 +130,13 @@ void s32tou16x(void *dp, Sint32 *lp, Sint32 c)
 {
   Uint16 *sp=(Uint16 *)(dp);
   Sint32 l;
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    {
+      u16x4_t out = (u16x4_t)__builtin_convertvector(clamp_x4(lp, 16) ^ 0x8000, s16x4_t);
+      *(u16x4_t *)sp = SWAP16x4(out);
+    }
+#endif
   while (c--)
     {
       l=(*lp++)>>(32-16-GUARD_BITS);
@@ -104,6 +149,10 @@ void s32tou16x(void *dp, Sint32 *lp, Sint32 c)
 void s32tof32(void *dp, Sint32 *lp, Sint32 c)
 {
   float *sp=(float *)(dp);
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    *(f32x4_t *)sp = __builtin_convertvector(*(const s32x4_t *)lp, f32x4_t) / 2147483647.0f;
+#endif
   while (c--)
     {
       *sp++ = (float)(*lp++) / 2147483647.0f;
@@ -122,6 +171,13 @@ void s32tos32(void *dp, Sint32 *lp, Sint32 c)
 void s32tos32x(void *dp, Sint32 *lp, Sint32 c)
 {
   Sint32 *sp=(Sint32 *)(dp);
+#if TIMIDITY_VECTORS
+  for (; c >= 4; c -= 4, lp += 4, sp += 4)
+    {
+      u32x4_t out = *(const u32x4_t *)lp;
+      *(u32x4_t *)sp = SWAP32x4(out);
+    }
+#endif
   while (c--)
     {
       *sp++ = SDL_Swap32(*lp++);
@@ -73,23 +73,42 @@ static int dumpstring(SDL_RWops *rw, Sint32 len, char *label)
   return 0;
 }
 
+/* Make room for one more event at the end of the song's event list. The
+   list is a single block, grown as needed, rather than a malloc per event. */
+static MidiEvent *new_event(MidiSong *song)
+{
+  if (song->event_count == song->evlist_size)
+    {
+      Sint32 size = song->evlist_size ? song->evlist_size * 2 : 1024;
+      MidiEvent *evlist;
+      if (size < song->evlist_size ||
+	  !(evlist = realloc(song->evlist, size * sizeof(MidiEvent))))
+	{
+	  SNDDBG(("Out of memory for MIDI events\n"));
+	  return 0;
+	}
+      song->evlist = evlist;
+      song->evlist_size = size;
+    }
+  return &song->evlist[song->event_count++];
+}
+
 #define MIDIEVENT(at,t,ch,pa,pb) \
-  new=safe_malloc(sizeof(MidiEventList)); \
-  new->event.time=at; new->event.type=t; new->event.channel=ch; \
-  new->event.a=pa; new->event.b=pb; new->next=0;\
+  if (!(new=new_event(song))) return 0; \
+  new->time=at; new->type=t; new->channel=ch; \
+  new->a=pa; new->b=pb; \
   return new;
 
-#define MAGIC_EOT ((MidiEventList *)(-1))
+#define MAGIC_EOT ((MidiEvent *)(-1))
 
-/* Read a MIDI event, returning a freshly allocated element that can
-   be linked to the event list */
-static MidiEventList *read_midi_event(MidiSong *song)
+/* Read a MIDI event, adding it to the end of the event list */
+static MidiEvent *read_midi_event(MidiSong *song)
 {
   static Uint8 laststatus, lastchan;
   static Uint8 nrpn=0, rpn_msb[16], rpn_lsb[16]; /* one per channel */
   Uint8 me, type, a,b,c;
   Sint32 len;
-  MidiEventList *new;
+  MidiEvent *new;
 
   for (;;)
     {
@@ -259,24 +278,18 @@ static MidiEventList *read_midi_event(MidiSong *song)
 
 #undef MIDIEVENT
 
-/* Read a midi track into the linked list, either merging with any previous
-   tracks or appending to them. */
+/* Read a midi track onto the end of the event list. Type 1 tracks get
+   merged afterwards, by merge_tracks(). To play type 2 tracks one after the
+   other, 'append' starts this one's clock where the last one ended. */
 static int read_track(MidiSong *song, int append)
 {
-  MidiEventList *meep;
-  MidiEventList *next, *new;
+  MidiEvent *new;
   Sint32 len;
   Sint64 next_pos, pos;
   char tmp[4];
 
-  meep = song->evlist;
-  if (append && meep)
-    {
-      /* find the last event in the list */
-      for (; meep->next; meep=meep->next)
-	;
-      song->at = meep->event.time;
-    }
+  if (append && song->event_count)
+    song->at = song->evlist[song->event_count - 1].time;
   else
     song->at=0;
 
@@ -307,45 +320,66 @@ static int read_track(MidiSong *song, int append)
             SDL_RWseek(song->rw, next_pos - pos, RW_SEEK_CUR);
 	  return 0;
 	}
+    }
+}
 
-      next=meep->next;
-      while (next && (next->event.time < new->event.time))
+/* Merge the tracks of a type 1 file, which start at the event indices in
+   track_start[], into one list in time order. Where tracks have events at
+   the same time, the later track's go first. Tracks are merged in pairs,
+   then pairs of pairs, and so on. */
+static int merge_tracks(MidiSong *song, Sint32 *track_start, int tracks)
+{
+  MidiEvent *from = song->evlist, *to, *swap;
+  int i, j;
+
+  if (tracks < 2)
+    return 0;
+  if (!(to = safe_malloc(song->evlist_size * sizeof(MidiEvent))))
+    return -1;
+  memcpy(to, from, track_start[0] * sizeof(MidiEvent));
+
+  while (tracks > 1)
+    {
+      for (i = j = 0; i < tracks; i += 2, j++)
 	{
-	  meep=next;
-	  next=meep->next;
+	  MidiEvent *lo = from + track_start[i], *lo_end = from + track_start[i+1];
+	  MidiEvent *hi = lo_end, *hi_end = hi, *dest = to + track_start[i];
+
+	  if (i+1 < tracks)
+	    hi_end = from + track_start[i+2];
+	  while (lo < lo_end && hi < hi_end)
+	    *dest++ = (hi->time <= lo->time) ? *hi++ : *lo++;
+	  while (lo < lo_end)
+	    *dest++ = *lo++;
+	  while (hi < hi_end)
+	    *dest++ = *hi++;
+	  track_start[j] = track_start[i];
 	}
-	  
-      new->next=next;
-      meep->next=new;
-
-      song->event_count++; /* Count the event. (About one?) */
-      meep=new;
+      track_start[j] = track_start[tracks];
+      tracks = j;
+      swap = from; from = to; to = swap;
     }
+
+  free(to);
+  song->evlist = from;
+  return 0;
 }
 
-/* Free the linked event list from memory. */
+/* Free the event list from memory. */
 static void free_midi_list(MidiSong *song)
 {
-  MidiEventList *meep, *next;
-  if (!(meep = song->evlist)) return;
-  while (meep)
-    {
-      next=meep->next;
-      free(meep);
-      meep=next;
-    }
+  free(song->evlist);
   song->evlist=0;
+  song->event_count=song->evlist_size=0;
 }
 
-/* Allocate an array of MidiEvents and fill it from the linked list of
-   events, marking used instruments for loading. Convert event times to
-   samples: handle tempo changes. Strip unnecessary events from the list.
-   Free the linked list. */
+/* Turn the event list into the song's array of MidiEvents in place,
+   marking used instruments for loading. Convert event times to samples:
+   handle tempo changes. Strip unnecessary events from the list. */
 static MidiEvent *groom_list(MidiSong *song, Sint32 divisions,Sint32 *eventsp,
 			     Sint32 *samplesp)
 {
-  MidiEvent *groomed_list, *lp;
-  MidiEventList *meep;
+  MidiEvent *groomed_list, *lp, ev;
   Sint32 i, our_event_count, tempo, skip_this_event, new_value;
   Sint32 sample_cum, samples_to_do, at, st, dt, counting_time;
 
@@ -362,9 +396,18 @@ static MidiEvent *groom_list(MidiSong *song, Sint32 divisions,Sint32 *eventsp,
   tempo=500000;
   compute_sample_increment(song, tempo, divisions);
 
-  /* This may allocate a bit more than we need */
-  groomed_list=lp=safe_malloc(sizeof(MidiEvent) * (song->event_count+1));
-  meep=song->evlist;
+  /* Events only ever get dropped, so this can overwrite the list as it goes.
+     It just needs room for the End-of-Track event. */
+  if (song->event_count == song->evlist_size)
+    {
+      if (!new_event(song))
+	{
+	  free_midi_list(song);
+	  return 0;
+	}
+      song->event_count--;
+    }
+  groomed_list=lp=song->evlist;
 
   our_event_count=0;
   st=at=sample_cum=0;
@@ -372,37 +415,38 @@ static MidiEvent *groom_list(MidiSong *song, Sint32 divisions,Sint32 *eventsp,
 
   for (i = 0; i < song->event_count; i++)
     {
+      ev=song->evlist[i];
       skip_this_event=0;
 
-      if (meep->event.type==ME_TEMPO)
+      if (ev.type==ME_TEMPO)
 	{
 	  skip_this_event=1;
 	}
-      else if (meep->event.channel >= MAXCHAN)
+      else if (ev.channel >= MAXCHAN)
         skip_this_event=1;
-      else switch (meep->event.type)
+      else switch (ev.type)
 	{
 	case ME_PROGRAM:
-	  if (ISDRUMCHANNEL(song, meep->event.channel))
+	  if (ISDRUMCHANNEL(song, ev.channel))
 	    {
-	      if (song->drumset[meep->event.a]) /* Is this a defined drumset? */
-		new_value=meep->event.a;
+	      if (song->drumset[ev.a]) /* Is this a defined drumset? */
+		new_value=ev.a;
 	      else
 		{
-		  SNDDBG(("Drum set %d is undefined\n", meep->event.a));
-		  new_value=meep->event.a=0;
+		  SNDDBG(("Drum set %d is undefined\n", ev.a));
+		  new_value=ev.a=0;
 		}
-	      if (current_set[meep->event.channel] != new_value)
-		current_set[meep->event.channel]=new_value;
+	      if (current_set[ev.channel] != new_value)
+		current_set[ev.channel]=new_value;
 	      else 
 		skip_this_event=1;
 	    }
 	  else
 	    {
-	      new_value=meep->event.a;
-	      if ((current_program[meep->event.channel] != SPECIAL_PROGRAM)
-		  && (current_program[meep->event.channel] != new_value))
-		current_program[meep->event.channel] = new_value;
+	      new_value=ev.a;
+	      if ((current_program[ev.channel] != SPECIAL_PROGRAM)
+		  && (current_program[ev.channel] != new_value))
+		current_program[ev.channel] = new_value;
 	      else
 		skip_this_event=1;
 	    }
@@ -411,49 +455,49 @@ static MidiEvent *groom_list(MidiSong *song, Sint32 divisions,Sint32 *eventsp,
 	case ME_NOTEON:
 	  if (counting_time)
 	    counting_time=1;
-	  if (ISDRUMCHANNEL(song, meep->event.channel))
+	  if (ISDRUMCHANNEL(song, ev.channel))
 	    {
 	      /* Mark this instrument to be loaded */
-	      if (!(song->drumset[current_set[meep->event.channel]]
-		    ->instrument[meep->event.a]))
-		song->drumset[current_set[meep->event.channel]]
-		  ->instrument[meep->event.a] = MAGIC_LOAD_INSTRUMENT;
+	      if (!(song->drumset[current_set[ev.channel]]
+		    ->instrument[ev.a]))
+		song->drumset[current_set[ev.channel]]
+		  ->instrument[ev.a] = MAGIC_LOAD_INSTRUMENT;
 	    }
 	  else
 	    {
-	      if (current_program[meep->event.channel]==SPECIAL_PROGRAM)
+	      if (current_program[ev.channel]==SPECIAL_PROGRAM)
 		break;
 	      /* Mark this instrument to be loaded */
-	      if (!(song->tonebank[current_bank[meep->event.channel]]
-		    ->instrument[current_program[meep->event.channel]]))
-		song->tonebank[current_bank[meep->event.channel]]
-		  ->instrument[current_program[meep->event.channel]] =
+	      if (!(song->tonebank[current_bank[ev.channel]]
+		    ->instrument[current_program[ev.channel]]))
+		song->tonebank[current_bank[ev.channel]]
+		  ->instrument[current_program[ev.channel]] =
 		    MAGIC_LOAD_INSTRUMENT;
 	    }
 	  break;
 
 	case ME_TONE_BANK:
-	  if (ISDRUMCHANNEL(song, meep->event.channel))
+	  if (ISDRUMCHANNEL(song, ev.channel))
 	    {
 	      skip_this_event=1;
 	      break;
 	    }
-	  if (song->tonebank[meep->event.a]) /* Is this a defined tone bank? */
-	    new_value=meep->event.a;
+	  if (song->tonebank[ev.a]) /* Is this a defined tone bank? */
+	    new_value=ev.a;
 	  else 
 	    {
-	      SNDDBG(("Tone bank %d is undefined\n", meep->event.a));
-	      new_value=meep->event.a=0;
+	      SNDDBG(("Tone bank %d is undefined\n", ev.a));
+	      new_value=ev.a=0;
 	    }
-	  if (current_bank[meep->event.channel]!=new_value)
-	    current_bank[meep->event.channel]=new_value;
+	  if (current_bank[ev.channel]!=new_value)
+	    current_bank[ev.channel]=new_value;
 	  else
 	    skip_this_event=1;
 	  break;
 	}
 
       /* Recompute time in samples*/
-      if ((dt=meep->event.time - at) && !counting_time)
+      if ((dt=ev.time - at) && !counting_time)
 	{
 	  samples_to_do = song->sample_increment * dt;
 	  sample_cum += song->sample_correction * dt;
@@ -465,55 +509,205 @@ static MidiEvent *groom_list(MidiSong *song, Sint32 divisions,Sint32 *eventsp,
 	  st += samples_to_do;
 	}
       else if (counting_time==1) counting_time=0;
-      if (meep->event.type==ME_TEMPO)
+      if (ev.type==ME_TEMPO)
 	{
 	  tempo=
-	    meep->event.channel + meep->event.b * 256 + meep->event.a * 65536;
+	    ev.channel + ev.b * 256 + ev.a * 65536;
 	  compute_sample_increment(song, tempo, divisions);
 	}
       if (!skip_this_event)
 	{
 	  /* Add the event to the list */
-	  *lp=meep->event;
+	  *lp=ev;
 	  lp->time=st;
 	  lp++;
 	  our_event_count++;
 	}
-      at=meep->event.time;
-      meep=meep->next;
+      at=ev.time;
     }
   /* Add an End-of-Track event */
   lp->time=st;
   lp->type=ME_EOT;
   our_event_count++;
-  free_midi_list(song);
+  song->evlist=0;
+  song->event_count=song->evlist_size=0;
 
   *eventsp=our_event_count;
   *samplesp=st;
   return groomed_list;
 }
 
-MidiEvent *read_midi_file(MidiSong *song, Sint32 *count, Sint32 *sp)
+/* Where to keep the parsed events of the songs we've loaded, if anywhere */
+static char *event_cache_dir = NULL;
+
+int Timidity_SetEventCache(const char *directory)
+{
+  char *dir = NULL;
+
+  if (directory && !(dir = safe_malloc(strlen(directory)+1)))
+    return -1;
+  if (dir)
+    strcpy(dir, directory);
+  free(event_cache_dir);
+  event_cache_dir = dir;
+  return 0;
+}
+
+#define EVENT_CACHE_MAGIC 0x544D4556 /* "TMEV" */
+#define EVENT_CACHE_VERSION 2
+
+/* A cache file is this, in the byte order of the machine that wrote it,
+   followed by the events exactly as they're laid out in memory, so they
+   can be read straight into the event list. A file from a machine with the
+   other byte order just doesn't match, and gets rewritten. events_hash is
+   hash_midi() of the events, to catch a damaged file. */
+typedef struct {
+  Uint32 magic, version, midi_size, midi_hash;
+  Sint32 divisions, event_count;
+  Uint32 events_hash;
+} EventCacheHeader;
+
+static Uint32 hash_midi(const Uint8 *data, size_t size)
+{
+  Uint32 h = 2166136261u;
+  while (size--)
+    h = (h ^ *data++) * 16777619u;
+  return h;
+}
+
+/* Could parse_midi_file() have made these events? Anything else in a
+   cache file would index past the channel and instrument arrays. */
+static int valid_cached_events(const MidiEvent *ev, Sint32 count)
+{
+  Sint32 i, at = 0;
+
+  for (i = 0; i < count; i++, ev++)
+    {
+      if (ev->time < at)
+	return 0;
+      at = ev->time;
+      if (ev->type == ME_TEMPO)
+	continue; /* the tempo's three bytes, any value */
+      if (ev->type > ME_TONE_BANK || ev->channel >= MAXCHAN ||
+	  ev->a >= 128 || ev->b >= 128)
+	return 0;
+    }
+  return 1;
+}
+
+static char *event_cache_path(Uint32 size, Uint32 hash)
+{
+  size_t len = strlen(event_cache_dir) + 32;
+  char *path = safe_malloc(len);
+  if (path)
+    SDL_snprintf(path, len, "%s%c%08x-%08x.tmev", event_cache_dir, PATH_SEP,
+		 (unsigned int)hash, (unsigned int)size);
+  return path;
+}
+
+/* Fill the event list from the cache file for this MIDI file, if there's
+   a good one. If not, the file gets parsed and the cache rewritten. */
+static int read_event_cache(MidiSong *song, const char *path, Uint32 size,
+			    Uint32 hash, Sint32 *divisions)
+{
+  EventCacheHeader header;
+  SDL_RWops *rw;
+  int ok = 0;
+
+  if (!(rw = SDL_RWFromFile(path, "rb")))
+    return 0;
+  if (SDL_RWread(rw, &header, sizeof(header), 1) == 1 &&
+      header.magic == EVENT_CACHE_MAGIC &&
+      header.version == EVENT_CACHE_VERSION &&
+      header.midi_size == size && header.midi_hash == hash &&
+      header.event_count > 0 && header.event_count <= (Sint32)(size/2 + 1))
+    {
+      /* One more for groom_list()'s End-of-Track event */
+      song->evlist = safe_malloc((header.event_count + 1) * sizeof(MidiEvent));
+      if (song->evlist &&
+	  SDL_RWread(rw, song->evlist, sizeof(MidiEvent), header.event_count) ==
+	    (size_t)header.event_count &&
+	  hash_midi((const Uint8 *)song->evlist,
+		    header.event_count * sizeof(MidiEvent)) == header.events_hash &&
+	  valid_cached_events(song->evlist, header.event_count))
+	{
+	  song->event_count = header.event_count;
+	  song->evlist_size = header.event_count + 1;
+	  *divisions = header.divisions;
+	  ok = 1;
+	}
+      else
+	free_midi_list(song);
+    }
+  SDL_RWclose(rw);
+  return ok;
+}
+
+static void write_event_cache(MidiSong *song, const char *path, Uint32 size,
+			      Uint32 hash, Sint32 divisions)
 {
-  Sint32 len, divisions;
+  EventCacheHeader header;
+  SDL_RWops *rw;
+  int ok;
+
+  if (!(rw = SDL_RWFromFile(path, "wb")))
+    return;
+  header.magic = EVENT_CACHE_MAGIC;
+  header.version = EVENT_CACHE_VERSION;
+  header.midi_size = size;
+  header.midi_hash = hash;
+  header.divisions = divisions;
+  header.event_count = song->event_count;
+  header.events_hash = hash_midi((const Uint8 *)song->evlist,
+				 song->event_count * sizeof(MidiEvent));
+  ok = (SDL_RWwrite(rw, &header, sizeof(header), 1) == 1 &&
+	SDL_RWwrite(rw, song->evlist, sizeof(MidiEvent), song->event_count) ==
+	  (size_t)song->event_count);
+  SDL_RWclose(rw);
+  if (!ok)
+    {
+      SNDDBG(("Couldn't write MIDI event cache %s\n", path));
+    }
+}
+
+/* Read the rest of the file into memory in one go, so parsing it doesn't
+   go back to the file for every byte. */
+static Uint8 *read_whole_file(SDL_RWops *rw, size_t *sizep)
+{
+  Sint64 pos = SDL_RWtell(rw), end = SDL_RWsize(rw);
+  Uint8 *data;
+
+  if (pos < 0 || end <= pos || end - pos > 0x7FFFFFFF)
+    return 0;
+  if (!(data = safe_malloc((size_t)(end - pos))))
+    return 0;
+  if (SDL_RWread(rw, data, 1, (size_t)(end - pos)) != (size_t)(end - pos))
+    {
+      free(data);
+      SDL_RWseek(rw, pos, RW_SEEK_SET);
+      return 0;
+    }
+  *sizep = (size_t)(end - pos);
+  return data;
+}
+
+static int parse_midi_file(MidiSong *song, Sint32 *divisionsp)
+{
+  Sint32 len, divisions, *track_start;
   Sint16 format, tracks, divisions_tmp;
   int i;
   char tmp[4];
 
-  song->event_count=0;
-  song->at=0;
-  song->evlist=0;
-
   if (SDL_RWread(song->rw, tmp, 1, 4) != 4 || SDL_RWread(song->rw, &len, 4, 1) != 1)
     {
       SNDDBG(("Not a MIDI file!\n"));
-      return 0;
+      return -1;
     }
   len=SDL_SwapBE32(len);
   if (memcmp(tmp, "MThd", 4) || len < 6)
     {
       SNDDBG(("Not a MIDI file!\n"));
-      return 0;
+      return -1;
     }
 
   SDL_RWread(song->rw, &format, 2, 1);
@@ -539,53 +733,91 @@ MidiEvent *read_midi_file(MidiSong *song, Sint32 *count, Sint32 *sp)
   if (format<0 || format >2)
     {
       SNDDBG(("Unknown MIDI file format %d\n", format));
-      return 0;
+      return -1;
     }
   if (tracks<1)
     {
       SNDDBG(("Bad number of tracks %d\n", tracks));
-      return 0;
+      return -1;
     }
   if (format==0 && tracks!=1)
     {
       SNDDBG(("%d tracks with Type-0 MIDI (must be 1.)\n", tracks));
-      return 0;
+      return -1;
     }
   SNDDBG(("Format: %d  Tracks: %d  Divisions: %d\n",
 	  format, tracks, divisions));
 
   /* Put a do-nothing event first in the list for easier processing */
-  song->evlist=safe_malloc(sizeof(MidiEventList));
-  memset(song->evlist, 0, sizeof(MidiEventList));
-  song->event_count++;
+  if (!new_event(song))
+    return -1;
+  memset(song->evlist, 0, sizeof(MidiEvent));
 
-  switch(format)
+  if (!(track_start = safe_malloc((tracks+1) * sizeof(Sint32))))
+    return -1;
+  for (i=0; i<tracks; i++)
     {
-    case 0:
-      if (read_track(song, 0))
+      track_start[i] = song->event_count;
+      /* Type 2 tracks play one after the other */
+      if (read_track(song, format==2))
 	{
-	  free_midi_list(song);
-	  return 0;
+	  free(track_start);
+	  return -1;
 	}
-      break;
-
-    case 1:
-      for (i=0; i<tracks; i++)
-	if (read_track(song, 0))
-	  {
-	    free_midi_list(song);
-	    return 0;
-	  }
-      break;
-
-    case 2: /* We simply play the tracks sequentially */
-      for (i=0; i<tracks; i++)
-	if (read_track(song, 1))
-	  {
-	    free_midi_list(song);
-	    return 0;
-	  }
-      break;
+    }
+  track_start[tracks] = song->event_count;
+  i = (format==1) ? merge_tracks(song, track_start, tracks) : 0;
+  free(track_start);
+
+  *divisionsp = divisions;
+  return i;
+}
+
+MidiEvent *read_midi_file(MidiSong *song, Sint32 *count, Sint32 *sp)
+{
+  SDL_RWops *rw = song->rw, *mem = 0;
+  Sint32 divisions;
+  Uint8 *data;
+  size_t size = 0;
+  Uint32 hash = 0;
+  char *cache = 0;
+  int ok;
+
+  song->event_count=song->evlist_size=0;
+  song->at=0;
+  song->evlist=0;
+
+  if ((data = read_whole_file(rw, &size)))
+    {
+      if (event_cache_dir)
+	{
+	  hash = hash_midi(data, size);
+	  cache = event_cache_path((Uint32)size, hash);
+	}
+      if (cache && read_event_cache(song, cache, (Uint32)size, hash, &divisions))
+	{
+	  free(cache);
+	  free(data);
+	  return groom_list(song, divisions, count, sp);
+	}
+      if ((mem = SDL_RWFromConstMem(data, (int)size)))
+	song->rw = mem;
+    }
+
+  ok = (parse_midi_file(song, &divisions) == 0);
+  if (ok && cache)
+    write_event_cache(song, cache, (Uint32)size, hash, divisions);
+
+  song->rw = rw;
+  if (mem)
+    SDL_RWclose(mem);
+  free(cache);
+  free(data);
+
+  if (!ok)
+    {
+      free_midi_list(song);
+      return 0;
     }
   return groom_list(song, divisions, count, sp);
 }
@@ -29,6 +29,43 @@
 
 #define PRECALC_LOOP_COUNT(start, end, incr) (((end) - (start) + (incr) - 1) / (incr))
 
+/* Linearly interpolate count samples starting at *ofsptr, stepping by incr.
+   Returns where the next sample goes and leaves the offset after the last one. */
+static SDL_INLINE sample_t *rs_linear(sample_t *dest, const sample_t *src,
+				      Sint32 *ofsptr, Sint32 incr, Sint32 count)
+{
+  Sint32 ofs = *ofsptr, o1, o2, o3, v1, v2;
+
+#define RS_LINEAR(o) \
+  (v1 = src[(o) >> FRACTION_BITS], v2 = src[((o) >> FRACTION_BITS)+1], \
+   (sample_t)(v1 + (((v2 - v1) * ((o) & FRACTION_MASK)) >> FRACTION_BITS)))
+
+  /* Four at a time, each with its own offset so the loads don't wait on
+     one another. The taps sit at fractional steps through the sample,
+     which vector loads can't fetch, so this stays scalar. */
+  for (; count >= 4; count -= 4)
+    {
+      o1 = ofs + incr;
+      o2 = ofs + incr*2;
+      o3 = ofs + incr*3;
+      dest[0] = RS_LINEAR(ofs);
+      dest[1] = RS_LINEAR(o1);
+      dest[2] = RS_LINEAR(o2);
+      dest[3] = RS_LINEAR(o3);
+      dest += 4;
+      ofs += incr*4;
+    }
+  for (; count > 0; count--)
+    {
+      *dest++ = RS_LINEAR(ofs);
+      ofs += incr;
+    }
+#undef RS_LINEAR
+
+  *ofsptr = ofs;
+  return dest;
+}
+
 /*************** resampling with fixed increment *****************/
 
 static sample_t *rs_plain(MidiSong *song, int v, Sint32 *countptr)
@@ -36,7 +73,6 @@ static sample_t *rs_plain(MidiSong *song, int v, Sint32 *countptr)
 
   /* Play sample until end, then free the voice. */
 
-  sample_t v1, v2;
   Voice 
     *vp=&(song->voice[v]);
   sample_t 
@@ -47,7 +83,7 @@ static sample_t *rs_plain(MidiSong *song, int v, Sint32 *countptr)
     incr=vp->sample_increment,
     le=vp->sample->data_length,
     count=*countptr;
-  Sint32 i, j;
+  Sint32 i;
 
   if (incr<0) incr = -incr; /* In case we're coming out of a bidir loop */
 
@@ -62,13 +98,7 @@ static sample_t *rs_plain(MidiSong *song, int v, Sint32 *countptr)
     } 
   else count -= i;
 
-  for (j = 0; j < i; j++)
-    {
-      v1 = src[ofs >> FRACTION_BITS];
-      v2 = src[(ofs >> FRACTION_BITS)+1];
-      *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-      ofs += incr;
-    }
+  dest = rs_linear(dest, src, &ofs, incr, i);
 
   if (ofs >= le) 
     {
@@ -87,7 +117,6 @@ static sample_t *rs_loop(MidiSong *song, Voice *vp, Sint32 count)
 
   /* Play sample until end-of-loop, skip back and continue. */
 
-  sample_t v1, v2;
   Sint32 
     ofs=vp->sample_offset, 
     incr=vp->sample_increment,
@@ -96,7 +125,7 @@ static sample_t *rs_loop(MidiSong *song, Voice *vp, Sint32 count)
   sample_t
     *dest=song->resample_buffer,
     *src=vp->sample->data;
-  Sint32 i, j;
+  Sint32 i;
   
   while (count) 
     {
@@ -110,13 +139,7 @@ static sample_t *rs_loop(MidiSong *song, Voice *vp, Sint32 count)
 	  count = 0;
 	} 
       else count -= i;
-      for (j = 0; j < i; j++)
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
     }
 
   vp->sample_offset=ofs; /* Update offset */
@@ -125,7 +148,6 @@ static sample_t *rs_loop(MidiSong *song, Voice *vp, Sint32 count)
 
 static sample_t *rs_bidir(MidiSong *song, Voice *vp, Sint32 count)
 {
-  sample_t v1, v2;
   Sint32 
     ofs=vp->sample_offset,
     incr=vp->sample_increment,
@@ -137,7 +159,7 @@ static sample_t *rs_bidir(MidiSong *song, Voice *vp, Sint32 count)
   Sint32
     le2 = le<<1,
     ls2 = ls<<1,
-    i, j;
+    i;
   /* Play normally until inside the loop region */
 
   if (incr > 0 && ofs < ls)
@@ -152,13 +174,7 @@ static sample_t *rs_bidir(MidiSong *song, Voice *vp, Sint32 count)
 	  count = 0;
 	} 
       else count -= i;
-      for (j = 0; j < i; j++)
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
     }
 
   /* Then do the bidirectional looping */
@@ -173,13 +189,7 @@ static sample_t *rs_bidir(MidiSong *song, Voice *vp, Sint32 count)
 	  count = 0;
 	} 
       else count -= i;
-      for (j = 0; j < i; j++)
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
       if (ofs>=le) 
 	{
 	  /* fold the overshoot back in */
@@ -329,7 +339,6 @@ static sample_t *rs_vib_loop(MidiSong *song, Voice *vp, Sint32 count)
 
   /* Play sample until end-of-loop, skip back and continue. */
   
-  sample_t v1, v2;
   Sint32 
     ofs=vp->sample_offset, 
     incr=vp->sample_increment, 
@@ -340,7 +349,7 @@ static sample_t *rs_vib_loop(MidiSong *song, Voice *vp, Sint32 count)
     *src=vp->sample->data;
   int 
     cc=vp->vibrato_control_counter;
-  Sint32 i, j;
+  Sint32 i;
   int
     vibflag=0;
 
@@ -360,13 +369,7 @@ static sample_t *rs_vib_loop(MidiSong *song, Voice *vp, Sint32 count)
 	} 
       else cc -= i;
       count -= i;
-      for (j = 0; j < i; j++)
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
       if(vibflag) 
 	{
 	  cc = vp->vibrato_control_ratio;
@@ -383,7 +386,6 @@ static sample_t *rs_vib_loop(MidiSong *song, Voice *vp, Sint32 count)
 
 static sample_t *rs_vib_bidir(MidiSong *song, Voice *vp, Sint32 count)
 {
-  sample_t v1, v2;
   Sint32 
     ofs=vp->sample_offset, 
     incr=vp->sample_increment,
@@ -397,7 +399,7 @@ static sample_t *rs_vib_bidir(MidiSong *song, Voice *vp, Sint32 count)
   Sint32
     le2=le<<1,
     ls2=ls<<1,
-    i, j;
+    i;
   int
     vibflag = 0;
 
@@ -413,13 +415,7 @@ static sample_t *rs_vib_bidir(MidiSong *song, Voice *vp, Sint32 count)
 	} 
       else cc -= i;
       count -= i;
-      for (j = 0; j < i; j++)
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
       if (vibflag) 
 	{
 	  cc = vp->vibrato_control_ratio;
@@ -442,13 +438,7 @@ static sample_t *rs_vib_bidir(MidiSong *song, Voice *vp, Sint32 count)
 	} 
       else cc -= i;
       count -= i;
-      while (i--) 
-	{
-          v1 = src[ofs >> FRACTION_BITS];
-          v2 = src[(ofs >> FRACTION_BITS)+1];
-          *dest++ = v1 + (((v2 - v1) * (ofs & FRACTION_MASK)) >> FRACTION_BITS);
-	  ofs += incr;
-	}
+      dest = rs_linear(dest, src, &ofs, incr, i);
       if (vibflag) 
 	{
 	  cc = vp->vibrato_control_ratio;
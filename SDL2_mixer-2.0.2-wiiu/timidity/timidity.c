@@ -32,6 +32,17 @@ ToneBank *master_tonebank[MAXBANK], *master_drumset[MAXBANK];
 
 static char def_instr_name[256] = "";
 
+/* Background bank preloads, to wait for in Timidity_Exit() */
+typedef struct _PreloadThread {
+  SDL_Thread *thread;
+  MidiSong *song;
+  int dr;
+  ToneBank *bank;
+  struct _PreloadThread *next;
+} PreloadThread;
+
+static PreloadThread *preload_threads = NULL;
+
 #define MAXWORDS 10
 
 /* Quick-and-dirty fgets() replacement. */
@@ -400,6 +411,8 @@ fail:
 
 int Timidity_Init_NoConfig()
 {
+  init_instrument_cache();
+
   /* Allocate memory for the standard tonebank and drumset */
   master_tonebank[0] = safe_malloc(sizeof(ToneBank));
   memset(master_tonebank[0], 0, sizeof(ToneBank));
@@ -452,6 +465,16 @@ int Timidity_Init()
   return 0;
 }
 
+static Sint32 control_ratio(int freq)
+{
+  Sint32 ratio = freq / CONTROLS_PER_SECOND;
+  if (ratio < 1)
+      ratio = 1;
+  else if (ratio > MAX_CONTROL_RATIO)
+      ratio = MAX_CONTROL_RATIO;
+  return ratio;
+}
+
 MidiSong *Timidity_LoadSong(SDL_RWops *rw, SDL_AudioSpec *audio)
 {
   MidiSong *song;
@@ -537,11 +560,7 @@ MidiSong *Timidity_LoadSong(SDL_RWops *rw, SDL_AudioSpec *audio)
   song->resample_buffer = safe_malloc(audio->samples * sizeof(sample_t));
   song->common_buffer = safe_malloc(audio->samples * 2 * sizeof(Sint32));
   
-  song->control_ratio = audio->freq / CONTROLS_PER_SECOND;
-  if (song->control_ratio < 1)
-      song->control_ratio = 1;
-  else if (song->control_ratio > MAX_CONTROL_RATIO)
-      song->control_ratio = MAX_CONTROL_RATIO;
+  song->control_ratio = control_ratio(audio->freq);
 
   song->lost_notes = 0;
   song->cut_notes = 0;
@@ -590,10 +609,78 @@ void Timidity_FreeSong(MidiSong *song)
   free(song);
 }
 
+static int SDLCALL preload_thread(void *data)
+{
+  PreloadThread *p = (PreloadThread *) data;
+  preload_instruments(p->song, p->dr, p->bank);
+  return 0;
+}
+
+int Timidity_PreloadBank(SDL_AudioSpec *audio, int drums, int bank, int background)
+{
+  ToneBank *tb;
+  MidiSong *song;
+  PreloadThread *p;
+
+  if (bank < 0 || bank >= MAXBANK) {
+    SDL_SetError("Bank must be between 0 and %d", MAXBANK-1);
+    return -1;
+  }
+  tb = (drums) ? master_drumset[bank] : master_tonebank[bank];
+  if (!tb || !tb->tone) {
+    SDL_SetError("No such %s in the Timidity config", (drums) ? "drum set" : "tone bank");
+    return -1;
+  }
+
+  /* load_instrument() only wants the song for its rate */
+  song = (MidiSong *)safe_malloc(sizeof(*song));
+  if (!song) {
+    return SDL_OutOfMemory();
+  }
+  memset(song, 0, sizeof(*song));
+  song->rate = audio->freq;
+  song->control_ratio = control_ratio(audio->freq);
+
+  if (!background) {
+    preload_instruments(song, drums, tb);
+    free(song);
+    return 0;
+  }
+
+  p = (PreloadThread *)safe_malloc(sizeof(*p));
+  if (!p) {
+    free(song);
+    return SDL_OutOfMemory();
+  }
+  p->song = song;
+  p->dr = drums;
+  p->bank = tb;
+  p->thread = SDL_CreateThread(preload_thread, "Timidity preload", p);
+  if (!p->thread) {
+    free(p);
+    free(song);
+    return -1;
+  }
+  p->next = preload_threads;
+  preload_threads = p;
+  return 0;
+}
+
 void Timidity_Exit(void)
 {
   int i, j;
 
+  while (preload_threads)
+  {
+    PreloadThread *p = preload_threads;
+    preload_threads = p->next;
+    SDL_WaitThread(p->thread, NULL);
+    free(p->song);
+    free(p);
+  }
+  quit_instrument_cache();
+  Timidity_SetEventCache(NULL);
+
   for (i = 0; i < MAXBANK; i++)
   {
     if (master_tonebank[i])
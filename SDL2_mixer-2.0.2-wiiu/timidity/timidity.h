@@ -100,11 +100,6 @@ typedef struct {
     Uint8 channel, type, a, b;
 } MidiEvent;
 
-typedef struct {
-    MidiEvent event;
-    void *next;
-} MidiEventList;
-
 typedef struct {
     int playing;
     SDL_RWops *rw;
@@ -137,9 +132,10 @@ typedef struct {
     Sint32 samples;
     MidiEvent *events;
     MidiEvent *current_event;
-    MidiEventList *evlist;
+    MidiEvent *evlist;
     Sint32 current_sample;
     Sint32 event_count;
+    Sint32 evlist_size;
     Sint32 at;
     Sint32 groomed_event_count;
 } MidiSong;
@@ -154,7 +150,9 @@ extern MidiSong *Timidity_LoadSong(SDL_RWops *rw, SDL_AudioSpec *audio);
 extern void Timidity_Start(MidiSong *song);
 extern void Timidity_Seek(MidiSong *song, Uint32 ms);
 extern Uint32 Timidity_GetSongLength(MidiSong *song); /* returns millseconds */
+extern int Timidity_PreloadBank(SDL_AudioSpec *audio, int drums, int bank, int background);
 extern void Timidity_FreeSong(MidiSong *song);
+extern int Timidity_SetEventCache(const char *directory);
 extern void Timidity_Exit(void);
 
 #ifdef __cplusplus